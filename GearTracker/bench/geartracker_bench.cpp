@@ -0,0 +1,475 @@
+// ====== geartracker_bench.cpp ======
+// GearTracker 的 HTTP 压测工具：按配置的比例混合请求，对运行中的服务生成负载，
+// 以 JSON 输出吞吐量和 p50/p95/p99/p999 延迟，便于比较调优前后的结果。
+//
+//   闭环（默认）：每个线程一个连接，收到响应后立即发下一个请求，测量服务能承受的最大吞吐量
+//   开环（--rate）：按固定的总速率发请求，延迟从计划的发送时间算起（服务变慢时不会因为少发请求而掩盖排队时间）
+//
+// --seed-rows 在压测前经 POST /api/import 写入合成数据（物品、库存和对应的操作日志），
+// 服务可以使用 MySQL，也可以使用嵌入式 SQLite（[database] backend = sqlite）。
+#include "httplib.h"
+#include "JsonWriter.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+// 请求类型，与 --mix 中的名称一一对应
+enum RequestType {
+    INVENTORY,        // GET /api/inventory?page=N
+    INVENTORY_SEARCH, // GET /api/inventory?search=词&page=N
+    OPERATION_LOGS,   // GET /api/operation_logs?page=N（一半带 search）
+    SEARCH_ITEMS,     // GET /api/search-items?q=词
+    ADD_ITEM,         // POST /api/add-item（已有物品加入库存）
+    UPDATE_ITEM,      // PUT /api/inventory/:id
+    REQUEST_TYPES
+};
+
+const char* const kTypeNames[REQUEST_TYPES] = {
+    "inventory", "inventory_search", "operation_logs", "search_items", "add_item", "update_item"};
+
+// 合成数据的名称由这些词组成，搜索时从中随机取词
+const char* const kWords[] = {"铁剑", "灵石", "丹药", "符箓", "法袍", "玉佩", "飞剑", "灵草",
+                              "矿石", "卷轴", "iron", "jade", "spirit", "talisman", "elixir", "scroll"};
+const size_t kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+const char* const kCategories[] = {"武器", "丹药", "材料", "法宝", "符箓"};
+const char* const kGrades[] = {"凡品", "灵品", "宝品", "仙品"};
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    int threads = 8;
+    double duration = 30; // 秒
+    double warmup = 5;    // 秒，期间的请求不计入结果
+    double rate = 0;      // 总请求速率（每秒）；0 为闭环
+    int pageSize = 20;
+    int maxPage = 50;     // 随机页码的上限，深翻页单独用 --max-page 测
+    int timeout = 10;     // 秒
+    long seedRows = 0;
+    long seedChunk = 50000;
+    std::string seedPrefix = "bench";
+    std::string mix = "inventory=35,inventory_search=15,operation_logs=20,search_items=15,add_item=5,update_item=10";
+    std::string out;
+};
+
+// 压测开始前从服务取得的数据：总页数和可以修改的库存
+struct Dataset {
+    long long inventoryTotal = 0;
+    long long logTotal = 0;
+    std::vector<int> inventoryIds;
+    std::vector<int> itemIds;
+    std::vector<std::string> itemNames;
+    std::vector<std::string> locations;
+};
+
+struct Sample {
+    RequestType type;
+    bool ok;
+    int64_t micros;
+};
+
+struct Totals {
+    std::vector<int64_t> latencies; // 微秒
+    uint64_t errors = 0;
+};
+
+void usage() {
+    std::cerr <<
+        "用法: geartracker_bench [选项]\n"
+        "  --host HOST           服务地址（默认 127.0.0.1）\n"
+        "  --port PORT           端口（默认 8080）\n"
+        "  --threads N           并发连接数（默认 8）\n"
+        "  --duration SEC        计入结果的压测时长（默认 30）\n"
+        "  --warmup SEC          预热时长，不计入结果（默认 5）\n"
+        "  --rate RPS            开环模式的总请求速率；不指定为闭环\n"
+        "  --mix 名称=权重,...   请求比例，名称: inventory inventory_search operation_logs\n"
+        "                        search_items add_item update_item\n"
+        "  --page-size N         每页行数（默认 20）\n"
+        "  --max-page N          随机页码的上限（默认 50）\n"
+        "  --seed-rows N         压测前导入 N 行合成数据（如 10000 ~ 10000000）\n"
+        "  --seed-chunk N        每次导入请求的行数（默认 50000）\n"
+        "  --seed-prefix TEXT    合成物品名称的前缀（默认 bench）\n"
+        "  --timeout SEC         单个请求的超时（默认 10）\n"
+        "  --out FILE            结果另存为 JSON 文件\n"
+        "\n"
+        "被压测的 geartracker 须为优化构建（cmake -DCMAKE_BUILD_TYPE=RelWithDebInfo 或 Release；\n"
+        "启用 GEARTRACKER_BENCH 且未指定构建类型时默认 RelWithDebInfo），Debug（-O0）构建的数字不可比较\n";
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--host") options.host = value;
+        else if (arg == "--port") options.port = std::atoi(value.c_str());
+        else if (arg == "--threads") options.threads = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--duration") options.duration = std::max(0.1, std::atof(value.c_str()));
+        else if (arg == "--warmup") options.warmup = std::max(0.0, std::atof(value.c_str()));
+        else if (arg == "--rate") options.rate = std::max(0.0, std::atof(value.c_str()));
+        else if (arg == "--mix") options.mix = value;
+        else if (arg == "--page-size") options.pageSize = std::clamp(std::atoi(value.c_str()), 1, 100);
+        else if (arg == "--max-page") options.maxPage = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--seed-rows") options.seedRows = std::max(0L, std::atol(value.c_str()));
+        else if (arg == "--seed-chunk") options.seedChunk = std::max(1L, std::atol(value.c_str()));
+        else if (arg == "--seed-prefix") options.seedPrefix = value;
+        else if (arg == "--timeout") options.timeout = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--out") options.out = value;
+        else return false;
+    }
+    return true;
+}
+
+// "inventory=35,search_items=15" -> 各类型的权重
+bool parseMix(const std::string& text, std::vector<double>& weights) {
+    weights.assign(REQUEST_TYPES, 0.0);
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t comma = text.find(',', start);
+        std::string part = text.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        start = comma == std::string::npos ? text.size() : comma + 1;
+        size_t eq = part.find('=');
+        std::string name = part.substr(0, eq);
+        double weight = eq == std::string::npos ? 1.0 : std::atof(part.c_str() + eq + 1);
+        auto found = std::find_if(std::begin(kTypeNames), std::end(kTypeNames),
+                                  [&name](const char* typeName) { return name == typeName; });
+        if (found == std::end(kTypeNames) || weight < 0) {
+            std::cerr << "未知的请求类型或权重: " << part << "\n";
+            return false;
+        }
+        weights[found - std::begin(kTypeNames)] = weight;
+    }
+    double sum = 0;
+    for (double weight : weights) sum += weight;
+    return sum > 0;
+}
+
+std::unique_ptr<httplib::Client> makeClient(const Options& options) {
+    auto client = std::make_unique<httplib::Client>(options.host, options.port);
+    client->set_keep_alive(true);
+    client->set_tcp_nodelay(true);
+    client->set_connection_timeout(options.timeout, 0);
+    client->set_read_timeout(options.timeout, 0);
+    client->set_write_timeout(options.timeout, 0);
+    return client;
+}
+
+// 分块生成 NDJSON 并经 POST /api/import 导入；每行新建一个物品并加入库存（同时产生操作日志）
+bool seed(const Options& options, JsonWriter& report) {
+    auto client = makeClient(options);
+    client->set_read_timeout(3600, 0);
+    client->set_write_timeout(3600, 0);
+    std::mt19937_64 random(42);
+    auto start = Clock::now();
+    long done = 0;
+    std::cerr << "导入合成数据: " << options.seedRows << " 行\n";
+    while (done < options.seedRows) {
+        long rows = std::min(options.seedChunk, options.seedRows - done);
+        JsonWriter body(static_cast<size_t>(rows) * 200);
+        for (long i = 0; i < rows; ++i) {
+            long n = done + i;
+            const char* word = kWords[random() % kWordCount];
+            body.beginObject()
+                .field("name", options.seedPrefix + "-" + word + "-" + std::to_string(n))
+                .field("category", kCategories[random() % 5])
+                .field("grade", kGrades[random() % 4])
+                .field("effect", std::string(kWords[random() % kWordCount]) + "加成 " + std::to_string(random() % 100))
+                .field("description", std::string("压测数据 ") + word)
+                .field("note", "")
+                .field("quantity", static_cast<int>(1 + random() % 500))
+                .field("location", "仓库-" + std::to_string(random() % 64))
+                .endObject()
+                .endLine();
+        }
+        auto res = client->Post("/api/import?format=ndjson&reason=bench-seed", body.str(), "application/x-ndjson");
+        if (!res || res->status != 200) {
+            std::cerr << "导入失败: "
+                      << (res ? std::to_string(res->status) + " " + res->body : httplib::to_string(res.error())) << "\n";
+            return false;
+        }
+        done += rows;
+        std::cerr << "  " << done << " / " << options.seedRows << "\n";
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    report.key("seed").beginObject()
+          .field("rows", static_cast<long long>(done))
+          .field("seconds", seconds)
+          .field("rows_per_second", seconds > 0 ? done / seconds : 0.0)
+          .endObject();
+    return true;
+}
+
+// 取得总行数和一批库存 id（PUT 和 add-item 只作用于这些行）
+bool loadDataset(const Options& options, Dataset& data) {
+    auto client = makeClient(options);
+    for (int page = 1; page <= 10; ++page) {
+        auto res = client->Get("/api/inventory?perPage=100&page=" + std::to_string(page));
+        if (!res || res->status != 200) {
+            std::cerr << "无法读取 /api/inventory: "
+                      << (res ? std::to_string(res->status) : httplib::to_string(res.error())) << "\n";
+            return false;
+        }
+        auto body = nlohmann::json::parse(res->body, nullptr, false);
+        if (body.is_discarded() || !body.contains("items")) {
+            std::cerr << "/api/inventory 的响应无法解析\n";
+            return false;
+        }
+        data.inventoryTotal = body.value("total", 0LL);
+        for (const auto& item : body["items"]) {
+            data.inventoryIds.push_back(item.value("id", 0));
+            data.itemIds.push_back(item.value("item_id", 0));
+            data.itemNames.push_back(item.value("item_name", std::string()));
+            data.locations.push_back(item.value("location", std::string("bench")));
+        }
+        if (body["items"].size() < 100) {
+            break;
+        }
+    }
+    auto res = client->Get("/api/operation_logs?perPage=1");
+    if (res && res->status == 200) {
+        auto body = nlohmann::json::parse(res->body, nullptr, false);
+        if (!body.is_discarded()) {
+            data.logTotal = body.value("totalItems", 0LL);
+        }
+    }
+    return true;
+}
+
+class Worker {
+public:
+    Worker(const Options& options, const Dataset& data, const std::vector<double>& weights, int index)
+        : options_(options), data_(data), client_(makeClient(options)),
+          pick_(weights.begin(), weights.end()), random_(0x9e3779b97f4a7c15ULL * (index + 1)) {}
+
+    // 发一个请求，返回是否成功（2xx 且业务上没有失败）
+    bool send(RequestType type) {
+        httplib::Result res;
+        switch (type) {
+            case INVENTORY:
+                res = client_->Get("/api/inventory?" + pageQuery(data_.inventoryTotal));
+                break;
+            case INVENTORY_SEARCH:
+                res = client_->Get("/api/inventory?" + pageQuery(data_.inventoryTotal / 8) + "&search=" + word());
+                break;
+            case OPERATION_LOGS:
+                res = client_->Get("/api/operation_logs?" + pageQuery(data_.logTotal) +
+                                   (random_() % 2 ? "&search=" + word() : std::string()));
+                break;
+            case SEARCH_ITEMS:
+                res = client_->Get("/api/search-items?q=" + word());
+                break;
+            case ADD_ITEM: {
+                if (data_.itemIds.empty()) return false;
+                size_t i = random_() % data_.itemIds.size();
+                JsonWriter body(256);
+                body.beginObject()
+                    .field("isNewItem", false)
+                    .key("item").beginObject().field("id", data_.itemIds[i]).field("name", data_.itemNames[i]).endObject()
+                    .field("quantity", 1)
+                    .field("location", "bench")
+                    .field("reason", "bench")
+                    .endObject();
+                res = client_->Post("/api/add-item", body.str(), "application/json");
+                break;
+            }
+            case UPDATE_ITEM: {
+                if (data_.inventoryIds.empty()) return false;
+                size_t i = random_() % data_.inventoryIds.size();
+                JsonWriter body(256);
+                body.beginObject()
+                    .field("quantity", static_cast<int>(1 + random_() % 500))
+                    .field("location", data_.locations[i])
+                    .field("reason", "bench")
+                    .endObject();
+                res = client_->Put("/api/inventory/" + std::to_string(data_.inventoryIds[i]), body.str(),
+                                   "application/json");
+                break;
+            }
+            default:
+                return false;
+        }
+        // 写接口失败时也返回 200，按响应中的 success 判断
+        return res && res->status >= 200 && res->status < 300 &&
+               res->body.find("\"success\":false") == std::string::npos;
+    }
+
+    RequestType next() { return static_cast<RequestType>(pick_(random_)); }
+
+    void run(Clock::time_point begin, Clock::time_point measureFrom, Clock::time_point end, double interval) {
+        samples_.reserve(65536);
+        Clock::time_point scheduled = begin;
+        auto step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(interval));
+        for (;;) {
+            Clock::time_point start;
+            if (interval > 0) {
+                // 开环：按计划的时间发请求，落后时立即发送，延迟从计划时间算起
+                scheduled += step;
+                if (scheduled >= end) break;
+                std::this_thread::sleep_until(scheduled);
+                start = scheduled;
+            } else {
+                start = Clock::now();
+                if (start >= end) break;
+            }
+            RequestType type = next();
+            bool ok = send(type);
+            Clock::time_point done = Clock::now();
+            if (start >= measureFrom) {
+                samples_.push_back({type, ok,
+                                    std::chrono::duration_cast<std::chrono::microseconds>(done - start).count()});
+            }
+        }
+    }
+
+    const std::vector<Sample>& samples() const { return samples_; }
+
+private:
+    std::string pageQuery(long long rows) {
+        long long pages = std::max(1LL, (rows + options_.pageSize - 1) / options_.pageSize);
+        pages = std::min<long long>(pages, options_.maxPage);
+        return "perPage=" + std::to_string(options_.pageSize) + "&page=" + std::to_string(1 + random_() % pages);
+    }
+
+    std::string word() {
+        return httplib::encode_uri_component(kWords[random_() % kWordCount]);
+    }
+
+    const Options& options_;
+    const Dataset& data_;
+    std::unique_ptr<httplib::Client> client_;
+    std::discrete_distribution<int> pick_;
+    std::mt19937_64 random_;
+    std::vector<Sample> samples_;
+};
+
+// 最近秩法取分位数（latencies 已排序）
+double percentileMs(const std::vector<int64_t>& latencies, double q) {
+    if (latencies.empty()) return 0;
+    size_t rank = static_cast<size_t>(std::ceil(q * static_cast<double>(latencies.size())));
+    rank = std::clamp<size_t>(rank, 1, latencies.size());
+    return static_cast<double>(latencies[rank - 1]) / 1000.0;
+}
+
+void writeTotals(JsonWriter& out, Totals& totals, double seconds) {
+    std::sort(totals.latencies.begin(), totals.latencies.end());
+    double sum = 0;
+    for (int64_t micros : totals.latencies) sum += static_cast<double>(micros);
+    size_t count = totals.latencies.size();
+    out.field("requests", count)
+       .field("errors", totals.errors)
+       .field("throughput_rps", seconds > 0 ? static_cast<double>(count) / seconds : 0.0)
+       .key("latency_ms").beginObject()
+       .field("mean", count ? sum / static_cast<double>(count) / 1000.0 : 0.0)
+       .field("p50", percentileMs(totals.latencies, 0.50))
+       .field("p95", percentileMs(totals.latencies, 0.95))
+       .field("p99", percentileMs(totals.latencies, 0.99))
+       .field("p999", percentileMs(totals.latencies, 0.999))
+       .field("max", count ? static_cast<double>(totals.latencies.back()) / 1000.0 : 0.0)
+       .endObject();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    std::vector<double> weights;
+    if (!parseOptions(argc, argv, options) || !parseMix(options.mix, weights)) {
+        usage();
+        return 2;
+    }
+
+    JsonWriter report(4096);
+    report.beginObject();
+    report.key("config").beginObject()
+          .field("host", options.host)
+          .field("port", options.port)
+          .field("mode", options.rate > 0 ? "open" : "closed")
+          .field("threads", options.threads)
+          .field("rate", options.rate)
+          .field("duration_s", options.duration)
+          .field("warmup_s", options.warmup)
+          .field("page_size", options.pageSize)
+          .field("max_page", options.maxPage)
+          .field("mix", options.mix)
+          .endObject();
+
+    if (options.seedRows > 0 && !seed(options, report)) {
+        return 1;
+    }
+    Dataset data;
+    if (!loadDataset(options, data)) {
+        return 1;
+    }
+    report.key("dataset").beginObject()
+          .field("inventory_rows", data.inventoryTotal)
+          .field("operation_log_rows", data.logTotal)
+          .endObject();
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (int i = 0; i < options.threads; ++i) {
+        workers.push_back(std::make_unique<Worker>(options, data, weights, i));
+    }
+    // 开环时每个线程承担总速率的 1/threads
+    double interval = options.rate > 0 ? options.threads / options.rate : 0;
+    auto begin = Clock::now();
+    auto measureFrom = begin + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.warmup));
+    auto end = measureFrom + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.duration));
+    std::cerr << "压测 " << options.warmup << " + " << options.duration << " 秒（"
+              << (options.rate > 0 ? "开环" : "闭环") << "，" << options.threads << " 个连接）\n";
+    std::vector<std::thread> threads;
+    for (auto& worker : workers) {
+        threads.emplace_back([&worker, begin, measureFrom, end, interval] {
+            worker->run(begin, measureFrom, end, interval);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - measureFrom).count();
+
+    Totals all;
+    std::vector<Totals> byType(REQUEST_TYPES);
+    for (const auto& worker : workers) {
+        for (const Sample& sample : worker->samples()) {
+            for (Totals* totals : {&all, &byType[sample.type]}) {
+                totals->latencies.push_back(sample.micros);
+                if (!sample.ok) totals->errors++;
+            }
+        }
+    }
+    report.field("seconds", seconds);
+    writeTotals(report, all, seconds);
+    report.key("endpoints").beginObject();
+    for (int type = 0; type < REQUEST_TYPES; ++type) {
+        if (weights[type] <= 0) continue;
+        report.key(kTypeNames[type]).beginObject();
+        writeTotals(report, byType[type], seconds);
+        report.endObject();
+    }
+    report.endObject().endObject().endLine();
+
+    std::cout << report.str();
+    if (!options.out.empty()) {
+        std::ofstream file(options.out, std::ios::binary);
+        file << report.str();
+        if (!file) {
+            std::cerr << "无法写入结果文件: " << options.out << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
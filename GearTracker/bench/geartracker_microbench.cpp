@@ -0,0 +1,365 @@
+// ====== geartracker_microbench.cpp ======
+// 数据访问和序列化热点路径的微基准测试（Google Benchmark）：
+//   ParseResultSet    Database::parseResultSet，每行一个 map<string, string>
+//   ResultTableLoad   同样的结果集读入按列存储的 ResultTable，作为对照
+//   SafeGet           Database::safeGet（命中、别名、缺失三种情况）
+//   ConfigGet*        Config::getString / getInt / getBool（两层 std::map 查找）
+//   *Response         按 /api/inventory、/api/operation_logs 的格式用 JsonWriter 输出一页
+//
+// 结果集来自内存中的假 StorageResult，不访问数据库。除耗时外每项还输出：
+//   ns_per_row / ns_per_call   每行（每次调用）的耗时
+//   allocs_per_row / ...       每行（每次调用、每个响应）的堆分配次数，由本文件替换的全局 operator new 计数
+//   bytes_per_response         输出的 JSON 字节数
+#include "Config.h"
+#include "Database.h"
+#include "JsonWriter.h"
+#include "Logger.h"
+#include "ResultTable.h"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// ====== 分配计数 ======
+// 替换全局的 operator new/delete；只计数，不改变分配行为
+static std::atomic<uint64_t> allocations{0};
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+// 基准循环中的分配次数：构造时记下计数，perUnit 换算为每单位（行、调用、响应）的次数
+class AllocationCounter {
+public:
+    AllocationCounter() : start_(allocations.load(std::memory_order_relaxed)) {}
+    double perUnit(const benchmark::State& state, int64_t unitsPerIteration) const {
+        uint64_t count = allocations.load(std::memory_order_relaxed) - start_;
+        double units = static_cast<double>(state.iterations()) * static_cast<double>(unitsPerIteration);
+        return units > 0 ? static_cast<double>(count) / units : 0.0;
+    }
+
+private:
+    uint64_t start_;
+};
+
+// 每单位的纳秒数（基准框架按总耗时除以 units 计算）
+benchmark::Counter nsPer(const benchmark::State& state, int64_t unitsPerIteration) {
+    return benchmark::Counter(static_cast<double>(state.iterations()) * static_cast<double>(unitsPerIteration),
+                              benchmark::Counter::kIsRate | benchmark::Counter::kInvert,
+                              benchmark::Counter::OneK::kIs1000);
+}
+
+// ====== 假结果集 ======
+// 与库存查询相同的 7 列；getString 像真实后端一样每次返回新字符串
+class FakeResult : public StorageResult {
+public:
+    struct Column {
+        std::string label;
+        ColumnType type;
+    };
+
+    FakeResult(const std::vector<Column>& columns, const std::vector<std::vector<std::string>>& rows)
+        : columns_(columns), rows_(rows) {}
+
+    void rewind() { row_ = -1; }
+
+    bool next() override { return ++row_ < static_cast<long>(rows_.size()); }
+    bool isNull(int col) override { return rows_[row_][col - 1].empty() && columns_[col - 1].type != TEXT; }
+    int getInt(int col) override { return std::atoi(rows_[row_][col - 1].c_str()); }
+    int64_t getInt64(int col) override { return std::atoll(rows_[row_][col - 1].c_str()); }
+    double getDouble(int col) override { return std::atof(rows_[row_][col - 1].c_str()); }
+    std::string getString(int col) override { return rows_[row_][col - 1]; }
+    int columnCount() override { return static_cast<int>(columns_.size()); }
+    std::string columnLabel(int col) override { return columns_[col - 1].label; }
+    ColumnType columnType(int col) override { return columns_[col - 1].type; }
+
+private:
+    const std::vector<Column>& columns_;
+    const std::vector<std::vector<std::string>>& rows_;
+    long row_ = -1;
+};
+
+const std::vector<FakeResult::Column>& inventoryColumns() {
+    static const std::vector<FakeResult::Column> columns = {
+        {"inventory_id", StorageResult::INTEGER}, {"item_id", StorageResult::INTEGER},
+        {"item_name", StorageResult::TEXT},       {"quantity", StorageResult::INTEGER},
+        {"location", StorageResult::TEXT},        {"stored_time", StorageResult::TEXT},
+        {"last_updated", StorageResult::TEXT}};
+    return columns;
+}
+
+std::vector<std::vector<std::string>> inventoryRows(size_t count) {
+    const char* const names[] = {"铁剑", "灵石", "回春丹", "护身符", "青云法袍", "iron sword", "jade pendant"};
+    std::vector<std::vector<std::string>> rows;
+    rows.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        rows.push_back({std::to_string(100000 + i), std::to_string(1 + i % 5000),
+                        std::string(names[i % 7]) + "-" + std::to_string(i), std::to_string(1 + i % 500),
+                        "仓库-" + std::to_string(i % 64), "2026-10-17 09:30:00", "2026-10-17 10:15:42"});
+    }
+    return rows;
+}
+
+std::vector<Database::InventoryItem> inventoryItems(size_t count) {
+    std::vector<Database::InventoryItem> items;
+    for (const auto& row : inventoryRows(count)) {
+        Database::InventoryItem item;
+        item.id = std::atoi(row[0].c_str());
+        item.item_id = std::atoi(row[1].c_str());
+        item.item_name = row[2];
+        item.quantity = std::atoi(row[3].c_str());
+        item.location = row[4];
+        item.stored_time = row[5];
+        item.last_updated = row[6];
+        items.push_back(std::move(item));
+    }
+    return items;
+}
+
+std::vector<Database::OperationLogEntry> operationLogs(size_t count) {
+    std::vector<Database::OperationLogEntry> logs;
+    for (size_t i = 0; i < count; ++i) {
+        Database::OperationLogEntry entry;
+        entry.id = static_cast<int>(500000 + i);
+        entry.operation_type = i % 3 == 0 ? "ADD" : "UPDATE";
+        entry.item_name = "灵石-" + std::to_string(i);
+        entry.operation_time = "2026-10-17 10:15:42";
+        entry.operation_note = "数量: 12→30, 位置: 仓库-3→仓库-3 | 原因: 盘点 \"季度\"";
+        logs.push_back(std::move(entry));
+    }
+    return logs;
+}
+
+// 写到临时文件的配置：SQLite 内存数据库（Database 构造时会连接），只输出错误日志
+class Fixture {
+public:
+    static Fixture& instance() {
+        static Fixture fixture;
+        return fixture;
+    }
+
+    Config& config() { return *config_; }
+    Database& database() { return *database_; }
+
+private:
+    Fixture() {
+        char path[] = "/tmp/geartracker_microbench_XXXXXX";
+        int fd = mkstemp(path);
+        if (fd >= 0) {
+            close(fd);
+        }
+        path_ = path;
+        std::ofstream file(path_);
+        file << "[database]\nbackend = sqlite\nsqlite_path = :memory:\nhost = localhost\nport = 3306\n"
+                "username = bench\npassword = bench\ndatabase = geartracker\nstmt_cache_size = 32\n\n"
+                "[application]\nlog_level = error\nlog_to_console = false\nlog_file = /dev/null\n"
+                "page_size = 20\nmetrics = false\nslow_query_ms = 0\n\n"
+                "[web]\nthreads = 8\nmax_queued = 64\n";
+        file.close();
+        config_ = std::make_unique<Config>(path_);
+        Logger::instance().configure(*config_);
+        database_ = std::make_unique<Database>(*config_);
+    }
+
+    ~Fixture() {
+        database_.reset();
+        std::remove(path_.c_str());
+    }
+
+    std::string path_;
+    std::unique_ptr<Config> config_;
+    std::unique_ptr<Database> database_;
+};
+
+// ====== 结果集解析 ======
+
+void BM_ParseResultSet(benchmark::State& state) {
+    const auto rows = inventoryRows(static_cast<size_t>(state.range(0)));
+    FakeResult result(inventoryColumns(), rows);
+    Database& db = Fixture::instance().database();
+    AllocationCounter allocs;
+    for (auto _ : state) {
+        result.rewind();
+        auto parsed = db.parseResultSet(&result);
+        benchmark::DoNotOptimize(parsed.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["ns_per_row"] = nsPer(state, state.range(0));
+    state.counters["allocs_per_row"] = allocs.perUnit(state, state.range(0));
+}
+BENCHMARK(BM_ParseResultSet)->Arg(20)->Arg(100)->Arg(1000);
+
+void BM_ResultTableLoad(benchmark::State& state) {
+    const auto rows = inventoryRows(static_cast<size_t>(state.range(0)));
+    FakeResult result(inventoryColumns(), rows);
+    ResultTable table;
+    AllocationCounter allocs;
+    for (auto _ : state) {
+        result.rewind();
+        table.load(&result, static_cast<size_t>(state.range(0)));
+        benchmark::DoNotOptimize(table.rowCount());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["ns_per_row"] = nsPer(state, state.range(0));
+    state.counters["allocs_per_row"] = allocs.perUnit(state, state.range(0));
+}
+BENCHMARK(BM_ResultTableLoad)->Arg(20)->Arg(100)->Arg(1000);
+
+// ====== safeGet ======
+
+void BM_SafeGet(benchmark::State& state, const char* key) {
+    const auto rows = inventoryRows(1);
+    FakeResult result(inventoryColumns(), rows);
+    auto parsed = Fixture::instance().database().parseResultSet(&result);
+    const auto& row = parsed.at(0);
+    AllocationCounter allocs;
+    for (auto _ : state) {
+        std::string value = Database::safeGet(row, key, "0");
+        benchmark::DoNotOptimize(value.data());
+    }
+    state.counters["ns_per_call"] = nsPer(state, 1);
+    state.counters["allocs_per_call"] = allocs.perUnit(state, 1);
+}
+BENCHMARK_CAPTURE(BM_SafeGet, hit, "location");
+BENCHMARK_CAPTURE(BM_SafeGet, alias, "inventory_id");
+BENCHMARK_CAPTURE(BM_SafeGet, missing, "description");
+
+// ====== Config ======
+// 与调用方一样传入字符串字面量，临时 std::string 的构造也计入
+
+void BM_ConfigGetString(benchmark::State& state) {
+    Config& config = Fixture::instance().config();
+    AllocationCounter allocs;
+    for (auto _ : state) {
+        std::string value = config.getString("database", "backend", "mysql");
+        benchmark::DoNotOptimize(value.data());
+    }
+    state.counters["ns_per_call"] = nsPer(state, 1);
+    state.counters["allocs_per_call"] = allocs.perUnit(state, 1);
+}
+BENCHMARK(BM_ConfigGetString);
+
+void BM_ConfigGetInt(benchmark::State& state) {
+    Config& config = Fixture::instance().config();
+    AllocationCounter allocs;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(config.getInt("application", "page_size", 10));
+    }
+    state.counters["ns_per_call"] = nsPer(state, 1);
+    state.counters["allocs_per_call"] = allocs.perUnit(state, 1);
+}
+BENCHMARK(BM_ConfigGetInt);
+
+void BM_ConfigGetBool(benchmark::State& state) {
+    Config& config = Fixture::instance().config();
+    AllocationCounter allocs;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(config.getBool("application", "metrics", true));
+    }
+    state.counters["ns_per_call"] = nsPer(state, 1);
+    state.counters["allocs_per_call"] = allocs.perUnit(state, 1);
+}
+BENCHMARK(BM_ConfigGetBool);
+
+// ====== JSON 响应 ======
+// 与 WebServer 中 /api/inventory、/api/operation_logs 的输出相同（字段和顺序）
+
+void BM_InventoryResponse(benchmark::State& state) {
+    const auto items = inventoryItems(static_cast<size_t>(state.range(0)));
+    size_t bytes = 0;
+    AllocationCounter allocs;
+    for (auto _ : state) {
+        JsonWriter out(256 + items.size() * 192);
+        out.beginObject().key("items").beginArray();
+        for (const auto& item : items) {
+            Database::writeJson(out, item);
+        }
+        out.endArray()
+           .field("total", 123456LL)
+           .field("totalEstimated", false)
+           .field("page", 1)
+           .field("perPage", static_cast<int>(items.size()))
+           .field("totalPages", 6173LL)
+           .endObject();
+        std::string body = out.take();
+        bytes = body.size();
+        benchmark::DoNotOptimize(body.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+    state.counters["ns_per_row"] = nsPer(state, state.range(0));
+    state.counters["allocs_per_response"] = allocs.perUnit(state, 1);
+    state.counters["bytes_per_response"] = static_cast<double>(bytes);
+}
+BENCHMARK(BM_InventoryResponse)->Arg(20)->Arg(100);
+
+void BM_OperationLogResponse(benchmark::State& state) {
+    const auto logs = operationLogs(static_cast<size_t>(state.range(0)));
+    size_t bytes = 0;
+    AllocationCounter allocs;
+    for (auto _ : state) {
+        JsonWriter out(256 + logs.size() * 192);
+        out.beginObject()
+           .field("status", "success")
+           .field("page", 1)
+           .field("perPage", static_cast<int>(logs.size()))
+           .field("totalItems", 987654LL)
+           .field("totalEstimated", true)
+           .field("totalPages", 49383LL);
+        out.key("logs").beginArray();
+        for (const auto& entry : logs) {
+            Database::writeJson(out, entry);
+        }
+        out.endArray().endObject();
+        std::string body = out.take();
+        bytes = body.size();
+        benchmark::DoNotOptimize(body.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+    state.counters["ns_per_row"] = nsPer(state, state.range(0));
+    state.counters["allocs_per_response"] = allocs.perUnit(state, 1);
+    state.counters["bytes_per_response"] = static_cast<double>(bytes);
+}
+BENCHMARK(BM_OperationLogResponse)->Arg(20)->Arg(100);
+
+} // namespace
+
+// 与 BENCHMARK_MAIN() 相同，另在结果的 context 中记录 geartracker 的构建类型
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::AddCustomContext("geartracker_build_type", GEARTRACKER_BUILD_TYPE);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,65 @@
+# ====== PrecompressWeb.cmake ======
+# 构建时处理 Web 界面文件（cmake -P 运行）：
+#   1. 把 SRC_DIR 复制到 DST_DIR（先清空，旧的哈希文件名不会残留）
+#   2. js/css 文件按内容 SHA256 的前 10 位改名为 name.<hash>.ext，并改写 index.html 中的引用，
+#      服务端对这些文件返回长期缓存（immutable）
+#   3. 用 gzip -9 为文本文件生成 .gz 预压缩版本，服务端直接发送；未找到 gzip 时跳过，
+#      由服务端在加载时压缩
+#
+# 参数：-DSRC_DIR=<web 源目录> -DDST_DIR=<输出目录> [-DGZIP_EXECUTABLE=<gzip 路径>]
+
+if(NOT SRC_DIR OR NOT DST_DIR)
+    message(FATAL_ERROR "PrecompressWeb.cmake 需要 SRC_DIR 和 DST_DIR")
+endif()
+
+file(REMOVE_RECURSE "${DST_DIR}")
+file(MAKE_DIRECTORY "${DST_DIR}")
+file(COPY "${SRC_DIR}/" DESTINATION "${DST_DIR}")
+
+# 内容哈希文件名
+file(GLOB_RECURSE pages RELATIVE "${DST_DIR}" "${DST_DIR}/*.html")
+file(GLOB_RECURSE hashed RELATIVE "${DST_DIR}" "${DST_DIR}/*.js" "${DST_DIR}/*.css")
+set(renames "")
+foreach(rel ${hashed})
+    file(SHA256 "${DST_DIR}/${rel}" digest)
+    string(SUBSTRING "${digest}" 0 10 digest)
+    string(REGEX REPLACE "\\.([^./]+)$" ".${digest}.\\1" target "${rel}")
+    file(RENAME "${DST_DIR}/${rel}" "${DST_DIR}/${target}")
+    list(APPEND renames "${rel}|${target}")
+endforeach()
+
+foreach(page ${pages})
+    file(READ "${DST_DIR}/${page}" content)
+    get_filename_component(pageDir "${page}" DIRECTORY)
+    foreach(entry ${renames})
+        string(REPLACE "|" ";" pair "${entry}")
+        list(GET pair 0 from)
+        list(GET pair 1 to)
+        # 页面中的引用是相对页面所在目录的路径
+        if(pageDir)
+            file(RELATIVE_PATH from "${DST_DIR}/${pageDir}" "${DST_DIR}/${from}")
+            file(RELATIVE_PATH to "${DST_DIR}/${pageDir}" "${DST_DIR}/${to}")
+        endif()
+        string(REPLACE "\"${from}\"" "\"${to}\"" content "${content}")
+        string(REPLACE "\"/${from}\"" "\"/${to}\"" content "${content}")
+    endforeach()
+    file(WRITE "${DST_DIR}/${page}" "${content}")
+endforeach()
+
+# 预压缩
+if(GZIP_EXECUTABLE)
+    file(GLOB_RECURSE texts "${DST_DIR}/*.html" "${DST_DIR}/*.js" "${DST_DIR}/*.css"
+                            "${DST_DIR}/*.svg" "${DST_DIR}/*.json" "${DST_DIR}/*.txt")
+    foreach(path ${texts})
+        execute_process(COMMAND "${GZIP_EXECUTABLE}" -9 -n -c "${path}"
+                        OUTPUT_FILE "${path}.gz"
+                        RESULT_VARIABLE result)
+        if(NOT result EQUAL 0)
+            message(WARNING "gzip 压缩失败: ${path}")
+            file(REMOVE "${path}.gz")
+        endif()
+    endforeach()
+endif()
+
+list(LENGTH hashed hashedCount)
+message(STATUS "Web 文件已生成到 ${DST_DIR}（${hashedCount} 个带内容哈希的文件）")
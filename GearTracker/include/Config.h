@@ -10,7 +10,7 @@ class Config {
 private:
     std::map<std::string, std::map<std::string, std::string>> configData;
     std::string configFilePath;
-    void parseLine(const std::string& line);
+    void parseLine(const std::string& line, const std::string& section);
 public:    
     Config(); 
     Config(const std::string& filePath); 
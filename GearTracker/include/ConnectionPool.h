@@ -0,0 +1,109 @@
+// ====== ConnectionPool.h ======
+#ifndef CONNECTION_POOL_H
+#define CONNECTION_POOL_H
+
+#include "Config.h"
+#include "Database.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// 有界、线程安全的数据库连接池，由 WebServer 持有，各请求处理函数从中借用连接。
+// 配置项位于 config.ini 的 [database] 节：
+//   pool_min_size        常驻的最少连接数
+//   pool_max_size        连接总数上限
+//   pool_idle_timeout    空闲超过该秒数且总数大于最小值时关闭连接
+//   pool_validate_after  连接空闲超过该秒数后，借出前才做一次有效性检查
+//   pool_acquire_timeout 连接池耗尽时等待空闲连接的最长秒数
+class ConnectionPool {
+public:
+    // 借出的数据库连接，析构时自动归还连接池
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(ConnectionPool* pool, std::unique_ptr<Database> db);
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        ~Lease();
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        Database* operator->() const { return db_.get(); }
+        Database& operator*() const { return *db_; }
+        explicit operator bool() const { return db_ != nullptr; }
+
+        // 连接出现不可恢复的错误时调用，归还时直接丢弃而不是放回池中
+        void invalidate() { broken_ = true; }
+
+    private:
+        void release();
+
+        ConnectionPool* pool_ = nullptr;
+        std::unique_ptr<Database> db_;
+        bool broken_ = false;
+    };
+
+    struct Stats {
+        size_t total = 0;       // 当前连接总数（空闲 + 借出）
+        size_t idle = 0;        // 空闲连接数
+        size_t inUse = 0;       // 借出连接数
+        size_t minSize = 0;
+        size_t maxSize = 0;
+        uint64_t created = 0;   // 累计新建连接数
+        uint64_t reused = 0;    // 累计复用空闲连接次数
+        uint64_t validated = 0; // 借出前做过有效性检查的次数
+        uint64_t discarded = 0; // 因失效或空闲超时被关闭的连接数
+        uint64_t timeouts = 0;  // 等待空闲连接超时的次数
+    };
+
+    explicit ConnectionPool(Config& config);
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    // 借用一个可用连接；无法建立连接或等待超时时返回空的 Lease
+    Lease acquire();
+
+    // 预先建立 pool_min_size 个连接
+    void warmUp();
+
+    // 关闭所有空闲连接并停止后台回收线程，借出的连接在归还时关闭
+    void shutdown();
+
+    Stats getStats();
+
+private:
+    struct IdleEntry {
+        std::unique_ptr<Database> db;
+        std::chrono::steady_clock::time_point since; // 归还到池中的时间
+    };
+
+    void giveBack(std::unique_ptr<Database> db, bool broken);
+    std::unique_ptr<Database> createConnection();
+    void reaperLoop();
+
+    Config& config_;
+    size_t minSize_;
+    size_t maxSize_;
+    std::chrono::seconds idleTimeout_;
+    std::chrono::seconds validateAfter_;
+    std::chrono::seconds acquireTimeout_;
+
+    std::mutex mutex_;
+    std::condition_variable available_;
+    std::condition_variable reaperWake_;
+    std::deque<IdleEntry> idle_; // 尾部为最近归还的连接，优先复用
+    size_t total_ = 0;
+    bool shuttingDown_ = false;
+    std::thread reaper_;
+
+    Stats counters_;
+};
+
+#endif // CONNECTION_POOL_H
@@ -0,0 +1,91 @@
+// ====== CountService.h ======
+#ifndef COUNT_SERVICE_H
+#define COUNT_SERVICE_H
+
+#include "Config.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// 分页总数的进程内缓存，连接池中的所有 Database 共用一份。
+// - 不带筛选条件的总数缓存在内存中，Database 插入/删除成功后增量更新，
+//   超过 count_cache_ttl 秒后重新执行一次 COUNT(*) 校正（其他进程的写入）。
+// - 带筛选条件的计数按 (表, 搜索词) 缓存，该表有写入时整体失效。
+// - 超过 count_estimate_threshold 的筛选计数只给出估算值，避免为总数再扫一遍全表。
+//
+// 缓存只保存数字，SQL 仍由 Database 执行。
+class CountService {
+public:
+    enum Table {
+        INVENTORY = 0,
+        OPERATION_LOG = 1,
+        TABLE_COUNT = 2
+    };
+
+    struct CountResult {
+        long long count = 0;
+        bool estimated = false; // true 表示 count 为估算值（只保证不小于阈值）
+    };
+
+    static CountService& instance();
+
+    // 从配置加载参数（[application] 节的 count_cache_ttl、count_estimate_threshold）
+    void configure(Config& config);
+
+    // 表的写入版本号：统计前取得，写回结果时传入，
+    // 统计期间有写入则结果不缓存，避免把增量计算两次
+    uint64_t generation(Table table) const;
+
+    // 读取缓存的总数，未加载或已过期时返回 false
+    bool getTotal(Table table, long long& count) const;
+    void setTotal(Table table, long long count, uint64_t generation);
+
+    // 写入成功后调用：调整已缓存的总数，并使该表的筛选计数失效
+    void adjust(Table table, long long delta);
+
+    // 强制下次重新统计（批量写入或无法确定影响行数时使用）
+    void invalidate(Table table);
+
+    bool getFiltered(Table table, const std::string& search, CountResult& result);
+    void putFiltered(Table table, const std::string& search, const CountResult& result,
+                     uint64_t generation);
+
+    // 0 表示总是精确计数
+    long long estimateThreshold() const { return estimateThreshold_.load(std::memory_order_relaxed); }
+
+    CountService(const CountService&) = delete;
+    CountService& operator=(const CountService&) = delete;
+
+private:
+    CountService();
+
+    using Clock = std::chrono::steady_clock;
+
+    struct TotalEntry {
+        std::atomic<long long> count{0};
+        std::atomic<bool> loaded{false};
+        std::atomic<int64_t> loadedAt{0}; // Clock 的时间戳（纳秒计数）
+        std::atomic<uint64_t> generation{0};
+    };
+
+    struct FilteredEntry {
+        CountResult result;
+        uint64_t generation = 0;
+        Clock::time_point expiresAt;
+    };
+
+    static const size_t kMaxFilteredEntries = 256;
+
+    TotalEntry totals_[TABLE_COUNT];
+
+    mutable std::mutex filteredMutex_;
+    std::unordered_map<std::string, FilteredEntry> filtered_[TABLE_COUNT];
+
+    std::atomic<int> ttlSeconds_{60};
+    std::atomic<long long> estimateThreshold_{10000};
+};
+
+#endif // COUNT_SERVICE_H
@@ -0,0 +1,61 @@
+// ====== Csv.h ======
+#ifndef CSV_H
+#define CSV_H
+
+#include "JsonWriter.h"
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// CSV 输出（RFC 4180）：含逗号、双引号或换行的字段加双引号，字段内的双引号写成两个，行以 CRLF 结束。
+// 与 JsonWriter 相同，缓冲区超过 flushBytes 时交给 sink 写出
+class CsvWriter {
+public:
+    using Sink = JsonWriter::Sink;
+
+    explicit CsvWriter(Sink sink, size_t flushBytes = 16 * 1024);
+
+    CsvWriter& field(std::string_view text);
+    CsvWriter& field(long long number);
+    CsvWriter& field(int number) { return field(static_cast<long long>(number)); }
+    CsvWriter& endRow();
+
+    // 原样写入（文件开头的 UTF-8 BOM 等）
+    CsvWriter& raw(std::string_view bytes);
+
+    bool flush();
+    bool ok() const { return ok_; }
+
+    static void appendField(std::string& out, std::string_view text);
+
+private:
+    void separate();
+
+    std::string buf_;
+    bool rowStarted_ = false;
+    Sink sink_;
+    size_t flushBytes_;
+    bool ok_ = true;
+};
+
+// CSV 输入：逐条读取记录，支持带引号的字段（含逗号、换行和 "" 转义）、CRLF 行尾和文件开头的 UTF-8 BOM
+class CsvReader {
+public:
+    explicit CsvReader(std::istream& in) : in_(in) {}
+
+    // 读取下一条记录。line 为记录开始的行号（从 1 开始），raw 为记录的原始文本（不含行尾）。
+    // 文件结束时返回 false；引号没有闭合时 error 为 true（记录一直读到文件结尾）
+    bool next(std::vector<std::string>& fields, size_t& line, std::string& raw, bool& error);
+
+    size_t bytesRead() const { return bytes_; }
+
+private:
+    std::istream& in_;
+    size_t line_ = 0;
+    size_t bytes_ = 0;
+    bool first_ = true;
+};
+
+#endif // CSV_H
@@ -0,0 +1,52 @@
+// ====== DataVersion.h ======
+#ifndef DATA_VERSION_H
+#define DATA_VERSION_H
+
+#include "Config.h"
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+
+// 各张表的数据版本号，进程内共用一份。Database 的写操作成功后递增对应表的版本，
+// Web 接口用它生成强 ETag：版本不变说明响应内容不变，带 If-None-Match 的请求直接返回 304，
+// 不借用连接、不查询数据库。
+//
+// 版本号只保存在内存中，ETag 含进程启动时间，重启后旧的 ETag 全部失效。
+// 其他程序直接写入数据库不会递增版本，因此 ETag 还含一个每 etag_refresh_interval 秒变化一次的
+// 时间段编号，这些修改最迟在一个周期后被客户端取到（设为 0 则只随本程序的写入变化）。
+class DataVersion {
+public:
+    enum Table {
+        INVENTORY = 0,
+        OPERATION_LOG = 1,
+        ITEMS = 2,
+        TABLE_COUNT = 3
+    };
+
+    static DataVersion& instance();
+
+    // 从配置加载参数（[application] 节的 etag_refresh_interval）
+    void configure(Config& config);
+
+    uint64_t current(Table table) const;
+
+    // 写入成功后调用
+    void bump(Table table);
+    void bumpAll(); // 无法确定影响范围时（任意 SQL、切换数据库）
+
+    // 由若干张表的版本组成的强 ETag（含双引号）
+    std::string etag(std::initializer_list<Table> tables) const;
+
+    DataVersion(const DataVersion&) = delete;
+    DataVersion& operator=(const DataVersion&) = delete;
+
+private:
+    DataVersion();
+
+    std::atomic<uint64_t> versions_[TABLE_COUNT];
+    std::string epoch_; // 进程启动时间（微秒，36 进制）
+    std::atomic<int> refreshSeconds_{60};
+};
+
+#endif // DATA_VERSION_H
@@ -2,28 +2,32 @@
 #define DATABASE_H
 
 #include "Config.h"
-#include <cppconn/driver.h>
-#include <cppconn/connection.h>
-#include <cppconn/resultset.h>
-#include <cppconn/statement.h>
-#include <cppconn/prepared_statement.h>
+#include "Logger.h"
+#include "PageCursor.h"
+#include "CountService.h"
+#include "ResultTable.h"
+#include "SearchIndex.h"
+#include "ItemCatalog.h"
+#include "StatementCache.h"
+#include "Transaction.h"
+#include "OperationLogQueue.h"
+#include "InventoryEngine.h"
+#include "DataVersion.h"
+#include "EventBus.h"
+#include "JsonWriter.h"
+#include "Storage.h"
 #include <string>
 #include <memory>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <stdexcept>
 #include <fstream>
 #include <ctime>
 #include <iomanip> // 用于时间格式化
 #include <algorithm> // 添加这个头文件
 #include <mutex>
-
-
-// 日志级别常量定义 (确保与头文件一致)
-const int LOG_DEBUG = 0;
-const int LOG_INFO = 1;
-const int LOG_WARNING = 2;
-const int LOG_ERROR = 3;
+#include <chrono>
 
 
 
@@ -34,18 +38,68 @@ class Database {
 public:
 
     struct InventoryItem {
-        int id;
-        int item_id;
+        int id = 0;
+        int item_id = 0;
         std::string item_name;
-        int quantity;
+        int quantity = 0;
         std::string location;
         std::string stored_time;
         std::string last_updated;
+        std::string sort_time; // 键集分页用的排序键（含微秒），只在按游标查询时填充
+    };
+
+    struct OperationLogEntry {
+        int id = 0;
+        std::string operation_type;
+        std::string item_name;
+        std::string operation_time;
+        std::string operation_note;
+        std::string sort_time;
+    };
+
+    // 批量库存操作中的一项
+    struct InventoryOperation {
+        enum Type { ADD, UPDATE, REMOVE };
+        Type type = ADD;
+        int inventoryId = 0; // UPDATE / REMOVE 的库存 id
+        int itemId = 0;      // ADD 的物品 id
+        int quantity = 0;
+        std::string location;
+        std::string reason;
+    };
+
+    struct InventoryOperationResult {
+        bool success = false;
+        int inventoryId = 0; // ADD 成功时为新行的 id
+        std::string error;
+    };
+
+    // 列表项的 JSON 对象（库存/操作日志列表接口和实时事件共用）
+    static void writeJson(JsonWriter& out, const InventoryItem& item);
+    static void writeJson(JsonWriter& out, const OperationLogEntry& entry);
+
+    // 批量导出的筛选条件（/api/export/*）。时间为 "YYYY-MM-DD HH:MM:SS[.ffffff]"，空表示不限
+    struct ExportFilter {
+        std::string search;        // 与列表接口的搜索相同
+        std::string from;          // 时间下限（含）：库存按 last_updated，日志按 operation_time
+        std::string to;            // 时间上限（含）
+        int itemId = 0;            // 库存：只导出该物品
+        std::string location;      // 库存：位置完全相同
+        std::string operationType; // 日志：操作类型完全相同
+    };
+
+    // 键集分页结果：游标为空字符串表示该方向没有更多数据
+    template <typename Row>
+    struct KeysetPage {
+        std::vector<Row> rows;
+        std::string nextCursor;
+        std::string prevCursor;
     };
     
     bool connect();
     bool testConnection();
     void disconnect();
+    bool isConnected() const { return connected; }
     
     ~Database();
     // 查询方法
@@ -73,24 +127,70 @@ public:
     bool deleteInventoryItem(int inventoryId, 
                             const std::string& operationReason = ""); // 添加默认值
 
+    // 批量增删改库存：全部操作在一个事务中执行，新增为多行 INSERT、修改为 UPDATE ... CASE、
+    // 删除为 DELETE ... IN，操作日志合并为一条多行 INSERT。results 与 ops 一一对应。
+    // atomic 为 true 时任一操作校验失败则全部不执行；否则只执行通过校验的操作。
+    // 全部成功返回 true
+    bool applyInventoryBatch(const std::vector<InventoryOperation>& ops, bool atomic,
+                             std::vector<InventoryOperationResult>& results);
+    
+    // 批量导入的一个物品（见 Importer）
+    struct ImportItem {
+        std::string name;
+        std::string category;
+        std::string grade;
+        std::string effect;
+        std::string description;
+        std::string note;
+    };
+
+    // 按名称查找或创建一批物品：一个事务内查出已存在的名称，其余用多行 INSERT 创建并记录操作日志。
+    // itemIds 与 items 一一对应（同名的项得到同一个 id）；不存在且缺少类别或品质的项不创建，id 为 0。
+    // created 为新建的个数。失败时整批回滚并返回 false
+    bool importItems(const std::vector<ImportItem>& items, const std::string& reason,
+                     std::vector<int>& itemIds, size_t& created);
     
     bool itemExistsInList(const std::string& name);
     
     int getItemIdByName(const std::string& name);
     
     // 库存管理方法
-    std::vector<std::map<std::string, std::string>> getInventory(int page = 1, int pageSize = 10, const std::string& search = "");
+    std::vector<InventoryItem> getInventory(int page = 1, int pageSize = 10, const std::string& search = "");
     std::vector<std::map<std::string, std::string>> getInventoryByItemId(int itemId);
+    // 键集分页：按 (last_updated, id) 从游标处继续取一页，代价与页码无关。
+    // cursor 无效时返回第一页；backward 为 true 时取游标之前（更新）的一页
+    KeysetPage<InventoryItem> getInventoryByCursor(const PageCursor& cursor, bool backward,
+                                                   int pageSize = 10, const std::string& search = "");
     
     // 操作日志方法
     bool logOperation(const std::string& operationType, 
                      const std::string& itemName, 
                      const std::string& note = "");
     
-    std::vector<std::map<std::string, std::string>> getOperationLogs(
+    // 在一个事务中用多行 INSERT 写入一批操作日志（延迟写入队列的后台线程调用）。
+    // ids 非空时回填新行的 id（只在搜索索引或实时事件需要时取得，否则为空）；
+    // journal 非空时在同一事务中把该日志文件的检查点更新为这批记录的最后一个序号
+    bool writeOperationLogs(const std::vector<OperationLogQueue::Entry>& entries,
+                            std::vector<int>* ids = nullptr, const std::string& journal = "");
+    // 延迟写入日志文件 journal 中已写入数据库的最大序号，没有检查点时为 0。
+    // 检查点表 operation_log_checkpoint 不存在时创建；失败抛出 StorageError
+    uint64_t operationLogCheckpoint(const std::string& journal);
+    
+    std::vector<OperationLogEntry> getOperationLogs(
         int page = 1, 
         int pageSize = 10, 
         const std::string& search = "");
+    // 键集分页：按 (operation_time, id) 从游标处继续取一页
+    KeysetPage<OperationLogEntry> getOperationLogsByCursor(const PageCursor& cursor, bool backward,
+                                                           int pageSize = 10, const std::string& search = "");
+    
+    // 批量导出：按 (时间, id) 升序取 after 之后最多约 limit 行，并把 after 移到已读取的最后一行。
+    // 每次调用都是一个独立的键集查询，不持有事务和结果集，导出任意多行只占用一段的内存。
+    // 没有更多数据时 done 为 true；查询失败抛出 StorageError
+    std::vector<InventoryItem> exportInventory(const ExportFilter& filter, PageCursor& after,
+                                               int limit, bool& done);
+    std::vector<OperationLogEntry> exportOperationLogs(const ExportFilter& filter, PageCursor& after,
+                                                       int limit, bool& done);
     
     // 日志方法
     void log(const std::string& message, bool error = false);
@@ -104,47 +204,92 @@ public:
                               const std::string& key, 
                               const std::string& defaultValue = "N/A");
 
-    // 新增获取总数的方法
+    // 新增获取总数的方法（不带筛选条件，优先使用内存中的缓存值）
     int getTotalInventoryCount();
     int getTotalOperationLogsCount();
+    // 与分页查询使用相同筛选条件的计数；结果很大时可能是估算值（见 CountService）
+    CountService::CountResult countInventory(const std::string& search = "");
+    CountService::CountResult countOperationLogs(const std::string& search = "");
     Config& getConfig() { return config; }
     void reloadConfig();
     void updateDatabaseCredentials(const std::string& host, int port, 
                                   const std::string& user, const std::string& password,
                                   const std::string& dbName);
-    // 添加分页获取库存数据的方法
-    std::vector<InventoryItem> getInventoryPaginated(int page, int perPage, const std::string& search = "");
     explicit Database(Config& config);
-    std::vector<std::map<std::string, std::string>> parseResultSet(sql::ResultSet* res);
+    std::vector<std::map<std::string, std::string>> parseResultSet(StorageResult* res);
     void ensureConnected();
     std::vector<std::map<std::string, std::string>> searchItems(const std::string& query, int limit);
     
+    // 从数据库全量构建搜索索引（WebServer 启动时在后台线程调用）
+    bool buildSearchIndex();
+    
+    // 比较 item_list 的版本指纹，有变化（或 force）时重新加载物品目录
+    bool refreshItemCatalog(bool force = false);
+    
+    // 启动时加载内存库存引擎（[application] inventory_engine 为 off 时什么也不做）
+    bool loadInventoryEngine();
+    
+    // 取得缓存的预处理语句（所有权归语句缓存，调用方不要释放）
+    StorageStatement* prepare(const std::string& sql);
+    StatementCache::Stats getStatementCacheStats() const { return stmtCache.getStats(); }
+    
     // 添加获取连接的方法
-    sql::Connection* getConnection() {
+    StorageConnection* getConnection() {
         ensureConnected();
         return con.get();
     }
 
 private:
+    // 计数的公共实现：fromWhere 为 "FROM ... [WHERE ...]"，params 依次绑定到其中的占位符
+    CountService::CountResult countRows(CountService::Table table, const std::string& fromWhere,
+                                        const std::vector<std::string>& params,
+                                        const std::string& search);
+    long long countWithLimit(const std::string& fromWhere, const std::vector<std::string>& params,
+                             long long limit);
+    long long estimateRows(const std::string& fromWhere, const std::vector<std::string>& params);
+
+    // 搜索索引相关：按主键批量取回行（结果按 ids 的顺序），以及写入后同步索引
+    std::vector<InventoryItem> loadInventoryByIds(const std::vector<int>& ids);
+    std::vector<InventoryItem> inventoryByIds(const std::vector<int>& ids); // 内存库存引擎可用时不查询数据库
+    std::vector<OperationLogEntry> loadOperationLogsByIds(const std::vector<int>& ids);
+    long long lastInsertId();
+    // 操作日志的多行 INSERT（调用方负责事务），以及提交后更新计数和索引
+    std::vector<int> insertOperationLogRows(const std::vector<OperationLogQueue::Entry>& entries);
+    void operationLogsWritten(size_t count, const std::vector<int>& ids);
+    void saveOperationLogCheckpoint(const std::string& journal, uint64_t seq); // 调用方负责事务
+    // 单条新增/修改/删除：单行加锁、单行写入和日志 INSERT 在同一事务中完成
+    bool applySingleInventoryOperation(const InventoryOperation& op, const char* action);
+    // 库存写入提交后的公共收尾（批量和单条路径共用）
+    void inventoryWritten(const std::vector<OperationLogQueue::Entry>& logs, std::vector<int>& logIds,
+                          bool deferLogs, const std::vector<int>& addedIds,
+                          const std::vector<int>& updatedIds, const std::vector<int>& removedIds);
+    std::unordered_map<int, std::string> resolveItemNames(const std::vector<int>& itemIds);
+    // 内存库存引擎：primary 模式的写入，以及 cache 模式提交后的同步
+    bool applyInventoryBatchToEngine(const std::vector<InventoryOperation>& ops, bool atomic,
+                                     std::vector<InventoryOperationResult>& results);
+    void syncInventoryCache(const std::vector<int>& changedIds, const std::vector<int>& removedIds);
+    void indexInventoryRow(int inventoryId); // 0 表示刚插入的行
+    void indexOperationLogRow(int logId);
+
     std::mutex connectionMutex; // 添加互斥锁定义
     Database();
+    bool connectLocked(); // 调用方需已持有 connectionMutex
     
 
     Database(const Database&) = delete;
     Database& operator=(const Database&) = delete;
 
-    sql::Driver* driver;
-    std::unique_ptr<sql::Connection> con;
+    std::unique_ptr<StorageConnection> con; // MySQL 或 SQLite，由 [database] backend 决定
+    StatementCache stmtCache; // 声明在 con 之后，保证析构时先于连接释放
     std::string host;
     std::string user;
     std::string password;
     std::string database;
-    std::ofstream logFile; // 日志文件流
     Config config; // 配置对象
-    bool logToConsole = true;  // 添加这行
-    int logLevelFlag = LOG_INFO;  // 添加日志级别标志
-    std::string logFileName;  // 修改为 logFileName
     bool connected;
+    // 连接最近一次被确认可用的时间，空闲超过 validateAfterIdle 才重新发送保活PING
+    std::chrono::steady_clock::time_point lastActivity;
+    std::chrono::seconds validateAfterIdle{30};
 };
 
 #endif // DATABASE_H
@@ -0,0 +1,78 @@
+// ====== EventBus.h ======
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include "Config.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 进程内的发布/订阅：Database 的写路径提交后发布库存变化和操作日志，WebServer 发布数据库连接状态，
+// /api/events 以 Server-Sent Events 推送给浏览器。
+//
+// 事件按发布顺序编号，保存在一个定长的环形缓冲区中（[application] events_buffer 条），
+// 每个订阅者只记录自己读到的编号，不单独排队。断线重连时按 Last-Event-ID 补发缓冲区中的事件；
+// 要补发的事件已被覆盖（或服务重启过）时，订阅者收到 reset，需要重新加载整页数据。
+// sticky 事件（如连接状态）另外保留每种类型的最后一条，新订阅者连上后先收到它们。
+//
+// 没有订阅者时 hasSubscribers() 为 false，写路径据此跳过事件内容的生成。
+class EventBus {
+public:
+    struct Event {
+        uint64_t id = 0;
+        std::string type;
+        std::string data; // JSON
+    };
+
+    static EventBus& instance();
+
+    // 读取配置（[application] events_buffer）
+    void configure(Config& config);
+
+    // 发布一条事件，返回其编号
+    uint64_t publish(const std::string& type, std::string data, bool sticky = false);
+
+    // 取 afterId 之后的事件，没有时最多等待 timeout。
+    // afterId 之后的事件已不在缓冲区中时返回 false（需要 reset）
+    bool waitEvents(uint64_t afterId, std::chrono::milliseconds timeout, std::vector<Event>& events);
+
+    std::vector<Event> stickyEvents() const;
+    uint64_t lastId() const;
+
+    // 事件编号的前缀（进程启动时间），用来识别重启前的 Last-Event-ID
+    const std::string& epoch() const { return epoch_; }
+
+    // 订阅者计数，超过 maxSubscribers 时返回 false
+    bool addSubscriber(size_t maxSubscribers);
+    void removeSubscriber();
+    bool hasSubscribers() const { return subscribers_.load(std::memory_order_acquire) > 0; }
+    size_t subscriberCount() const { return subscribers_.load(std::memory_order_acquire); }
+
+    // 服务停止：唤醒所有等待中的订阅者，之后 waitEvents 立即返回
+    void close();
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+
+private:
+    EventBus();
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Event> events_;                 // 最近的事件，编号连续
+    std::map<std::string, Event> sticky_;      // 每种 sticky 类型的最后一条
+    size_t capacity_ = 256;
+    uint64_t lastId_ = 0;
+    std::string epoch_;
+    std::atomic<size_t> subscribers_{0};
+    std::atomic<bool> closed_{false};
+};
+
+#endif // EVENT_BUS_H
@@ -0,0 +1,30 @@
+// ====== HttpCompression.h ======
+#ifndef HTTP_COMPRESSION_H
+#define HTTP_COMPRESSION_H
+
+#include <string>
+
+// HTTP 响应压缩：按 Accept-Encoding 协商编码并压缩响应体。
+// gzip 需要编译时找到 zlib（GEARTRACKER_WITH_ZLIB），brotli 需要 libbrotlienc（GEARTRACKER_WITH_BROTLI），
+// 都没有时 negotiate() 总是返回 IDENTITY。
+class HttpCompression {
+public:
+    enum Encoding { IDENTITY, GZIP, BROTLI };
+
+    // 选择客户端接受（q > 0）且本程序支持的编码，同等 q 值时优先 brotli
+    static Encoding negotiate(const std::string& acceptEncoding);
+
+    // 客户端是否接受该编码（只看请求头，不要求本程序支持，用于发送预压缩的内容）
+    static bool accepts(const std::string& acceptEncoding, Encoding encoding);
+
+    // Content-Encoding 头的值
+    static const char* name(Encoding encoding);
+
+    // 适合压缩的 Content-Type（文本、JSON、JavaScript 等）
+    static bool compressible(const std::string& contentType);
+
+    // level：gzip 为 1-9，brotli 为 0-11（超出范围时取边界值）。失败返回 false
+    static bool compress(Encoding encoding, const std::string& input, std::string& output, int level);
+};
+
+#endif // HTTP_COMPRESSION_H
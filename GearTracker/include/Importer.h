@@ -0,0 +1,59 @@
+// ====== Importer.h ======
+#ifndef IMPORTER_H
+#define IMPORTER_H
+
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <string>
+
+class Database;
+
+// 批量导入物品和库存（命令行 geartracker import 和 POST /api/import 共用）。
+// 输入为 CSV（首行是列名）或 NDJSON（每行一个 JSON 对象），识别的列：
+//   name（或 item_name）  物品名称，必填
+//   category, grade, effect, description, note
+//                         物品属性；物品不存在时按这些列创建，类别和品质缺一不可
+//   quantity, location    数量和位置：填写 quantity 时向库存添加一行，quantity 须为正整数且 location 必填
+//   reason                库存操作原因，空时使用 Options::reason
+// 导出的库存 CSV（/api/export/inventory）可以直接导入：按 item_name 匹配已有物品。
+//
+// 读取和校验在单独的线程中进行，解析好的行按 chunkRows 分批交给调用线程写入：
+// 每批在一个事务中查找/创建物品（多行 INSERT），再作为一次非原子的批量库存操作写入库存。
+// 不合法或写入失败的行交给 onReject，不影响其余行。
+class Importer {
+public:
+    enum Format { CSV, NDJSON };
+
+    struct Reject {
+        size_t line = 0;     // 行号（从 1 开始）
+        std::string error;
+        std::string row;     // 原始文本
+    };
+
+    struct Progress {
+        size_t rows = 0;           // 已处理的数据行（含被拒绝的）
+        size_t itemsCreated = 0;
+        size_t inventoryAdded = 0;
+        size_t rejected = 0;
+        size_t bytesRead = 0;
+        double seconds = 0;
+    };
+
+    struct Options {
+        size_t chunkRows = 1000;
+        std::string reason = "批量导入";
+        std::function<void(const Reject&)> onReject;
+        std::function<void(const Progress&)> onProgress; // 每写入一批调用一次
+    };
+
+    // 按文件扩展名或格式名（csv / ndjson / jsonl）识别格式
+    static bool formatFromName(const std::string& name, Format& format);
+
+    // 导入整个输入流。无法继续时（CSV 缺少 name 列、数据库写入失败）返回 false 并设置 error，
+    // 此前写入的批次保留
+    static bool run(Database& db, std::istream& in, Format format, const Options& options,
+                    Progress& progress, std::string& error);
+};
+
+#endif // IMPORTER_H
@@ -0,0 +1,183 @@
+// ====== InventoryEngine.h ======
+#ifndef INVENTORY_ENGINE_H
+#define INVENTORY_ENGINE_H
+
+#include "Config.h"
+#include "SearchIndex.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 内存中的库存表：按 id 的哈希表，另有 item_id、location 和 (last_updated, id) 三个二级索引，
+// 库存列表、按物品/按 id 查询、计数和命令行的库存显示都直接在内存中完成。
+//
+// 由 [application] inventory_engine 选择工作方式（修改后需重启）：
+//   off      不启用（默认），所有读写都访问数据库
+//   cache    直写缓存：启动时从数据库加载，写入仍在数据库事务中完成，提交后按数据库中的值同步到内存。
+//            只适合本程序是 inventory 表唯一写入方的部署
+//   primary  内存为库存的主存储：写入先追加到预写日志（WAL）并 fsync，再更新内存，数据库的 inventory 表
+//            不再写入（item_list 和 operation_log 仍在数据库中）。后台线程定期把全部数据写成紧凑的
+//            二进制快照并截断 WAL，重启时读快照再重放 WAL。首次启动（没有快照和 WAL）时从数据库导入
+//
+// 相关配置（[application] 节）：
+//   inventory_snapshot               快照文件路径
+//   inventory_wal                    WAL 文件路径
+//   inventory_snapshot_interval      写快照的间隔秒数
+//   inventory_snapshot_wal_records   WAL 累积多少批写入后立即写快照
+class InventoryEngine {
+public:
+    enum Mode { OFF, CACHE, PRIMARY };
+
+    struct Row {
+        int id = 0;
+        int itemId = 0;
+        int quantity = 0;
+        std::string location;
+        std::string storedTime;  // 含微秒
+        std::string lastUpdated; // 含微秒，键集分页和排序使用
+    };
+
+    // primary 模式的一次提交。added 的 id 和时间由 commit() 填写；updated 只使用 id、quantity、location
+    struct Changes {
+        std::vector<Row> added;
+        std::vector<Row> updated;
+        std::vector<int> removed;
+    };
+
+    // 按物品或位置筛选（与 LIKE 的包含匹配配合使用）。两者都为空表示不筛选
+    struct Match {
+        std::function<bool(int itemId)> item;
+        std::function<bool(const std::string& location)> location;
+        bool empty() const { return !item && !location; }
+    };
+
+    struct Stats {
+        Mode mode = OFF;
+        bool ready = false;
+        size_t rows = 0;
+        size_t items = 0;     // 不同的 item_id 数
+        size_t locations = 0; // 不同的位置数
+        uint64_t walBatches = 0;   // 上次快照以来写入 WAL 的批次
+        uint64_t walBytes = 0;
+        uint64_t snapshots = 0;
+        uint64_t lastSnapshotSeq = 0;
+    };
+
+    static InventoryEngine& instance();
+
+    static const char* modeName(Mode mode);
+
+    // 读取配置（只在第一次调用时生效）。primary 模式读取快照并重放 WAL，启动快照线程
+    void configure(Config& config);
+
+    // primary 模式写最后一次快照并停止后台线程（程序退出前调用）
+    void shutdown();
+
+    Mode mode() const { return mode_; }
+    bool ready() const { return ready_.load(std::memory_order_acquire); }
+    bool serving() const { return mode_ != OFF && ready(); }
+
+    // primary 模式下没有任何持久化数据（首次启动），需要先用数据库中的库存 load()
+    bool needsSeed() const { return needsSeed_; }
+
+    // 用全量数据替换内存表：cache 模式从数据库加载；primary 模式首次启动时导入并立即写快照
+    bool load(std::vector<Row> rows);
+
+    // ---------- 查询 ----------
+    bool find(int id, Row& row) const;
+    std::vector<Row> findMany(const std::vector<int>& ids) const; // 按 ids 的顺序，不存在的跳过
+    std::vector<Row> byItem(int itemId) const;                   // last_updated 降序
+
+    // 一页数据：按 (last_updated, id) 降序，向后翻页时升序（与数据库键集查询一致）
+    std::vector<Row> page(const SearchIndex::PageRequest& request, const Match& match) const;
+    long long count(const Match& match) const;
+    size_t size() const;
+
+    // 遍历全部行（构建搜索索引用），遍历期间持有读锁
+    void forEach(const std::function<void(const Row&)>& fn) const;
+
+    // ---------- 写入 ----------
+    // primary 模式：读取当前值、校验到 commit() 之间持有，保证写入按顺序进行
+    std::unique_lock<std::mutex> lockWrites() { return std::unique_lock<std::mutex>(writeMutex_); }
+
+    // primary 模式（调用方持有 lockWrites()）：追加 WAL 并 fsync 后更新内存。
+    // 回填 added 的 id 和时间；WAL 写入失败时返回 false，内存不变
+    bool commit(Changes& changes);
+
+    // cache 模式：数据库提交后，按数据库中的值更新或删除（比内存中的行旧的值忽略，
+    // 并发提交的同步顺序颠倒时不会覆盖较新的值）
+    void apply(const std::vector<Row>& upserts, const std::vector<int>& removed);
+
+    // cache 模式：同步失败后清空内存数据并停止使用，读取退回数据库，重启后重新加载
+    void invalidate();
+
+    // primary 模式：立即写快照并截断 WAL
+    bool snapshot();
+
+    Stats getStats() const;
+
+    InventoryEngine(const InventoryEngine&) = delete;
+    InventoryEngine& operator=(const InventoryEngine&) = delete;
+
+private:
+    InventoryEngine() = default;
+    ~InventoryEngine();
+
+    using OrderKey = std::pair<std::string, int>; // (last_updated, id)
+
+    // put / erase / clear 的调用方持有 mutex_ 的写锁
+    void put(Row row);
+    void erase(int id);
+    void clear();
+    std::vector<int> matchIds(const Match& match) const; // 调用方持有读锁
+
+    bool recover();                    // 读取快照并重放 WAL
+    bool readSnapshot(uint64_t& seq);
+    bool replayWal(uint64_t afterSeq);
+    bool openWal();
+    bool appendWal(const std::string& data);
+    void snapshotLoop();
+
+    Mode mode_ = OFF;
+    bool configured_ = false;
+    bool needsSeed_ = false;
+    std::atomic<bool> ready_{false};
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<int, Row> rows_;
+    std::unordered_map<int, std::set<int>> byItem_;
+    std::unordered_map<std::string, std::set<int>> byLocation_;
+    std::set<OrderKey> byUpdated_;
+    int nextId_ = 1;
+
+    // primary 模式的持久化状态，由 writeMutex_ 保护
+    std::mutex writeMutex_;
+    std::string snapshotPath_;
+    std::string walPath_;
+    int walFd_ = -1;
+    uint64_t lastSeq_ = 0;
+    uint64_t snapshotSeq_ = 0;
+    std::atomic<uint64_t> walBatches_{0}; // 上次快照以来的批次
+    std::atomic<uint64_t> walBytes_{0};
+    std::atomic<uint64_t> snapshots_{0};
+
+    std::mutex snapshotMutex_; // 同一时间只写一个快照
+    std::mutex loopMutex_;
+    std::condition_variable loopCv_;
+    bool stopping_ = false;
+    std::thread snapshotter_;
+    std::chrono::seconds snapshotInterval_{300};
+    uint64_t snapshotAfterBatches_ = 10000;
+};
+
+#endif // INVENTORY_ENGINE_H
@@ -0,0 +1,70 @@
+// ====== ItemCatalog.h ======
+#ifndef ITEM_CATALOG_H
+#define ITEM_CATALOG_H
+
+#include <atomic>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// item_list 的内存副本（id ↔ 名称、类别、品质），进程内共用一份。
+// 启动时由 Database::refreshItemCatalog 全量加载；本程序新增物品时由 addItemToList 同步写入；
+// 其他程序的修改由 WebServer 的后台线程定期比较版本指纹后重新加载。
+// 加载完成后按名称/ID 的查找都不再访问数据库，未找到即视为不存在。
+class ItemCatalog {
+public:
+    struct Item {
+        int id = 0;
+        std::string name;
+        std::string category;
+        std::string grade;
+    };
+
+    // item_list 的版本指纹：行数、最大 id、内容校验和
+    struct Version {
+        long long count = 0;
+        long long maxId = 0;
+        long long checksum = 0;
+
+        bool operator==(const Version& other) const {
+            return count == other.count && maxId == other.maxId && checksum == other.checksum;
+        }
+        bool operator!=(const Version& other) const { return !(*this == other); }
+    };
+
+    static ItemCatalog& instance();
+
+    bool ready() const { return ready_.load(std::memory_order_acquire); }
+
+    // 用全量数据替换目录
+    void replace(std::vector<Item> items, const Version& version);
+
+    // 新增或修改单个物品（写入后调用）
+    void upsert(const Item& item);
+
+    // 按名称查找 id，不存在返回 -1（与 MySQL 默认排序规则一致：英文不区分大小写、忽略末尾空格）
+    int idOf(const std::string& name) const;
+    bool findByName(const std::string& name, Item& item) const;
+    bool findById(int id, Item& item) const;
+    bool nameOf(int id, std::string& name) const;
+
+    Version version() const;
+    size_t size() const;
+
+    ItemCatalog(const ItemCatalog&) = delete;
+    ItemCatalog& operator=(const ItemCatalog&) = delete;
+
+private:
+    ItemCatalog() = default;
+
+    static std::string nameKey(const std::string& name);
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<int, Item> byId_;
+    std::unordered_map<std::string, int> byName_;
+    Version version_;
+    std::atomic<bool> ready_{false};
+};
+
+#endif // ITEM_CATALOG_H
@@ -0,0 +1,95 @@
+// ====== JsonWriter.h ======
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 流式 JSON 输出：值直接追加到一块输出缓冲区，不构建中间的 DOM 树。
+// 逗号由写入器按嵌套层次自动补上，调用方只需按顺序写键和值：
+//
+//   JsonWriter out(4096);
+//   out.beginObject().field("total", 12).key("items").beginArray();
+//   for (...) out.beginObject().field("id", id).field("name", name).endObject();
+//   out.endArray().endObject();
+//   res.set_content(out.take(), "application/json");
+//
+// 带 sink 构造时，缓冲区超过 flushBytes 就交给 sink 写出（例如 httplib 的 DataSink），
+// 输出任意多行只占用一个缓冲区的内存。sink 返回 false（客户端断开）后不再写出，ok() 为 false。
+//
+// 字符串按 UTF-8 原样输出，只转义引号、反斜杠和控制字符；无效的 UTF-8 字节替换为 U+FFFD，
+// 保证输出总是合法的 JSON。
+class JsonWriter {
+public:
+    using Sink = std::function<bool(const char* data, size_t size)>;
+
+    explicit JsonWriter(size_t reserveBytes = 256);
+    JsonWriter(Sink sink, size_t flushBytes = 16 * 1024);
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+    JsonWriter& key(std::string_view name);
+
+    JsonWriter& value(std::string_view text);
+    JsonWriter& value(const std::string& text) { return value(std::string_view(text)); }
+    JsonWriter& value(const char* text) { return value(std::string_view(text)); }
+    JsonWriter& value(bool flag);
+    JsonWriter& value(int number) { return value(static_cast<long long>(number)); }
+    JsonWriter& value(long number) { return value(static_cast<long long>(number)); }
+    JsonWriter& value(long long number);
+    JsonWriter& value(unsigned number) { return value(static_cast<unsigned long long>(number)); }
+    JsonWriter& value(unsigned long number) { return value(static_cast<unsigned long long>(number)); }
+    JsonWriter& value(unsigned long long number);
+    JsonWriter& value(double number); // NaN 和无穷输出为 null
+    JsonWriter& value(std::nullptr_t);
+
+    // 已经序列化好的 JSON 片段，原样写入
+    JsonWriter& raw(std::string_view json);
+
+    // NDJSON：每个顶层值之后换行
+    JsonWriter& endLine();
+
+    template <typename T>
+    JsonWriter& field(std::string_view name, const T& v) {
+        key(name);
+        return value(v);
+    }
+
+    // 值为空字符串时写 null（分页游标等可选字段）
+    JsonWriter& optionalField(std::string_view name, const std::string& text) {
+        key(name);
+        return text.empty() ? value(nullptr) : value(text);
+    }
+
+    // sink 模式：把缓冲区中的内容立即写出。sink 已失败时返回 false
+    bool flush();
+    bool ok() const { return ok_; }
+
+    // 非 sink 模式：取得输出（take 之后写入器不再可用）
+    const std::string& str() const { return buf_; }
+    std::string take() { return std::move(buf_); }
+    size_t size() const { return buf_.size(); }
+
+    // 把 text 转义后追加到 out（不含两侧引号）
+    static void escape(std::string& out, std::string_view text);
+
+private:
+    void separate();  // 同一层的第二个及以后的值前面写逗号
+    void afterValue();
+    void quoted(std::string_view text);
+
+    std::string buf_;
+    std::vector<uint8_t> hasItems_; // 每层已写入的元素个数是否大于 0
+    bool afterKey_ = false;
+    Sink sink_;
+    size_t flushBytes_ = 0;
+    bool ok_ = true;
+};
+
+#endif // JSON_WRITER_H
@@ -0,0 +1,132 @@
+// ====== Logger.h ======
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include "Config.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// 日志级别常量
+const int LOG_DEBUG = 0;
+const int LOG_INFO = 1;
+const int LOG_WARNING = 2;
+const int LOG_ERROR = 3;
+
+// 异步日志系统：调用方只把消息放入无锁环形缓冲区（多生产者、单消费者），
+// 由后台线程持有日志文件并批量写出、按大小/时间轮转。缓冲区满时丢弃并计数，
+// 请求线程永远不会因为写日志而阻塞。
+//
+// 相关配置（[application] 节）：
+//   log_level                 debug / info / warning / error
+//   log_file                  日志文件路径
+//   log_to_console            是否同时输出到控制台
+//   log_flush_interval_ms     后台线程批量写出的间隔
+//   log_max_size_mb           单个日志文件的大小上限，超过后轮转
+//   log_rotate_interval_hours 按时间轮转的间隔，0 表示不按时间轮转
+//   log_max_files             保留的历史日志文件数
+class Logger {
+public:
+    static Logger& instance();
+
+    // 从配置加载日志参数（可重复调用，用于重新加载配置）
+    void configure(Config& config);
+
+    // 级别检查放在格式化消息之前，配合 GT_LOG 宏使用
+    bool shouldLog(int level) const {
+        return level >= level_.load(std::memory_order_relaxed);
+    }
+
+    // 放入缓冲区后立即返回；缓冲区满时丢弃该条日志
+    void write(int level, std::string message);
+
+    void setLevel(int level) { level_.store(level, std::memory_order_relaxed); }
+    int getLevel() const { return level_.load(std::memory_order_relaxed); }
+    uint64_t droppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+
+    // 等待缓冲区中已有的日志全部写出
+    void flush();
+
+    // 写出剩余日志并停止后台线程（程序退出前调用）
+    void shutdown();
+
+    static int parseLevel(const std::string& name);
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+private:
+    Logger();
+    ~Logger();
+
+    static const size_t kBufferCapacity = 16384; // 环形缓冲区容量（条），必须是2的幂
+
+    struct Record {
+        int level = LOG_INFO;
+        std::chrono::system_clock::time_point time;
+        std::string message;
+    };
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        Record record;
+    };
+
+    bool tryPop(Record& record);
+    void writerLoop();
+    size_t drainBatch();
+    void appendFormatted(const Record& record);
+    void openFile();
+    void rotateIfNeeded();
+    void rotate();
+
+    // 环形缓冲区（Vyukov 有界队列，消费者只有后台写线程）
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> enqueuePos_{0};
+    alignas(64) size_t dequeuePos_ = 0;
+
+    std::atomic<int> level_{LOG_INFO};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> consumed_{0}; // 后台线程已取出的条数，供 flush() 等待
+    std::atomic<bool> running_{false};
+    std::thread writer_;
+
+    // 以下设置只由后台线程和 configure() 访问
+    std::mutex settingsMutex_;
+    std::string fileName_ = "geartracker.log";
+    bool toConsole_ = true;
+    bool reopenRequested_ = false;
+    std::chrono::milliseconds flushInterval_{100};
+    uint64_t maxFileBytes_ = 10ull * 1024 * 1024;
+    std::chrono::hours rotateInterval_{24};
+    int maxFiles_ = 5;
+
+    // 仅后台线程使用
+    FILE* file_ = nullptr;
+    uint64_t fileBytes_ = 0;
+    std::chrono::system_clock::time_point fileOpenedAt_;
+    std::string batch_;
+    time_t cachedSecond_ = 0;
+    char cachedTimestamp_[32] = {0};
+};
+
+// 先检查级别再求值消息表达式，低于当前级别的日志不产生任何字符串拼接
+#define GT_LOG(level, message)                                   \
+    do {                                                         \
+        if (Logger::instance().shouldLog(level)) {               \
+            Logger::instance().write((level), (message));        \
+        }                                                        \
+    } while (0)
+
+#define GT_LOG_DEBUG(message) GT_LOG(LOG_DEBUG, message)
+#define GT_LOG_INFO(message) GT_LOG(LOG_INFO, message)
+#define GT_LOG_WARNING(message) GT_LOG(LOG_WARNING, message)
+#define GT_LOG_ERROR(message) GT_LOG(LOG_ERROR, message)
+
+#endif // LOGGER_H
@@ -0,0 +1,141 @@
+// ====== Metrics.h ======
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "Config.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+
+// 进程内的指标注册表，由 GET /metrics 以 Prometheus 文本格式输出。
+// 计数器、仪表和直方图都只用原子变量更新，记录一次不加锁；按名称和标签取得指标时加读锁，
+// 返回的指针在进程内一直有效，热点路径（每条 SQL 语句）应在首次取得后缓存它。
+//
+// 直方图按微秒记录，桶的划分与 HDR Histogram 相同：每个 2 的幂区间再等分为 4 个子桶，
+// 相对误差不超过 25%，覆盖 1 微秒到约 71 分钟。输出时按 2 的幂边界（16 微秒到 134 秒）汇总为累计桶。
+//
+// 相关配置（[application] 节）：
+//   metrics  是否记录和输出指标（默认 true）
+class Metrics {
+public:
+    class Counter {
+    public:
+        void add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+        uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint64_t> value_{0};
+    };
+
+    class Gauge {
+    public:
+        void add(int64_t n) { value_.fetch_add(n, std::memory_order_relaxed); }
+        void set(int64_t n) { value_.store(n, std::memory_order_relaxed); }
+        int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<int64_t> value_{0};
+    };
+
+    class Histogram {
+    public:
+        static constexpr int kMaxMajor = 31; // 2^32 微秒以上计入最后一个桶
+        static constexpr size_t kBuckets = (kMaxMajor - 1) * 4 + 4;
+
+        void record(uint64_t micros);
+        void record(std::chrono::steady_clock::duration elapsed) {
+            record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+        }
+
+        uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+        uint64_t sumMicros() const { return sum_.load(std::memory_order_relaxed); }
+        // 估算的分位数（微秒），取所在桶的上界
+        uint64_t quantile(double q) const;
+
+        // 桶 index 的上界（不含）
+        static uint64_t bucketLimit(size_t index);
+        static size_t bucketOf(uint64_t micros);
+
+    private:
+        friend class Metrics;
+        std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+        std::atomic<uint64_t> count_{0};
+        std::atomic<uint64_t> sum_{0};
+    };
+
+    static Metrics& instance();
+
+    // 读取配置（可重复调用）
+    void configure(Config& config);
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    // 取得（首次调用时创建）一个指标。同一 name 的 help 和类型以第一次为准；
+    // labels 为 Prometheus 标签文本，如 method="GET",route="/api/inventory"（值用 label() 转义）
+    Counter* counter(const std::string& name, const std::string& help, const std::string& labels = "");
+    Gauge* gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+    Histogram* histogram(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    // 追加所有已注册指标的 Prometheus 文本格式
+    void render(std::string& out) const;
+
+    // 追加一个不在注册表中的样本（由其他模块的统计数据在输出时换算）
+    static void appendSample(std::string& out, std::string_view name, const char* type, std::string_view help,
+                             double value, std::string_view labels = "");
+
+    // 标签值转义（反斜杠、双引号、换行）后加上双引号
+    static std::string label(std::string_view value);
+
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+private:
+    Metrics() = default;
+
+    enum Type { COUNTER, GAUGE, HISTOGRAM };
+
+    struct Family {
+        Type type;
+        std::string help;
+        std::map<std::string, std::unique_ptr<Counter>> counters;
+        std::map<std::string, std::unique_ptr<Gauge>> gauges;
+        std::map<std::string, std::unique_ptr<Histogram>> histograms;
+    };
+
+    Family& family(const std::string& name, const std::string& help, Type type);
+    template <typename T>
+    T* series(const std::string& name, const std::string& help, const std::string& labels, Type type,
+              std::map<std::string, std::unique_ptr<T>> Family::*member);
+
+    std::atomic<bool> enabled_{true};
+    mutable std::shared_mutex mutex_;
+    std::map<std::string, Family> families_;
+};
+
+// 计时到作用域结束，记录到直方图（histogram 为空时不计时）
+class MetricsTimer {
+public:
+    explicit MetricsTimer(Metrics::Histogram* histogram)
+        : histogram_(histogram), start_(histogram ? std::chrono::steady_clock::now()
+                                                  : std::chrono::steady_clock::time_point()) {}
+    ~MetricsTimer() {
+        if (histogram_) {
+            histogram_->record(std::chrono::steady_clock::now() - start_);
+        }
+    }
+
+    MetricsTimer(const MetricsTimer&) = delete;
+    MetricsTimer& operator=(const MetricsTimer&) = delete;
+
+private:
+    Metrics::Histogram* histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#endif // METRICS_H
@@ -0,0 +1,16 @@
+// ====== MySqlStorage.h ======
+#ifndef MYSQL_STORAGE_H
+#define MYSQL_STORAGE_H
+
+#include "Storage.h"
+#include <memory>
+
+// MySQL 后端：对 MySQL Connector/C++ 的薄封装，sql::SQLException 转换为 StorageError。
+// 连接参数取自 [database] host / port / username / password / database。
+class MySqlStorage {
+public:
+    // 建立连接、选择数据库、设置字符集并执行一次验证查询
+    static std::unique_ptr<StorageConnection> open(Config& config);
+};
+
+#endif // MYSQL_STORAGE_H
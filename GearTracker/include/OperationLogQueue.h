@@ -0,0 +1,106 @@
+// ====== OperationLogQueue.h ======
+#ifndef OPERATION_LOG_QUEUE_H
+#define OPERATION_LOG_QUEUE_H
+
+#include "Config.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 操作日志的延迟写入（write-behind）队列。
+// 开启后增删改只把操作日志放入内存中的有界队列，并追加到本地日志文件（journal）后 fsync，
+// 由后台线程每隔 oplog_flush_interval_ms 或攒够 oplog_flush_batch 条时用多行 INSERT 写入 operation_log。
+// 每批记录与数据库中的检查点（日志文件的序号）在同一事务中写入，程序异常退出后，
+// 下次启动时只把日志文件中序号大于检查点的记录重新入队，不会重复写入。
+//
+// 相关配置（[application] 节）：
+//   oplog_write_behind       是否开启（默认 false，即每次操作同步写入）
+//   oplog_flush_interval_ms  后台写入间隔
+//   oplog_flush_batch        攒够多少条立即写入
+//   oplog_queue_capacity     队列上限，满时调用方退回同步写入
+//   oplog_journal            本地日志文件路径
+class OperationLogQueue {
+public:
+    struct Entry {
+        uint64_t seq = 0;
+        std::string type;
+        std::string itemName;
+        std::string note;
+        std::string time; // 入队时间（含微秒），写入 operation_time
+    };
+
+    struct Stats {
+        bool enabled = false;
+        size_t pending = 0;
+        uint64_t flushed = 0;
+        uint64_t rejected = 0;
+        uint64_t flushErrors = 0;
+    };
+
+    static OperationLogQueue& instance();
+
+    // 读取配置（可重复调用）。首次开启时恢复日志文件中未写入的记录并启动后台线程
+    void configure(Config& config);
+
+    // 写出剩余记录并停止后台线程（程序退出前调用）
+    void shutdown();
+
+    bool enabled() const { return enabled_.load(std::memory_order_acquire); }
+
+    // 入队：先追加到日志文件并 fsync（不持有队列锁），再放入队列。
+    // 未开启、队列已满或日志文件写入失败时返回 false，调用方应同步写入数据库
+    bool enqueue(std::vector<Entry> entries);
+    bool enqueue(const std::string& type, const std::string& itemName, const std::string& note);
+
+    // 尚未写入数据库的记录，最新的在前；search 非空时按包含匹配过滤（英文不区分大小写）
+    std::vector<Entry> pending(const std::string& search, size_t limit) const;
+    size_t pendingCount(const std::string& search = "") const;
+
+    Stats getStats() const;
+
+    OperationLogQueue(const OperationLogQueue&) = delete;
+    OperationLogQueue& operator=(const OperationLogQueue&) = delete;
+
+private:
+    OperationLogQueue() = default;
+    ~OperationLogQueue();
+
+    void flushLoop();
+    bool openJournal();   // 调用方持有 journalMutex_
+    void recoverJournal(uint64_t checkpoint); // 调用方持有 journalMutex_ 和 mutex_
+    void truncateJournal(); // 调用方持有 journalMutex_
+    bool appendJournal(const std::string& data, bool sync); // 调用方持有 journalMutex_
+    void closeJournal();  // 调用方持有 journalMutex_
+
+    static bool matches(const Entry& entry, const std::string& needle);
+
+    // 加锁顺序为 journalMutex_ → mutex_。journalMutex_ 保护日志文件和序号，
+    // mutex_ 保护队列和设置，日志文件的写入和 fsync 不持有 mutex_
+    std::mutex journalMutex_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Entry> queue_;
+    uint64_t nextSeq_ = 1;
+    int journalFd_ = -1;
+    std::string journalPath_;
+
+    std::unique_ptr<Config> config_; // 后台线程用它建立自己的数据库连接
+    std::atomic<bool> enabled_{false};
+    bool stopping_ = false;
+    std::thread flusher_;
+    std::chrono::milliseconds flushInterval_{200};
+    size_t flushBatch_ = 100;
+    size_t capacity_ = 10000;
+
+    std::atomic<uint64_t> flushed_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> flushErrors_{0};
+};
+
+#endif // OPERATION_LOG_QUEUE_H
@@ -0,0 +1,25 @@
+// ====== PageCursor.h ======
+#ifndef PAGE_CURSOR_H
+#define PAGE_CURSOR_H
+
+#include <string>
+
+// 键集分页游标：记录一页边界行的排序键 (时间, id)。
+// 对外以不透明的 base64url 字符串传递，客户端只需原样回传。
+struct PageCursor {
+    std::string sortTime; // 排序时间列，含微秒，例如 2024-01-01 10:00:00.000000
+    long long id = 0;     // 同一时间内的次级排序键
+
+    bool valid() const { return !sortTime.empty() && id > 0; }
+
+    std::string encode() const;
+
+    // 解析客户端传回的游标，格式不正确时返回 false
+    static bool decode(const std::string& token, PageCursor& cursor);
+};
+
+// 当前本地时间，格式与 sortTime 相同（含微秒）。
+// 由程序生成的排序时间（延迟写入的操作日志、内存库存引擎的行）都用它，与数据库生成的值可直接比较
+std::string currentSortTime();
+
+#endif // PAGE_CURSOR_H
@@ -0,0 +1,97 @@
+// ====== RequestQueue.h ======
+#ifndef REQUEST_QUEUE_H
+#define REQUEST_QUEUE_H
+
+#include "httplib.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// HTTP 服务器的工作线程池和请求队列，替换 httplib 默认的线程池（Server::new_task_queue）。
+// 每个任务是一个客户端连接（含其上 keep-alive 的后续请求）。
+//   - workers 个工作线程；等待的连接超过 maxQueued 时，新连接交给空闲的溢出线程（overflowThreads 个）：
+//     溢出线程上的请求 overloaded() 为 true，WebServer 直接回复 503 + Retry-After，
+//     HttpServer 只读一个请求（最多等待 overflowTimeoutMs）并在回复后关闭连接，不再排队等待
+//   - 溢出线程都在忙时直接关闭连接，不排队
+//   - 工作线程开始处理一个连接时记录它在队列中等待的时间（queueWaitMs()），
+//     WebServer 据此丢弃等待超过路由时限的请求
+class RequestQueue : public httplib::TaskQueue {
+public:
+    struct Options {
+        size_t workers = 8;
+        size_t maxQueued = 64;
+        size_t overflowThreads = 2;
+        int overflowTimeoutMs = 1000;
+    };
+
+    // 运行情况，由 WebServer 持有（线程池在 listen() 结束时销毁，计数保留）
+    struct Counters {
+        std::atomic<size_t> workers{0};
+        std::atomic<size_t> active{0};      // 正在处理连接的工作线程
+        std::atomic<size_t> queued{0};      // 等待工作线程的连接
+        std::atomic<uint64_t> accepted{0};  // 交给工作线程的连接
+        std::atomic<uint64_t> overflowed{0}; // 交给溢出线程（回复 503）的连接
+        std::atomic<uint64_t> dropped{0};    // 溢出线程都在忙，直接关闭的连接
+        std::atomic<uint64_t> waitMsTotal{0};
+        std::atomic<uint64_t> waitMsMax{0};
+    };
+
+    RequestQueue(const Options& options, std::shared_ptr<Counters> counters);
+    ~RequestQueue() override;
+
+    bool enqueue(std::function<void()> fn) override;
+    void shutdown() override;
+
+    // 当前线程处理的连接是否是队列已满时接收的（应回复 503）
+    static bool overloaded();
+
+    // 当前线程处理的连接在队列中等待的毫秒数，只对连接上的第一个请求有效，取一次后清零
+    static long long takeQueueWaitMs();
+
+    RequestQueue(const RequestQueue&) = delete;
+    RequestQueue& operator=(const RequestQueue&) = delete;
+
+private:
+    struct Job {
+        std::function<void()> fn;
+        std::chrono::steady_clock::time_point enqueued;
+    };
+
+    void workerLoop();
+    void overflowLoop();
+
+    Options options_;
+    std::shared_ptr<Counters> counters_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable overflowCv_;
+    std::deque<Job> jobs_;
+    std::deque<Job> overflow_;
+    size_t idle_ = 0;         // 等待任务的工作线程
+    size_t overflowIdle_ = 0; // 等待任务的溢出线程
+    bool shutdown_ = false;
+    std::vector<std::thread> threads_;
+};
+
+// httplib::Server 的子类，按连接所在的线程决定处理方式（与 SSLServer 一样重写 process_and_close_socket）：
+//   - 工作线程：与 httplib 相同的 keep-alive 循环
+//   - 溢出线程：只处理一个请求，回复后关闭连接；从接收连接起最多 overflowTimeoutMs 毫秒，
+//     期间收不到完整的请求头就直接关闭，空闲或很慢的客户端不会拖住溢出线程
+class HttpServer : public httplib::Server {
+public:
+    void setOverflowTimeout(int ms) { overflowTimeoutMs_ = ms; }
+
+private:
+    bool process_and_close_socket(socket_t sock) override;
+
+    int overflowTimeoutMs_ = 1000;
+};
+
+#endif // REQUEST_QUEUE_H
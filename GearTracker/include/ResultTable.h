@@ -0,0 +1,79 @@
+// ====== ResultTable.h ======
+#ifndef RESULT_TABLE_H
+#define RESULT_TABLE_H
+
+#include "Storage.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 按列存储的查询结果。
+// 列名和类型在读取第一行之前从元数据解析一次；整数/浮点值存放在每列连续的数组中，
+// 字符串统一追加到一块内存（arena），单元格只记录偏移和长度。
+// 读取一整页结果时不再为每行每列分配 map 节点和列名字符串。
+class ResultTable {
+public:
+    enum ColumnType {
+        INTEGER, // 整数类型，按 int64 存储
+        REAL,    // 浮点类型，按 double 存储
+        TEXT     // 其余类型（字符串、时间、DECIMAL 等），按文本存储
+    };
+
+    struct Column {
+        std::string name; // 列标签（AS 别名），已转为小写
+        ColumnType type = TEXT;
+    };
+
+    ResultTable() = default;
+
+    // 读取结果集中剩余的所有行；expectedRows 用于预先分配空间
+    void load(StorageResult* res, size_t expectedRows = 0);
+    void clear();
+
+    size_t rowCount() const { return rows_; }
+    size_t columnCount() const { return columns_.size(); }
+    const Column& column(size_t col) const { return columns_[col]; }
+
+    // 按列名（不区分大小写）查找列序号，找不到返回 -1
+    int columnIndex(const std::string& name) const;
+
+    bool isNull(size_t row, size_t col) const { return data_[col].nulls[row] != 0; }
+
+    // 类型化访问：类型不符时按需转换，NULL 返回 0 或空串
+    int64_t getInt(size_t row, size_t col) const;
+    double getDouble(size_t row, size_t col) const;
+
+    // TEXT 列直接返回 arena 中的视图（在 ResultTable 被修改或销毁前有效）；
+    // 数值列请使用 getText
+    std::string_view getString(size_t row, size_t col) const;
+
+    // 任意类型列的文本形式
+    std::string getText(size_t row, size_t col) const;
+
+    // 所有字符串占用的字节数（用于调优与统计）
+    size_t arenaBytes() const { return arena_.size(); }
+
+private:
+    struct Slice {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+    };
+
+    // 每列只使用与类型对应的一个数组
+    struct ColumnData {
+        std::vector<int64_t> ints;
+        std::vector<double> reals;
+        std::vector<Slice> texts;
+        std::vector<uint8_t> nulls;
+    };
+
+    static ColumnType mapType(StorageResult::ColumnType type);
+
+    std::vector<Column> columns_;
+    std::vector<ColumnData> data_;
+    std::string arena_;
+    size_t rows_ = 0;
+};
+
+#endif // RESULT_TABLE_H
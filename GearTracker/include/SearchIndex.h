@@ -0,0 +1,119 @@
+// ====== SearchIndex.h ======
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+#include "PageCursor.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 进程内倒排索引，替代 LIKE '%词%' 的全表扫描。
+// 文本按 UTF-8 字符切分为单字和相邻两字（bigram），中文名称无需分词即可匹配；
+// 查询时对各 bigram 的倒排表求交集，再用子串比较确认，结果与 LIKE 的包含匹配一致
+// （英文字母不区分大小写，% 和 _ 按普通字符处理）。
+//
+// 索引由 WebServer 启动时在后台构建（Database::buildSearchIndex），之后 Database 的
+// 每次写入都会同步更新。构建完成前 ready() 为 false，调用方应回退到 LIKE 查询。
+class SearchIndex {
+public:
+    enum Domain {
+        ITEMS = 0,         // item_list：name
+        INVENTORY = 1,     // inventory：物品名称、位置
+        OPERATION_LOG = 2, // operation_log：操作类型、物品名称、备注
+        DOMAIN_COUNT = 3
+    };
+
+    struct Document {
+        int id = 0;
+        std::vector<std::string> fields; // 参与搜索的各列，不跨列匹配
+        std::string sortKey;             // 排序键：物品为名称，库存/日志为含微秒的时间
+    };
+
+    // 分页请求：cursor 非空时按键集分页，否则按 offset 分页
+    struct PageRequest {
+        size_t offset = 0;
+        size_t limit = 10;
+        const PageCursor* cursor = nullptr;
+        bool backward = false;
+    };
+
+    struct Stats {
+        bool ready = false;
+        size_t documents[DOMAIN_COUNT] = {0, 0, 0};
+        size_t tokens[DOMAIN_COUNT] = {0, 0, 0};
+        uint64_t queries = 0;
+    };
+
+    static SearchIndex& instance();
+
+    bool ready() const { return ready_.load(std::memory_order_acquire); }
+
+    // 索引已构建或正在构建：写入方需要把变更通知给索引
+    bool tracking() const {
+        return ready() || rebuilding_.load(std::memory_order_acquire);
+    }
+
+    // 重建流程：beginRebuild() 之后 addToRebuild() 逐条加入（只由构建线程调用），
+    // commitRebuild() 一次性替换现有索引。构建期间的写入会在替换后重放。
+    void beginRebuild();
+    void addToRebuild(Domain domain, Document doc);
+    void commitRebuild();
+    void abortRebuild();
+
+    // 写入后同步更新（索引尚未构建时忽略）
+    void upsert(Domain domain, Document doc);
+    void remove(Domain domain, int id);
+
+    // 按排序键返回匹配文档的一页 id：物品按名称升序，库存/日志按时间降序；
+    // 向后翻页时顺序相反（与数据库键集查询一致）。索引不可用时返回 false
+    bool findPage(Domain domain, const std::string& term, const PageRequest& request,
+                  std::vector<int>& ids) const;
+    bool count(Domain domain, const std::string& term, long long& total) const;
+
+    Stats getStats() const;
+
+    SearchIndex(const SearchIndex&) = delete;
+    SearchIndex& operator=(const SearchIndex&) = delete;
+
+private:
+    SearchIndex() = default;
+
+    struct StoredDocument {
+        std::vector<std::string> fields; // 已转为小写，用于子串确认
+        std::string sortKey;
+    };
+
+    struct Table {
+        std::unordered_map<int, StoredDocument> documents;
+        std::unordered_map<uint64_t, std::vector<int>> postings; // 有序的文档 id 列表
+    };
+
+    struct PendingOp {
+        Domain domain;
+        bool remove;
+        Document doc;
+    };
+
+    static void addDocument(Table& table, int id, StoredDocument doc);
+    static void removeDocument(Table& table, int id);
+    static StoredDocument normalize(Document& doc);
+    std::vector<int> match(const Table& table, const std::string& term) const;
+
+    mutable std::shared_mutex mutex_;
+    Table tables_[DOMAIN_COUNT];
+    std::atomic<bool> ready_{false};
+    mutable std::atomic<uint64_t> queries_{0};
+
+    // 重建期间使用，只有构建线程访问 staging_
+    std::mutex pendingMutex_;
+    std::atomic<bool> rebuilding_{false};
+    std::vector<PendingOp> pending_;
+    std::unique_ptr<Table[]> staging_;
+};
+
+#endif // SEARCH_INDEX_H
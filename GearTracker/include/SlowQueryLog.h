@@ -0,0 +1,135 @@
+// ====== SlowQueryLog.h ======
+#ifndef SLOW_QUERY_LOG_H
+#define SLOW_QUERY_LOG_H
+
+#include "Config.h"
+#include "Storage.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 慢查询日志。所有经 StatementCache 准备的语句都会计时（查询含读取结果），
+// 超过 slow_query_ms 的语句连同规范化的 SQL、参数类型和返回行数交给后台线程，
+// 后台线程在自己的连接上对它执行 EXPLAIN（SQLite 为 EXPLAIN QUERY PLAN），
+// 然后追加到慢查询日志文件，并保留在内存中供 GET /api/admin/slow-queries 查看。
+// 参数的值只用于 EXPLAIN，不写入日志和接口。
+//
+// 相关配置（[application] 节）：
+//   slow_query_ms       阈值（毫秒，可为小数；0 关闭，默认 200）
+//   slow_query_log      日志文件路径
+//   slow_query_explain  是否执行 EXPLAIN（默认 true）
+//   slow_query_keep     内存中保留的最近记录条数
+class SlowQueryLog {
+public:
+    // 绑定的参数：类型 + 值（整数在 number 中，字符串在 text 中）
+    struct Param {
+        enum Type { NONE, INT, INT64, STRING, NULL_VALUE };
+        Type type = NONE;
+        int64_t number = 0;
+        std::string text;
+    };
+
+    struct Entry {
+        uint64_t id = 0;
+        std::string time;
+        std::string query;  // 查询名，如 "SELECT inventory"
+        std::string sql;    // 规范化后的 SQL
+        std::vector<std::string> params; // 参数类型，如 int、string(12)、null；连续相同的记为 string(8)*90
+        long long rows = 0;  // 查询返回的行数，或更新影响的行数
+        double durationMs = 0;
+        std::vector<std::string> plan; // EXPLAIN 的每一行
+        std::string planError;
+    };
+
+    // 按规范化 SQL 汇总
+    struct Summary {
+        std::string sql;
+        std::string query;
+        uint64_t count = 0;
+        double totalMs = 0;
+        double maxMs = 0;
+        long long maxRows = 0;
+    };
+
+    struct Stats {
+        bool enabled = false;
+        double thresholdMs = 0;
+        uint64_t recorded = 0;
+        uint64_t dropped = 0; // 后台线程积压时丢弃的记录
+    };
+
+    static SlowQueryLog& instance();
+
+    // 读取配置（可重复调用）。首次开启时启动后台线程
+    void configure(Config& config);
+
+    // 写出剩余记录并停止后台线程（程序退出前调用）
+    void shutdown();
+
+    bool enabled() const { return thresholdMicros_.load(std::memory_order_relaxed) > 0; }
+    int64_t thresholdMicros() const { return thresholdMicros_.load(std::memory_order_relaxed); }
+
+    // 记录一条慢语句（由计时的语句在超过阈值时调用，不阻塞）
+    void record(const std::string& sql, const std::string& query, std::vector<Param> params, long long rows,
+                std::chrono::steady_clock::duration elapsed);
+
+    // 最近的记录，最新的在前
+    std::vector<Entry> recent(size_t limit) const;
+    // 按累计耗时从高到低的汇总
+    std::vector<Summary> summary(size_t limit) const;
+    Stats getStats() const;
+    void clear();
+
+    // 合并空白，字面量替换为 ?，IN 列表等连续的占位符合并为 "?, ..."
+    static std::string normalize(const std::string& sql);
+
+    SlowQueryLog(const SlowQueryLog&) = delete;
+    SlowQueryLog& operator=(const SlowQueryLog&) = delete;
+
+private:
+    SlowQueryLog() = default;
+    ~SlowQueryLog();
+
+    struct Pending {
+        Entry entry;
+        std::string rawSql;
+        std::vector<Param> params;
+    };
+
+    void writerLoop();
+    void explain(Pending& pending);
+    void writeEntry(const Entry& entry);
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Pending> queue_;
+    std::deque<Entry> recent_;
+    std::map<std::string, Summary> summary_;
+    size_t keep_ = 100;
+    uint64_t nextId_ = 1;
+    bool stopping_ = false;
+    std::thread writer_;
+
+    std::atomic<int64_t> thresholdMicros_{0};
+    std::atomic<bool> explain_{true};
+    std::unique_ptr<Config> config_;              // 后台线程用它建立 EXPLAIN 用的连接
+    std::unique_ptr<StorageConnection> explainCon_; // 只在后台线程上使用
+    std::chrono::steady_clock::time_point explainRetryAt_; // 连接失败后到这个时间之前不再重试
+    std::ofstream file_;                           // 只在后台线程上使用
+    std::string path_;
+    std::string openPath_;
+
+    std::atomic<uint64_t> recorded_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+#endif // SLOW_QUERY_LOG_H
@@ -0,0 +1,22 @@
+// ====== SqliteStorage.h ======
+#ifndef SQLITE_STORAGE_H
+#define SQLITE_STORAGE_H
+
+#include "Storage.h"
+#include <memory>
+
+// 嵌入式 SQLite 后端：数据保存在 [database] sqlite_path 指定的单个文件中，无需数据库服务器。
+// 打开时启用 WAL（读写互不阻塞），表和索引不存在时按与 MySQL 相同的结构创建，
+// 并注册 DATE_FORMAT / CRC32 / CONCAT_WS 几个函数，使两种后端共用同一套 SQL。
+// 时间列以 "YYYY-MM-DD HH:MM:SS.ffffff" 文本存储，按字典序比较即为时间顺序。
+// 需要 SQLite 3.32 及以上版本（行值比较和多行 INSERT 的参数个数上限）。
+//
+// 相关配置（[database] 节）：
+//   sqlite_path          数据库文件路径
+//   sqlite_busy_timeout  等待其他连接释放写锁的毫秒数
+class SqliteStorage {
+public:
+    static std::unique_ptr<StorageConnection> open(Config& config);
+};
+
+#endif // SQLITE_STORAGE_H
@@ -0,0 +1,65 @@
+// ====== StatementCache.h ======
+#ifndef STATEMENT_CACHE_H
+#define STATEMENT_CACHE_H
+
+#include "Storage.h"
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// 按 SQL 文本缓存的预处理语句，每个数据库连接一份。
+// 热点查询在一个连接上只需解析一次（MySQL 由服务器解析，SQLite 编译为字节码）；容量有限，按最近最少使用淘汰。
+// 连接重建时必须调用 clear()，旧连接上的语句句柄不能继续使用。
+class StatementCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t size = 0;
+        size_t capacity = 0;
+    };
+
+    explicit StatementCache(size_t capacity = 32);
+    ~StatementCache();
+
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    // 返回该连接上 sql 对应的预处理语句（参数已清空），所有权仍归缓存
+    StorageStatement* get(StorageConnection* con, const std::string& sql);
+
+    // 准备一条不进入缓存的语句（由调用方释放），与缓存的语句一样计时并参与慢查询日志
+    static StorageStatement* prepare(StorageConnection* con, const std::string& sql);
+
+    // 释放所有语句句柄（重连或断开前调用）
+    void clear();
+
+    void setCapacity(size_t capacity);
+    Stats getStats() const;
+
+    // 进程内所有连接的累计命中情况，用于调优 stmt_cache_size
+    static Stats globalStats();
+
+private:
+    using Entry = std::pair<std::string, std::unique_ptr<StorageStatement>>;
+    using LruList = std::list<Entry>;
+
+    void evictOverflow();
+
+    LruList lru_; // 头部为最近使用
+    std::unordered_map<std::string, LruList::iterator> index_;
+    size_t capacity_;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t evictions_ = 0;
+
+    static std::atomic<uint64_t> totalHits_;
+    static std::atomic<uint64_t> totalMisses_;
+    static std::atomic<uint64_t> totalEvictions_;
+};
+
+#endif // STATEMENT_CACHE_H
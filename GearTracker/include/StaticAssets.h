@@ -0,0 +1,39 @@
+// ====== StaticAssets.h ======
+#ifndef STATIC_ASSETS_H
+#define STATIC_ASSETS_H
+
+#include <string>
+#include <unordered_map>
+
+// Web 界面的静态文件，启动时把整个目录读入内存，每次请求不再访问文件系统。
+// - 构建时 cmake/PrecompressWeb.cmake 给 js/css 生成带内容哈希的文件名（如 main.3f2a9c1b0d.js）、
+//   改写 index.html 中的引用，并为每个文件生成 .gz 预压缩版本。目录中存在 xxx.gz 时直接使用，
+//   否则在加载时压缩一次（需要 zlib）
+// - 文件名带内容哈希的文件内容不会变化，可以长期缓存（immutable）；其他文件每次用 ETag 验证
+// - 修改目录中的文件后需要重启才生效
+class StaticAssets {
+public:
+    struct Asset {
+        std::string contentType;
+        std::string body;
+        std::string gzip;      // 预压缩的内容，为空表示没有
+        std::string etag;      // 按内容计算的强 ETag（含双引号）
+        bool immutable = false; // 文件名带内容哈希
+    };
+
+    // 读取 root 下的全部文件，目录不存在时返回 false
+    bool load(const std::string& root, int gzipLevel);
+
+    // 按请求路径查找（"/" 和以 "/" 结尾的路径对应其中的 index.html），不存在返回 nullptr
+    const Asset* find(const std::string& path) const;
+
+    size_t size() const { return assets_.size(); }
+
+private:
+    static std::string contentTypeOf(const std::string& path);
+    static bool hasContentHash(const std::string& path);
+
+    std::unordered_map<std::string, Asset> assets_; // 键为 "/js/main.js" 形式的路径
+};
+
+#endif // STATIC_ASSETS_H
@@ -0,0 +1,109 @@
+// ====== Storage.h ======
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include "Config.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+// 存储后端接口。Database 只通过这里的几个类访问数据库，具体实现由 [database] backend 选择：
+//   mysql   MySqlStorage，经 MySQL Connector/C++ 连接服务器（默认）
+//   sqlite  SqliteStorage，嵌入式单文件数据库，适合单机部署和本地测试
+// 接口沿用 JDBC 的风格，参数和列的序号都从 1 开始。两种后端使用同一套 SQL，
+// 少数方言差异（行锁、插入 id、行数估算、执行计划）由连接对象提供。
+
+// 后端的错误统一转换为 StorageError，保留原始错误码和 SQLSTATE
+class StorageError : public std::runtime_error {
+public:
+    explicit StorageError(const std::string& message, int code = 0, const std::string& sqlState = "");
+
+    int getErrorCode() const { return code_; }
+    const std::string& getSQLState() const { return sqlState_; }
+
+private:
+    int code_;
+    std::string sqlState_;
+};
+
+// 只进结果集
+class StorageResult {
+public:
+    enum ColumnType {
+        INTEGER,
+        REAL,
+        TEXT // 字符串、时间、DECIMAL 等
+    };
+
+    virtual ~StorageResult() = default;
+
+    virtual bool next() = 0;
+    virtual bool isNull(int col) = 0;
+    virtual int getInt(int col) = 0;
+    virtual int64_t getInt64(int col) = 0;
+    virtual double getDouble(int col) = 0;
+    virtual std::string getString(int col) = 0;
+
+    virtual int columnCount() = 0;
+    virtual std::string columnLabel(int col) = 0; // AS 别名，没有别名时为列名
+    virtual ColumnType columnType(int col) = 0;
+};
+
+// 预处理语句
+class StorageStatement {
+public:
+    virtual ~StorageStatement() = default;
+
+    virtual void setInt(int index, int value) = 0;
+    virtual void setInt64(int index, int64_t value) = 0;
+    virtual void setString(int index, const std::string& value) = 0;
+    virtual void setNull(int index) = 0;
+    virtual void clearParameters() = 0;
+
+    // 返回的结果集由调用方释放
+    virtual StorageResult* executeQuery() = 0;
+    // 返回受影响的行数
+    virtual int executeUpdate() = 0;
+};
+
+class StorageConnection {
+public:
+    virtual ~StorageConnection() = default;
+
+    virtual const char* backendName() const = 0;
+
+    // 返回的语句由调用方释放（通常交给 StatementCache 持有）
+    virtual StorageStatement* prepareStatement(const std::string& sql) = 0;
+    // 直接执行不返回结果的语句
+    virtual void execute(const std::string& sql) = 0;
+
+    virtual void begin() = 0;
+    virtual void commit() = 0;
+    virtual void rollback() = 0;
+
+    virtual bool isClosed() = 0;
+    virtual bool isValid() = 0; // 必要时与服务器往返一次确认连接可用
+    virtual void close() = 0;
+
+    // 最近一条 INSERT 插入的第一行 id；rows 为该语句插入的行数
+    virtual long long firstInsertId(size_t rows) = 0;
+    // 多行 INSERT 中相邻两行 id 的差：第 k 行的 id 为 firstInsertId() + k * insertIdStep()。
+    // MySQL 为 auto_increment_increment（多主、Galera 集群中常大于 1），SQLite 为 1
+    virtual long long insertIdStep() = 0;
+
+    // 锁定读取的 SELECT 后缀：MySQL 为 " FOR UPDATE"；SQLite 在 begin() 时已取得写锁，为空
+    virtual const char* lockClause() const = 0;
+
+    // 能否根据执行计划（EXPLAIN）估算匹配行数
+    virtual bool supportsRowEstimate() const = 0;
+
+    // 查看执行计划的语句前缀：MySQL 为 "EXPLAIN "，SQLite 为 "EXPLAIN QUERY PLAN "
+    virtual const char* explainPrefix() const = 0;
+};
+
+// 按 [database] backend 创建连接，失败时抛出 StorageError
+std::unique_ptr<StorageConnection> openStorage(Config& config);
+
+#endif // STORAGE_H
@@ -0,0 +1,90 @@
+// ====== Trace.h ======
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "Config.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+// 按请求的追踪。每个 HTTP 请求在工作线程上开始时分配一个 trace id（响应头 X-Trace-Id），
+// 按 trace_sample_rate 抽样（或请求头 X-Trace: 1 强制）；抽中的请求在处理期间记录 TRACE_SPAN 的起止时间，
+// 请求结束时连同整个请求的根 span 一起以 Chrome trace_event 格式追加到追踪文件，
+// 可直接在 chrome://tracing 或 ui.perfetto.dev 中打开，按时间线查看各阶段的嵌套和耗时。
+//
+// span 记录在线程局部的缓冲区中，未抽中的请求和后台线程上的 TRACE_SPAN 只检查一个线程局部标志。
+// 编译时未定义 GEARTRACKER_TRACING（CMake 选项）时 TRACE_SPAN 展开为空语句。
+//
+// 相关配置（[application] 节）：
+//   trace_sample_rate   抽样比例 0 ~ 1（默认 0.01）
+//   trace_file          追踪文件路径
+//   trace_file_max_mb   单个文件的上限，超过后轮转为 .1、.2 ...
+//   trace_files         保留的历史文件个数
+class Trace {
+public:
+    // 作用域内的一段耗时。name 须在请求结束前一直有效（通常是字符串字面量）
+    class Span {
+    public:
+        explicit Span(const char* name);
+        ~Span() { end(); }
+        Span(Span&& other) noexcept : name_(other.name_), start_(other.start_) { other.start_ = -1; }
+
+        // 提前结束（之后析构不再记录）
+        void end();
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+        Span& operator=(Span&&) = delete;
+
+    private:
+        const char* name_;
+        int64_t start_; // 微秒；-1 表示当前线程没有在记录
+    };
+
+    static Trace& instance();
+
+    // 读取配置（可重复调用）
+    void configure(Config& config);
+
+    // 请求开始：返回新的 trace id，并决定本请求是否记录 span（force 为 true 时总是记录）
+    std::string beginRequest(bool force);
+
+    // 请求结束：记录的请求以 name 为根 span（从 start 到现在）写入追踪文件
+    void endRequest(std::string_view name, std::chrono::steady_clock::time_point start, int status);
+
+    // 当前线程上的请求是否在记录
+    static bool recording();
+
+    Trace(const Trace&) = delete;
+    Trace& operator=(const Trace&) = delete;
+
+private:
+    Trace() = default;
+
+    void write(const std::string& events);
+    void openFile();
+    void rotate();
+
+    std::atomic<uint64_t> sampleThreshold_{0}; // 随机数（53 位）小于该值时抽中
+    std::mutex fileMutex_;
+    std::ofstream file_;
+    std::string path_;
+    size_t fileBytes_ = 0;
+    size_t maxBytes_ = 16u << 20;
+    int maxFiles_ = 3;
+};
+
+#ifdef GEARTRACKER_TRACING
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SPAN(name) Trace::Span TRACE_CONCAT(traceSpan_, __LINE__)(name)
+#else
+#define TRACE_SPAN(name) ((void)0)
+#endif
+
+#endif // TRACE_H
@@ -0,0 +1,29 @@
+// ====== Transaction.h ======
+#ifndef TRANSACTION_H
+#define TRANSACTION_H
+
+#include "Storage.h"
+
+// 数据库事务的 RAII 封装：构造时开始事务（MySQL 为 START TRANSACTION，
+// SQLite 为 BEGIN IMMEDIATE），commit() 提交；未提交就析构（包括异常退出）时自动回滚。
+// 连接保持自动提交模式，事务结束后无需再切换，开始和结束各只需一次往返。
+class Transaction {
+public:
+    // 开始事务失败时抛出 StorageError
+    explicit Transaction(StorageConnection* con);
+    ~Transaction();
+
+    // 提交失败时抛出 StorageError，析构时会回滚
+    void commit();
+    void rollback();
+    bool active() const { return active_; }
+
+    Transaction(const Transaction&) = delete;
+    Transaction& operator=(const Transaction&) = delete;
+
+private:
+    StorageConnection* con_;
+    bool active_;
+};
+
+#endif // TRANSACTION_H
@@ -2,12 +2,20 @@
 #define WEBSERVER_H
 
 #include <string>
+#include <atomic>
 #include <memory>
 #include <mutex>
+#include <condition_variable>
 #include <thread>
 #include "httplib.h"
 #include "Config.h"  // 改为包含 Config.h 而不是 Database.h
 #include "Database.h"
+#include "ConnectionPool.h"
+#include "StaticAssets.h"
+#include "RequestQueue.h"
+#include "Metrics.h"
+#include <utility>
+#include <vector>
 
 // 将 OperationLogEntry 定义在类内部
 class WebServer {
@@ -23,10 +31,54 @@ public:
 private:
     Config& config_;  // 修改为保存 Config 引用
     void setupRoutes();
+    void setupStaticRoutes();
+    void compressResponse(const httplib::Request& req, httplib::Response& res) const;
+    void checkConnectionHealth(bool& lastConnected, bool& known);
+    void loadWebOptions();
+    int routeTimeoutMs(const std::string& path) const;
+    void rejectBusy(httplib::Response& res, bool closeConnection) const;
+    void recordRequestMetrics(const httplib::Request& req, const httplib::Response& res);
+    // /api/export/* 的公共部分：分段读取 fetch 的结果，按 CSV 或 NDJSON 以分块传输写出
+    template <typename Row>
+    void streamExport(const httplib::Request& req, httplib::Response& res, const std::string& name,
+                      const std::vector<std::string>& csvHeader, const Database::ExportFilter& filter,
+                      std::vector<Row> (Database::*fetch)(const Database::ExportFilter&, PageCursor&, int, bool&));
     
     int port_;
-    std::unique_ptr<httplib::Server> server;
+    std::unique_ptr<HttpServer> server;
+    std::unique_ptr<ConnectionPool> dbPool_; // 所有请求处理函数共享的数据库连接池
     std::thread serverThread;
+    std::thread indexThread_; // 启动时在后台构建搜索索引
+    std::thread catalogThread_; // 定期检查 item_list 版本，刷新物品目录
+    std::thread healthThread_;  // 有实时事件订阅者时定期检查数据库连接，状态变化时发布事件
+    std::mutex backgroundMutex_; // 以下两项由后台线程共用，stop() 时唤醒它们退出
+    std::condition_variable backgroundCv_;
+    bool backgroundStop_ = false;
+    int eventsMaxClients_ = 4;
+    int exportMaxClients_ = 2;       // 同时进行的导出数
+    int exportChunkRows_ = 1000;     // 导出时每段查询的行数
+    std::atomic<int> activeExports_{0};
+    int importChunkRows_ = 1000;     // 导入时每批写入的行数
+    size_t importMaxBytes_ = 64u << 20; // 请求体上限（import_max_mb）
+    std::atomic<int> activeImports_{0};
+    Metrics::Gauge* httpInFlight_ = nullptr;   // 注册表中的指标，进程内一直有效
+    Metrics::Counter* httpBytesOut_ = nullptr;
+    
+    // [web] 节：工作线程、请求队列、超时和 keep-alive
+    RequestQueue::Options queueOptions_;
+    std::shared_ptr<RequestQueue::Counters> queueCounters_ = std::make_shared<RequestQueue::Counters>();
+    int readTimeout_ = 20;
+    int writeTimeout_ = 20;
+    int keepAliveMaxRequests_ = 100;
+    int keepAliveTimeout_ = 5;
+    int retryAfter_ = 5;
+    int queueTimeoutMs_ = 5000;                            // 在队列中等待超过该时间的请求回复 503
+    std::vector<std::pair<std::string, int>> routeTimeouts_; // 按路径前缀覆盖 queueTimeoutMs_，长前缀在前
+    StaticAssets staticAssets_;  // Web 界面文件（内存中）
+    std::string webRoot_;
+    bool compression_ = true;     // 压缩 API 响应
+    size_t compressionMinBytes_ = 1024;
+    int compressionLevel_ = 6;
     bool running = false;
     std::mutex serverMutex;
 };
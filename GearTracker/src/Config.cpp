@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <cctype>
 #include <stdexcept>
+#include <set>
 
 // 辅助函数：去除字符串两端空白
 static std::string trim(const std::string& str) {
@@ -26,6 +27,17 @@ static std::string toLower(const std::string& str) {
     return result;
 }
 
+// 辅助函数：写出节内除已知键以外的其余配置项（如连接池参数），避免保存时丢失
+static void writeRemainingKeys(std::ofstream& file,
+                               const std::map<std::string, std::string>& section,
+                               const std::set<std::string>& written) {
+    for (const auto& kv : section) {
+        if (written.count(kv.first) == 0) {
+            file << kv.first << " = " << kv.second << "\n";
+        }
+    }
+}
+
 Config::Config() : configFilePath(getConfigFilePath()) {
     reload();
 }
@@ -77,11 +89,11 @@ void Config::reload() {
         }
         
         // 处理键值对
-        parseLine(line);
+        parseLine(line, currentSection);
     }
 }
 
-void Config::parseLine(const std::string& line) {
+void Config::parseLine(const std::string& line, const std::string& currentSection) {
     size_t pos = line.find('=');
     if (pos == std::string::npos) {
         return; // 无效行
@@ -90,12 +102,15 @@ void Config::parseLine(const std::string& line) {
     std::string key = toLower(trim(line.substr(0, pos)));
     std::string value = trim(line.substr(pos + 1));
     
-    // 确定节（这里简化处理，实际应跟踪当前节）
-    std::string section = "database"; // 默认数据库节
-    
-    // 如果检测到应用配置项
-    if (key == "log_level" || key == "page_size" || key == "log_file") {
-        section = "application";
+    // 使用当前所在的节；没有节头的旧式配置文件按键名推断
+    std::string section = currentSection;
+    if (section == "default") {
+        section = "database"; // 默认数据库节
+        
+        // 如果检测到应用配置项
+        if (key == "log_level" || key == "page_size" || key == "log_file") {
+            section = "application";
+        }
     }
     
     configData[section][key] = value;
@@ -113,13 +128,24 @@ void Config::save() {
     file << "port = " << getInt("database", "port", 3306) << "\n";
     file << "username = " << getString("database", "username", "") << "\n";
     file << "password = " << getString("database", "password", "") << "\n";
-    file << "database = " << getString("database", "database", "geartracker") << "\n\n";
+    file << "database = " << getString("database", "database", "geartracker") << "\n";
+    writeRemainingKeys(file, configData["database"],
+                       {"host", "port", "username", "password", "database"});
+    file << "\n";
     
     // 写入应用配置
     file << "[application]\n";
     file << "log_level = " << getString("application", "log_level", "info") << "\n";
     file << "page_size = " << getInt("application", "page_size", 10) << "\n";
     file << "log_file = " << getString("application", "log_file", "geartracker.log") << "\n";
+    writeRemainingKeys(file, configData["application"], {"log_level", "page_size", "log_file"});
+    
+    // 写入其他节
+    for (const auto& section : configData) {
+        if (section.first == "database" || section.first == "application") continue;
+        file << "\n[" << section.first << "]\n";
+        writeRemainingKeys(file, section.second, {});
+    }
     
     file.close();
 }
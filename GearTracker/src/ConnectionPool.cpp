@@ -0,0 +1,218 @@
+// ====== ConnectionPool.cpp ======
+#include "ConnectionPool.h"
+#include "Logger.h"
+#include "Trace.h"
+#include <algorithm>
+#include <vector>
+
+// ====== Lease ======
+ConnectionPool::Lease::Lease(ConnectionPool* pool, std::unique_ptr<Database> db)
+    : pool_(pool), db_(std::move(db)) {}
+
+ConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_), db_(std::move(other.db_)), broken_(other.broken_) {
+    other.pool_ = nullptr;
+}
+
+ConnectionPool::Lease& ConnectionPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool_ = other.pool_;
+        db_ = std::move(other.db_);
+        broken_ = other.broken_;
+        other.pool_ = nullptr;
+    }
+    return *this;
+}
+
+ConnectionPool::Lease::~Lease() {
+    release();
+}
+
+void ConnectionPool::Lease::release() {
+    if (pool_ && db_) {
+        pool_->giveBack(std::move(db_), broken_);
+    }
+    pool_ = nullptr;
+}
+
+// ====== ConnectionPool ======
+ConnectionPool::ConnectionPool(Config& config)
+    : config_(config) {
+    int minSize = config_.getInt("database", "pool_min_size", 2);
+    int maxSize = config_.getInt("database", "pool_max_size", 8);
+    if (maxSize < 1) maxSize = 1;
+    if (minSize < 0) minSize = 0;
+    if (minSize > maxSize) minSize = maxSize;
+    minSize_ = static_cast<size_t>(minSize);
+    maxSize_ = static_cast<size_t>(maxSize);
+
+    idleTimeout_ = std::chrono::seconds(std::max(1, config_.getInt("database", "pool_idle_timeout", 300)));
+    validateAfter_ = std::chrono::seconds(std::max(0, config_.getInt("database", "pool_validate_after", 30)));
+    acquireTimeout_ = std::chrono::seconds(std::max(0, config_.getInt("database", "pool_acquire_timeout", 5)));
+
+    reaper_ = std::thread(&ConnectionPool::reaperLoop, this);
+    GT_LOG_INFO("数据库连接池已创建 (min=" + std::to_string(minSize_) + ", max=" + std::to_string(maxSize_) + ")");
+}
+
+ConnectionPool::~ConnectionPool() {
+    shutdown();
+}
+
+std::unique_ptr<Database> ConnectionPool::createConnection() {
+    try {
+        // Database 构造时即建立连接并完成字符集设置，之后在池中复用
+        auto db = std::make_unique<Database>(config_);
+        if (!db->isConnected()) {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        counters_.created++;
+        return db;
+    } catch (const std::exception& e) {
+        GT_LOG_ERROR(std::string("连接池创建连接失败: ") + e.what());
+        return nullptr;
+    }
+}
+
+ConnectionPool::Lease ConnectionPool::acquire() {
+    TRACE_SPAN("ConnectionPool::acquire");
+    auto deadline = std::chrono::steady_clock::now() + acquireTimeout_;
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (!shuttingDown_) {
+        // 1. 优先复用最近归还的空闲连接
+        if (!idle_.empty()) {
+            IdleEntry entry = std::move(idle_.back());
+            idle_.pop_back();
+            bool needsCheck = std::chrono::steady_clock::now() - entry.since >= validateAfter_;
+            if (needsCheck) {
+                counters_.validated++;
+            }
+            lock.unlock();
+
+            // 刚归还的连接直接借出，只有空闲较久的连接才额外做一次往返检查
+            if (!needsCheck || entry.db->testConnection()) {
+                lock.lock();
+                counters_.reused++;
+                lock.unlock();
+                return Lease(this, std::move(entry.db));
+            }
+
+            entry.db.reset();
+            lock.lock();
+            --total_;
+            counters_.discarded++;
+            continue;
+        }
+
+        // 2. 未达上限时新建连接（在锁外完成握手）
+        if (total_ < maxSize_) {
+            ++total_;
+            lock.unlock();
+            auto db = createConnection();
+            if (db) {
+                return Lease(this, std::move(db));
+            }
+            lock.lock();
+            --total_;
+            available_.notify_one();
+            return Lease();
+        }
+
+        // 3. 连接池耗尽，等待其他请求归还
+        if (available_.wait_until(lock, deadline) == std::cv_status::timeout &&
+            idle_.empty() && total_ >= maxSize_) {
+            counters_.timeouts++;
+            lock.unlock();
+            GT_LOG_WARNING("等待数据库连接超时 (pool_max_size=" + std::to_string(maxSize_) + ")");
+            return Lease();
+        }
+    }
+    return Lease();
+}
+
+void ConnectionPool::giveBack(std::unique_ptr<Database> db, bool broken) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (shuttingDown_ || broken || !db->isConnected()) {
+        --total_;
+        counters_.discarded++;
+        lock.unlock();
+        available_.notify_one();
+        db.reset(); // 在锁外关闭连接
+        return;
+    }
+    idle_.push_back({std::move(db), std::chrono::steady_clock::now()});
+    lock.unlock();
+    available_.notify_one();
+}
+
+void ConnectionPool::warmUp() {
+    for (size_t i = 0; i < minSize_; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (shuttingDown_ || total_ >= minSize_) return;
+            ++total_;
+        }
+        auto db = createConnection();
+        if (!db) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --total_;
+            return;
+        }
+        giveBack(std::move(db), false);
+    }
+}
+
+void ConnectionPool::reaperLoop() {
+    auto interval = std::max<std::chrono::seconds>(std::chrono::seconds(1), idleTimeout_ / 2);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!shuttingDown_) {
+        reaperWake_.wait_for(lock, interval);
+        if (shuttingDown_) break;
+
+        // 队列头部是空闲最久的连接，超时且总数高于最小值时关闭
+        auto now = std::chrono::steady_clock::now();
+        std::vector<std::unique_ptr<Database>> expired;
+        while (!idle_.empty() && total_ > minSize_ && now - idle_.front().since >= idleTimeout_) {
+            expired.push_back(std::move(idle_.front().db));
+            idle_.pop_front();
+            --total_;
+            counters_.discarded++;
+        }
+
+        if (!expired.empty()) {
+            lock.unlock();
+            expired.clear();
+            lock.lock();
+        }
+    }
+}
+
+void ConnectionPool::shutdown() {
+    std::deque<IdleEntry> closing;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (shuttingDown_) return;
+        shuttingDown_ = true;
+        total_ -= idle_.size();
+        closing.swap(idle_);
+    }
+    reaperWake_.notify_all();
+    available_.notify_all();
+    if (reaper_.joinable()) {
+        reaper_.join();
+    }
+    closing.clear();
+}
+
+ConnectionPool::Stats ConnectionPool::getStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = counters_;
+    stats.total = total_;
+    stats.idle = idle_.size();
+    stats.inUse = total_ - idle_.size();
+    stats.minSize = minSize_;
+    stats.maxSize = maxSize_;
+    return stats;
+}
@@ -0,0 +1,95 @@
+// ====== CountService.cpp ======
+#include "CountService.h"
+#include <algorithm>
+
+CountService& CountService::instance() {
+    static CountService service;
+    return service;
+}
+
+CountService::CountService() {}
+
+void CountService::configure(Config& config) {
+    ttlSeconds_ = std::max(0, config.getInt("application", "count_cache_ttl", 60));
+    estimateThreshold_ = std::max(0, config.getInt("application", "count_estimate_threshold", 10000));
+}
+
+uint64_t CountService::generation(Table table) const {
+    return totals_[table].generation.load(std::memory_order_acquire);
+}
+
+bool CountService::getTotal(Table table, long long& count) const {
+    const TotalEntry& entry = totals_[table];
+    if (!entry.loaded.load(std::memory_order_acquire)) {
+        return false;
+    }
+    int64_t age = Clock::now().time_since_epoch().count() - entry.loadedAt.load(std::memory_order_relaxed);
+    if (age >= std::chrono::duration_cast<Clock::duration>(
+                   std::chrono::seconds(ttlSeconds_.load(std::memory_order_relaxed))).count()) {
+        return false; // 过期：重新统计以校正其他进程造成的偏差
+    }
+    count = entry.count.load(std::memory_order_relaxed);
+    return true;
+}
+
+void CountService::setTotal(Table table, long long count, uint64_t generation) {
+    TotalEntry& entry = totals_[table];
+    if (entry.generation.load(std::memory_order_acquire) != generation) {
+        // 统计期间有写入，无法判断结果是否已包含这些增量。
+        // 已有增量维护的值时沿用它并推迟下次校正，避免写入频繁时每次请求都重新统计
+        if (entry.loaded.load(std::memory_order_acquire)) {
+            entry.loadedAt.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        }
+        return;
+    }
+    entry.count.store(count, std::memory_order_relaxed);
+    entry.loadedAt.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    entry.loaded.store(true, std::memory_order_release);
+}
+
+void CountService::adjust(Table table, long long delta) {
+    TotalEntry& entry = totals_[table];
+    entry.count.fetch_add(delta, std::memory_order_relaxed);
+    entry.generation.fetch_add(1, std::memory_order_release);
+}
+
+void CountService::invalidate(Table table) {
+    TotalEntry& entry = totals_[table];
+    entry.loaded.store(false, std::memory_order_release);
+    entry.generation.fetch_add(1, std::memory_order_release);
+}
+
+bool CountService::getFiltered(Table table, const std::string& search, CountResult& result) {
+    uint64_t generation = totals_[table].generation.load(std::memory_order_acquire);
+    std::lock_guard<std::mutex> lock(filteredMutex_);
+    auto& cache = filtered_[table];
+    auto it = cache.find(search);
+    if (it == cache.end()) {
+        return false;
+    }
+    if (it->second.generation != generation || Clock::now() >= it->second.expiresAt) {
+        cache.erase(it);
+        return false;
+    }
+    result = it->second.result;
+    return true;
+}
+
+void CountService::putFiltered(Table table, const std::string& search, const CountResult& result,
+                               uint64_t generation) {
+    if (totals_[table].generation.load(std::memory_order_acquire) != generation) {
+        return;
+    }
+    FilteredEntry entry;
+    entry.result = result;
+    entry.generation = generation;
+    entry.expiresAt = Clock::now() + std::chrono::seconds(ttlSeconds_.load(std::memory_order_relaxed));
+
+    std::lock_guard<std::mutex> lock(filteredMutex_);
+    auto& cache = filtered_[table];
+    if (cache.size() >= kMaxFilteredEntries && cache.find(search) == cache.end()) {
+        // 搜索词种类很多时直接清空，避免缓存无限增长
+        cache.clear();
+    }
+    cache[search] = entry;
+}
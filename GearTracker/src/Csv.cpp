@@ -0,0 +1,134 @@
+// ====== Csv.cpp ======
+#include "Csv.h"
+#include <charconv>
+
+CsvWriter::CsvWriter(Sink sink, size_t flushBytes)
+    : sink_(std::move(sink)), flushBytes_(flushBytes) {
+    buf_.reserve(flushBytes + flushBytes / 4);
+}
+
+void CsvWriter::appendField(std::string& out, std::string_view text) {
+    if (text.find_first_of(",\"\r\n") == std::string_view::npos) {
+        out.append(text.data(), text.size());
+        return;
+    }
+    out += '"';
+    size_t start = 0;
+    size_t quote;
+    while ((quote = text.find('"', start)) != std::string_view::npos) {
+        out.append(text.data() + start, quote - start + 1);
+        out += '"';
+        start = quote + 1;
+    }
+    out.append(text.data() + start, text.size() - start);
+    out += '"';
+}
+
+void CsvWriter::separate() {
+    if (rowStarted_) {
+        buf_ += ',';
+    }
+    rowStarted_ = true;
+}
+
+CsvWriter& CsvWriter::field(std::string_view text) {
+    separate();
+    appendField(buf_, text);
+    return *this;
+}
+
+CsvWriter& CsvWriter::field(long long number) {
+    separate();
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), number);
+    buf_.append(digits, result.ptr - digits);
+    return *this;
+}
+
+CsvWriter& CsvWriter::endRow() {
+    buf_ += "\r\n";
+    rowStarted_ = false;
+    if (buf_.size() >= flushBytes_) {
+        flush();
+    }
+    return *this;
+}
+
+CsvWriter& CsvWriter::raw(std::string_view bytes) {
+    buf_.append(bytes.data(), bytes.size());
+    return *this;
+}
+
+bool CsvWriter::flush() {
+    if (buf_.empty()) {
+        return ok_;
+    }
+    if (ok_) {
+        ok_ = sink_(buf_.data(), buf_.size());
+    }
+    buf_.clear();
+    return ok_;
+}
+
+bool CsvReader::next(std::vector<std::string>& fields, size_t& line, std::string& raw, bool& error) {
+    fields.clear();
+    raw.clear();
+    error = false;
+    std::string text;
+    if (!std::getline(in_, text)) {
+        return false;
+    }
+    bytes_ += text.size() + 1;
+    line = ++line_;
+    if (first_) {
+        first_ = false;
+        if (text.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+            text.erase(0, 3);
+        }
+    }
+
+    std::string field;
+    bool quoted = false;
+    size_t i = 0;
+    while (true) {
+        if (!text.empty() && text.back() == '\r') {
+            text.pop_back();
+        }
+        raw += text;
+        for (; i < text.size(); ++i) {
+            char c = text[i];
+            if (quoted) {
+                if (c != '"') {
+                    field += c;
+                } else if (i + 1 < text.size() && text[i + 1] == '"') {
+                    field += '"';
+                    ++i;
+                } else {
+                    quoted = false;
+                }
+            } else if (c == '"') {
+                quoted = true;
+            } else if (c == ',') {
+                fields.push_back(std::move(field));
+                field.clear();
+            } else {
+                field += c;
+            }
+        }
+        if (!quoted) {
+            break;
+        }
+        // 引号内的换行属于字段内容，接着读下一行
+        if (!std::getline(in_, text)) {
+            error = true;
+            break;
+        }
+        bytes_ += text.size() + 1;
+        ++line_;
+        field += '\n';
+        raw += '\n';
+        i = 0;
+    }
+    fields.push_back(std::move(field));
+    return true;
+}
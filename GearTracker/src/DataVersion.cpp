@@ -0,0 +1,65 @@
+// ====== DataVersion.cpp ======
+#include "DataVersion.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+std::string toBase36(uint64_t value) {
+    static const char digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+    std::string text;
+    do {
+        text += digits[value % 36];
+        value /= 36;
+    } while (value > 0);
+    std::reverse(text.begin(), text.end());
+    return text;
+}
+
+} // namespace
+
+DataVersion& DataVersion::instance() {
+    static DataVersion version;
+    return version;
+}
+
+DataVersion::DataVersion() {
+    for (auto& version : versions_) {
+        version.store(0, std::memory_order_relaxed);
+    }
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    epoch_ = toBase36(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(now).count()));
+}
+
+void DataVersion::configure(Config& config) {
+    refreshSeconds_ = std::max(0, config.getInt("application", "etag_refresh_interval", 60));
+}
+
+uint64_t DataVersion::current(Table table) const {
+    return versions_[table].load(std::memory_order_acquire);
+}
+
+void DataVersion::bump(Table table) {
+    versions_[table].fetch_add(1, std::memory_order_acq_rel);
+}
+
+void DataVersion::bumpAll() {
+    for (auto& version : versions_) {
+        version.fetch_add(1, std::memory_order_acq_rel);
+    }
+}
+
+std::string DataVersion::etag(std::initializer_list<Table> tables) const {
+    std::string tag = "\"" + epoch_;
+    int refresh = refreshSeconds_.load(std::memory_order_relaxed);
+    if (refresh > 0) {
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        tag += "-" + toBase36(static_cast<uint64_t>(seconds / refresh));
+    }
+    for (Table table : tables) {
+        tag += "-" + toBase36(current(table));
+    }
+    return tag + "\"";
+}
@@ -1,18 +1,13 @@
 #include "Database.h"
 #include "Config.h" 
-
-// 首先包含 MySQL 头文件
-#include <cppconn/driver.h>
-#include <cppconn/exception.h>
-#include <cppconn/connection.h>
-#include <cppconn/resultset.h>
-#include <cppconn/statement.h>
-#include <cppconn/prepared_statement.h> // 添加这个
+#include "Metrics.h"
+#include "Trace.h"
 
 // 然后是标准库头文件
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <iterator>
 #include <cctype>
 #include <chrono>
 #include <ctime>
@@ -20,6 +15,8 @@
 #include <sstream>
 #include <mutex>
 #include <thread> // 添加头文件用于睡眠
+#include <unordered_map>
+#include <unordered_set>
 
 
 
@@ -34,32 +31,421 @@ std::string currentDateTime() {
     return buf;
 }
 
+// 辅助函数：按列名取得各列序号后逐行转换为库存结构体（列序号只查找一次）
+static std::vector<Database::InventoryItem> toInventoryItems(const ResultTable& table) {
+    int cId = table.columnIndex("inventory_id");
+    int cItemId = table.columnIndex("item_id");
+    int cName = table.columnIndex("item_name");
+    int cQuantity = table.columnIndex("quantity");
+    int cLocation = table.columnIndex("location");
+    int cStored = table.columnIndex("stored_time");
+    int cUpdated = table.columnIndex("last_updated");
+    int cSort = table.columnIndex("sort_time");
+
+    std::vector<Database::InventoryItem> items(table.rowCount());
+    for (size_t r = 0; r < table.rowCount(); ++r) {
+        Database::InventoryItem& item = items[r];
+        if (cId >= 0) item.id = static_cast<int>(table.getInt(r, cId));
+        if (cItemId >= 0) item.item_id = static_cast<int>(table.getInt(r, cItemId));
+        if (cName >= 0) item.item_name = table.getString(r, cName);
+        if (cQuantity >= 0) item.quantity = static_cast<int>(table.getInt(r, cQuantity));
+        if (cLocation >= 0) item.location = table.getString(r, cLocation);
+        if (cStored >= 0) item.stored_time = table.getString(r, cStored);
+        if (cUpdated >= 0) item.last_updated = table.getString(r, cUpdated);
+        if (cSort >= 0) item.sort_time = table.getString(r, cSort);
+    }
+    return items;
+}
+
+// 辅助函数：转换为操作日志结构体
+static std::vector<Database::OperationLogEntry> toOperationLogEntries(const ResultTable& table) {
+    int cId = table.columnIndex("id");
+    int cType = table.columnIndex("operation_type");
+    int cName = table.columnIndex("item_name");
+    int cTime = table.columnIndex("formatted_time");
+    int cNote = table.columnIndex("operation_note");
+    int cSort = table.columnIndex("sort_time");
+
+    std::vector<Database::OperationLogEntry> entries(table.rowCount());
+    for (size_t r = 0; r < table.rowCount(); ++r) {
+        Database::OperationLogEntry& entry = entries[r];
+        if (cId >= 0) entry.id = static_cast<int>(table.getInt(r, cId));
+        if (cType >= 0) entry.operation_type = table.getString(r, cType);
+        if (cName >= 0) entry.item_name = table.getString(r, cName);
+        if (cTime >= 0) entry.operation_time = table.getString(r, cTime);
+        if (cNote >= 0) entry.operation_note = table.getString(r, cNote);
+        if (cSort >= 0) entry.sort_time = table.getString(r, cSort);
+    }
+    return entries;
+}
+
+// 辅助函数：把多取一行的查询结果整理成一页，并生成前后游标。
+// 结果按排序方向返回：向后翻页时数据库按升序取出，这里翻转回降序。
+template <typename Row>
+static Database::KeysetPage<Row> buildKeysetPage(std::vector<Row> rows, int pageSize,
+                                                 bool backward, bool hasCursor) {
+    Database::KeysetPage<Row> page;
+    bool hasMore = static_cast<int>(rows.size()) > pageSize;
+    if (hasMore) {
+        rows.resize(pageSize);
+    }
+    if (backward) {
+        std::reverse(rows.begin(), rows.end());
+    }
+
+    auto cursorOf = [](const Row& row) {
+        PageCursor cursor;
+        cursor.sortTime = row.sort_time;
+        cursor.id = row.id;
+        return cursor.valid() ? cursor.encode() : std::string();
+    };
+
+    if (!rows.empty()) {
+        // 向前翻页：是否还有下一页取决于多取的那一行；游标存在说明前面还有数据
+        // 向后翻页：反之
+        bool hasNext = backward ? true : hasMore;
+        bool hasPrev = backward ? hasMore : hasCursor;
+        if (hasNext) page.nextCursor = cursorOf(rows.back());
+        if (hasPrev) page.prevCursor = cursorOf(rows.front());
+    }
+    page.rows = std::move(rows);
+    return page;
+}
+
+// 按主键批量查询时 IN 列表的占位符个数向上取整到 2 的幂（多出的位置重复最后一个 id），
+// 同一类查询只会产生少数几种 SQL 文本，预处理语句缓存可以复用
+static size_t paddedIdCount(size_t count) {
+    size_t padded = 1;
+    while (padded < count) padded <<= 1;
+    return padded;
+}
+
+static std::string idPlaceholders(size_t count) {
+    std::string placeholders;
+    for (size_t i = 0; i < paddedIdCount(count); ++i) {
+        placeholders += (i == 0 ? "?" : ",?");
+    }
+    return placeholders;
+}
+
+static void bindIds(StorageStatement* pstmt, int firstIndex, const std::vector<int>& ids) {
+    size_t padded = paddedIdCount(ids.size());
+    for (size_t i = 0; i < padded; ++i) {
+        pstmt->setInt(firstIndex + static_cast<int>(i), ids[std::min(i, ids.size() - 1)]);
+    }
+}
+
+// 把按主键取回的行排成 ids 的顺序（数据库返回的 IN 结果没有顺序保证）
+template <typename Row, typename IdOf>
+static std::vector<Row> orderByIds(std::vector<Row> rows, const std::vector<int>& ids, IdOf idOf) {
+    std::unordered_map<int, size_t> position;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        position[idOf(rows[i])] = i;
+    }
+    std::vector<Row> ordered;
+    ordered.reserve(ids.size());
+    for (int id : ids) {
+        auto it = position.find(id);
+        if (it != position.end()) {
+            ordered.push_back(std::move(rows[it->second]));
+        }
+    }
+    return ordered;
+}
+
+// 辅助函数：行数据转换为搜索索引文档
+static SearchIndex::Document toSearchDocument(const Database::InventoryItem& item) {
+    SearchIndex::Document doc;
+    doc.id = item.id;
+    doc.fields = {item.item_name, item.location};
+    doc.sortKey = item.sort_time;
+    return doc;
+}
+
+static SearchIndex::Document toSearchDocument(const Database::OperationLogEntry& entry) {
+    SearchIndex::Document doc;
+    doc.id = entry.id;
+    doc.fields = {entry.operation_type, entry.item_name, entry.operation_note};
+    doc.sortKey = entry.sort_time;
+    return doc;
+}
+
+// 辅助函数：内存库存引擎的行与库存结构体互相转换（物品名称取自物品目录）
+static Database::InventoryItem toInventoryItem(const InventoryEngine::Row& row) {
+    Database::InventoryItem item;
+    item.id = row.id;
+    item.item_id = row.itemId;
+    ItemCatalog::instance().nameOf(row.itemId, item.item_name);
+    item.quantity = row.quantity;
+    item.location = row.location;
+    item.stored_time = row.storedTime.substr(0, 19);
+    item.last_updated = row.lastUpdated.substr(0, 19);
+    item.sort_time = row.lastUpdated;
+    return item;
+}
+
+static std::vector<Database::InventoryItem> toInventoryItems(const std::vector<InventoryEngine::Row>& rows) {
+    std::vector<Database::InventoryItem> items;
+    items.reserve(rows.size());
+    for (const auto& row : rows) {
+        items.push_back(toInventoryItem(row));
+    }
+    return items;
+}
+
+// 辅助函数：读取内存库存引擎使用的行（时间含微秒）
+static std::vector<InventoryEngine::Row> toEngineRows(StorageResult* res) {
+    std::vector<InventoryEngine::Row> rows;
+    while (res->next()) {
+        InventoryEngine::Row row;
+        row.id = res->getInt(1);
+        row.itemId = res->getInt(2);
+        row.quantity = res->getInt(3);
+        row.location = res->getString(4);
+        row.storedTime = res->getString(5);
+        row.lastUpdated = res->getString(6);
+        rows.push_back(std::move(row));
+    }
+    return rows;
+}
+
+// 与 getInventoryItemById / getInventoryByItemId 的查询结果相同的键
+static std::map<std::string, std::string> toInventoryMap(const InventoryEngine::Row& row) {
+    Database::InventoryItem item = toInventoryItem(row);
+    return {
+        {"inventory_id", std::to_string(item.id)},
+        {"item_id", std::to_string(item.item_id)},
+        {"item_name", item.item_name},
+        {"quantity", std::to_string(item.quantity)},
+        {"location", item.location},
+        {"stored_time", item.stored_time},
+        {"last_updated", item.last_updated}
+    };
+}
+
+// 与 "LIKE '%search%'" 相同的包含匹配（英文不区分大小写）
+static bool containsIgnoreCase(const std::string& text, const std::string& search) {
+    auto it = std::search(text.begin(), text.end(), search.begin(), search.end(),
+                          [](unsigned char a, unsigned char b) { return std::tolower(a) == std::tolower(b); });
+    return it != text.end();
+}
+
+// 库存列表的搜索条件 "il.name LIKE ? OR i.location LIKE ?" 在内存引擎中的等价筛选
+static InventoryEngine::Match inventoryMatch(const std::string& search) {
+    InventoryEngine::Match match;
+    if (search.empty()) {
+        return match;
+    }
+    match.item = [search](int itemId) {
+        std::string name;
+        return ItemCatalog::instance().nameOf(itemId, name) && containsIgnoreCase(name, search);
+    };
+    match.location = [search](const std::string& location) {
+        return containsIgnoreCase(location, search);
+    };
+    return match;
+}
+
+// 批量写入时单条语句最多包含的行数。不足一整批的部分按 2 的幂拆分，
+// 同一类语句只有少数几种形状，预处理语句缓存可以复用
+static const size_t kBatchChunkRows = 256;
+
+static std::vector<size_t> batchChunks(size_t count) {
+    std::vector<size_t> chunks;
+    while (count >= kBatchChunkRows) {
+        chunks.push_back(kBatchChunkRows);
+        count -= kBatchChunkRows;
+    }
+    for (size_t size = kBatchChunkRows / 2; size > 0; size >>= 1) {
+        if (count >= size) {
+            chunks.push_back(size);
+            count -= size;
+        }
+    }
+    return chunks;
+}
+
+static std::string repeatTuple(const char* tuple, size_t count, const char* separator = ", ") {
+    std::string sql;
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) sql += separator;
+        sql += tuple;
+    }
+    return sql;
+}
+
+static OperationLogQueue::Entry logEntry(const char* type, const std::string& itemName,
+                                        const std::string& note) {
+    OperationLogQueue::Entry entry;
+    entry.type = type;
+    entry.itemName = itemName;
+    entry.note = note;
+    return entry;
+}
+
+// ====== 实时事件（/api/events）======
+// 列表项与 /api/inventory、/api/operation_logs 使用同一个序列化函数，前端直接用来更新表格
+void Database::writeJson(JsonWriter& out, const InventoryItem& item) {
+    out.beginObject()
+       .field("id", item.id)
+       .field("item_id", item.item_id)
+       .field("item_name", item.item_name)
+       .field("quantity", item.quantity)
+       .field("location", item.location)
+       .field("stored_time", item.stored_time)
+       .field("last_updated", item.last_updated)
+       .endObject();
+}
+
+void Database::writeJson(JsonWriter& out, const OperationLogEntry& entry) {
+    out.beginObject()
+       .field("id", entry.id)
+       .field("operation_type", entry.operation_type)
+       .field("item_name", entry.item_name)
+       .field("operation_time", entry.operation_time)
+       .field("operation_note", entry.operation_note)
+       .endObject();
+}
+
+static void publishInventoryEvent(const std::vector<Database::InventoryItem>& added,
+                                  const std::vector<Database::InventoryItem>& updated,
+                                  const std::vector<int>& removed) {
+    if (added.empty() && updated.empty() && removed.empty()) {
+        return;
+    }
+    JsonWriter data(128 * (added.size() + updated.size()) + 8 * removed.size() + 64);
+    data.beginObject().key("added").beginArray();
+    for (const auto& item : added) {
+        Database::writeJson(data, item);
+    }
+    data.endArray().key("updated").beginArray();
+    for (const auto& item : updated) {
+        Database::writeJson(data, item);
+    }
+    data.endArray().key("removed").beginArray();
+    for (int id : removed) {
+        data.value(id);
+    }
+    data.endArray().endObject();
+    EventBus::instance().publish("inventory", data.take());
+}
+
+// ids 与 entries 一一对应；没有 id 的（延迟写入队列中尚未写入数据库）为 0
+static void publishOperationLogEvent(const std::vector<OperationLogQueue::Entry>& entries,
+                                     const std::vector<int>& ids) {
+    if (entries.empty() || !EventBus::instance().hasSubscribers()) {
+        return;
+    }
+    std::string now = currentDateTime();
+    JsonWriter data(128 * entries.size() + 16);
+    data.beginObject().key("logs").beginArray();
+    for (size_t k = 0; k < entries.size(); ++k) {
+        const OperationLogQueue::Entry& entry = entries[k];
+        Database::OperationLogEntry log;
+        log.id = k < ids.size() ? ids[k] : 0;
+        log.operation_type = entry.type;
+        log.item_name = entry.itemName;
+        log.operation_time = entry.time.empty() ? now : entry.time.substr(0, 19);
+        log.operation_note = entry.note;
+        Database::writeJson(data, log);
+    }
+    data.endArray().endObject();
+    EventBus::instance().publish("operation_log", data.take());
+}
+
+// 延迟写入队列中尚未写入数据库的操作日志（id 为 0）与数据库中的记录一起分页，保证刚发生的操作立即可见。
+// 队列中的记录一般比数据库中的新，计算位置时排在数据库记录之前：从第 offset 条开始的一页
+// 先取队列中的 [offset, offset + perPage) 条，不足的部分从数据库的 dbOffset 处取 dbLimit 条补齐，
+// 每页仍为 perPage 条，之后的页码也按队列的长度顺延
+struct PendingLogSlice {
+    std::vector<OperationLogQueue::Entry> entries;
+    int dbOffset = 0;
+    int dbLimit = 0;
+};
+
+static PendingLogSlice pendingLogSlice(const std::string& search, int offset, int perPage) {
+    PendingLogSlice slice;
+    offset = std::max(0, offset);
+    size_t end = static_cast<size_t>(offset) + static_cast<size_t>(perPage);
+    std::vector<OperationLogQueue::Entry> pending = OperationLogQueue::instance().pending(search, end);
+    size_t begin = std::min(pending.size(), static_cast<size_t>(offset));
+    slice.entries.assign(std::make_move_iterator(pending.begin() + begin),
+                         std::make_move_iterator(pending.end()));
+    slice.dbOffset = std::max(0, offset - static_cast<int>(pending.size()));
+    slice.dbLimit = perPage - static_cast<int>(slice.entries.size());
+    return slice;
+}
+
+// 按 sort_time 把队列中的记录合并进数据库的一页（两者都按时间降序，时间相同时队列中的在前）
+static std::vector<Database::OperationLogEntry> mergePendingLogs(std::vector<OperationLogQueue::Entry> pending,
+                                                                 std::vector<Database::OperationLogEntry> rows) {
+    if (pending.empty()) {
+        return rows;
+    }
+    std::vector<Database::OperationLogEntry> queued;
+    queued.reserve(pending.size());
+    for (auto& entry : pending) {
+        Database::OperationLogEntry row;
+        row.operation_type = std::move(entry.type);
+        row.item_name = std::move(entry.itemName);
+        row.operation_note = std::move(entry.note);
+        row.operation_time = entry.time.substr(0, 19);
+        row.sort_time = std::move(entry.time);
+        queued.push_back(std::move(row));
+    }
+    std::vector<Database::OperationLogEntry> merged;
+    merged.reserve(queued.size() + rows.size());
+    std::merge(std::make_move_iterator(queued.begin()), std::make_move_iterator(queued.end()),
+               std::make_move_iterator(rows.begin()), std::make_move_iterator(rows.end()),
+               std::back_inserter(merged),
+               [](const Database::OperationLogEntry& a, const Database::OperationLogEntry& b) {
+                   return a.sort_time > b.sort_time;
+               });
+    return merged;
+}
+
+// 库存查询公共的列（含键集分页/搜索索引使用的排序键）
+static const char* kInventorySelect =
+    "SELECT i.id AS inventory_id, i.item_id, il.name AS item_name, "
+    "i.quantity, i.location, "
+    "DATE_FORMAT(i.stored_time, '%Y-%m-%d %H:%i:%s') AS stored_time, "
+    "DATE_FORMAT(i.last_updated, '%Y-%m-%d %H:%i:%s') AS last_updated, "
+    "DATE_FORMAT(i.last_updated, '%Y-%m-%d %H:%i:%s.%f') AS sort_time "
+    "FROM inventory i "
+    "JOIN item_list il ON i.item_id = il.id ";
+
+static const char* kEngineRowSelect =
+    "SELECT id, item_id, quantity, location, "
+    "DATE_FORMAT(stored_time, '%Y-%m-%d %H:%i:%s.%f'), "
+    "DATE_FORMAT(last_updated, '%Y-%m-%d %H:%i:%s.%f') "
+    "FROM inventory ";
+
+static const char* kOperationLogSelect =
+    "SELECT "
+    "  id, "
+    "  operation_type, "
+    "  item_name, "
+    "  DATE_FORMAT(operation_time, '%Y-%m-%d %H:%i:%s') AS formatted_time, "
+    "  DATE_FORMAT(operation_time, '%Y-%m-%d %H:%i:%s.%f') AS sort_time, "
+    "  operation_note "
+    "FROM operation_log ";
+
 // Database.cpp
 Database::Database(Config& cfg) 
     : config(cfg), 
-      driver(nullptr), 
       con(nullptr),
-      logToConsole(true),
-      logLevelFlag(LOG_INFO),
       connected(false)
 {
-    // 1. 从配置获取日志文件名
-    logFileName = config.getString("application", "log_file", "geartracker.log");
+    // 日志级别、文件等由全局 Logger 统一配置（main 启动时和 reloadConfig 中）
     
-    // 2. 设置日志级别
-    std::string logLevel = config.getString("application", "log_level", "info");
-    if (logLevel == "debug") {
-        logLevelFlag = LOG_DEBUG;
-    } else if (logLevel == "warning") {
-        logLevelFlag = LOG_WARNING;
-    } else if (logLevel == "error") {
-        logLevelFlag = LOG_ERROR;
-    } else {
-        logLevelFlag = LOG_INFO;
-    }
+    // 每个连接缓存的预处理语句数量
+    stmtCache.setCapacity(static_cast<size_t>(std::max(1, config.getInt("database", "stmt_cache_size", 32))));
+    
+    // 空闲多久后才需要重新验证连接（与连接池共用同一配置项）
+    validateAfterIdle = std::chrono::seconds(config.getInt("database", "pool_validate_after", 30));
     
     // 3. 初始化日志系统并立即尝试连接数据库
-    log("数据库实例已创建，配置加载完成 - 尝试连接数据库");
+    GT_LOG_DEBUG("数据库实例已创建，配置加载完成 - 尝试连接数据库");
     
     // 关键修改：在构造函数中立即尝试连接
     connect();
@@ -70,169 +456,77 @@ Database::Database(Config& cfg)
 // Database.cpp
 // 保持析构函数实现不变
 Database::~Database() {
-    // 清理资源
+    // 清理资源：预处理语句必须先于连接释放
+    stmtCache.clear();
     if (con && !con->isClosed()) {
-        log("Disconnecting from database");
+        GT_LOG_INFO("Disconnecting from database");
         con->close();
     }
 }
 
 
-// 修改日志函数使用配置文件中的日志文件
+// 兼容旧接口：新代码请直接使用 GT_LOG_* 宏，低于当前级别时不会拼接消息
 void Database::log(const std::string& message, bool isError) {
-    int level = isError ? LOG_ERROR : LOG_INFO;
-    
-    // 检查日志级别
-    if (level < logLevelFlag) return;
-    
-    // 获取当前时间
-    auto now = std::chrono::system_clock::now();
-    std::time_t now_time = std::chrono::system_clock::to_time_t(now);
-    std::tm now_tm = *std::localtime(&now_time);
-    
-    // 格式化时间
-    std::ostringstream timeStream;
-    timeStream << std::put_time(&now_tm, "%Y-%m-%d %H:%M:%S");
-    
-    // 打开日志文件
-    std::ofstream logFileStream(logFileName, std::ios_base::app);
-    if (!logFileStream.is_open()) {
-        // 如果文件打开失败，尝试使用默认文件名
-        logFileStream.open("geartracker.log", std::ios_base::app);
-    }
-    
-    if (logFileStream.is_open()) {
-        logFileStream << "[" << timeStream.str() << "] ";
-        if (isError) logFileStream << "[ERROR] ";
-        else logFileStream << "[INFO] ";
-        logFileStream << message << std::endl;
-    }
-    
-    // 同时输出到控制台
-    if (logToConsole) {
-        std::cout << "[" << timeStream.str() << "] " << message << std::endl;
-    }
+    // 交给异步日志系统，文件写入和控制台输出都在后台线程完成
+    GT_LOG(isError ? LOG_ERROR : LOG_INFO, message);
 }
 
 
 
 bool Database::connect() {
     std::lock_guard<std::mutex> lock(connectionMutex);
+    return connectLocked();
+}
+
+bool Database::connectLocked() {
+    // 旧连接上的预处理语句随连接一起失效
+    stmtCache.clear();
     
     // 清除任何现有无效连接
     if (con && !con->isClosed()) {
         try {
-            log("关闭现有连接");
+            GT_LOG_DEBUG("关闭现有连接");
             con->close();
-        } catch (const sql::SQLException& e) {
+        } catch (const StorageError& e) {
             std::ostringstream oss;
             oss << "关闭连接错误 [code:" << e.getErrorCode()
                 << ", SQLState:" << e.getSQLState() << "]: "
                 << e.what();
-            log(oss.str(), true);
+            GT_LOG_ERROR(oss.str());
         } catch (...) {
-            log("关闭连接时发生未知错误", true);
+            GT_LOG_ERROR("关闭连接时发生未知错误");
         }
         con.reset();
     }
     
-    // 从配置获取最新连接参数
-    std::string host = config.getString("database", "host", "127.0.0.1");
-    int port = config.getInt("database", "port", 3306);
-    std::string user = config.getString("database", "username", "");
-    std::string password = config.getString("database", "password", "");
-    std::string dbName = config.getString("database", "database", "geartracker");
-    
-    // 记录详细的连接参数
-    log("连接参数: ");
-    log("  主机: " + host);
-    log("  端口: " + std::to_string(port));
-    log("  用户: " + user);
-    log("  数据库: " + dbName);
-    
+    // 按 [database] backend 打开 MySQL 或 SQLite 连接（连接参数的日志由各后端输出）
+    std::string backend = config.getString("database", "backend", "mysql");
     try {
-        // 确保驱动已初始化
-        if (!driver) {
-            log("获取MySQL驱动实例");
-            driver = get_driver_instance();
-            if (!driver) {
-                log("无法获取MySQL驱动实例", true);
-                return false;
-            }
-        }
-        
-        // 构建连接字符串
-        std::string connectionStr = "tcp://" + host + ":" + std::to_string(port);
-        log("创建连接: " + connectionStr);
-        
-        // 创建新连接
-        log("正在连接到MySQL服务器...");
-        sql::Connection* rawCon = driver->connect(connectionStr, user, password);
-        if (!rawCon) {
-            log("连接创建失败，但没有抛出异常", true);
-            return false;
-        }
-        con.reset(rawCon);
-        
-        // ====== 添加超时设置 ======
-        log("设置连接超时选项");
-        con->setClientOption("OPT_CONNECT_TIMEOUT", "5");
-        con->setClientOption("OPT_READ_TIMEOUT", "10");
-        con->setClientOption("OPT_WRITE_TIMEOUT", "10");
-        
-        // 设置数据库
-        log("选择数据库: " + dbName);
-        con->setSchema(dbName);
-        
-        // 设置字符集
-        log("设置字符集为utf8mb4");
-        std::unique_ptr<sql::Statement> stmt(con->createStatement());
-        stmt->execute("SET NAMES 'utf8mb4'");
-        stmt->execute("SET CHARACTER SET utf8mb4");
-        
-        // ====== 优化连接保持设置 ======
-        con->setClientOption("MYSQL_OPT_KEEPALIVE_INTERVAL", "60");
-        con->setClientOption("MYSQL_OPT_TCP_KEEPALIVE", "1");
-        log("已启用TCP keepalive");
-        
-        // 执行简单查询验证连接
-        log("执行连接验证查询...");
-        std::unique_ptr<sql::Statement> testStmt(con->createStatement());
-        std::unique_ptr<sql::ResultSet> res(testStmt->executeQuery("SELECT 1 AS test_value"));
-        if (res->next() && res->getInt("test_value") == 1) {
-            log("连接验证成功");
-            connected = true;
-            return true;
-        } else {
-            log("连接验证失败: 查询返回意外结果", true);
-            connected = false;
-            return false;
-        }
-    } catch (sql::SQLException &e) {
+        con = openStorage(config);
+        Metrics::instance().counter("geartracker_db_connects_total", "成功建立的数据库连接数")->add();
+        GT_LOG_DEBUG(std::string("存储后端: ") + con->backendName());
+        connected = true;
+        lastActivity = std::chrono::steady_clock::now();
+        return true;
+    } catch (const StorageError& e) {
         std::ostringstream oss;
-        oss << "MySQL连接错误 [code:" << e.getErrorCode()
+        oss << "数据库连接错误 [backend:" << backend << ", code:" << e.getErrorCode()
             << ", SQLState:" << e.getSQLState() << "]: "
             << e.what();
-        log(oss.str(), true);
-        
-        // 添加详细错误诊断
-        std::ostringstream params;
-        params << "连接参数: \n"
-               << "  主机: " << host << "\n"
-               << "  端口: " << port << "\n"
-               << "  用户: " << user << "\n"
-               << "  数据库: " << dbName;
-        log(params.str(), true);
-        
+        GT_LOG_ERROR(oss.str());
+        Metrics::instance().counter("geartracker_db_connect_failures_total", "建立数据库连接失败次数")->add();
+        con.reset();
         connected = false;
         return false;
     } catch (const std::exception& e) {
         std::string errorMsg = "连接错误: " + std::string(e.what());
-        log(errorMsg, true);
+        GT_LOG_ERROR(errorMsg);
+        con.reset();
         connected = false;
         return false;
     } catch (...) {
-        log("未知连接错误", true);
+        GT_LOG_ERROR("未知连接错误");
+        con.reset();
         connected = false;
         return false;
     }
@@ -241,23 +535,26 @@ bool Database::connect() {
 
 
 bool Database::testConnection() {
+    TRACE_SPAN("Database::testConnection");
     std::lock_guard<std::mutex> lock(connectionMutex);
-    log("测试数据库连接状态");
+    GT_LOG_DEBUG("测试数据库连接状态");
     
     // 首先检查是否已有有效连接
     if (con && !con->isClosed() && con->isValid()) {
-        log("连接状态良好，无需重新连接");
+        GT_LOG_DEBUG("连接状态良好，无需重新连接");
+        lastActivity = std::chrono::steady_clock::now();
         return true;
     }
     
     // 如果没有连接或连接无效，尝试重新连接
-    log("连接无效或未建立，尝试重新连接");
-    return connect();
+    GT_LOG_INFO("连接无效或未建立，尝试重新连接");
+    return connectLocked();
 }
 
 std::vector<std::map<std::string, std::string>> Database::executeQuery(const std::string& sql) {
+    TRACE_SPAN("Database::executeQuery");
     std::lock_guard<std::mutex> lock(connectionMutex);
-    log("Executing query: " + sql);
+    GT_LOG_DEBUG("Executing query: " + sql);
     std::vector<std::map<std::string, std::string>> results;
     
     // 最大重试次数
@@ -270,36 +567,35 @@ std::vector<std::map<std::string, std::string>> Database::executeQuery(const std
         try {
             // 确保连接有效（修改点1）
             if (!con || con->isClosed() || !con->isValid()) {
-                log("Connection invalid, reconnecting... (attempt " + std::to_string(attempt) + ")");
-                if (!connect()) {
-                    log("Failed to reconnect for query", true);
+                GT_LOG_INFO("Connection invalid, reconnecting... (attempt " + std::to_string(attempt) + ")");
+                if (!connectLocked()) {
+                    GT_LOG_ERROR("Failed to reconnect for query");
                     return results; // 返回空结果
                 }
             }
             
-            // 创建语句对象（修改点2）
-            sql::Statement* stmt = con->createStatement();
+            // 临时语句不进入语句缓存，但同样计时（修改点2）
+            std::unique_ptr<StorageStatement> stmt(StatementCache::prepare(con.get(), sql));
             
             // 执行查询（修改点3）
-            sql::ResultSet* res = stmt->executeQuery(sql);
+            std::unique_ptr<StorageResult> res(stmt->executeQuery());
+            const int columns = res->columnCount();
             
-            // 获取元数据
-            sql::ResultSetMetaData* meta = res->getMetaData();
-            const int columns = meta->getColumnCount();
-            
-            // 记录列信息（优化点4）
-            std::ostringstream columnsStream;
-            for (int i = 1; i <= columns; ++i) {
-                if (i > 1) columnsStream << ", ";
-                columnsStream << meta->getColumnName(i);
+            // 记录列信息（仅调试级别）
+            if (Logger::instance().shouldLog(LOG_DEBUG)) {
+                std::ostringstream columnsStream;
+                for (int i = 1; i <= columns; ++i) {
+                    if (i > 1) columnsStream << ", ";
+                    columnsStream << res->columnLabel(i);
+                }
+                GT_LOG_DEBUG("Query returned columns: " + columnsStream.str());
             }
-            log("Query returned columns: " + columnsStream.str());
             
             // 处理结果集（修改点5）
             while (res->next()) {
                 std::map<std::string, std::string> row;
                 for (int i = 1; i <= columns; ++i) {
-                    std::string colName = meta->getColumnName(i);
+                    std::string colName = res->columnLabel(i);
                     std::transform(colName.begin(), colName.end(), colName.begin(), 
                                   [](unsigned char c){ return std::tolower(c); });
                     
@@ -312,11 +608,11 @@ std::vector<std::map<std::string, std::string>> Database::executeQuery(const std
                 results.push_back(row);
             }
             
-            // 显式释放资源（关键修改点6）
-            delete res;
-            delete stmt;
+            // 结果集必须先于语句释放（关键修改点6）
+            res.reset();
+            stmt.reset();
             
-            log("Query executed successfully, returned " + std::to_string(results.size()) + " rows");
+            GT_LOG_DEBUG("Query executed successfully, returned " + std::to_string(results.size()) + " rows");
             
             // 只在调试时记录详细结果
             #ifdef DEBUG
@@ -326,21 +622,21 @@ std::vector<std::map<std::string, std::string>> Database::executeQuery(const std
                 for (const auto& col : results[0]) {
                     oss << col.first << ": " << col.second << " | ";
                 }
-                log(oss.str());
+                GT_LOG_DEBUG(oss.str());
             }
             #endif
             
             return results;
             
-        } catch (sql::SQLException &e) {
+        } catch (StorageError &e) {
             // 处理特定错误代码（修改点7）
             if (e.getErrorCode() == 2014 || e.getErrorCode() == 2006) { // Commands out of sync or server gone away
-                log("Commands out of sync, resetting connection...", true);
+                GT_LOG_ERROR("Commands out of sync, resetting connection...");
                 disconnect(); // 强制断开
                 con.reset();  // 重置连接
                 
                 if (attempt <= maxRetries) {
-                    log("Retrying query (attempt " + std::to_string(attempt) + ")");
+                    GT_LOG_INFO("Retrying query (attempt " + std::to_string(attempt) + ")");
                     continue; // 重试查询
                 }
             }
@@ -350,13 +646,13 @@ std::vector<std::map<std::string, std::string>> Database::executeQuery(const std
             errorMsg << "MySQL Query Error [" << e.getErrorCode() 
                      << ", SQLState: " << e.getSQLState() << "]: " 
                      << e.what() << "\nQuery: " << sql;
-            log(errorMsg.str(), true);
+            GT_LOG_ERROR(errorMsg.str());
             
             return results;
             
         } catch (const std::exception& e) {
             std::string errorMsg = "General query error: " + std::string(e.what());
-            log(errorMsg, true);
+            GT_LOG_ERROR(errorMsg);
             return results;
         }
     }
@@ -367,25 +663,27 @@ std::vector<std::map<std::string, std::string>> Database::executeQuery(const std
 
 
 int Database::executeUpdate(const std::string& sql) {
+    TRACE_SPAN("Database::executeUpdate");
+    ensureConnected(); // ensureConnected 内部自行加锁，必须在持锁之前调用
     std::lock_guard<std::mutex> lock(connectionMutex); // 使用互斥锁
-    ensureConnected();
-    log("Executing update: " + sql);
+    GT_LOG_DEBUG("Executing update: " + sql);
     if (!con || con->isClosed()) {
-        log("Connection closed, attempting to reconnect...");
-        if (!connect()) {
-            log("Failed to connect for update", true);
+        GT_LOG_INFO("Connection closed, attempting to reconnect...");
+        if (!connectLocked()) {
+            GT_LOG_ERROR("Failed to connect for update");
             return -1;
         }
     }
     
     try {
-        std::unique_ptr<sql::Statement> stmt(con->createStatement());
-        int result = stmt->executeUpdate(sql);
-        log("Update executed successfully, affected rows: " + std::to_string(result));
+        std::unique_ptr<StorageStatement> stmt(StatementCache::prepare(con.get(), sql));
+        int result = stmt->executeUpdate();
+        DataVersion::instance().bumpAll(); // 任意 SQL，无法判断修改了哪张表
+        GT_LOG_DEBUG("Update executed successfully, affected rows: " + std::to_string(result));
         return result;
-    } catch (sql::SQLException &e) {
+    } catch (StorageError &e) {
         std::string errorMsg = "MySQL Update Error (" + sql + "): " + std::string(e.what());
-        log(errorMsg, true);
+        GT_LOG_ERROR(errorMsg);
         return -1;
     }
 }
@@ -393,22 +691,21 @@ int Database::executeUpdate(const std::string& sql) {
 bool Database::addItemToList(const std::string& name, const std::string& category,
                             const std::string& grade, const std::string& effect,
                             const std::string& description, const std::string& note, const std::string& operationReason) {
+    TRACE_SPAN("Database::addItemToList");
     ensureConnected();
-    log("Adding item to list: " + name);
+    GT_LOG_DEBUG("Adding item to list: " + name);
     if (!con || con->isClosed()) {
-        log("Connection closed, attempting to reconnect...");
+        GT_LOG_INFO("Connection closed, attempting to reconnect...");
         if (!connect()) {
-            log("Failed to connect for addItemToList", true);
+            GT_LOG_ERROR("Failed to connect for addItemToList");
             return false;
         }
     }
     
     try {
-        std::unique_ptr<sql::PreparedStatement> pstmt(
-            con->prepareStatement(
-                "INSERT INTO item_list (name, category, grade, effect, description, note) "
-                "VALUES (?, ?, ?, ?, ?, ?)"
-            )
+        StorageStatement* pstmt = prepare(
+            "INSERT INTO item_list (name, category, grade, effect, description, note) "
+            "VALUES (?, ?, ?, ?, ?, ?)"
         );
         
         pstmt->setString(1, name);
@@ -417,20 +714,40 @@ bool Database::addItemToList(const std::string& name, const std::string& categor
         pstmt->setString(4, effect);
         
         if (description.empty()) {
-            pstmt->setNull(5, sql::DataType::LONGVARCHAR);
+            pstmt->setNull(5);
         } else {
             pstmt->setString(5, description);
         }
         
         if (note.empty()) {
-            pstmt->setNull(6, sql::DataType::LONGVARCHAR);
+            pstmt->setNull(6);
         } else {
             pstmt->setString(6, note);
         }
         
         int result = pstmt->executeUpdate();
         if (result > 0) {
-            log("Item added to list successfully: " + name);
+            GT_LOG_INFO("Item added to list successfully: " + name);
+            DataVersion::instance().bump(DataVersion::ITEMS);
+            // 同步物品目录和搜索索引
+            try {
+                ItemCatalog::Item item;
+                item.id = static_cast<int>(lastInsertId());
+                item.name = name;
+                item.category = category;
+                item.grade = grade;
+                ItemCatalog::instance().upsert(item);
+                
+                if (SearchIndex::instance().tracking()) {
+                    SearchIndex::Document doc;
+                    doc.id = item.id;
+                    doc.fields = {name};
+                    doc.sortKey = name;
+                    SearchIndex::instance().upsert(SearchIndex::ITEMS, std::move(doc));
+                }
+            } catch (StorageError &e) {
+                GT_LOG_WARNING("更新物品目录失败: " + std::string(e.what()));
+            }
             // 记录操作日志
             std::string opNote = "类别: " + category + ", 品质: " + grade;
             if (!operationReason.empty()) {
@@ -439,161 +756,144 @@ bool Database::addItemToList(const std::string& name, const std::string& categor
             logOperation("ADD", name, opNote);
             return true;
         } else {
-            log("Failed to add item to list: " + name, true);
+            GT_LOG_ERROR("Failed to add item to list: " + name);
             return false;
         }
-    } catch (sql::SQLException &e) {
+    } catch (StorageError &e) {
         std::string errorMsg = "MySQL Error in addItemToList: " + std::string(e.what());
-        log(errorMsg, true);
+        GT_LOG_ERROR(errorMsg);
         return false;
     }
 }
 
 bool Database::addItemToInventory(int itemId, int quantity, const std::string& location, const std::string& operationReason) {
-    ensureConnected(); // 确保连接有效
-    log("Adding item to inventory. ID: " + std::to_string(itemId) + ", Quantity: " + std::to_string(quantity));
-    if (!con || con->isClosed()) {
-        log("Connection closed, attempting to reconnect...");
-        if (!connect()) {
-            log("Failed to connect for addItemToInventory", true);
-            return false;
-        }
-    }
-    
-    try {
-        // 获取物品名称用于日志记录
-        std::string itemName = "未知物品";
-        auto itemInfo = executeQuery("SELECT name FROM item_list WHERE id = " + std::to_string(itemId));
-        if (!itemInfo.empty()) {
-            itemName = itemInfo[0]["name"];
-        }
-        
-        std::unique_ptr<sql::PreparedStatement> pstmt(
-            con->prepareStatement(
-                "INSERT INTO inventory (item_id, quantity, location) "
-                "VALUES (?, ?, ?)"
-            )
-        );
-        
-        pstmt->setInt(1, itemId);
-        pstmt->setInt(2, quantity);
-        pstmt->setString(3, location);
-        
-        int result = pstmt->executeUpdate();
-        if (result > 0) {
-            // 修改日志记录，添加操作原因
-            std::string opNote = "数量: " + std::to_string(quantity) + ", 位置: " + location;
-            if (!operationReason.empty()) {
-                opNote += " | 原因: " + operationReason;
-            }
-            logOperation("ADD", itemName, opNote);
-            return true;
-        } else {
-            log("Failed to add item to inventory. ID: " + std::to_string(itemId), true);
-            return false;
-        }
-    } catch (sql::SQLException &e) {
-        std::string errorMsg = "MySQL Error in addItemToInventory: " + std::string(e.what());
-        log(errorMsg, true);
-        return false;
-    }
+    TRACE_SPAN("Database::addItemToInventory");
+    GT_LOG_DEBUG("Adding item to inventory. ID: " + std::to_string(itemId) + ", Quantity: " + std::to_string(quantity));
+    // 与修改/删除相同，插入和操作日志在同一事务中写入
+    InventoryOperation op;
+    op.type = InventoryOperation::ADD;
+    op.itemId = itemId;
+    op.quantity = quantity;
+    op.location = location;
+    op.reason = operationReason;
+    return applySingleInventoryOperation(op, "Add");
 }
 
 bool Database::itemExistsInList(const std::string& name) {
+    TRACE_SPAN("Database::itemExistsInList");
+    // 物品目录已加载时直接在内存中查找
+    if (ItemCatalog::instance().ready()) {
+        return ItemCatalog::instance().idOf(name) > 0;
+    }
     ensureConnected(); // 确保连接有效
-    log("Checking if item exists: " + name);
+    GT_LOG_DEBUG("Checking if item exists: " + name);
     try {
         if (!con || con->isClosed()) {
-            log("Connection closed, attempting to reconnect...");
+            GT_LOG_INFO("Connection closed, attempting to reconnect...");
             if (!connect()) {
-                log("Failed to connect for itemExistsInList", true);
+                GT_LOG_ERROR("Failed to connect for itemExistsInList");
                 return false;
             }
         }
         
-        std::unique_ptr<sql::PreparedStatement> pstmt(
-            con->prepareStatement("SELECT COUNT(*) FROM item_list WHERE name = ?")
-        );
+        StorageStatement* pstmt = prepare("SELECT COUNT(*) FROM item_list WHERE name = ?");
         pstmt->setString(1, name);
-        std::unique_ptr<sql::ResultSet> res(pstmt->executeQuery());
+        std::unique_ptr<StorageResult> res(pstmt->executeQuery());
         
         if (res->next()) {
             int count = res->getInt(1);
             if (count > 0) {
-                log("Item exists: " + name);
+                GT_LOG_DEBUG("Item exists: " + name);
             } else {
-                log("Item does not exist: " + name);
+                GT_LOG_DEBUG("Item does not exist: " + name);
             }
             return count > 0;
         }
-        log("Item existence check failed for: " + name, true);
+        GT_LOG_ERROR("Item existence check failed for: " + name);
         return false;
     } catch (const std::exception& e) {
         std::string errorMsg = "Error in itemExistsInList: " + std::string(e.what());
-        log(errorMsg, true);
+        GT_LOG_ERROR(errorMsg);
         return false;
     }
 }
 
 int Database::getItemIdByName(const std::string& name) {
+    TRACE_SPAN("Database::getItemIdByName");
+    if (ItemCatalog::instance().ready()) {
+        int id = ItemCatalog::instance().idOf(name);
+        if (id <= 0) {
+            GT_LOG_ERROR("Item not found: " + name);
+        }
+        return id;
+    }
     ensureConnected(); // 确保连接有效
-    log("Getting item ID by name: " + name);
+    GT_LOG_DEBUG("Getting item ID by name: " + name);
     try {
         if (!con || con->isClosed()) {
-            log("Connection closed, attempting to reconnect...");
+            GT_LOG_INFO("Connection closed, attempting to reconnect...");
             if (!connect()) {
-                log("Failed to connect for getItemIdByName", true);
+                GT_LOG_ERROR("Failed to connect for getItemIdByName");
                 return -1;
             }
         }
         
-        std::unique_ptr<sql::PreparedStatement> pstmt(
-            con->prepareStatement("SELECT id FROM item_list WHERE name = ?")
-        );
+        StorageStatement* pstmt = prepare("SELECT id FROM item_list WHERE name = ?");
         pstmt->setString(1, name);
-        std::unique_ptr<sql::ResultSet> res(pstmt->executeQuery());
+        std::unique_ptr<StorageResult> res(pstmt->executeQuery());
         
         if (res->next()) {
-            int id = res->getInt("id");
-            log("Found item ID: " + std::to_string(id) + " for name: " + name);
+            int id = res->getInt(1);
+            GT_LOG_DEBUG("Found item ID: " + std::to_string(id) + " for name: " + name);
             return id;
         }
-        log("Item not found: " + name, true);
+        GT_LOG_ERROR("Item not found: " + name);
         return -1;
     } catch (const std::exception& e) {
         std::string errorMsg = "Error in getItemIdByName: " + std::string(e.what());
-        log(errorMsg, true);
+        GT_LOG_ERROR(errorMsg);
         return -1;
     }
 }
 
 void Database::disconnect() {
+    stmtCache.clear();
     if (con && !con->isClosed()) {
-        log("Disconnecting from database");
+        GT_LOG_INFO("Disconnecting from database");
         con->close();
     }
 }
 
+// 从当前连接的语句缓存中取得预处理语句，同一 SQL 在一个连接上只解析一次
+StorageStatement* Database::prepare(const std::string& sql) {
+    return stmtCache.get(con.get(), sql);
+}
+
 // 操作日志记录方法
 bool Database::logOperation(const std::string& operationType, 
                            const std::string& itemName, 
                            const std::string& note) {
+    TRACE_SPAN("Database::logOperation");
+    // 开启延迟写入时只入队，由后台线程批量写入
+    if (OperationLogQueue::instance().enqueue(operationType, itemName, note)) {
+        DataVersion::instance().bump(DataVersion::OPERATION_LOG); // 待写入的记录显示在日志第一页
+        publishOperationLogEvent({logEntry(operationType.c_str(), itemName, note)}, {});
+        return true;
+    }
     ensureConnected(); // 确保连接有效
-    log("Logging operation: " + operationType + " for item: " + itemName);
+    GT_LOG_DEBUG("Logging operation: " + operationType + " for item: " + itemName);
     if (!con || con->isClosed()) {
-        log("Connection closed, attempting to reconnect...");
+        GT_LOG_INFO("Connection closed, attempting to reconnect...");
         if (!connect()) {
-            log("Failed to connect for logOperation", true);
+            GT_LOG_ERROR("Failed to connect for logOperation");
             return false;
         }
     }
     
     try {
-        std::unique_ptr<sql::PreparedStatement> pstmt(
-            con->prepareStatement(
-                "INSERT INTO operation_log (operation_type, item_name, operation_note) "
-                "VALUES (?, ?, ?)"
-            )
+        StorageStatement* pstmt = prepare(
+            "INSERT INTO operation_log (operation_type, item_name, operation_note) "
+            "VALUES (?, ?, ?)"
         );
         std::string opType = operationType;
         if (opType == "ADD_ITEM") opType = "ADD";
@@ -604,15 +904,22 @@ bool Database::logOperation(const std::string& operationType,
         
         int result = pstmt->executeUpdate();
         if (result > 0) {
-            log("Operation logged successfully");
+            CountService::instance().adjust(CountService::OPERATION_LOG, result);
+            DataVersion::instance().bump(DataVersion::OPERATION_LOG);
+            if (EventBus::instance().hasSubscribers()) {
+                publishOperationLogEvent({logEntry(operationType.c_str(), itemName, note)},
+                                         {static_cast<int>(lastInsertId())});
+            }
+            indexOperationLogRow(0);
+            GT_LOG_DEBUG("Operation logged successfully");
             return true;
         } else {
-            log("Failed to log operation", true);
+            GT_LOG_ERROR("Failed to log operation");
             return false;
         }
-    } catch (sql::SQLException &e) {
+    } catch (StorageError &e) {
         std::string errorMsg = "MySQL Error in logOperation: " + std::string(e.what());
-        log(errorMsg, true);
+        GT_LOG_ERROR(errorMsg);
         return false;
     }
 }
@@ -621,23 +928,28 @@ bool Database::logOperation(const std::string& operationType,
 // 带分页的操作日志查询
 // Database.cpp
 // Database.cpp 实现文件中的修改
-std::vector<std::map<std::string, std::string>> Database::getOperationLogs(
+std::vector<Database::OperationLogEntry> Database::getOperationLogs(
     int page, 
     int perPage,  // 更合理的参数命名
     const std::string& search) 
 {
+    TRACE_SPAN("Database::getOperationLogs");
     ensureConnected();
-    int offset = (page - 1) * perPage;  // 使用 perPage 而不是 pageSize
+    // 延迟写入队列中的记录排在最前面，数据库部分的 OFFSET/LIMIT 随之调整
+    PendingLogSlice pending = pendingLogSlice(search, (page - 1) * perPage, perPage);
+    
+    if (!search.empty()) {
+        SearchIndex::PageRequest request;
+        request.offset = pending.dbOffset;
+        request.limit = pending.dbLimit;
+        std::vector<int> ids;
+        if (SearchIndex::instance().findPage(SearchIndex::OPERATION_LOG, search, request, ids)) {
+            return mergePendingLogs(std::move(pending.entries), loadOperationLogsByIds(ids));
+        }
+    }
     
-    // 构建基础查询 - 修改别名
-    std::string baseQuery = 
-        "SELECT "
-        "  id, "
-        "  operation_type, "
-        "  item_name, "
-        "  DATE_FORMAT(operation_time, '%Y-%m-%d %H:%i:%s') AS formatted_time, " // 改为 formatted_time
-        "  operation_note "
-        "FROM operation_log ";
+    // 构建基础查询（带 sort_time，与队列中的记录按时间合并）
+    std::string baseQuery = kOperationLogSelect;
     
     // 准备查询和参数
     std::string fullQuery;
@@ -652,61 +964,144 @@ std::vector<std::map<std::string, std::string>> Database::getOperationLogs(
         };
     }
     
-    // 添加排序和分页
+    // 添加排序和分页（分页参数也用占位符，保证 SQL 文本固定以便复用预处理语句）
     fullQuery = baseQuery + 
-        "ORDER BY operation_time DESC "
-        "LIMIT " + std::to_string(perPage) + 
-        " OFFSET " + std::to_string(offset);
+        "ORDER BY operation_time DESC, id DESC "
+        "LIMIT ? OFFSET ?";
     
-    log("Executing operation logs query: " + fullQuery);
+    GT_LOG_DEBUG("Executing operation logs query: " + fullQuery);
     if (!search.empty()) {
-        log("With search term: " + search);
+        GT_LOG_DEBUG("With search term: " + search);
     }
     
-    // 执行查询
-    if (!con || con->isClosed() || !con->isValid()) {
-        log("Connection invalid, reconnecting...");
+    // 执行查询（连接有效性已由 ensureConnected 按空闲时间检查）
+    if (!con || con->isClosed()) {
+        GT_LOG_INFO("Connection invalid, reconnecting...");
         if (!connect()) {
-            log("Failed to reconnect for getOperationLogs", true);
+            GT_LOG_ERROR("Failed to reconnect for getOperationLogs");
             return {};
         }
     }
     
     try {
         // 统一使用预处理语句（更安全）
-        std::unique_ptr<sql::PreparedStatement> pstmt(
-            con->prepareStatement(fullQuery)
-        );
+        StorageStatement* pstmt = prepare(fullQuery);
         
         for (size_t i = 0; i < params.size(); i++) {
             pstmt->setString(i + 1, params[i]);
         }
+        pstmt->setInt(params.size() + 1, pending.dbLimit);
+        pstmt->setInt(params.size() + 2, pending.dbOffset);
         
-        std::unique_ptr<sql::ResultSet> res(pstmt->executeQuery());
-        auto results = parseResultSet(res.get());
+        std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+        ResultTable table;
+        table.load(res.get(), pending.dbLimit);
         
         // 添加调试日志
-        log("Operation logs query returned " + std::to_string(results.size()) + " rows");
-        if (!results.empty()) {
-            std::ostringstream oss;
-            oss << "First log entry fields: ";
-            for (const auto& field : results[0]) {
-                oss << field.first << " ";
-            }
-            log(oss.str());
-        }
+        GT_LOG_DEBUG("Operation logs query returned " + std::to_string(table.rowCount()) + " rows");
         
-        return results;
-    } catch (sql::SQLException &e) {
+        return mergePendingLogs(std::move(pending.entries), toOperationLogEntries(table));
+    } catch (StorageError &e) {
         std::ostringstream oss;
         oss << "MySQL Error in getOperationLogs ["
             << e.getErrorCode() << "]: " << e.what()
             << "\nQuery: " << fullQuery;
-        log(oss.str(), true);
+        GT_LOG_ERROR(oss.str());
         return {};
     } catch (const std::exception& e) {
         std::string errorMsg = "Error in getOperationLogs: " + std::string(e.what());
-        log(errorMsg, true);
+        GT_LOG_ERROR(errorMsg);
+        return {};
+    }
+}
+
+
+// 键集分页的操作日志查询
+Database::KeysetPage<Database::OperationLogEntry> Database::getOperationLogsByCursor(
+    const PageCursor& cursor,
+    bool backward,
+    int perPage,
+    const std::string& search)
+{
+    TRACE_SPAN("Database::getOperationLogsByCursor");
+    ensureConnected();
+    bool hasCursor = cursor.valid();
+    if (!hasCursor) {
+        backward = false;
+    }
+    // 第一页最前面放延迟写入队列中的记录，至少留一行给数据库，游标总是来自数据库中的行；
+    // 没有放下的记录写入数据库后出现在列表中
+    std::vector<OperationLogQueue::Entry> pending;
+    if (!hasCursor) {
+        pending = pendingLogSlice(search, 0, perPage - 1).entries;
+    }
+    int dbPageSize = perPage - static_cast<int>(pending.size());
+
+    if (!search.empty()) {
+        SearchIndex::PageRequest request;
+        request.limit = dbPageSize + 1;
+        request.cursor = hasCursor ? &cursor : nullptr;
+        request.backward = backward;
+        std::vector<int> ids;
+        if (SearchIndex::instance().findPage(SearchIndex::OPERATION_LOG, search, request, ids)) {
+            auto page = buildKeysetPage(loadOperationLogsByIds(ids), dbPageSize, backward, hasCursor);
+            page.rows = mergePendingLogs(std::move(pending), std::move(page.rows));
+            return page;
+        }
+    }
+
+    std::string query = kOperationLogSelect;
+
+    std::vector<std::string> params;
+    std::vector<std::string> conditions;
+    if (!search.empty()) {
+        conditions.push_back("(operation_type LIKE ? OR item_name LIKE ? OR operation_note LIKE ?)");
+        params = {
+            "%" + search + "%",
+            "%" + search + "%",
+            "%" + search + "%"
+        };
+    }
+    if (hasCursor) {
+        conditions.push_back(backward ? "(operation_time, id) > (?, ?)"
+                                      : "(operation_time, id) < (?, ?)");
+    }
+    for (size_t i = 0; i < conditions.size(); ++i) {
+        query += (i == 0 ? "WHERE " : "AND ") + conditions[i] + " ";
+    }
+    query += backward ? "ORDER BY operation_time ASC, id ASC LIMIT ?"
+                      : "ORDER BY operation_time DESC, id DESC LIMIT ?";
+
+    GT_LOG_DEBUG("Executing operation logs keyset query: " + query);
+
+    try {
+        StorageStatement* pstmt = prepare(query);
+        int paramIndex = 1;
+        for (const auto& param : params) {
+            pstmt->setString(paramIndex++, param);
+        }
+        if (hasCursor) {
+            pstmt->setString(paramIndex++, cursor.sortTime);
+            pstmt->setInt64(paramIndex++, cursor.id);
+        }
+        pstmt->setInt(paramIndex++, dbPageSize + 1);
+
+        std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+        ResultTable table;
+        table.load(res.get(), dbPageSize + 1);
+        auto page = buildKeysetPage(toOperationLogEntries(table), dbPageSize, backward, hasCursor);
+        page.rows = mergePendingLogs(std::move(pending), std::move(page.rows));
+        GT_LOG_DEBUG("Operation logs keyset query returned " + std::to_string(page.rows.size()) + " rows");
+        return page;
+    } catch (StorageError &e) {
+        std::ostringstream oss;
+        oss << "MySQL Error in getOperationLogsByCursor ["
+            << e.getErrorCode() << "]: " << e.what()
+            << "\nQuery: " << query;
+        GT_LOG_ERROR(oss.str());
+        return {};
+    } catch (const std::exception& e) {
+        GT_LOG_ERROR("Error in getOperationLogsByCursor: " + std::string(e.what()));
         return {};
     }
 }
@@ -714,62 +1109,61 @@ std::vector<std::map<std::string, std::string>> Database::getOperationLogs(
 
 
 // 添加辅助函数：解析结果集
-std::vector<std::map<std::string, std::string>> Database::parseResultSet(sql::ResultSet* res) {
+std::vector<std::map<std::string, std::string>> Database::parseResultSet(StorageResult* res) {
     std::vector<std::map<std::string, std::string>> results;
     
     if (!res) return results;
     
-    sql::ResultSetMetaData* meta = res->getMetaData();
-    int columns = meta->getColumnCount();
+    int columns = res->columnCount();
     
-    // 记录列名
-    std::ostringstream columnsList;
+    // 记录列名（仅调试级别，避免每次查询都拼接列信息）
+    if (Logger::instance().shouldLog(LOG_DEBUG)) {
+        std::ostringstream columnsList;
+        for (int i = 1; i <= columns; ++i) {
+            if (i > 1) columnsList << ", ";
+            columnsList << res->columnLabel(i);
+        }
+        GT_LOG_DEBUG("Result set columns: " + columnsList.str());
+    }
+    
+    // 列名在读取数据前解析一次：列标签（AS 别名，没有别名时为列名）统一转为小写
+    std::vector<std::string> columnNames(columns);
     for (int i = 1; i <= columns; ++i) {
-        if (i > 1) columnsList << ", ";
-        columnsList << meta->getColumnName(i) << " (Label: " << meta->getColumnLabel(i) << ")";
+        std::string colName = res->columnLabel(i);
+        std::transform(colName.begin(), colName.end(), colName.begin(), 
+                      [](unsigned char c){ return std::tolower(c); });
+        columnNames[i - 1] = std::move(colName);
     }
-    log("Result set columns: " + columnsList.str());
     
     while (res->next()) {
-        std::map<std::string, std::string> row;
+        results.emplace_back();
+        std::map<std::string, std::string>& row = results.back();
         for (int i = 1; i <= columns; ++i) {
-            // 优先使用列标签（AS 别名），如果没有则使用列名
-            std::string colName = meta->getColumnLabel(i);
-            if (colName.empty()) {
-                colName = meta->getColumnName(i);
-                log("Warning: Empty column label for column " + std::to_string(i) + 
-                    ", using name: " + colName);
-            }
-            
-            // 将列名转换为小写，确保键名一致性
-            std::transform(colName.begin(), colName.end(), colName.begin(), 
-                          [](unsigned char c){ return std::tolower(c); });
-            
+            const std::string& colName = columnNames[i - 1];
             if (res->isNull(i)) {
-                row[colName] = "";
+                row.emplace(colName, std::string());
             } else {
                 try {
-                    row[colName] = res->getString(i);
-                } catch (const sql::SQLException& e) {
+                    row.emplace(colName, res->getString(i));
+                } catch (const StorageError& e) {
                     std::ostringstream oss;
                     oss << "Error getting string for column " << colName 
                          << " (index " << i << "): " << e.what();
-                    log(oss.str(), true);
+                    GT_LOG_ERROR(oss.str());
                     row[colName] = "[ERROR]";
                 }
             }
         }
-        results.push_back(row);
     }
     
     // 记录第一行数据
-    if (!results.empty()) {
+    if (!results.empty() && Logger::instance().shouldLog(LOG_DEBUG)) {
         std::ostringstream oss;
         oss << "First row data: ";
         for (const auto& pair : results[0]) {
             oss << pair.first << "=" << pair.second << " | ";
         }
-        log(oss.str());
+        GT_LOG_DEBUG(oss.str());
     }
     
     return results;
@@ -777,17 +1171,39 @@ std::vector<std::map<std::string, std::string>> Database::parseResultSet(sql::Re
 
 
 // 带分页的库存查询
-std::vector<std::map<std::string, std::string>> 
+std::vector<Database::InventoryItem>
 Database::getInventory(int page, int pageSize, const std::string& search) 
 {
-    ensureConnected();
-    log("获取库存数据，页码: " + std::to_string(page) + 
+    TRACE_SPAN("Database::getInventory");
+    GT_LOG_DEBUG("获取库存数据，页码: " + std::to_string(page) + 
         ", 每页: " + std::to_string(pageSize) + 
         ", 搜索: '" + search + "'");
     
     // 计算偏移量
     int offset = (page - 1) * pageSize;
     
+    // 有搜索词且索引可用时不再执行 LIKE 全表扫描
+    if (!search.empty()) {
+        SearchIndex::PageRequest request;
+        request.offset = offset;
+        request.limit = pageSize;
+        std::vector<int> ids;
+        if (SearchIndex::instance().findPage(SearchIndex::INVENTORY, search, request, ids)) {
+            return inventoryByIds(ids);
+        }
+    }
+    
+    // 内存库存引擎可用时整页都在内存中完成
+    InventoryEngine& engine = InventoryEngine::instance();
+    if (engine.serving()) {
+        SearchIndex::PageRequest request;
+        request.offset = static_cast<size_t>(std::max(0, offset));
+        request.limit = static_cast<size_t>(std::max(0, pageSize));
+        return toInventoryItems(engine.page(request, inventoryMatch(search)));
+    }
+    
+    ensureConnected();
+    
     // 构建基础查询
     std::string query = 
         "SELECT i.id AS inventory_id, i.item_id, il.name AS item_name, "
@@ -802,14 +1218,14 @@ Database::getInventory(int page, int pageSize, const std::string& search)
         query += "WHERE il.name LIKE ? OR i.location LIKE ? ";
     }
     
-    query += "ORDER BY i.last_updated DESC "
+    query += "ORDER BY i.last_updated DESC, i.id DESC "
              "LIMIT ? OFFSET ?";
     
-    log("执行查询: " + query);
+    GT_LOG_DEBUG("执行查询: " + query);
     
     try {
         // 准备参数化查询
-        std::unique_ptr<sql::PreparedStatement> pstmt(con->prepareStatement(query));
+        StorageStatement* pstmt = prepare(query);
         int paramIndex = 1;
         
         // 设置搜索参数
@@ -824,26 +1240,27 @@ Database::getInventory(int page, int pageSize, const std::string& search)
         pstmt->setInt(paramIndex++, offset);
         
         // 执行查询
-        log("执行查询...");
-        std::unique_ptr<sql::ResultSet> res(pstmt->executeQuery());
+        GT_LOG_DEBUG("执行查询...");
+        std::unique_ptr<StorageResult> res(pstmt->executeQuery());
         
-        log("解析结果...");
-        auto results = parseResultSet(res.get());
+        GT_LOG_DEBUG("解析结果...");
+        ResultTable table;
+        table.load(res.get(), pageSize);
         
-        log("获取 " + std::to_string(results.size()) + " 条库存记录");
-        return results;
+        GT_LOG_DEBUG("获取 " + std::to_string(table.rowCount()) + " 条库存记录");
+        return toInventoryItems(table);
         
-    } catch (sql::SQLException &e) {
+    } catch (StorageError &e) {
         // 详细错误处理
         std::ostringstream errorMsg;
         errorMsg << "库存查询错误 [MySQL错误 " << e.getErrorCode() << "]: " 
                  << e.what() << "\nSQL状态: " << e.getSQLState();
         
-        log(errorMsg.str(), true);
+        GT_LOG_ERROR(errorMsg.str());
         
         // 如果是连接错误，尝试重新连接
         if (e.getErrorCode() == 2013 || e.getErrorCode() == 2006) {  // CR_SERVER_LOST 或 CR_SERVER_GONE_ERROR
-            log("检测到连接丢失，尝试重新连接...");
+            GT_LOG_INFO("检测到连接丢失，尝试重新连接...");
             disconnect();
             connect();
         }
@@ -852,32 +1269,318 @@ Database::getInventory(int page, int pageSize, const std::string& search)
         throw;
         
     } catch (const std::exception& e) {
-        log("库存查询异常: " + std::string(e.what()), true);
+        GT_LOG_ERROR("库存查询异常: " + std::string(e.what()));
         throw;
     }
 }
 
 
-// 按物品ID获取库存信息
-std::vector<std::map<std::string, std::string>> Database::getInventoryByItemId(int itemId) {
-    ensureConnected(); // 确保连接有效
-    std::string query = 
-        "SELECT i.id AS inventory_id, i.item_id, il.name AS item_name, "
-        "i.quantity, i.location, i.stored_time, i.last_updated "
-        "FROM inventory i "
-        "JOIN item_list il ON i.item_id = il.id "
-        "WHERE i.item_id = " + std::to_string(itemId) + " "
-        "ORDER BY i.last_updated DESC";
-    
-    return executeQuery(query);
-}
+// 键集分页的库存查询
+Database::KeysetPage<Database::InventoryItem>
+Database::getInventoryByCursor(const PageCursor& cursor, bool backward,
+                               int pageSize, const std::string& search)
+{
+    TRACE_SPAN("Database::getInventoryByCursor");
+    bool hasCursor = cursor.valid();
+    if (!hasCursor) {
+        backward = false; // 没有游标时总是从第一页开始
+    }
 
-// 安全获取值的辅助函数
-std::string Database::safeGet(const std::map<std::string, std::string>& data, 
-                             const std::string& key, 
-                             const std::string& defaultValue) {
-    // 尝试别名映射
-    static const std::map<std::string, std::string> aliasMap = {
+    // 有搜索词且索引可用时，由索引直接给出这一页的 id
+    if (!search.empty()) {
+        SearchIndex::PageRequest request;
+        request.limit = pageSize + 1;
+        request.cursor = hasCursor ? &cursor : nullptr;
+        request.backward = backward;
+        std::vector<int> ids;
+        if (SearchIndex::instance().findPage(SearchIndex::INVENTORY, search, request, ids)) {
+            return buildKeysetPage(inventoryByIds(ids), pageSize, backward, hasCursor);
+        }
+    }
+
+    InventoryEngine& engine = InventoryEngine::instance();
+    if (engine.serving()) {
+        SearchIndex::PageRequest request;
+        request.limit = static_cast<size_t>(std::max(0, pageSize)) + 1;
+        request.cursor = hasCursor ? &cursor : nullptr;
+        request.backward = backward;
+        return buildKeysetPage(toInventoryItems(engine.page(request, inventoryMatch(search))),
+                               pageSize, backward, hasCursor);
+    }
+
+    ensureConnected();
+
+    std::string query = kInventorySelect;
+
+    std::vector<std::string> conditions;
+    if (!search.empty()) {
+        conditions.push_back("(il.name LIKE ? OR i.location LIKE ?)");
+    }
+    if (hasCursor) {
+        // 行值比较可以直接利用 (last_updated, id) 索引定位起点，无需跳过前面的行
+        conditions.push_back(backward ? "(i.last_updated, i.id) > (?, ?)"
+                                      : "(i.last_updated, i.id) < (?, ?)");
+    }
+    for (size_t i = 0; i < conditions.size(); ++i) {
+        query += (i == 0 ? "WHERE " : "AND ") + conditions[i] + " ";
+    }
+    query += backward ? "ORDER BY i.last_updated ASC, i.id ASC LIMIT ?"
+                      : "ORDER BY i.last_updated DESC, i.id DESC LIMIT ?";
+
+    GT_LOG_DEBUG("执行键集分页查询: " + query);
+
+    try {
+        StorageStatement* pstmt = prepare(query);
+        int paramIndex = 1;
+        if (!search.empty()) {
+            std::string likePattern = "%" + search + "%";
+            pstmt->setString(paramIndex++, likePattern);
+            pstmt->setString(paramIndex++, likePattern);
+        }
+        if (hasCursor) {
+            pstmt->setString(paramIndex++, cursor.sortTime);
+            pstmt->setInt64(paramIndex++, cursor.id);
+        }
+        pstmt->setInt(paramIndex++, pageSize + 1); // 多取一行用于判断是否还有下一页
+
+        std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+        ResultTable table;
+        table.load(res.get(), pageSize + 1);
+        auto page = buildKeysetPage(toInventoryItems(table), pageSize, backward, hasCursor);
+        GT_LOG_DEBUG("获取 " + std::to_string(page.rows.size()) + " 条库存记录（键集分页）");
+        return page;
+
+    } catch (StorageError &e) {
+        std::ostringstream errorMsg;
+        errorMsg << "库存键集分页查询错误 [MySQL错误 " << e.getErrorCode() << "]: "
+                 << e.what() << "\nSQL状态: " << e.getSQLState();
+        GT_LOG_ERROR(errorMsg.str());
+
+        if (e.getErrorCode() == 2013 || e.getErrorCode() == 2006) {
+            GT_LOG_INFO("检测到连接丢失，尝试重新连接...");
+            disconnect();
+            connect();
+        }
+        throw;
+    }
+}
+
+
+// 批量导出库存。内存库存引擎可用时沿 (last_updated, id) 索引分段读取（每段单独加读锁），
+// 否则每段执行一次键集查询
+std::vector<Database::InventoryItem>
+Database::exportInventory(const ExportFilter& filter, PageCursor& after, int limit, bool& done)
+{
+    TRACE_SPAN("Database::exportInventory");
+    limit = std::max(1, limit);
+    done = false;
+    std::vector<InventoryItem> rows;
+
+    InventoryEngine& engine = InventoryEngine::instance();
+    if (engine.serving()) {
+        InventoryEngine::Match match = inventoryMatch(filter.search);
+        while (rows.size() < static_cast<size_t>(limit)) {
+            // 第一段从时间下限开始：id 从 1 起，(from, 0) 之后的键正好是 last_updated >= from 的行
+            PageCursor start = after;
+            if (!start.valid() && !filter.from.empty()) {
+                start.sortTime = filter.from;
+                start.id = 0;
+            }
+            SearchIndex::PageRequest request;
+            request.limit = static_cast<size_t>(limit);
+            request.cursor = start.sortTime.empty() ? nullptr : &start;
+            request.backward = true; // 升序
+            std::vector<InventoryEngine::Row> page = engine.page(request, InventoryEngine::Match());
+            for (const auto& row : page) {
+                if (!filter.to.empty() && row.lastUpdated > filter.to) {
+                    done = true;
+                    break;
+                }
+                after.sortTime = row.lastUpdated;
+                after.id = row.id;
+                if ((filter.itemId > 0 && row.itemId != filter.itemId) ||
+                    (!filter.location.empty() && row.location != filter.location) ||
+                    (!match.empty() && !match.item(row.itemId) && !match.location(row.location))) {
+                    continue;
+                }
+                rows.push_back(toInventoryItem(row));
+            }
+            if (done || page.size() < request.limit) {
+                done = true;
+                break;
+            }
+        }
+        return rows;
+    }
+
+    ensureConnected();
+
+    std::string query = kInventorySelect;
+    std::vector<std::string> conditions;
+    if (!filter.search.empty()) {
+        conditions.push_back("(il.name LIKE ? OR i.location LIKE ?)");
+    }
+    if (filter.itemId > 0) {
+        conditions.push_back("i.item_id = ?");
+    }
+    if (!filter.location.empty()) {
+        conditions.push_back("i.location = ?");
+    }
+    if (after.valid()) {
+        conditions.push_back("(i.last_updated, i.id) > (?, ?)");
+    } else if (!filter.from.empty()) {
+        conditions.push_back("i.last_updated >= ?");
+    }
+    if (!filter.to.empty()) {
+        conditions.push_back("i.last_updated <= ?");
+    }
+    for (size_t i = 0; i < conditions.size(); ++i) {
+        query += (i == 0 ? "WHERE " : "AND ") + conditions[i] + " ";
+    }
+    query += "ORDER BY i.last_updated ASC, i.id ASC LIMIT ?";
+
+    try {
+        StorageStatement* pstmt = prepare(query);
+        int paramIndex = 1;
+        if (!filter.search.empty()) {
+            std::string likePattern = "%" + filter.search + "%";
+            pstmt->setString(paramIndex++, likePattern);
+            pstmt->setString(paramIndex++, likePattern);
+        }
+        if (filter.itemId > 0) {
+            pstmt->setInt(paramIndex++, filter.itemId);
+        }
+        if (!filter.location.empty()) {
+            pstmt->setString(paramIndex++, filter.location);
+        }
+        if (after.valid()) {
+            pstmt->setString(paramIndex++, after.sortTime);
+            pstmt->setInt64(paramIndex++, after.id);
+        } else if (!filter.from.empty()) {
+            pstmt->setString(paramIndex++, filter.from);
+        }
+        if (!filter.to.empty()) {
+            pstmt->setString(paramIndex++, filter.to);
+        }
+        pstmt->setInt(paramIndex++, limit);
+
+        std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+        ResultTable table;
+        table.load(res.get(), limit);
+        rows = toInventoryItems(table);
+    } catch (StorageError& e) {
+        GT_LOG_ERROR("库存导出查询错误 [" + std::to_string(e.getErrorCode()) + "]: " + e.what());
+        throw;
+    }
+
+    done = rows.size() < static_cast<size_t>(limit);
+    if (!rows.empty()) {
+        after.sortTime = rows.back().sort_time;
+        after.id = rows.back().id;
+    }
+    return rows;
+}
+
+// 批量导出操作日志（延迟写入队列中尚未写入数据库的记录不包含在内）
+std::vector<Database::OperationLogEntry>
+Database::exportOperationLogs(const ExportFilter& filter, PageCursor& after, int limit, bool& done)
+{
+    TRACE_SPAN("Database::exportOperationLogs");
+    limit = std::max(1, limit);
+    ensureConnected();
+
+    std::string query = kOperationLogSelect;
+    std::vector<std::string> conditions;
+    if (!filter.search.empty()) {
+        conditions.push_back("(operation_type LIKE ? OR item_name LIKE ? OR operation_note LIKE ?)");
+    }
+    if (!filter.operationType.empty()) {
+        conditions.push_back("operation_type = ?");
+    }
+    if (after.valid()) {
+        conditions.push_back("(operation_time, id) > (?, ?)");
+    } else if (!filter.from.empty()) {
+        conditions.push_back("operation_time >= ?");
+    }
+    if (!filter.to.empty()) {
+        conditions.push_back("operation_time <= ?");
+    }
+    for (size_t i = 0; i < conditions.size(); ++i) {
+        query += (i == 0 ? "WHERE " : "AND ") + conditions[i] + " ";
+    }
+    query += "ORDER BY operation_time ASC, id ASC LIMIT ?";
+
+    std::vector<OperationLogEntry> rows;
+    try {
+        StorageStatement* pstmt = prepare(query);
+        int paramIndex = 1;
+        if (!filter.search.empty()) {
+            std::string likePattern = "%" + filter.search + "%";
+            for (int k = 0; k < 3; ++k) {
+                pstmt->setString(paramIndex++, likePattern);
+            }
+        }
+        if (!filter.operationType.empty()) {
+            pstmt->setString(paramIndex++, filter.operationType);
+        }
+        if (after.valid()) {
+            pstmt->setString(paramIndex++, after.sortTime);
+            pstmt->setInt64(paramIndex++, after.id);
+        } else if (!filter.from.empty()) {
+            pstmt->setString(paramIndex++, filter.from);
+        }
+        if (!filter.to.empty()) {
+            pstmt->setString(paramIndex++, filter.to);
+        }
+        pstmt->setInt(paramIndex++, limit);
+
+        std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+        ResultTable table;
+        table.load(res.get(), limit);
+        rows = toOperationLogEntries(table);
+    } catch (StorageError& e) {
+        GT_LOG_ERROR("操作日志导出查询错误 [" + std::to_string(e.getErrorCode()) + "]: " + e.what());
+        throw;
+    }
+
+    done = rows.size() < static_cast<size_t>(limit);
+    if (!rows.empty()) {
+        after.sortTime = rows.back().sort_time;
+        after.id = rows.back().id;
+    }
+    return rows;
+}
+
+
+// 按物品ID获取库存信息
+std::vector<std::map<std::string, std::string>> Database::getInventoryByItemId(int itemId) {
+    TRACE_SPAN("Database::getInventoryByItemId");
+    InventoryEngine& engine = InventoryEngine::instance();
+    if (engine.serving()) {
+        std::vector<std::map<std::string, std::string>> result;
+        for (const auto& row : engine.byItem(itemId)) {
+            result.push_back(toInventoryMap(row));
+        }
+        return result;
+    }
+    ensureConnected(); // 确保连接有效
+    std::string query = 
+        "SELECT i.id AS inventory_id, i.item_id, il.name AS item_name, "
+        "i.quantity, i.location, i.stored_time, i.last_updated "
+        "FROM inventory i "
+        "JOIN item_list il ON i.item_id = il.id "
+        "WHERE i.item_id = " + std::to_string(itemId) + " "
+        "ORDER BY i.last_updated DESC";
+    
+    return executeQuery(query);
+}
+
+// 安全获取值的辅助函数
+std::string Database::safeGet(const std::map<std::string, std::string>& data, 
+                             const std::string& key, 
+                             const std::string& defaultValue) {
+    // 尝试别名映射
+    static const std::map<std::string, std::string> aliasMap = {
         {"inventory_id", "id"},
         {"item_name", "name"}
     };
@@ -922,250 +1625,1038 @@ std::string Database::safeGet(const std::map<std::string, std::string>& data,
 // 更新库存项目
 bool Database::updateInventoryItem(int inventoryId, int newQuantity, const std::string& newLocation,
                                   const std::string& operationReason) {
-    ensureConnected(); // 确保连接有效
-    log("Updating inventory item ID: " + std::to_string(inventoryId));
+    TRACE_SPAN("Database::updateInventoryItem");
+    GT_LOG_DEBUG("Updating inventory item ID: " + std::to_string(inventoryId));
     if (inventoryId <= 0) {
-        log("错误：无效的库存ID: " + std::to_string(inventoryId), true);
+        GT_LOG_ERROR("错误：无效的库存ID: " + std::to_string(inventoryId));
         return false;
     }
-    if (!con || con->isClosed()) {
-        log("Connection closed, attempting to reconnect...");
-        if (!connect()) {
-            log("Failed to connect for updateInventoryItem", true);
-            return false;
+    InventoryOperation op;
+    op.type = InventoryOperation::UPDATE;
+    op.inventoryId = inventoryId;
+    op.quantity = newQuantity;
+    op.location = newLocation;
+    op.reason = operationReason;
+    return applySingleInventoryOperation(op, "Update");
+}
+
+// 删除库存项目
+bool Database::deleteInventoryItem(int inventoryId, const std::string& operationReason) {
+    TRACE_SPAN("Database::deleteInventoryItem");
+    GT_LOG_DEBUG("Deleting inventory item ID: " + std::to_string(inventoryId));
+    if (inventoryId <= 0) {
+        GT_LOG_ERROR("错误：无效的库存ID: " + std::to_string(inventoryId));
+        return false;
+    }
+    InventoryOperation op;
+    op.type = InventoryOperation::REMOVE;
+    op.inventoryId = inventoryId;
+    op.reason = operationReason;
+    return applySingleInventoryOperation(op, "Delete");
+}
+
+// 获取单个库存项目
+std::vector<std::map<std::string, std::string>> Database::getInventoryItemById(int inventoryId) {
+    TRACE_SPAN("Database::getInventoryItemById");
+    if (inventoryId <= 0) {
+        GT_LOG_ERROR("无效的库存ID: " + std::to_string(inventoryId));
+        return {};
+    }
+    std::vector<std::map<std::string, std::string>> result;
+    InventoryEngine& engine = InventoryEngine::instance();
+    InventoryEngine::Row row;
+    if (engine.serving()) {
+        if (engine.find(inventoryId, row)) {
+            result.push_back(toInventoryMap(row));
         }
+    } else {
+        ensureConnected(); // 确保连接有效
+        try {
+            StorageStatement* pstmt = prepare(
+                "SELECT i.id AS inventory_id, i.item_id, il.name AS item_name, "
+                "i.quantity, i.location, i.stored_time, i.last_updated "
+                "FROM inventory i "
+                "JOIN item_list il ON i.item_id = il.id "
+                "WHERE i.id = ?");
+            pstmt->setInt(1, inventoryId);
+            std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+            result = parseResultSet(res.get());
+        } catch (StorageError &e) {
+            GT_LOG_ERROR("MySQL Error in getInventoryItemById: " + std::string(e.what()));
+            return {};
+        }
+    }
+    
+    // 添加结果验证
+    if (result.empty()) {
+        GT_LOG_ERROR("未找到库存项目: " + std::to_string(inventoryId));
+    } else {
+        GT_LOG_DEBUG("找到库存项目: " + std::to_string(inventoryId));
     }
     
+    return result;
+}
+
+// ====== 批量库存操作 ======
+
+// 库存行在本批次中的状态：执行前读入，之后按操作顺序推演，
+// 同一行的多次修改在日志中依次体现，最终只写一次
+struct InventoryRowState {
+    std::string itemName;
+    int quantity = 0;
+    std::string location;
+    bool exists = true;
+    bool changed = false;
+};
+
+// 按顺序校验每个操作、推演行状态并生成日志（数据库和内存引擎两种写入方式共用）。
+// addOps 为通过校验的新增操作的下标；有操作失败时返回 true
+static bool planInventoryBatch(const std::vector<Database::InventoryOperation>& ops,
+                               std::unordered_map<int, InventoryRowState>& rows,
+                               const std::unordered_map<int, std::string>& itemNames,
+                               std::vector<Database::InventoryOperationResult>& results,
+                               std::vector<size_t>& addOps,
+                               std::vector<OperationLogQueue::Entry>& logs) {
+    typedef Database::InventoryOperation InventoryOperation;
+    bool failed = false;
+    for (size_t i = 0; i < ops.size(); ++i) {
+        const InventoryOperation& op = ops[i];
+        Database::InventoryOperationResult& result = results[i];
+        std::string reasonNote = op.reason.empty() ? " | 原因: 未提供" : " | 原因: " + op.reason;
+
+        if (op.type != InventoryOperation::REMOVE && op.quantity < 0) {
+            result.error = "数量不能为负数";
+        } else if (op.type == InventoryOperation::ADD) {
+            auto nameIt = itemNames.find(op.itemId);
+            if (nameIt == itemNames.end()) {
+                result.error = "物品不存在: " + std::to_string(op.itemId);
+            } else {
+                addOps.push_back(i);
+                std::string note = "数量: " + std::to_string(op.quantity) + ", 位置: " + op.location;
+                if (!op.reason.empty()) {
+                    note += " | 原因: " + op.reason;
+                }
+                logs.push_back(logEntry("ADD", nameIt->second, note));
+            }
+        } else {
+            auto rowIt = rows.find(op.inventoryId);
+            if (rowIt == rows.end() || !rowIt->second.exists) {
+                result.error = "库存项目不存在: " + std::to_string(op.inventoryId);
+            } else if (op.type == InventoryOperation::UPDATE) {
+                InventoryRowState& row = rowIt->second;
+                std::string note = "数量: " + std::to_string(row.quantity) + "→" +
+                                   std::to_string(op.quantity) +
+                                   ", 位置: " + row.location + "→" + op.location + reasonNote;
+                logs.push_back(logEntry("UPDATE", row.itemName, note));
+                row.quantity = op.quantity;
+                row.location = op.location;
+                row.changed = true;
+                result.inventoryId = op.inventoryId;
+            } else {
+                InventoryRowState& row = rowIt->second;
+                std::string note = "数量: " + std::to_string(row.quantity) +
+                                   ", 位置: " + row.location + reasonNote;
+                logs.push_back(logEntry("DELETE", row.itemName, note));
+                row.exists = false;
+                result.inventoryId = op.inventoryId;
+            }
+        }
+
+        if (result.error.empty()) {
+            result.success = true;
+        } else {
+            failed = true;
+        }
+    }
+    return failed;
+}
+
+// atomic 批次中有操作校验失败：把通过校验的操作也标记为未执行
+static void cancelInventoryBatch(std::vector<Database::InventoryOperationResult>& results) {
+    for (auto& result : results) {
+        if (result.success) {
+            result.success = false;
+            result.inventoryId = 0;
+            result.error = "同批次中有操作失败，未执行";
+        }
+    }
+    GT_LOG_WARNING("批量库存操作校验失败，已全部取消");
+}
+
+// 物品 id → 名称，优先使用物品目录，目录中没有的再查询数据库
+std::unordered_map<int, std::string> Database::resolveItemNames(const std::vector<int>& itemIds) {
+    TRACE_SPAN("Database::resolveItemNames");
+    std::unordered_map<int, std::string> itemNames;
+    std::vector<int> unknownItems;
+    for (int itemId : itemIds) {
+        std::string name;
+        if (ItemCatalog::instance().nameOf(itemId, name)) {
+            itemNames[itemId] = name;
+        } else if (itemId > 0) {
+            unknownItems.push_back(itemId);
+        }
+    }
+    std::sort(unknownItems.begin(), unknownItems.end());
+    unknownItems.erase(std::unique(unknownItems.begin(), unknownItems.end()), unknownItems.end());
+    if (!unknownItems.empty()) {
+        ensureConnected();
+    }
+    for (size_t begin = 0; begin < unknownItems.size(); begin += kBatchChunkRows) {
+        std::vector<int> chunk(unknownItems.begin() + begin,
+                               unknownItems.begin() + std::min(unknownItems.size(), begin + kBatchChunkRows));
+        StorageStatement* pstmt = prepare(
+            "SELECT id, name FROM item_list WHERE id IN (" + idPlaceholders(chunk.size()) + ")");
+        bindIds(pstmt, 1, chunk);
+        std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+        while (res->next()) {
+            itemNames[res->getInt(1)] = res->getString(2);
+        }
+    }
+    return itemNames;
+}
+
+bool Database::applyInventoryBatch(const std::vector<InventoryOperation>& ops, bool atomic,
+                                   std::vector<InventoryOperationResult>& results) {
+    TRACE_SPAN("Database::applyInventoryBatch");
+    results.assign(ops.size(), InventoryOperationResult());
+    if (ops.empty()) {
+        return true;
+    }
+    InventoryEngine& engine = InventoryEngine::instance();
+    if (engine.mode() == InventoryEngine::PRIMARY) {
+        return applyInventoryBatchToEngine(ops, atomic, results);
+    }
+    ensureConnected();
+    GT_LOG_DEBUG("Applying inventory batch: " + std::to_string(ops.size()) + " operations");
+    if (!con || con->isClosed()) {
+        GT_LOG_ERROR("Failed to connect for applyInventoryBatch");
+        for (auto& result : results) {
+            result.error = "无法连接数据库";
+        }
+        return false;
+    }
+
     try {
-        // 获取当前库存信息用于日志记录
-        log("查询库存项目 ID: " + std::to_string(inventoryId));
-        auto currentItem = getInventoryItemById(inventoryId);
-        if (currentItem.empty()) {
-            log("Inventory item not found: " + std::to_string(inventoryId), true);
-            return false;
+        Transaction tx(con.get());
+
+        // 1. 锁定要修改/删除的库存行，读取旧值用于校验和日志
+        std::vector<int> lockIds;
+        std::vector<int> addItemIds;
+        for (const auto& op : ops) {
+            if (op.type == InventoryOperation::ADD) {
+                addItemIds.push_back(op.itemId);
+            } else if (op.inventoryId > 0) {
+                lockIds.push_back(op.inventoryId);
+            }
         }
-        
-        std::string itemName = safeGet(currentItem[0], "item_name", "未知物品");
-        std::string oldLocation = safeGet(currentItem[0], "location", "未知位置");
-        // 安全获取旧数量
-        int oldQuantity = 0;
+        std::sort(lockIds.begin(), lockIds.end());
+        lockIds.erase(std::unique(lockIds.begin(), lockIds.end()), lockIds.end());
+
+        std::unordered_map<int, InventoryRowState> rows;
+        for (size_t begin = 0; begin < lockIds.size(); begin += kBatchChunkRows) {
+            std::vector<int> chunk(lockIds.begin() + begin,
+                                   lockIds.begin() + std::min(lockIds.size(), begin + kBatchChunkRows));
+            StorageStatement* pstmt = prepare(
+                "SELECT i.id, il.name, i.quantity, i.location "
+                "FROM inventory i JOIN item_list il ON i.item_id = il.id "
+                "WHERE i.id IN (" + idPlaceholders(chunk.size()) + ")" + con->lockClause());
+            bindIds(pstmt, 1, chunk);
+            std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+            while (res->next()) {
+                InventoryRowState& row = rows[res->getInt(1)];
+                row.itemName = res->getString(2);
+                row.quantity = res->getInt(3);
+                row.location = res->getString(4);
+            }
+        }
+
+        // 2. 新增操作的物品名称（优先使用物品目录）
+        std::unordered_map<int, std::string> itemNames = resolveItemNames(addItemIds);
+
+        // 3. 按顺序校验每个操作并生成日志
+        std::vector<size_t> addOps;
+        std::vector<OperationLogQueue::Entry> logs;
+        bool failed = planInventoryBatch(ops, rows, itemNames, results, addOps, logs);
+        if (failed && atomic) {
+            cancelInventoryBatch(results);
+            return false; // tx 析构时回滚，释放行锁
+        }
+        // 4. 新增：多行 INSERT。InnoDB 和 SQLite（事务内独占写入）都为一条多行 INSERT
+        //    按固定间隔分配自增值：firstInsertId() 为第一行的 id，相邻两行相差 insertIdStep()
+        std::vector<int> addedIds;
+        size_t addPos = 0;
+        for (size_t chunk : batchChunks(addOps.size())) {
+            StorageStatement* pstmt = prepare(
+                "INSERT INTO inventory (item_id, quantity, location) VALUES " +
+                repeatTuple("(?, ?, ?)", chunk));
+            for (size_t k = 0; k < chunk; ++k) {
+                const InventoryOperation& op = ops[addOps[addPos + k]];
+                int base = static_cast<int>(k * 3);
+                pstmt->setInt(base + 1, op.itemId);
+                pstmt->setInt(base + 2, op.quantity);
+                pstmt->setString(base + 3, op.location);
+            }
+            pstmt->executeUpdate();
+            long long firstId = con->firstInsertId(chunk);
+            long long step = con->insertIdStep();
+            for (size_t k = 0; k < chunk; ++k) {
+                int id = static_cast<int>(firstId + static_cast<long long>(k) * step);
+                results[addOps[addPos + k]].inventoryId = id;
+                addedIds.push_back(id);
+            }
+            addPos += chunk;
+        }
+
+        // 5. 修改：UPDATE ... CASE 一次写入多行的最终值
+        std::vector<int> updatedIds;
+        std::vector<int> removedIds;
+        for (const auto& entry : rows) {
+            if (!entry.second.exists) {
+                removedIds.push_back(entry.first);
+            } else if (entry.second.changed) {
+                updatedIds.push_back(entry.first);
+            }
+        }
+        std::sort(updatedIds.begin(), updatedIds.end());
+        std::sort(removedIds.begin(), removedIds.end());
+
+        size_t updatePos = 0;
+        for (size_t chunk : batchChunks(updatedIds.size())) {
+            StorageStatement* pstmt = prepare(
+                "UPDATE inventory SET "
+                "quantity = CASE id " + repeatTuple("WHEN ? THEN ?", chunk, " ") + " END, "
+                "location = CASE id " + repeatTuple("WHEN ? THEN ?", chunk, " ") + " END "
+                "WHERE id IN (" + repeatTuple("?", chunk, ",") + ")");
+            int index = 1;
+            for (size_t k = 0; k < chunk; ++k) {
+                int id = updatedIds[updatePos + k];
+                pstmt->setInt(index++, id);
+                pstmt->setInt(index++, rows[id].quantity);
+            }
+            for (size_t k = 0; k < chunk; ++k) {
+                int id = updatedIds[updatePos + k];
+                pstmt->setInt(index++, id);
+                pstmt->setString(index++, rows[id].location);
+            }
+            for (size_t k = 0; k < chunk; ++k) {
+                pstmt->setInt(index++, updatedIds[updatePos + k]);
+            }
+            pstmt->executeUpdate();
+            updatePos += chunk;
+        }
+
+        // 6. 删除
+        for (size_t begin = 0; begin < removedIds.size(); begin += kBatchChunkRows) {
+            std::vector<int> chunk(removedIds.begin() + begin,
+                                   removedIds.begin() + std::min(removedIds.size(), begin + kBatchChunkRows));
+            StorageStatement* pstmt = prepare(
+                "DELETE FROM inventory WHERE id IN (" + idPlaceholders(chunk.size()) + ")");
+            bindIds(pstmt, 1, chunk);
+            pstmt->executeUpdate();
+        }
+
+        // 7. 操作日志：与数据变更在同一事务中写入；开启延迟写入时提交后再入队
+        bool deferLogs = OperationLogQueue::instance().enabled();
+        std::vector<int> logIds;
+        if (!deferLogs) {
+            logIds = insertOperationLogRows(logs);
+        }
+
+        tx.commit();
+        GT_LOG_INFO("批量库存操作完成: 新增 " + std::to_string(addedIds.size()) +
+                    ", 修改 " + std::to_string(updatedIds.size()) +
+                    ", 删除 " + std::to_string(removedIds.size()));
+
+        // 8. 提交后同步计数缓存、内存库存缓存和搜索索引
+        inventoryWritten(logs, logIds, deferLogs, addedIds, updatedIds, removedIds);
+        return !failed;
+    } catch (StorageError &e) {
+        GT_LOG_ERROR("MySQL Error in applyInventoryBatch [" + std::to_string(e.getErrorCode()) + "]: " + e.what());
+        for (auto& result : results) {
+            result.success = false;
+            result.inventoryId = 0;
+            result.error = "数据库错误，批次已回滚";
+        }
+        return false;
+    }
+}
+
+// 库存写入提交后的公共收尾：计数缓存、数据版本、操作日志入队或计数、内存库存缓存、搜索索引和实时事件
+void Database::inventoryWritten(const std::vector<OperationLogQueue::Entry>& logs, std::vector<int>& logIds,
+                                bool deferLogs, const std::vector<int>& addedIds,
+                                const std::vector<int>& updatedIds, const std::vector<int>& removedIds) {
+    InventoryEngine& engine = InventoryEngine::instance();
+    if (!addedIds.empty() || !updatedIds.empty() || !removedIds.empty()) {
+        CountService::instance().adjust(CountService::INVENTORY,
+            static_cast<long long>(addedIds.size()) - static_cast<long long>(removedIds.size()));
+        DataVersion::instance().bump(DataVersion::INVENTORY);
+    }
+    if (deferLogs && !logs.empty()) {
+        DataVersion::instance().bump(DataVersion::OPERATION_LOG);
+    }
+    if (deferLogs && !OperationLogQueue::instance().enqueue(logs)) {
+        // 队列已满：退回同步写入（数据已提交，日志单独写入）
+        writeOperationLogs(logs, &logIds);
+    } else if (!deferLogs) {
+        operationLogsWritten(logs.size(), logIds);
+    }
+    publishOperationLogEvent(logs, logIds);
+    std::vector<int> changedIds = addedIds;
+    changedIds.insert(changedIds.end(), updatedIds.begin(), updatedIds.end());
+    if (engine.mode() == InventoryEngine::CACHE && engine.ready()) {
+        syncInventoryCache(changedIds, removedIds);
+    }
+    // 搜索索引和实时事件都需要写入后的行（更新时间由数据库生成）
+    SearchIndex& index = SearchIndex::instance();
+    bool publish = EventBus::instance().hasSubscribers();
+    if (index.tracking() || publish) {
         try {
-            if (currentItem[0].count("quantity")) {
-                oldQuantity = std::stoi(currentItem[0]["quantity"]);
+            std::unordered_set<int> added(addedIds.begin(), addedIds.end());
+            std::vector<InventoryItem> addedRows;
+            std::vector<InventoryItem> updatedRows;
+            for (size_t begin = 0; begin < changedIds.size(); begin += kBatchChunkRows) {
+                std::vector<int> chunk(changedIds.begin() + begin,
+                                       changedIds.begin() + std::min(changedIds.size(), begin + kBatchChunkRows));
+                for (auto& item : inventoryByIds(chunk)) {
+                    if (index.tracking()) {
+                        index.upsert(SearchIndex::INVENTORY, toSearchDocument(item));
+                    }
+                    if (publish) {
+                        (added.count(item.id) ? addedRows : updatedRows).push_back(std::move(item));
+                    }
+                }
             }
-        } catch (const std::exception& e) {
-            log("转换旧数量失败: " + std::string(e.what()), true);
+            if (index.tracking()) {
+                for (int id : removedIds) {
+                    index.remove(SearchIndex::INVENTORY, id);
+                }
+            }
+            if (publish) {
+                publishInventoryEvent(addedRows, updatedRows, removedIds);
+            }
+        } catch (StorageError &e) {
+            GT_LOG_WARNING("批量操作后更新搜索索引失败: " + std::string(e.what()));
         }
-        std::unique_ptr<sql::PreparedStatement> pstmt(
-            con->prepareStatement(
-                "UPDATE inventory SET quantity = ?, location = ? "
-                "WHERE id = ?"
-            )
-        );
-        
-        pstmt->setInt(1, newQuantity);
-        pstmt->setString(2, newLocation);
-        pstmt->setInt(3, inventoryId);
-        
-        int result = pstmt->executeUpdate();
-        if (result > 0) {
-            // 修改日志记录，添加变化详情和操作原因
-            std::string opNote = "数量: " + std::to_string(oldQuantity) + "→" + 
-                                std::to_string(newQuantity) + 
-                                ", 位置: " + oldLocation + "→" + newLocation;
-            
-            // 确保操作原因不为空
-            if (operationReason.empty()) {
-                opNote += " | 原因: 未提供";
-            } else {
-                opNote += " | 原因: " + operationReason;
+    }
+}
+
+// 单条新增/修改/删除：不走批量路径的 IN 列表加锁和 UPDATE ... CASE，
+// 事务内只有一次单行加锁读取（新增时没有）、一条单行写入和一条日志 INSERT。
+// 加锁读取（MySQL 为 SELECT ... FOR UPDATE，SQLite 在事务开始时已取得写锁）保证
+// 日志中的旧值就是被修改前的值，不会与并发写入交错
+bool Database::applySingleInventoryOperation(const InventoryOperation& op, const char* action) {
+    TRACE_SPAN("Database::applySingleInventoryOperation");
+    int targetId = op.type == InventoryOperation::ADD ? op.itemId : op.inventoryId;
+    std::vector<InventoryOperationResult> results(1);
+    if (InventoryEngine::instance().mode() == InventoryEngine::PRIMARY) {
+        if (applyInventoryBatchToEngine({op}, true, results)) {
+            return true;
+        }
+        GT_LOG_ERROR(std::string(action) + " inventory item failed. ID: " + std::to_string(targetId) +
+                     " - " + results[0].error);
+        return false;
+    }
+    ensureConnected();
+    if (!con || con->isClosed()) {
+        GT_LOG_ERROR(std::string(action) + " inventory item failed: 无法连接数据库");
+        return false;
+    }
+
+    try {
+        Transaction tx(con.get());
+
+        // 1. 修改/删除锁定目标行并读取旧值；新增只需要物品名称
+        std::unordered_map<int, InventoryRowState> rows;
+        std::unordered_map<int, std::string> itemNames;
+        if (op.type == InventoryOperation::ADD) {
+            itemNames = resolveItemNames({op.itemId});
+        } else {
+            StorageStatement* pstmt = prepare(
+                std::string("SELECT il.name, i.quantity, i.location "
+                            "FROM inventory i JOIN item_list il ON i.item_id = il.id "
+                            "WHERE i.id = ?") + con->lockClause());
+            pstmt->setInt(1, op.inventoryId);
+            std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+            if (res->next()) {
+                InventoryRowState& row = rows[op.inventoryId];
+                row.itemName = res->getString(1);
+                row.quantity = res->getInt(2);
+                row.location = res->getString(3);
             }
-            
-            logOperation("UPDATE", itemName, opNote);
+        }
+
+        // 2. 校验并生成日志（与批量路径共用）
+        std::vector<size_t> addOps;
+        std::vector<OperationLogQueue::Entry> logs;
+        if (planInventoryBatch({op}, rows, itemNames, results, addOps, logs)) {
+            GT_LOG_ERROR(std::string(action) + " inventory item failed. ID: " + std::to_string(targetId) +
+                         " - " + results[0].error);
+            return false; // tx 析构时回滚，释放行锁
+        }
+
+        // 3. 单行写入
+        std::vector<int> addedIds;
+        std::vector<int> updatedIds;
+        std::vector<int> removedIds;
+        if (op.type == InventoryOperation::ADD) {
+            StorageStatement* pstmt = prepare(
+                "INSERT INTO inventory (item_id, quantity, location) VALUES (?, ?, ?)");
+            pstmt->setInt(1, op.itemId);
+            pstmt->setInt(2, op.quantity);
+            pstmt->setString(3, op.location);
+            pstmt->executeUpdate();
+            addedIds.push_back(static_cast<int>(con->firstInsertId(1)));
+        } else if (op.type == InventoryOperation::UPDATE) {
+            StorageStatement* pstmt = prepare(
+                "UPDATE inventory SET quantity = ?, location = ? WHERE id = ?");
+            pstmt->setInt(1, op.quantity);
+            pstmt->setString(2, op.location);
+            pstmt->setInt(3, op.inventoryId);
+            pstmt->executeUpdate();
+            updatedIds.push_back(op.inventoryId);
+        } else {
+            StorageStatement* pstmt = prepare("DELETE FROM inventory WHERE id = ?");
+            pstmt->setInt(1, op.inventoryId);
+            pstmt->executeUpdate();
+            removedIds.push_back(op.inventoryId);
+        }
+
+        // 4. 操作日志与数据变更在同一事务中写入；开启延迟写入时提交后再入队
+        bool deferLogs = OperationLogQueue::instance().enabled();
+        std::vector<int> logIds;
+        if (!deferLogs) {
+            logIds = insertOperationLogRows(logs);
+        }
+        tx.commit();
+
+        inventoryWritten(logs, logIds, deferLogs, addedIds, updatedIds, removedIds);
+        return true;
+    } catch (StorageError &e) {
+        GT_LOG_ERROR(std::string(action) + " inventory item failed. ID: " + std::to_string(targetId) +
+                     " [" + std::to_string(e.getErrorCode()) + "]: " + e.what());
+        return false;
+    }
+}
+
+// 导入时按名称匹配物品：与 MySQL 默认排序规则和 SQLite 的 NOCASE 一致，ASCII 字母不区分大小写
+static std::string nameKey(const std::string& name) {
+    std::string key = name;
+    std::transform(key.begin(), key.end(), key.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return key;
+}
+
+// 批量导入物品：一个事务内查出已存在的名称，其余用多行 INSERT 创建，操作日志在同一事务中写入
+bool Database::importItems(const std::vector<ImportItem>& items, const std::string& reason,
+                           std::vector<int>& itemIds, size_t& created) {
+    TRACE_SPAN("Database::importItems");
+    itemIds.assign(items.size(), 0);
+    created = 0;
+    if (items.empty()) {
+        return true;
+    }
+    ensureConnected();
+    if (!con || con->isClosed()) {
+        GT_LOG_ERROR("Failed to connect for importItems");
+        return false;
+    }
+
+    // 同名的项只处理第一次出现的
+    std::unordered_map<std::string, int> ids;
+    std::vector<std::string> names;
+    for (const auto& item : items) {
+        if (ids.emplace(nameKey(item.name), 0).second) {
+            names.push_back(item.name);
+        }
+    }
+
+    try {
+        Transaction tx(con.get());
+
+        for (size_t begin = 0; begin < names.size(); begin += kBatchChunkRows) {
+            size_t count = std::min(kBatchChunkRows, names.size() - begin);
+            StorageStatement* pstmt = prepare(
+                "SELECT id, name FROM item_list WHERE name IN (" + idPlaceholders(count) + ")");
+            for (size_t i = 0; i < paddedIdCount(count); ++i) {
+                pstmt->setString(static_cast<int>(i) + 1, names[begin + std::min(i, count - 1)]);
+            }
+            std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+            while (res->next()) {
+                auto it = ids.find(nameKey(res->getString(2)));
+                if (it != ids.end() && it->second == 0) {
+                    it->second = res->getInt(1);
+                }
+            }
+        }
+
+        std::vector<const ImportItem*> newItems;
+        for (const auto& item : items) {
+            int& id = ids[nameKey(item.name)];
+            if (id == 0 && !item.category.empty() && !item.grade.empty()) {
+                id = -1; // 本批次中创建
+                newItems.push_back(&item);
+            }
+        }
+
+        std::vector<ItemCatalog::Item> catalogItems;
+        std::vector<OperationLogQueue::Entry> logs;
+        size_t pos = 0;
+        for (size_t chunk : batchChunks(newItems.size())) {
+            StorageStatement* pstmt = prepare(
+                "INSERT INTO item_list (name, category, grade, effect, description, note) VALUES " +
+                repeatTuple("(?, ?, ?, ?, ?, ?)", chunk));
+            for (size_t k = 0; k < chunk; ++k) {
+                const ImportItem& item = *newItems[pos + k];
+                int base = static_cast<int>(k * 6);
+                pstmt->setString(base + 1, item.name);
+                pstmt->setString(base + 2, item.category);
+                pstmt->setString(base + 3, item.grade);
+                pstmt->setString(base + 4, item.effect);
+                if (item.description.empty()) pstmt->setNull(base + 5);
+                else pstmt->setString(base + 5, item.description);
+                if (item.note.empty()) pstmt->setNull(base + 6);
+                else pstmt->setString(base + 6, item.note);
+            }
+            pstmt->executeUpdate();
+            long long firstId = con->firstInsertId(chunk);
+            long long step = con->insertIdStep();
+            for (size_t k = 0; k < chunk; ++k) {
+                const ImportItem& item = *newItems[pos + k];
+                ItemCatalog::Item catalogItem;
+                catalogItem.id = static_cast<int>(firstId + static_cast<long long>(k) * step);
+                catalogItem.name = item.name;
+                catalogItem.category = item.category;
+                catalogItem.grade = item.grade;
+                ids[nameKey(item.name)] = catalogItem.id;
+                catalogItems.push_back(std::move(catalogItem));
+
+                std::string note = "类别: " + item.category + ", 品质: " + item.grade;
+                if (!reason.empty()) {
+                    note += " | 原因: " + reason;
+                }
+                logs.push_back(logEntry("ADD", item.name, note));
+            }
+            pos += chunk;
+        }
+
+        bool deferLogs = OperationLogQueue::instance().enabled();
+        std::vector<int> logIds;
+        if (!deferLogs) {
+            logIds = insertOperationLogRows(logs);
+        }
+        tx.commit();
+
+        for (size_t i = 0; i < items.size(); ++i) {
+            itemIds[i] = ids[nameKey(items[i].name)];
+        }
+        created = catalogItems.size();
+        if (created == 0) {
             return true;
+        }
+        GT_LOG_INFO("导入物品: 新建 " + std::to_string(created) + " 个");
+
+        // 提交后同步物品目录、搜索索引、计数和操作日志
+        DataVersion::instance().bump(DataVersion::ITEMS);
+        SearchIndex& index = SearchIndex::instance();
+        for (const auto& item : catalogItems) {
+            ItemCatalog::instance().upsert(item);
+            if (index.tracking()) {
+                SearchIndex::Document doc;
+                doc.id = item.id;
+                doc.fields = {item.name};
+                doc.sortKey = item.name;
+                index.upsert(SearchIndex::ITEMS, std::move(doc));
+            }
+        }
+        if (deferLogs) {
+            DataVersion::instance().bump(DataVersion::OPERATION_LOG);
+            if (!OperationLogQueue::instance().enqueue(logs)) {
+                writeOperationLogs(logs, &logIds);
+            }
         } else {
-            log("Failed to update inventory item. ID: " + std::to_string(inventoryId), true);
+            operationLogsWritten(logs.size(), logIds);
+        }
+        publishOperationLogEvent(logs, logIds);
+        return true;
+    } catch (StorageError &e) {
+        GT_LOG_ERROR("MySQL Error in importItems [" + std::to_string(e.getErrorCode()) + "]: " + e.what());
+        itemIds.assign(items.size(), 0);
+        return false;
+    }
+}
+
+// primary 模式的批量库存操作：校验和推演与数据库方式相同，写入为一次 WAL 提交。
+// 操作日志仍写入数据库的 operation_log，在 WAL 提交之后写入（或交给延迟写入队列）
+bool Database::applyInventoryBatchToEngine(const std::vector<InventoryOperation>& ops, bool atomic,
+                                           std::vector<InventoryOperationResult>& results) {
+    InventoryEngine& engine = InventoryEngine::instance();
+    GT_LOG_DEBUG("Applying inventory batch to engine: " + std::to_string(ops.size()) + " operations");
+    if (!engine.ready()) {
+        GT_LOG_ERROR("库存引擎尚未就绪，无法写入库存");
+        for (auto& result : results) {
+            result.error = "库存引擎未就绪";
+        }
+        return false;
+    }
+
+    std::vector<size_t> addOps;
+    std::vector<OperationLogQueue::Entry> logs;
+    InventoryEngine::Changes changes;
+    bool failed = false;
+    try {
+        auto writeLock = engine.lockWrites();
+
+        // 1. 读取要修改/删除的行的当前值（写入按顺序进行，读到的值在提交前不会变化）
+        std::unordered_map<int, InventoryEngine::Row> current;
+        std::vector<int> itemIds;
+        for (const auto& op : ops) {
+            InventoryEngine::Row row;
+            if (op.type == InventoryOperation::ADD) {
+                itemIds.push_back(op.itemId);
+            } else if (op.inventoryId > 0 && !current.count(op.inventoryId) &&
+                       engine.find(op.inventoryId, row)) {
+                itemIds.push_back(row.itemId);
+                current[row.id] = row;
+            }
+        }
+
+        // 2. 物品名称（新增校验和日志用）
+        std::unordered_map<int, std::string> itemNames = resolveItemNames(itemIds);
+        std::unordered_map<int, InventoryRowState> rows;
+        for (const auto& entry : current) {
+            InventoryRowState& row = rows[entry.first];
+            row.itemName = itemNames[entry.second.itemId];
+            row.quantity = entry.second.quantity;
+            row.location = entry.second.location;
+        }
+
+        // 3. 校验
+        failed = planInventoryBatch(ops, rows, itemNames, results, addOps, logs);
+        if (failed && atomic) {
+            cancelInventoryBatch(results);
             return false;
         }
-    } catch (sql::SQLException &e) {
-        std::string errorMsg = "MySQL 更新错误: " + std::string(e.what()) + 
-                              " (错误代码: " + std::to_string(e.getErrorCode()) + ")";
-        log(errorMsg, true);
-        return false;
+
+        // 4. 追加到 WAL 后更新内存
+        for (size_t i : addOps) {
+            InventoryEngine::Row row;
+            row.itemId = ops[i].itemId;
+            row.quantity = ops[i].quantity;
+            row.location = ops[i].location;
+            changes.added.push_back(std::move(row));
+        }
+        for (const auto& entry : rows) {
+            if (!entry.second.exists) {
+                changes.removed.push_back(entry.first);
+            } else if (entry.second.changed) {
+                InventoryEngine::Row row;
+                row.id = entry.first;
+                row.quantity = entry.second.quantity;
+                row.location = entry.second.location;
+                changes.updated.push_back(std::move(row));
+            }
+        }
+        std::sort(changes.removed.begin(), changes.removed.end());
+        std::sort(changes.updated.begin(), changes.updated.end(),
+                  [](const InventoryEngine::Row& a, const InventoryEngine::Row& b) { return a.id < b.id; });
+
+        if (!engine.commit(changes)) {
+            for (auto& result : results) {
+                result.success = false;
+                result.inventoryId = 0;
+                result.error = "写入库存 WAL 失败，批次未执行";
+            }
+            return false;
+        }
+    } catch (StorageError &e) {
+        GT_LOG_ERROR("MySQL Error in applyInventoryBatchToEngine [" + std::to_string(e.getErrorCode()) + "]: " + e.what());
+        for (auto& result : results) {
+            result.success = false;
+            result.inventoryId = 0;
+            result.error = "数据库错误，批次未执行";
+        }
+        return false;
+    }
+
+    for (size_t k = 0; k < addOps.size(); ++k) {
+        results[addOps[k]].inventoryId = changes.added[k].id;
+    }
+    GT_LOG_INFO("批量库存操作完成（内存引擎）: 新增 " + std::to_string(changes.added.size()) +
+                ", 修改 " + std::to_string(changes.updated.size()) +
+                ", 删除 " + std::to_string(changes.removed.size()));
+
+    // 5. 提交后同步计数缓存、操作日志和搜索索引
+    if (!changes.added.empty() || !changes.removed.empty()) {
+        CountService::instance().adjust(CountService::INVENTORY,
+            static_cast<long long>(changes.added.size()) - static_cast<long long>(changes.removed.size()));
+    }
+    if (!changes.added.empty() || !changes.updated.empty() || !changes.removed.empty()) {
+        DataVersion::instance().bump(DataVersion::INVENTORY);
+    }
+    if (OperationLogQueue::instance().enabled() && !logs.empty()) {
+        DataVersion::instance().bump(DataVersion::OPERATION_LOG);
+    }
+    std::vector<int> logIds;
+    if (!OperationLogQueue::instance().enabled() || !OperationLogQueue::instance().enqueue(logs)) {
+        if (!writeOperationLogs(logs, &logIds)) {
+            GT_LOG_ERROR("库存已写入，但操作日志写入失败（" + std::to_string(logs.size()) + " 条）");
+        }
+    }
+    publishOperationLogEvent(logs, logIds);
+    if (EventBus::instance().hasSubscribers()) {
+        publishInventoryEvent(toInventoryItems(changes.added), toInventoryItems(changes.updated), changes.removed);
+    }
+    SearchIndex& index = SearchIndex::instance();
+    if (index.tracking()) {
+        for (const auto* group : {&changes.added, &changes.updated}) {
+            for (const auto& row : *group) {
+                index.upsert(SearchIndex::INVENTORY, toSearchDocument(toInventoryItem(row)));
+            }
+        }
+        for (int id : changes.removed) {
+            index.remove(SearchIndex::INVENTORY, id);
+        }
+    }
+    return !failed;
+}
+
+// cache 模式：提交后按数据库中的值更新内存（更新时间由数据库生成）。
+// 读取失败时停止使用内存数据，库存查询退回数据库
+void Database::syncInventoryCache(const std::vector<int>& changedIds, const std::vector<int>& removedIds) {
+    InventoryEngine& engine = InventoryEngine::instance();
+    try {
+        std::vector<InventoryEngine::Row> rows;
+        for (size_t begin = 0; begin < changedIds.size(); begin += kBatchChunkRows) {
+            std::vector<int> chunk(changedIds.begin() + begin,
+                                   changedIds.begin() + std::min(changedIds.size(), begin + kBatchChunkRows));
+            StorageStatement* pstmt = prepare(
+                std::string(kEngineRowSelect) + "WHERE id IN (" + idPlaceholders(chunk.size()) + ")");
+            bindIds(pstmt, 1, chunk);
+            std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+            for (auto& row : toEngineRows(res.get())) {
+                rows.push_back(std::move(row));
+            }
+        }
+        engine.apply(rows, removedIds);
+    } catch (StorageError &e) {
+        GT_LOG_ERROR("同步库存缓存失败，库存查询改为访问数据库: " + std::string(e.what()));
+        engine.invalidate();
     }
 }
 
-// 删除库存项目
-bool Database::deleteInventoryItem(int inventoryId, const std::string& operationReason) {
-    ensureConnected(); // 确保连接有效
-    log("Deleting inventory item ID: " + std::to_string(inventoryId));
-    
-    if (!con || con->isClosed()) {
-        log("Connection closed, attempting to reconnect...");
-        if (!connect()) {
-            log("Failed to connect for deleteInventoryItem", true);
-            return false;
-        }
+// 启动时加载内存库存引擎：cache 模式总是从数据库全量加载；
+// primary 模式只在首次启动（没有快照和 WAL）时从数据库导入
+bool Database::loadInventoryEngine() {
+    TRACE_SPAN("Database::loadInventoryEngine");
+    InventoryEngine& engine = InventoryEngine::instance();
+    if (engine.mode() == InventoryEngine::OFF) {
+        return true;
     }
-    
+    // 库存行只保存 item_id，名称由物品目录提供
+    if (!ItemCatalog::instance().ready() && !refreshItemCatalog(true)) {
+        GT_LOG_WARNING("物品目录加载失败，内存库存引擎中的物品名称暂不可用");
+    }
+    if (engine.mode() == InventoryEngine::PRIMARY && !engine.needsSeed()) {
+        return engine.ready();
+    }
+
+    ensureConnected();
+    const int batchSize = 5000;
+    auto started = std::chrono::steady_clock::now();
+    std::vector<InventoryEngine::Row> rows;
     try {
-        // 获取库存信息用于日志记录
-        auto currentItem = getInventoryItemById(inventoryId);
-        if (currentItem.empty()) {
-            log("Inventory item not found: " + std::to_string(inventoryId), true);
-            return false;
-        }
-        
-        std::string itemName = safeGet(currentItem[0], "item_name");
-        int quantity = std::stoi(safeGet(currentItem[0], "quantity"));
-        std::string location = safeGet(currentItem[0], "location");
-        
-        std::unique_ptr<sql::PreparedStatement> pstmt(
-            con->prepareStatement(
-                "DELETE FROM inventory WHERE id = ?"
-            )
-        );
-        
-        pstmt->setInt(1, inventoryId);
-        
-        int result = pstmt->executeUpdate();
-        if (result > 0) {
-            // 修改日志记录，添加操作原因
-            std::string opNote = "数量: " + std::to_string(quantity) + ", 位置: " + location;
-            if (operationReason.empty()) {
-                opNote += " | 原因: 未提供";
-            } else {
-                opNote += " | 原因: " + operationReason;
+        int lastId = 0;
+        for (;;) {
+            StorageStatement* pstmt = prepare(
+                std::string(kEngineRowSelect) + "WHERE id > ? ORDER BY id LIMIT ?");
+            pstmt->setInt(1, lastId);
+            pstmt->setInt(2, batchSize);
+            std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+            std::vector<InventoryEngine::Row> batch = toEngineRows(res.get());
+            for (auto& row : batch) {
+                lastId = row.id;
+                rows.push_back(std::move(row));
             }
-            logOperation("DELETE", itemName, opNote);
-            return true;
-        } else {
-            log("Failed to delete inventory item. ID: " + std::to_string(inventoryId), true);
-            return false;
+            if (batch.size() < static_cast<size_t>(batchSize)) break;
         }
-    } catch (sql::SQLException &e) {
-        std::string errorMsg = "MySQL Error in deleteInventoryItem: " + std::string(e.what());
-        log(errorMsg, true);
+    } catch (StorageError &e) {
+        GT_LOG_ERROR("加载内存库存引擎失败 [MySQL错误 " + std::to_string(e.getErrorCode()) + "]: " + e.what());
         return false;
     }
-}
 
-// 获取单个库存项目
-std::vector<std::map<std::string, std::string>> Database::getInventoryItemById(int inventoryId) {
-    ensureConnected(); // 确保连接有效
-    if (inventoryId <= 0) {
-        log("无效的库存ID: " + std::to_string(inventoryId), true);
-        return {};
-    }
-    std::string query = 
-        "SELECT i.id AS inventory_id, i.item_id, il.name AS item_name, "
-        "i.quantity, i.location, i.stored_time, i.last_updated "
-        "FROM inventory i "
-        "JOIN item_list il ON i.item_id = il.id "
-        "WHERE i.id = " + std::to_string(inventoryId);
-    log("执行查询: " + query);
-    auto result = executeQuery(query);
-    
-    // 添加结果验证
-    if (result.empty()) {
-        log("未找到库存项目: " + std::to_string(inventoryId), true);
-    } else {
-        log("找到库存项目: " + std::to_string(inventoryId));
+    size_t count = rows.size();
+    if (!engine.load(std::move(rows))) {
+        return false;
     }
-    
-    return result;
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - started).count();
+    GT_LOG_INFO("内存库存引擎从数据库加载 " + std::to_string(count) + " 条库存，耗时 " +
+                std::to_string(elapsed) + "ms");
+    return true;
 }
 
 // 获取库存总数
 int Database::getTotalInventoryCount() {
-    ensureConnected(); // 确保连接有效
-    try {
-        log("Executing total inventory count query");
-         // 添加连接检查
-        if (!con || con->isClosed()) {
-            if (!connect()) {
-                log("Failed to connect for total count", true);
-                return 0;
-            }
+    return static_cast<int>(countInventory().count);
+}
+
+// 获取操作日志总数
+int Database::getTotalOperationLogsCount() {
+    return static_cast<int>(countOperationLogs().count);
+}
+
+// 与 getInventory / getInventoryByCursor 相同筛选条件的库存计数
+CountService::CountResult Database::countInventory(const std::string& search) {
+    TRACE_SPAN("Database::countInventory");
+    CountService::CountResult indexed;
+    if (!search.empty() && SearchIndex::instance().count(SearchIndex::INVENTORY, search, indexed.count)) {
+        return indexed; // 索引给出的是精确计数
+    }
+    InventoryEngine& engine = InventoryEngine::instance();
+    if (engine.serving()) {
+        indexed.count = engine.count(inventoryMatch(search));
+        return indexed;
+    }
+    if (search.empty()) {
+        return countRows(CountService::INVENTORY, "FROM inventory", {}, search);
+    }
+    std::string likePattern = "%" + search + "%";
+    return countRows(CountService::INVENTORY,
+                     "FROM inventory i JOIN item_list il ON i.item_id = il.id "
+                     "WHERE (il.name LIKE ? OR i.location LIKE ?)",
+                     {likePattern, likePattern}, search);
+}
+
+// 与 getOperationLogs / getOperationLogsByCursor 相同筛选条件的日志计数
+CountService::CountResult Database::countOperationLogs(const std::string& search) {
+    TRACE_SPAN("Database::countOperationLogs");
+    CountService::CountResult result;
+    if (search.empty() || !SearchIndex::instance().count(SearchIndex::OPERATION_LOG, search, result.count)) {
+        if (search.empty()) {
+            result = countRows(CountService::OPERATION_LOG, "FROM operation_log", {}, search);
+        } else {
+            std::string likePattern = "%" + search + "%";
+            result = countRows(CountService::OPERATION_LOG,
+                               "FROM operation_log "
+                               "WHERE (operation_type LIKE ? OR item_name LIKE ? OR operation_note LIKE ?)",
+                               {likePattern, likePattern, likePattern}, search);
         }
-        // 改为直接获取第一列的值
-        std::unique_ptr<sql::Statement> stmt(con->createStatement());
-        std::unique_ptr<sql::ResultSet> res(stmt->executeQuery("SELECT COUNT(*) FROM inventory"));
-        
-        if (res->next()) {
-            int count = res->getInt(1); // 直接获取第一列整数值
-            log("Total inventory count: " + std::to_string(count));
-            return count;
-        }
-        log("Total count query returned no result", true);
-        return 0;
-    } catch (sql::SQLException &e) {
-        std::string errorMsg = "MySQL Error in getTotalInventoryCount: " + std::string(e.what());
-        log(errorMsg, true);
-        return 0;
-    } catch (const std::exception& e) {
-        std::string errorMsg = "Error in getTotalInventoryCount: " + std::string(e.what());
-        log(errorMsg, true);
-        return 0;
     }
+    // 加上延迟写入队列中尚未写入的记录
+    result.count += static_cast<long long>(OperationLogQueue::instance().pendingCount(search));
+    return result;
 }
 
+CountService::CountResult Database::countRows(CountService::Table table, const std::string& fromWhere,
+                                              const std::vector<std::string>& params,
+                                              const std::string& search) {
+    CountService& counts = CountService::instance();
+    CountService::CountResult result;
 
+    // 不带筛选条件：内存中的总数由写操作增量维护
+    if (search.empty() && counts.getTotal(table, result.count)) {
+        return result;
+    }
+    if (!search.empty() && counts.getFiltered(table, search, result)) {
+        return result;
+    }
 
-// 获取操作日志总数
-int Database::getTotalOperationLogsCount() {
-    ensureConnected(); // 确保连接有效
+    ensureConnected();
+    uint64_t generation = counts.generation(table);
     try {
-        log("Executing total operation logs count query");
-        // 确保连接有效
-        if (!con || con->isClosed()) {
-            log("Connection closed, attempting to reconnect...");
-            if (!connect()) {
-                log("Failed to connect for getTotalOperationLogsCount", true);
-                return 0;
+        long long threshold = counts.estimateThreshold();
+        // SQLite 没有可用的行数估算，筛选计数始终精确计算
+        if (search.empty() || threshold <= 0 || !con->supportsRowEstimate()) {
+            result.count = countWithLimit(fromWhere, params, 0);
+        } else {
+            // 先数到阈值为止；超过阈值说明结果集很大，改用执行计划估算，不再扫描剩余部分
+            long long capped = countWithLimit(fromWhere, params, threshold + 1);
+            if (capped <= threshold) {
+                result.count = capped;
+            } else {
+                result.count = std::max(threshold + 1, estimateRows(fromWhere, params));
+                long long total = 0;
+                if (counts.getTotal(table, total) && total > threshold) {
+                    result.count = std::min(result.count, total); // 筛选结果不会超过总数
+                }
+                result.estimated = true;
+                GT_LOG_DEBUG("筛选计数超过阈值，使用估算值: " + std::to_string(result.count));
             }
         }
-        
-        // 直接获取第一列的值
-        std::unique_ptr<sql::Statement> stmt(con->createStatement());
-        std::unique_ptr<sql::ResultSet> res(stmt->executeQuery("SELECT COUNT(*) FROM operation_log"));
-        
-        if (res->next()) {
-            int count = res->getInt(1); // 直接获取第一列整数值
-            log("Total operation logs count: " + std::to_string(count));
-            return count;
-        }
-        log("Total operation logs count query returned no result", true);
-        return 0;
-    } catch (sql::SQLException &e) {
-        std::string errorMsg = "MySQL Error in getTotalOperationLogsCount: " + std::string(e.what());
-        log(errorMsg, true);
-        return 0;
-    } catch (const std::exception& e) {
-        std::string errorMsg = "Error in getTotalOperationLogsCount: " + std::string(e.what());
-        log(errorMsg, true);
-        return 0;
+    } catch (StorageError &e) {
+        GT_LOG_ERROR("Database error in countRows [" + std::to_string(e.getErrorCode()) + "]: " +
+                     std::string(e.what()) + "\nQuery: SELECT COUNT(*) " + fromWhere);
+        return result;
+    }
+
+    if (search.empty()) {
+        counts.setTotal(table, result.count, generation);
+    } else {
+        counts.putFiltered(table, search, result, generation);
+    }
+    return result;
+}
+
+// 执行 COUNT(*)；limit > 0 时最多数到 limit 行
+long long Database::countWithLimit(const std::string& fromWhere, const std::vector<std::string>& params,
+                                   long long limit) {
+    std::string query = limit > 0
+        ? "SELECT COUNT(*) FROM (SELECT 1 " + fromWhere + " LIMIT ?) AS capped"
+        : "SELECT COUNT(*) " + fromWhere;
+    GT_LOG_DEBUG("Executing count query: " + query);
+
+    StorageStatement* pstmt = prepare(query);
+    int paramIndex = 1;
+    for (const auto& param : params) {
+        pstmt->setString(paramIndex++, param);
+    }
+    if (limit > 0) {
+        pstmt->setInt64(paramIndex++, limit);
+    }
+
+    std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+    if (res->next()) {
+        return res->getInt64(1);
     }
+    GT_LOG_ERROR("Count query returned no result");
+    return 0;
 }
 
+// 根据 EXPLAIN 的 rows × filtered 估算匹配行数
+long long Database::estimateRows(const std::string& fromWhere, const std::vector<std::string>& params) {
+    StorageStatement* pstmt = prepare("EXPLAIN SELECT 1 " + fromWhere);
+    int paramIndex = 1;
+    for (const auto& param : params) {
+        pstmt->setString(paramIndex++, param);
+    }
+
+    std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+    auto plan = parseResultSet(res.get());
+    double estimate = plan.empty() ? 0.0 : 1.0;
+    for (const auto& step : plan) {
+        // 联接的每一步按扫描行数与过滤比例相乘
+        try {
+            double rows = std::stod(safeGet(step, "rows", "1"));
+            double filtered = std::stod(safeGet(step, "filtered", "100"));
+            estimate *= rows * filtered / 100.0;
+        } catch (const std::exception&) {
+            // 缺少 rows/filtered 列（旧版本 MySQL）时忽略该步
+        }
+    }
+    return static_cast<long long>(estimate);
+}
 
 
 
 void Database::reloadConfig() {
     config.reload();
-    logFileName = config.getString("application", "log_file", "geartracker.log");  // 使用logFileName
     
-    // 重新设置日志级别
-    std::string logLevel = config.getString("application", "log_level", "info");
-    if (logLevel == "debug") {
-        logLevelFlag = LOG_DEBUG;
-    } else if (logLevel == "warning") {
-        logLevelFlag = LOG_WARNING;
-    } else if (logLevel == "error") {
-        logLevelFlag = LOG_ERROR;
-    } else {
-        logLevelFlag = LOG_INFO;
-    }
+    // 重新设置日志级别、文件和轮转参数
+    Logger::instance().configure(config);
+    CountService::instance().configure(config);
+    OperationLogQueue::instance().configure(config);
+    DataVersion::instance().configure(config);
+    EventBus::instance().configure(config);
 }
 
 void Database::updateDatabaseCredentials(const std::string& host, int port, 
@@ -1181,161 +2672,47 @@ void Database::updateDatabaseCredentials(const std::string& host, int port,
     // 保存到文件
     config.save();
     
-    // 重新连接数据库
-    try {
-        if (con) {
-            con->close();
-        }
-        
-        // 构建连接字符串
-        std::string connectionStr = "tcp://" + host + ":" + std::to_string(port);
-        // 使用 DriverManager 获取驱动实例
-        driver = get_driver_instance(); // 重新获取驱动实例
-
-        // 创建新连接
-        con.reset(driver->connect(connectionStr, user, password));
-        con->setSchema(dbName);
-        log("数据库连接已更新，成功连接到: " + dbName);
-    } catch (sql::SQLException &e) {
-        std::string errorMsg = "无法更新数据库连接: " + std::string(e.what());
-        log(errorMsg, true);
+    // 重新连接数据库（连接参数只对 MySQL 后端有效，SQLite 后端会重新打开同一个文件）
+    if (!connect()) {
+        std::string errorMsg = "无法更新数据库连接: 使用新参数连接失败";
+        GT_LOG_ERROR(errorMsg);
         throw std::runtime_error(errorMsg);
     }
-}
-std::vector<Database::InventoryItem> Database::getInventoryPaginated(int page, int perPage, const std::string& searchTerm) {
-    ensureConnected(); // 确保连接有效
-    std::vector<InventoryItem> items;
-    
-    try {
-        log("Executing getInventoryPaginated query with search: " + (searchTerm.empty() ? "(no search)" : searchTerm));
-        
-        // 确保连接有效
-        if (!con || con->isClosed()) {
-            log("Connection closed, attempting to reconnect...");
-            if (!connect()) {
-                log("Failed to connect for getInventoryPaginated", true);
-                return items;
-            }
-        }
-        
-        int offset = (page - 1) * perPage;
-        std::string baseQuery = 
-            "SELECT i.id, i.item_id, il.name AS item_name, i.quantity, i.location, "
-            "i.stored_time, i.last_updated "
-            "FROM inventory i JOIN item_list il ON i.item_id = il.id ";
-        
-        // 添加搜索条件
-        if (!searchTerm.empty()) {
-            baseQuery += "WHERE il.name LIKE ? OR i.location LIKE ? ";
-        }
-        
-        // 添加排序
-        baseQuery += "ORDER BY i.last_updated DESC";
-        
-        log("SQL: " + baseQuery);
-        
-        if (!searchTerm.empty()) {
-            // 使用预处理语句 - 更安全
-            std::unique_ptr<sql::PreparedStatement> pstmt(con->prepareStatement(baseQuery + " LIMIT ? OFFSET ?"));
-            
-            // 设置搜索参数 (添加%通配符)
-            std::string searchPattern = "%" + searchTerm + "%";
-            pstmt->setString(1, searchPattern);
-            pstmt->setString(2, searchPattern);
-            
-            // 设置分页参数
-            pstmt->setInt(3, perPage);
-            pstmt->setInt(4, offset);
-            
-            // 执行查询
-            std::unique_ptr<sql::ResultSet> res(pstmt->executeQuery());
-            
-            while (res->next()) {
-                InventoryItem item;
-                item.id = res->getInt("id");
-                item.item_id = res->getInt("item_id");
-                item.item_name = res->getString("item_name");
-                item.quantity = res->getInt("quantity");
-                item.location = res->getString("location");
-                item.stored_time = res->getString("stored_time");
-                item.last_updated = res->getString("last_updated");
-                items.push_back(item);
-            }
-        } else {
-            // 没有搜索条件 - 直接拼接分页参数
-            std::string fullQuery = baseQuery + " LIMIT " + std::to_string(perPage) + 
-                                   " OFFSET " + std::to_string(offset);
-            
-            log("Full query: " + fullQuery);
-            
-            std::unique_ptr<sql::Statement> stmt(con->createStatement());
-            std::unique_ptr<sql::ResultSet> res(stmt->executeQuery(fullQuery));
-            
-            while (res->next()) {
-                InventoryItem item;
-                item.id = res->getInt("id");
-                item.item_id = res->getInt("item_id");
-                item.item_name = res->getString("item_name");
-                item.quantity = res->getInt("quantity");
-                item.location = res->getString("location");
-                item.stored_time = res->getString("stored_time");
-                item.last_updated = res->getString("last_updated");
-                items.push_back(item);
-            }
-        }
-        
-        log("Retrieved " + std::to_string(items.size()) + " inventory items");
-    } catch (sql::SQLException &e) {
-        std::string errorMsg = "MySQL Error in getInventoryPaginated: " + std::string(e.what());
-        log(errorMsg, true);
-        
-        // 添加详细错误日志
-        log("SQL error code: " + std::to_string(e.getErrorCode()), true);
-        log("SQL state: " + std::string(e.getSQLState()), true);
-        
-        // 尝试重新连接
-        if (e.getErrorCode() == 2013 || e.getErrorCode() == 2006) { // 连接丢失错误代码
-            log("Attempting to reconnect due to lost connection");
-            if (connect()) {
-                log("Reconnection successful, retrying query");
-                return getInventoryPaginated(page, perPage, searchTerm);
-            }
-        }
-    } catch (const std::exception& e) {
-        std::string errorMsg = "Error in getInventoryPaginated: " + std::string(e.what());
-        log(errorMsg, true);
-    }
+    GT_LOG_INFO("数据库连接已更新，成功连接到: " + dbName);
     
-    return items;
+    // 换了数据库，缓存的总数全部作废
+    CountService::instance().invalidate(CountService::INVENTORY);
+    CountService::instance().invalidate(CountService::OPERATION_LOG);
+    DataVersion::instance().bumpAll();
+    refreshItemCatalog(true);
 }
-
-
-
 void Database::ensureConnected() {
+    TRACE_SPAN("Database::ensureConnected");
     std::lock_guard<std::mutex> lock(connectionMutex); // 使用互斥锁
     
     // 如果连接不存在或已关闭
     if (!con || con->isClosed()) {
-        log("连接已断开，尝试重连...");
+        GT_LOG_INFO("连接已断开，尝试重连...");
+        Metrics::instance().counter("geartracker_db_reconnects_total", "连接断开后的重连次数")->add();
         
         // 优雅地断开现有连接
         if (con) {
             try {
                 con->close();
-            } catch (const sql::SQLException& e) {
-                log("关闭连接时出错: " + std::string(e.what()), true);
+            } catch (const StorageError& e) {
+                GT_LOG_ERROR("关闭连接时出错: " + std::string(e.what()));
             }
         }
         
         // 尝试重连，最多重试3次
         for (int attempt = 1; attempt <= 3; attempt++) {
             try {
-                if (connect()) {
-                    log("重连成功!");
+                if (connectLocked()) {
+                    GT_LOG_INFO("重连成功!");
                     return;
                 }
             } catch (const std::exception& e) {
-                log("重连尝试 " + std::to_string(attempt) + " 失败: " + e.what(), true);
+                GT_LOG_ERROR("重连尝试 " + std::to_string(attempt) + " 失败: " + e.what());
             }
             
             // 指数退避策略
@@ -1345,17 +2722,26 @@ void Database::ensureConnected() {
         throw std::runtime_error("无法重新连接数据库");
     }
     
+    // 连接刚刚使用过，无需额外往返；只有空闲超过阈值才发送保活PING
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastActivity < validateAfterIdle) {
+        lastActivity = now;
+        return;
+    }
+    
     // 如果连接存在，发送保活ping
     try {
-        log("发送保活PING...");
-        std::unique_ptr<sql::Statement> stmt(con->createStatement());
-        std::unique_ptr<sql::ResultSet> res(stmt->executeQuery("SELECT 1"));
+        GT_LOG_DEBUG("发送保活PING...");
+        StorageStatement* pstmt = prepare("SELECT 1");
+        std::unique_ptr<StorageResult> res(pstmt->executeQuery());
         if (res->next()) {
-            log("连接状态正常");
+            GT_LOG_DEBUG("连接状态正常");
+            lastActivity = now;
         }
-    } catch (const sql::SQLException& e) {
-        log("保活PING失败: " + std::string(e.what()), true);
+    } catch (const StorageError& e) {
+        GT_LOG_ERROR("保活PING失败: " + std::string(e.what()));
         // 如果ping失败，标记连接为断开
+        stmtCache.clear();
         if (con) {
             try {
                 con->close();
@@ -1371,28 +2757,48 @@ void Database::ensureConnected() {
 // ====== 新增：搜索物品 ======
 std::vector<std::map<std::string, std::string>> 
 Database::searchItems(const std::string& query, int limit) {
+    TRACE_SPAN("Database::searchItems");
     ensureConnected();
-    log("搜索物品: " + query + ", 限制: " + std::to_string(limit));
+    GT_LOG_DEBUG("搜索物品: " + query + ", 限制: " + std::to_string(limit));
     std::vector<std::map<std::string, std::string>> results;
     
     if (!con || con->isClosed()) {
-        log("连接已关闭，尝试重新连接...");
+        GT_LOG_INFO("连接已关闭，尝试重新连接...");
         if (!connect()) {
-            log("无法为searchItems建立连接", true);
+            GT_LOG_ERROR("无法为searchItems建立连接");
             return results;
         }
     }
     
     try {
-        // 使用预处理语句防止SQL注入
-        std::unique_ptr<sql::PreparedStatement> pstmt(
-            con->prepareStatement(
+        // 索引可用时按名称匹配出 id，再按主键取回
+        SearchIndex::PageRequest request;
+        request.limit = limit;
+        std::vector<int> ids;
+        if (SearchIndex::instance().findPage(SearchIndex::ITEMS, query, request, ids)) {
+            if (ids.empty()) {
+                return results;
+            }
+            StorageStatement* pstmt = prepare(
                 "SELECT id, name, category, grade, effect, description, note "
-                "FROM item_list "
-                "WHERE name LIKE ? "
-                "ORDER BY name "
-                "LIMIT ?"
-            )
+                "FROM item_list WHERE id IN (" + idPlaceholders(ids.size()) + ")");
+            bindIds(pstmt, 1, ids);
+            std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+            results = orderByIds(parseResultSet(res.get()), ids,
+                                 [](const std::map<std::string, std::string>& row) {
+                                     return std::atoi(safeGet(row, "id", "0").c_str());
+                                 });
+            GT_LOG_DEBUG("索引找到 " + std::to_string(results.size()) + " 个匹配物品");
+            return results;
+        }
+        
+        // 使用预处理语句防止SQL注入
+        StorageStatement* pstmt = prepare(
+            "SELECT id, name, category, grade, effect, description, note "
+            "FROM item_list "
+            "WHERE name LIKE ? "
+            "ORDER BY name "
+            "LIMIT ?"
         );
         
         // 添加通配符进行部分匹配
@@ -1400,16 +2806,358 @@ Database::searchItems(const std::string& query, int limit) {
         pstmt->setString(1, searchPattern);
         pstmt->setInt(2, limit);
         
-        std::unique_ptr<sql::ResultSet> res(pstmt->executeQuery());
+        std::unique_ptr<StorageResult> res(pstmt->executeQuery());
         results = parseResultSet(res.get());
         
-        log("找到 " + std::to_string(results.size()) + " 个匹配物品");
+        GT_LOG_DEBUG("找到 " + std::to_string(results.size()) + " 个匹配物品");
         return results;
-    } catch (const sql::SQLException& e) {
+    } catch (const StorageError& e) {
         std::ostringstream oss;
         oss << "MySQL错误在searchItems: [错误代码" << e.getErrorCode() 
             << ", SQL状态:" << e.getSQLState() << "]: " << e.what();
-        log(oss.str(), true);
+        GT_LOG_ERROR(oss.str());
+        return {};
+    }
+}
+
+// ====== 操作日志批量写入 ======
+// 多行 INSERT 写入操作日志，返回新行的 id（只在搜索索引需要时查询）。
+// 记录带有时间（来自延迟写入队列）时写入该时间，否则使用数据库的默认时间。
+// 调用方负责事务
+std::vector<int> Database::insertOperationLogRows(const std::vector<OperationLogQueue::Entry>& entries) {
+    bool wantIds = SearchIndex::instance().tracking() || EventBus::instance().hasSubscribers();
+    bool withTime = !entries.empty() && !entries[0].time.empty();
+    std::vector<int> ids;
+    size_t pos = 0;
+    for (size_t chunk : batchChunks(entries.size())) {
+        StorageStatement* pstmt = prepare(withTime
+            ? "INSERT INTO operation_log (operation_type, item_name, operation_note, operation_time) VALUES " +
+              repeatTuple("(?, ?, ?, ?)", chunk)
+            : "INSERT INTO operation_log (operation_type, item_name, operation_note) VALUES " +
+              repeatTuple("(?, ?, ?)", chunk));
+        int columns = withTime ? 4 : 3;
+        for (size_t k = 0; k < chunk; ++k) {
+            const OperationLogQueue::Entry& entry = entries[pos + k];
+            int base = static_cast<int>(k) * columns;
+            pstmt->setString(base + 1, entry.type);
+            pstmt->setString(base + 2, entry.itemName);
+            pstmt->setString(base + 3, entry.note);
+            if (withTime) {
+                pstmt->setString(base + 4, entry.time);
+            }
+        }
+        pstmt->executeUpdate();
+        if (wantIds) {
+            long long firstId = con->firstInsertId(chunk);
+            long long step = con->insertIdStep();
+            for (size_t k = 0; k < chunk; ++k) {
+                ids.push_back(static_cast<int>(firstId + static_cast<long long>(k) * step));
+            }
+        }
+        pos += chunk;
+    }
+    return ids;
+}
+
+// 操作日志提交后同步计数缓存和搜索索引
+void Database::operationLogsWritten(size_t count, const std::vector<int>& ids) {
+    if (count > 0) {
+        CountService::instance().adjust(CountService::OPERATION_LOG, static_cast<long long>(count));
+        DataVersion::instance().bump(DataVersion::OPERATION_LOG);
+    }
+    SearchIndex& index = SearchIndex::instance();
+    if (ids.empty() || !index.tracking()) {
+        return;
+    }
+    try {
+        for (size_t begin = 0; begin < ids.size(); begin += kBatchChunkRows) {
+            std::vector<int> chunk(ids.begin() + begin,
+                                   ids.begin() + std::min(ids.size(), begin + kBatchChunkRows));
+            for (const auto& entry : loadOperationLogsByIds(chunk)) {
+                index.upsert(SearchIndex::OPERATION_LOG, toSearchDocument(entry));
+            }
+        }
+    } catch (StorageError &e) {
+        GT_LOG_WARNING("更新日志搜索索引失败: " + std::string(e.what()));
+    }
+}
+
+bool Database::writeOperationLogs(const std::vector<OperationLogQueue::Entry>& entries,
+                                  std::vector<int>* ids, const std::string& journal) {
+    TRACE_SPAN("Database::writeOperationLogs");
+    if (entries.empty()) {
+        return true;
+    }
+    ensureConnected();
+    if (!con || con->isClosed()) {
+        GT_LOG_ERROR("Failed to connect for writeOperationLogs");
+        return false;
+    }
+    try {
+        std::vector<int> newIds;
+        {
+            Transaction tx(con.get());
+            newIds = insertOperationLogRows(entries);
+            if (!journal.empty()) {
+                saveOperationLogCheckpoint(journal, entries.back().seq);
+            }
+            tx.commit();
+        }
+        operationLogsWritten(entries.size(), newIds);
+        if (ids) {
+            *ids = std::move(newIds);
+        }
+        GT_LOG_DEBUG("Operation logs written: " + std::to_string(entries.size()));
+        return true;
+    } catch (StorageError &e) {
+        GT_LOG_ERROR("MySQL Error in writeOperationLogs [" + std::to_string(e.getErrorCode()) + "]: " + e.what());
+        return false;
+    }
+}
+
+// ====== 延迟写入检查点 ======
+// 每个日志文件一行，记录已写入 operation_log 的最大序号。它与操作日志在同一事务中更新，
+// 提交后、日志文件记下检查点之前异常退出时，恢复仍能跳过已写入的记录
+static const char* const kCheckpointTable =
+    "CREATE TABLE IF NOT EXISTS operation_log_checkpoint ("
+    "  journal VARCHAR(255) NOT NULL PRIMARY KEY,"
+    "  seq BIGINT NOT NULL"
+    ")";
+
+uint64_t Database::operationLogCheckpoint(const std::string& journal) {
+    ensureConnected();
+    if (!con || con->isClosed()) {
+        throw StorageError("无法连接数据库");
+    }
+    con->execute(kCheckpointTable);
+    StorageStatement* pstmt = prepare("SELECT seq FROM operation_log_checkpoint WHERE journal = ?");
+    pstmt->setString(1, journal);
+    std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+    return res->next() ? static_cast<uint64_t>(res->getInt64(1)) : 0;
+}
+
+void Database::saveOperationLogCheckpoint(const std::string& journal, uint64_t seq) {
+    // 序号只增不减，已有的行一定会被更新；影响 0 行说明还没有这个日志文件的检查点
+    StorageStatement* pstmt = prepare("UPDATE operation_log_checkpoint SET seq = ? WHERE journal = ?");
+    pstmt->setInt64(1, static_cast<int64_t>(seq));
+    pstmt->setString(2, journal);
+    if (pstmt->executeUpdate() > 0) {
+        return;
+    }
+    pstmt = prepare("INSERT INTO operation_log_checkpoint (journal, seq) VALUES (?, ?)");
+    pstmt->setString(1, journal);
+    pstmt->setInt64(2, static_cast<int64_t>(seq));
+    pstmt->executeUpdate();
+}
+
+// ====== 搜索索引 ======
+// 按主键批量取回库存行，结果按 ids 的顺序排列
+// 内存库存引擎可用时直接从内存取，否则查询数据库
+std::vector<Database::InventoryItem> Database::inventoryByIds(const std::vector<int>& ids) {
+    InventoryEngine& engine = InventoryEngine::instance();
+    if (engine.serving()) {
+        return toInventoryItems(engine.findMany(ids));
+    }
+    return loadInventoryByIds(ids);
+}
+
+std::vector<Database::InventoryItem> Database::loadInventoryByIds(const std::vector<int>& ids) {
+    TRACE_SPAN("Database::loadInventoryByIds");
+    if (ids.empty()) {
+        return {};
+    }
+    StorageStatement* pstmt = prepare(
+        std::string(kInventorySelect) + "WHERE i.id IN (" + idPlaceholders(ids.size()) + ")");
+    bindIds(pstmt, 1, ids);
+    std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+    ResultTable table;
+    table.load(res.get(), ids.size());
+    return orderByIds(toInventoryItems(table), ids,
+                      [](const InventoryItem& item) { return item.id; });
+}
+
+std::vector<Database::OperationLogEntry> Database::loadOperationLogsByIds(const std::vector<int>& ids) {
+    TRACE_SPAN("Database::loadOperationLogsByIds");
+    if (ids.empty()) {
         return {};
     }
+    StorageStatement* pstmt = prepare(
+        std::string(kOperationLogSelect) + "WHERE id IN (" + idPlaceholders(ids.size()) + ")");
+    bindIds(pstmt, 1, ids);
+    std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+    ResultTable table;
+    table.load(res.get(), ids.size());
+    return orderByIds(toOperationLogEntries(table), ids,
+                      [](const OperationLogEntry& entry) { return entry.id; });
+}
+
+long long Database::lastInsertId() {
+    return con->firstInsertId(1);
+}
+
+// 写入后按主键重读一行更新索引（排序时间由数据库生成，需要取回）。
+// id 为 0 表示刚插入的行
+void Database::indexInventoryRow(int inventoryId) {
+    SearchIndex& index = SearchIndex::instance();
+    if (!index.tracking()) {
+        return;
+    }
+    try {
+        if (inventoryId <= 0) {
+            inventoryId = static_cast<int>(lastInsertId());
+        }
+        auto rows = loadInventoryByIds({inventoryId});
+        if (rows.empty()) {
+            index.remove(SearchIndex::INVENTORY, inventoryId);
+        } else {
+            index.upsert(SearchIndex::INVENTORY, toSearchDocument(rows[0]));
+        }
+    } catch (StorageError &e) {
+        GT_LOG_WARNING("更新库存搜索索引失败: " + std::string(e.what()));
+    }
+}
+
+void Database::indexOperationLogRow(int logId) {
+    SearchIndex& index = SearchIndex::instance();
+    if (!index.tracking()) {
+        return;
+    }
+    try {
+        if (logId <= 0) {
+            logId = static_cast<int>(lastInsertId());
+        }
+        auto rows = loadOperationLogsByIds({logId});
+        if (!rows.empty()) {
+            index.upsert(SearchIndex::OPERATION_LOG, toSearchDocument(rows[0]));
+        }
+    } catch (StorageError &e) {
+        GT_LOG_WARNING("更新日志搜索索引失败: " + std::string(e.what()));
+    }
+}
+
+// 物品目录：先取版本指纹（行数、最大 id、内容校验和），与内存中的一致就不重新加载
+bool Database::refreshItemCatalog(bool force) {
+    TRACE_SPAN("Database::refreshItemCatalog");
+    ItemCatalog& catalog = ItemCatalog::instance();
+    try {
+        ensureConnected();
+        StorageStatement* versionStmt = prepare(
+            "SELECT COUNT(*), COALESCE(MAX(id), 0), "
+            "COALESCE(SUM(CRC32(CONCAT_WS('|', id, name, category, grade))), 0) "
+            "FROM item_list");
+        std::unique_ptr<StorageResult> versionRes(versionStmt->executeQuery());
+        ItemCatalog::Version version;
+        if (versionRes->next()) {
+            version.count = versionRes->getInt64(1);
+            version.maxId = versionRes->getInt64(2);
+            version.checksum = versionRes->getInt64(3);
+        }
+        if (!force && catalog.ready() && catalog.version() == version) {
+            return true;
+        }
+
+        StorageStatement* pstmt = prepare("SELECT id, name, category, grade FROM item_list");
+        std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+        ResultTable table;
+        table.load(res.get(), static_cast<size_t>(version.count));
+        std::vector<ItemCatalog::Item> items(table.rowCount());
+        for (size_t r = 0; r < table.rowCount(); ++r) {
+            items[r].id = static_cast<int>(table.getInt(r, 0));
+            items[r].name = table.getText(r, 1);
+            items[r].category = table.getText(r, 2);
+            items[r].grade = table.getText(r, 3);
+        }
+        catalog.replace(std::move(items), version);
+        DataVersion::instance().bump(DataVersion::ITEMS); // 库存列表中的物品名称可能随之变化
+        GT_LOG_INFO("物品目录已加载: " + std::to_string(catalog.size()) + " 个物品");
+        return true;
+    } catch (StorageError &e) {
+        GT_LOG_ERROR("加载物品目录失败 [MySQL错误 " + std::to_string(e.getErrorCode()) + "]: " + e.what());
+        return false;
+    }
+}
+
+// 分批（按主键顺序）读取三张表构建索引，避免一次把大表全部读入内存
+bool Database::buildSearchIndex() {
+    TRACE_SPAN("Database::buildSearchIndex");
+    ensureConnected();
+    SearchIndex& index = SearchIndex::instance();
+    const int batchSize = 5000;
+    auto started = std::chrono::steady_clock::now();
+
+    index.beginRebuild();
+    try {
+        int lastId = 0;
+        for (;;) {
+            StorageStatement* pstmt = prepare(
+                "SELECT id, name FROM item_list WHERE id > ? ORDER BY id LIMIT ?");
+            pstmt->setInt(1, lastId);
+            pstmt->setInt(2, batchSize);
+            std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+            ResultTable table;
+            table.load(res.get(), batchSize);
+            for (size_t r = 0; r < table.rowCount(); ++r) {
+                SearchIndex::Document doc;
+                doc.id = static_cast<int>(table.getInt(r, 0));
+                doc.fields = {std::string(table.getString(r, 1))};
+                doc.sortKey = doc.fields[0];
+                lastId = doc.id;
+                index.addToRebuild(SearchIndex::ITEMS, std::move(doc));
+            }
+            if (table.rowCount() < static_cast<size_t>(batchSize)) break;
+        }
+
+        lastId = 0;
+        InventoryEngine& engine = InventoryEngine::instance();
+        if (engine.serving()) {
+            engine.forEach([&index](const InventoryEngine::Row& row) {
+                index.addToRebuild(SearchIndex::INVENTORY, toSearchDocument(toInventoryItem(row)));
+            });
+        } else {
+            for (;;) {
+                StorageStatement* pstmt = prepare(
+                    std::string(kInventorySelect) + "WHERE i.id > ? ORDER BY i.id LIMIT ?");
+                pstmt->setInt(1, lastId);
+                pstmt->setInt(2, batchSize);
+                std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+                ResultTable table;
+                table.load(res.get(), batchSize);
+                for (const auto& item : toInventoryItems(table)) {
+                    lastId = item.id;
+                    index.addToRebuild(SearchIndex::INVENTORY, toSearchDocument(item));
+                }
+                if (table.rowCount() < static_cast<size_t>(batchSize)) break;
+            }
+        }
+
+        lastId = 0;
+        for (;;) {
+            StorageStatement* pstmt = prepare(
+                std::string(kOperationLogSelect) + "WHERE id > ? ORDER BY id LIMIT ?");
+            pstmt->setInt(1, lastId);
+            pstmt->setInt(2, batchSize);
+            std::unique_ptr<StorageResult> res(pstmt->executeQuery());
+            ResultTable table;
+            table.load(res.get(), batchSize);
+            for (const auto& entry : toOperationLogEntries(table)) {
+                lastId = entry.id;
+                index.addToRebuild(SearchIndex::OPERATION_LOG, toSearchDocument(entry));
+            }
+            if (table.rowCount() < static_cast<size_t>(batchSize)) break;
+        }
+    } catch (StorageError &e) {
+        index.abortRebuild();
+        GT_LOG_ERROR("构建搜索索引失败 [MySQL错误 " + std::to_string(e.getErrorCode()) + "]: " + e.what());
+        return false;
+    }
+    index.commitRebuild();
+
+    SearchIndex::Stats stats = index.getStats();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - started).count();
+    GT_LOG_INFO("搜索索引构建完成：物品 " + std::to_string(stats.documents[SearchIndex::ITEMS]) +
+                "，库存 " + std::to_string(stats.documents[SearchIndex::INVENTORY]) +
+                "，日志 " + std::to_string(stats.documents[SearchIndex::OPERATION_LOG]) +
+                "，耗时 " + std::to_string(elapsed) + "ms");
+    return true;
 }
\ No newline at end of file
@@ -0,0 +1,97 @@
+// ====== EventBus.cpp ======
+#include "EventBus.h"
+#include <algorithm>
+
+EventBus& EventBus::instance() {
+    static EventBus bus;
+    return bus;
+}
+
+EventBus::EventBus() {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    epoch_ = std::to_string(std::chrono::duration_cast<std::chrono::seconds>(now).count());
+}
+
+void EventBus::configure(Config& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = static_cast<size_t>(std::max(16, config.getInt("application", "events_buffer", 256)));
+    while (events_.size() > capacity_) {
+        events_.pop_front();
+    }
+}
+
+uint64_t EventBus::publish(const std::string& type, std::string data, bool sticky) {
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Event event;
+        event.id = id = ++lastId_;
+        event.type = type;
+        event.data = std::move(data);
+        if (sticky) {
+            sticky_[type] = event;
+        }
+        events_.push_back(std::move(event));
+        if (events_.size() > capacity_) {
+            events_.pop_front();
+        }
+    }
+    cv_.notify_all();
+    return id;
+}
+
+bool EventBus::waitEvents(uint64_t afterId, std::chrono::milliseconds timeout, std::vector<Event>& events) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (afterId > lastId_) {
+        return false; // 编号来自重启前
+    }
+    cv_.wait_for(lock, timeout, [&]() { return lastId_ > afterId || closed(); });
+    if (lastId_ <= afterId) {
+        return true;
+    }
+    if (events_.empty() || events_.front().id > afterId + 1) {
+        return false; // 中间的事件已被覆盖
+    }
+    for (auto it = events_.begin() + static_cast<std::ptrdiff_t>(afterId + 1 - events_.front().id);
+         it != events_.end(); ++it) {
+        events.push_back(*it);
+    }
+    return true;
+}
+
+std::vector<EventBus::Event> EventBus::stickyEvents() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Event> events;
+    for (const auto& entry : sticky_) {
+        events.push_back(entry.second);
+    }
+    std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) { return a.id < b.id; });
+    return events;
+}
+
+uint64_t EventBus::lastId() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastId_;
+}
+
+bool EventBus::addSubscriber(size_t maxSubscribers) {
+    size_t current = subscribers_.load(std::memory_order_acquire);
+    do {
+        if (closed() || current >= maxSubscribers) {
+            return false;
+        }
+    } while (!subscribers_.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel));
+    return true;
+}
+
+void EventBus::removeSubscriber() {
+    subscribers_.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void EventBus::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_.store(true, std::memory_order_release);
+    }
+    cv_.notify_all();
+}
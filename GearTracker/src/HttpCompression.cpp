@@ -0,0 +1,155 @@
+// ====== HttpCompression.cpp ======
+#include "HttpCompression.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+#ifdef GEARTRACKER_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef GEARTRACKER_WITH_BROTLI
+#include <brotli/encode.h>
+#endif
+
+namespace {
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return std::string();
+    }
+    size_t end = text.find_last_not_of(" \t");
+    return text.substr(begin, end - begin + 1);
+}
+
+std::string lower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c){ return std::tolower(c); });
+    return text;
+}
+
+} // namespace
+
+// Accept-Encoding: gzip, deflate, br;q=0.9, *;q=0
+// 没有单独列出的编码按 * 的 q 值处理，都没有时为 -1（不接受）
+struct AcceptedQ {
+    double gzip = -1;
+    double brotli = -1;
+};
+
+static AcceptedQ parseAcceptEncoding(const std::string& acceptEncoding) {
+    AcceptedQ accepted;
+    double anyQ = -1;
+    size_t pos = 0;
+    while (pos <= acceptEncoding.size()) {
+        size_t end = acceptEncoding.find(',', pos);
+        if (end == std::string::npos) end = acceptEncoding.size();
+        std::string item = acceptEncoding.substr(pos, end - pos);
+        pos = end + 1;
+
+        double q = 1.0;
+        size_t semi = item.find(';');
+        if (semi != std::string::npos) {
+            std::string param = lower(trim(item.substr(semi + 1)));
+            if (param.compare(0, 2, "q=") == 0) {
+                q = std::atof(param.c_str() + 2);
+            }
+            item = item.substr(0, semi);
+        }
+        item = lower(trim(item));
+        if (item == "gzip" || item == "x-gzip") {
+            accepted.gzip = q;
+        } else if (item == "br") {
+            accepted.brotli = q;
+        } else if (item == "*") {
+            anyQ = q;
+        }
+    }
+    if (accepted.gzip < 0) accepted.gzip = anyQ;
+    if (accepted.brotli < 0) accepted.brotli = anyQ;
+    return accepted;
+}
+
+HttpCompression::Encoding HttpCompression::negotiate(const std::string& acceptEncoding) {
+    AcceptedQ accepted = parseAcceptEncoding(acceptEncoding);
+#ifdef GEARTRACKER_WITH_BROTLI
+    if (accepted.brotli > 0 && accepted.brotli >= accepted.gzip) {
+        return BROTLI;
+    }
+#endif
+#ifdef GEARTRACKER_WITH_ZLIB
+    if (accepted.gzip > 0) {
+        return GZIP;
+    }
+#endif
+    (void)accepted;
+    return IDENTITY;
+}
+
+bool HttpCompression::accepts(const std::string& acceptEncoding, Encoding encoding) {
+    AcceptedQ accepted = parseAcceptEncoding(acceptEncoding);
+    switch (encoding) {
+        case GZIP: return accepted.gzip > 0;
+        case BROTLI: return accepted.brotli > 0;
+        default: return true;
+    }
+}
+
+const char* HttpCompression::name(Encoding encoding) {
+    switch (encoding) {
+        case GZIP: return "gzip";
+        case BROTLI: return "br";
+        default: return "identity";
+    }
+}
+
+bool HttpCompression::compressible(const std::string& contentType) {
+    std::string type = lower(contentType.substr(0, contentType.find(';')));
+    if (type == "text/event-stream") {
+        return false; // 流式推送逐条写出，不能整体压缩
+    }
+    return type.compare(0, 5, "text/") == 0 ||
+           type == "application/json" ||
+           type == "application/javascript" ||
+           type == "application/xml" ||
+           type == "image/svg+xml";
+}
+
+bool HttpCompression::compress(Encoding encoding, const std::string& input, std::string& output, int level) {
+    if (encoding == GZIP) {
+#ifdef GEARTRACKER_WITH_ZLIB
+        z_stream stream = {};
+        // windowBits 15 + 16：输出 gzip 格式（而不是 zlib 格式）
+        if (deflateInit2(&stream, std::max(1, std::min(9, level)), Z_DEFLATED, 15 + 16, 8,
+                         Z_DEFAULT_STRATEGY) != Z_OK) {
+            return false;
+        }
+        output.resize(deflateBound(&stream, static_cast<uLong>(input.size())));
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        stream.avail_in = static_cast<uInt>(input.size());
+        stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+        stream.avail_out = static_cast<uInt>(output.size());
+        int rc = deflate(&stream, Z_FINISH);
+        output.resize(stream.total_out);
+        deflateEnd(&stream);
+        return rc == Z_STREAM_END;
+#endif
+    } else if (encoding == BROTLI) {
+#ifdef GEARTRACKER_WITH_BROTLI
+        size_t size = BrotliEncoderMaxCompressedSize(input.size());
+        if (size == 0) {
+            return false;
+        }
+        output.resize(size);
+        if (!BrotliEncoderCompress(std::max(0, std::min(11, level)), BROTLI_DEFAULT_WINDOW,
+                                   BROTLI_MODE_TEXT, input.size(),
+                                   reinterpret_cast<const uint8_t*>(input.data()), &size,
+                                   reinterpret_cast<uint8_t*>(&output[0]))) {
+            return false;
+        }
+        output.resize(size);
+        return true;
+#endif
+    }
+    return false;
+}
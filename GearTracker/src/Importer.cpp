@@ -0,0 +1,425 @@
+// ====== Importer.cpp ======
+#include "Importer.h"
+#include "Csv.h"
+#include "Database.h"
+#include "Logger.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+using json = nlohmann::json;
+
+namespace {
+
+const size_t kMaxNameBytes = 255;
+
+// 校验通过的一行
+struct Row {
+    size_t line = 0;
+    std::string raw;
+    Database::ImportItem item;
+    int quantity = 0; // 0 表示不添加库存
+    std::string location;
+    std::string reason;
+};
+
+// 读取线程交给写入线程的一批
+struct Chunk {
+    std::vector<Row> rows;
+    std::vector<Importer::Reject> rejects; // 校验失败的行
+    size_t records = 0;                    // 本批读取的数据行（含被拒绝的）
+    size_t bytesRead = 0;                  // 读到本批结束时的累计字节数
+};
+
+// 读取线程和写入线程之间的有界队列：最多积压 capacity 批，读取不会跑到写入前面太远
+class ChunkQueue {
+public:
+    explicit ChunkQueue(size_t capacity) : capacity_(capacity) {}
+
+    // 写入线程已放弃时返回 false
+    bool push(Chunk chunk) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [&] { return cancelled_ || chunks_.size() < capacity_; });
+        if (cancelled_) {
+            return false;
+        }
+        chunks_.push_back(std::move(chunk));
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    // 读取结束（error 非空表示无法继续）
+    void finish(const std::string& error) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_ = true;
+        error_ = error;
+        notEmpty_.notify_one();
+    }
+
+    // 没有更多的批次时返回 false
+    bool pop(Chunk& chunk) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [&] { return finished_ || !chunks_.empty(); });
+        if (chunks_.empty()) {
+            return false;
+        }
+        chunk = std::move(chunks_.front());
+        chunks_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+
+    void cancel() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelled_ = true;
+        chunks_.clear();
+        notFull_.notify_one();
+    }
+
+    std::string error() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return error_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+    std::deque<Chunk> chunks_;
+    size_t capacity_;
+    bool finished_ = false;
+    bool cancelled_ = false;
+    std::string error_;
+};
+
+std::string trimmed(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    return text.substr(begin, text.find_last_not_of(" \t") - begin + 1);
+}
+
+std::string lowered(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+// 一行的各列（CSV 按列名取值，NDJSON 按键取值），统一成字符串后校验
+struct Fields {
+    std::string name, category, grade, effect, description, note, quantity, location, reason;
+};
+
+// 校验并转换成 Row，失败时返回错误信息
+std::string validate(Fields& fields, Row& row) {
+    row.item.name = trimmed(fields.name);
+    if (row.item.name.empty()) {
+        return "缺少物品名称";
+    }
+    if (row.item.name.size() > kMaxNameBytes) {
+        return "物品名称超过 " + std::to_string(kMaxNameBytes) + " 字节";
+    }
+    row.item.category = trimmed(fields.category);
+    row.item.grade = trimmed(fields.grade);
+    row.item.effect = trimmed(fields.effect);
+    row.item.description = std::move(fields.description);
+    row.item.note = std::move(fields.note);
+    row.location = trimmed(fields.location);
+    row.reason = trimmed(fields.reason);
+
+    std::string quantity = trimmed(fields.quantity);
+    if (!quantity.empty()) {
+        const char* end = quantity.data() + quantity.size();
+        auto result = std::from_chars(quantity.data(), end, row.quantity);
+        if (result.ec != std::errc() || result.ptr != end || row.quantity <= 0) {
+            return "数量必须为正整数: " + quantity;
+        }
+        if (row.location.empty()) {
+            return "填写数量时位置不能为空";
+        }
+        if (row.location.size() > kMaxNameBytes) {
+            return "位置超过 " + std::to_string(kMaxNameBytes) + " 字节";
+        }
+    }
+    return "";
+}
+
+// 按行读取并校验，每 chunkRows 行交给队列一次。在单独的线程中运行
+class Reader {
+public:
+    Reader(std::istream& in, Importer::Format format, size_t chunkRows, ChunkQueue& queue)
+        : in_(in), format_(format), chunkRows_(chunkRows), queue_(queue) {}
+
+    void run() {
+        std::string error;
+        try {
+            error = format_ == Importer::CSV ? readCsv() : readNdjson();
+        } catch (const std::exception& e) {
+            error = std::string("读取输入失败: ") + e.what();
+        }
+        if (error.empty() && chunk_.records > 0) {
+            chunk_.bytesRead = bytes_;
+            queue_.push(std::move(chunk_));
+        }
+        queue_.finish(error);
+    }
+
+private:
+    std::string readCsv() {
+        CsvReader reader(in_);
+        std::vector<std::string> record;
+        std::string raw;
+        size_t line = 0;
+        bool broken = false;
+        if (!reader.next(record, line, raw, broken)) {
+            return "输入为空";
+        }
+        // 列名不区分大小写；未识别的列忽略
+        std::unordered_map<std::string, size_t> columns;
+        for (size_t i = 0; i < record.size(); ++i) {
+            columns.emplace(lowered(trimmed(record[i])), i);
+        }
+        if (!columns.count("name") && !columns.count("item_name")) {
+            return "CSV 首行缺少 name（或 item_name）列";
+        }
+        auto column = [&](const char* name) -> std::string {
+            auto it = columns.find(name);
+            return it != columns.end() && it->second < record.size() ? record[it->second] : std::string();
+        };
+
+        while (reader.next(record, line, raw, broken)) {
+            bytes_ = reader.bytesRead();
+            if (record.size() == 1 && trimmed(record[0]).empty() && !broken) {
+                continue; // 空行
+            }
+            if (broken) {
+                reject(line, raw, "引号没有闭合");
+                continue;
+            }
+            Fields fields;
+            fields.name = column("name");
+            if (fields.name.empty()) {
+                fields.name = column("item_name");
+            }
+            fields.category = column("category");
+            fields.grade = column("grade");
+            fields.effect = column("effect");
+            fields.description = column("description");
+            fields.note = column("note");
+            fields.quantity = column("quantity");
+            fields.location = column("location");
+            fields.reason = column("reason");
+            if (!accept(line, raw, fields)) {
+                return "";
+            }
+        }
+        bytes_ = reader.bytesRead();
+        return "";
+    }
+
+    std::string readNdjson() {
+        std::string text;
+        size_t line = 0;
+        while (std::getline(in_, text)) {
+            ++line;
+            bytes_ += text.size() + 1;
+            if (!text.empty() && text.back() == '\r') {
+                text.pop_back();
+            }
+            if (trimmed(text).empty()) {
+                continue;
+            }
+            json object = json::parse(text, nullptr, false);
+            if (object.is_discarded() || !object.is_object()) {
+                reject(line, text, "不是有效的 JSON 对象");
+                continue;
+            }
+            Fields fields;
+            std::string error;
+            // 字符串原样取值，数字转成文本（quantity 可以写成 3 或 "3"）
+            auto take = [&](const char* key, std::string& out) {
+                auto it = object.find(key);
+                if (it == object.end() || it->is_null()) return;
+                if (it->is_string()) {
+                    out = it->get<std::string>();
+                } else if (it->is_number_integer()) {
+                    out = std::to_string(it->get<long long>());
+                } else if (error.empty()) {
+                    error = std::string("字段 ") + key + " 的类型不正确";
+                }
+            };
+            take("name", fields.name);
+            if (fields.name.empty()) {
+                take("item_name", fields.name);
+            }
+            take("category", fields.category);
+            take("grade", fields.grade);
+            take("effect", fields.effect);
+            take("description", fields.description);
+            take("note", fields.note);
+            take("quantity", fields.quantity);
+            take("location", fields.location);
+            take("reason", fields.reason);
+            if (!error.empty()) {
+                reject(line, text, error);
+                continue;
+            }
+            if (!accept(line, text, fields)) {
+                return "";
+            }
+        }
+        return "";
+    }
+
+    void reject(size_t line, const std::string& raw, const std::string& error) {
+        Importer::Reject item;
+        item.line = line;
+        item.error = error;
+        item.row = raw;
+        chunk_.rejects.push_back(std::move(item));
+        ++chunk_.records;
+    }
+
+    // 写入线程已放弃时返回 false
+    bool accept(size_t line, const std::string& raw, Fields& fields) {
+        Row row;
+        row.line = line;
+        std::string error = validate(fields, row);
+        if (!error.empty()) {
+            reject(line, raw, error);
+        } else {
+            row.raw = raw;
+            chunk_.rows.push_back(std::move(row));
+            ++chunk_.records;
+        }
+        if (chunk_.records < chunkRows_) {
+            return true;
+        }
+        chunk_.bytesRead = bytes_;
+        bool ok = queue_.push(std::move(chunk_));
+        chunk_ = Chunk();
+        return ok;
+    }
+
+    std::istream& in_;
+    Importer::Format format_;
+    size_t chunkRows_;
+    ChunkQueue& queue_;
+    Chunk chunk_;
+    size_t bytes_ = 0;
+};
+
+} // namespace
+
+bool Importer::formatFromName(const std::string& name, Format& format) {
+    std::string lower = lowered(name);
+    size_t dot = lower.rfind('.');
+    std::string ext = dot == std::string::npos ? lower : lower.substr(dot + 1);
+    if (ext == "csv") {
+        format = CSV;
+        return true;
+    }
+    if (ext == "ndjson" || ext == "jsonl") {
+        format = NDJSON;
+        return true;
+    }
+    return false;
+}
+
+bool Importer::run(Database& db, std::istream& in, Format format, const Options& options,
+                   Progress& progress, std::string& error) {
+    progress = Progress();
+    error.clear();
+    auto started = std::chrono::steady_clock::now();
+    size_t chunkRows = std::max<size_t>(1, options.chunkRows);
+
+    ChunkQueue queue(2);
+    Reader reader(in, format, chunkRows, queue);
+    std::thread readerThread(&Reader::run, &reader);
+
+    auto rejectRow = [&](Reject item) {
+        ++progress.rejected;
+        if (options.onReject) {
+            options.onReject(item);
+        }
+    };
+
+    Chunk chunk;
+    while (queue.pop(chunk)) {
+        for (auto& item : chunk.rejects) {
+            rejectRow(std::move(item));
+        }
+
+        if (!chunk.rows.empty()) {
+            // 1. 查找/创建物品
+            std::vector<Database::ImportItem> items;
+            items.reserve(chunk.rows.size());
+            for (const auto& row : chunk.rows) {
+                items.push_back(row.item);
+            }
+            std::vector<int> itemIds;
+            size_t created = 0;
+            if (!db.importItems(items, options.reason, itemIds, created)) {
+                error = "第 " + std::to_string(chunk.rows.front().line) + " 行起的一批物品写入失败";
+                queue.cancel();
+                break;
+            }
+            progress.itemsCreated += created;
+
+            // 2. 库存，不合法的操作单独拒绝
+            std::vector<Database::InventoryOperation> ops;
+            std::vector<const Row*> opRows;
+            for (size_t i = 0; i < chunk.rows.size(); ++i) {
+                const Row& row = chunk.rows[i];
+                if (itemIds[i] <= 0) {
+                    rejectRow({row.line, "物品不存在，且缺少类别或品质无法创建", row.raw});
+                    continue;
+                }
+                if (row.quantity <= 0) {
+                    continue;
+                }
+                Database::InventoryOperation op;
+                op.type = Database::InventoryOperation::ADD;
+                op.itemId = itemIds[i];
+                op.quantity = row.quantity;
+                op.location = row.location;
+                op.reason = row.reason.empty() ? options.reason : row.reason;
+                ops.push_back(std::move(op));
+                opRows.push_back(&row);
+            }
+            std::vector<Database::InventoryOperationResult> results;
+            db.applyInventoryBatch(ops, false, results);
+            for (size_t i = 0; i < results.size(); ++i) {
+                if (results[i].success) {
+                    ++progress.inventoryAdded;
+                } else {
+                    rejectRow({opRows[i]->line, "添加库存失败: " + results[i].error, opRows[i]->raw});
+                }
+            }
+        }
+
+        progress.rows += chunk.records;
+        progress.bytesRead = chunk.bytesRead;
+        progress.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        if (options.onProgress) {
+            options.onProgress(progress);
+        }
+    }
+    readerThread.join();
+
+    if (error.empty()) {
+        error = queue.error();
+    }
+    progress.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    GT_LOG_INFO("批量导入结束: " + std::to_string(progress.rows) + " 行, 新建物品 " +
+                std::to_string(progress.itemsCreated) + ", 添加库存 " + std::to_string(progress.inventoryAdded) +
+                ", 拒绝 " + std::to_string(progress.rejected) + (error.empty() ? "" : ", 错误: " + error));
+    return error.empty();
+}
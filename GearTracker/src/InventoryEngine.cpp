@@ -0,0 +1,795 @@
+// ====== InventoryEngine.cpp ======
+#include "InventoryEngine.h"
+#include "Logger.h"
+#include "PageCursor.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 文件格式（整数按本机字节序，字符串为 u32 长度 + 字节）：
+//   快照  "GTINVSN1" | u32 版本 | u64 序号 | i32 下一个 id | u64 行数 | 行... | u32 校验和
+//   WAL   记录序列，每条为 u32 长度 | u32 校验和 | 内容；内容为 u64 批次序号 | u8 类型 | ...
+//         PUT 后跟完整的行，DELETE 后跟 i32 id，COMMIT 表示该批次完整。
+//         重放时只应用带 COMMIT 的批次，末尾不完整的写入会被截掉
+// 行：i32 id | i32 item_id | i32 数量 | 位置 | 入库时间 | 更新时间
+namespace {
+
+const char kSnapshotMagic[8] = {'G', 'T', 'I', 'N', 'V', 'S', 'N', '1'};
+const uint32_t kSnapshotVersion = 1;
+
+enum WalType : uint8_t { WAL_PUT = 1, WAL_DELETE = 2, WAL_COMMIT = 3 };
+
+// FNV-1a，用于发现截断或损坏的数据
+uint32_t checksum(const char* data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+template <typename T>
+void putValue(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void putString(std::string& out, const std::string& text) {
+    putValue<uint32_t>(out, static_cast<uint32_t>(text.size()));
+    out.append(text);
+}
+
+void putRow(std::string& out, const InventoryEngine::Row& row) {
+    putValue<int32_t>(out, row.id);
+    putValue<int32_t>(out, row.itemId);
+    putValue<int32_t>(out, row.quantity);
+    putString(out, row.location);
+    putString(out, row.storedTime);
+    putString(out, row.lastUpdated);
+}
+
+struct Reader {
+    const char* pos;
+    const char* end;
+
+    template <typename T>
+    bool value(T& out) {
+        if (static_cast<size_t>(end - pos) < sizeof(T)) return false;
+        std::memcpy(&out, pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+
+    bool string(std::string& out) {
+        uint32_t length = 0;
+        if (!value(length) || static_cast<size_t>(end - pos) < length) return false;
+        out.assign(pos, length);
+        pos += length;
+        return true;
+    }
+
+    bool row(InventoryEngine::Row& out) {
+        int32_t id = 0, itemId = 0, quantity = 0;
+        if (!value(id) || !value(itemId) || !value(quantity) ||
+            !string(out.location) || !string(out.storedTime) || !string(out.lastUpdated)) {
+            return false;
+        }
+        out.id = id;
+        out.itemId = itemId;
+        out.quantity = quantity;
+        return true;
+    }
+};
+
+void putWalRecord(std::string& out, uint64_t seq, WalType type, const std::string& body) {
+    std::string payload;
+    putValue<uint64_t>(payload, seq);
+    putValue<uint8_t>(payload, type);
+    payload.append(body);
+    putValue<uint32_t>(out, static_cast<uint32_t>(payload.size()));
+    putValue<uint32_t>(out, checksum(payload.data(), payload.size()));
+    out.append(payload);
+}
+
+bool readFile(const std::string& path, std::string& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad();
+}
+
+bool writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = ::write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// 先写临时文件并 fsync，再改名替换，保证文件要么是旧内容要么是完整的新内容
+bool replaceFile(const std::string& path, const std::string& data) {
+    std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    bool ok = writeAll(fd, data.data(), data.size()) && ::fsync(fd) == 0;
+    ::close(fd);
+    if (!ok || ::rename(tmp.c_str(), path.c_str()) != 0) {
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    // 改名本身也要落盘
+    std::string dir = path.find('/') == std::string::npos ? "." : path.substr(0, path.rfind('/'));
+    int dirFd = ::open(dir.empty() ? "/" : dir.c_str(), O_RDONLY | O_CLOEXEC);
+    if (dirFd >= 0) {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+    return true;
+}
+
+bool fileExists(const std::string& path) {
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0 && st.st_size > 0;
+}
+
+} // namespace
+
+InventoryEngine& InventoryEngine::instance() {
+    static InventoryEngine engine;
+    return engine;
+}
+
+InventoryEngine::~InventoryEngine() {
+    shutdown();
+}
+
+const char* InventoryEngine::modeName(Mode mode) {
+    switch (mode) {
+        case CACHE: return "cache";
+        case PRIMARY: return "primary";
+        default: return "off";
+    }
+}
+
+void InventoryEngine::configure(Config& config) {
+    if (configured_) {
+        return; // 运行中不切换工作方式
+    }
+    configured_ = true;
+
+    std::string mode = config.getString("application", "inventory_engine", "off");
+    std::transform(mode.begin(), mode.end(), mode.begin(),
+                   [](unsigned char c){ return std::tolower(c); });
+    if (mode == "cache") {
+        mode_ = CACHE;
+    } else if (mode == "primary") {
+        mode_ = PRIMARY;
+    } else {
+        if (mode != "off") {
+            GT_LOG_WARNING("未知的 inventory_engine: " + mode + "，按 off 处理");
+        }
+        mode_ = OFF;
+        return;
+    }
+
+    snapshotPath_ = config.getString("application", "inventory_snapshot", "inventory.snapshot");
+    walPath_ = config.getString("application", "inventory_wal", "inventory.wal");
+    snapshotInterval_ = std::chrono::seconds(
+        std::max(1, config.getInt("application", "inventory_snapshot_interval", 300)));
+    snapshotAfterBatches_ = static_cast<uint64_t>(
+        std::max(1, config.getInt("application", "inventory_snapshot_wal_records", 10000)));
+
+    if (mode_ == CACHE) {
+        GT_LOG_INFO("库存引擎: 直写缓存模式，等待从数据库加载");
+        return;
+    }
+
+    if (!recover()) {
+        GT_LOG_ERROR("库存引擎恢复失败，库存读写不可用。请检查 " + snapshotPath_ + " 和 " + walPath_);
+        return;
+    }
+    if (!needsSeed_) {
+        ready_.store(true, std::memory_order_release);
+        GT_LOG_INFO("库存引擎: 主存储模式，已恢复 " + std::to_string(size()) + " 条库存（WAL 批次 " +
+                    std::to_string(walBatches_.load()) + "）");
+    } else {
+        GT_LOG_INFO("库存引擎: 主存储模式，没有快照和 WAL，等待从数据库导入");
+    }
+    stopping_ = false;
+    snapshotter_ = std::thread(&InventoryEngine::snapshotLoop, this);
+}
+
+void InventoryEngine::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(loopMutex_);
+        stopping_ = true;
+    }
+    loopCv_.notify_all();
+    if (snapshotter_.joinable()) {
+        snapshotter_.join();
+    }
+    if (mode_ == PRIMARY && ready() && walBatches_.load() > 0) {
+        snapshot();
+    }
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    if (walFd_ >= 0) {
+        ::close(walFd_);
+        walFd_ = -1;
+    }
+}
+
+// ---------- 内存表 ----------
+
+void InventoryEngine::put(Row row) {
+    auto it = rows_.find(row.id);
+    if (it != rows_.end()) {
+        const Row& old = it->second;
+        if (old.itemId != row.itemId) {
+            auto item = byItem_.find(old.itemId);
+            item->second.erase(old.id);
+            if (item->second.empty()) byItem_.erase(item);
+        }
+        if (old.location != row.location) {
+            auto location = byLocation_.find(old.location);
+            location->second.erase(old.id);
+            if (location->second.empty()) byLocation_.erase(location);
+        }
+        byUpdated_.erase(OrderKey(old.lastUpdated, old.id));
+    }
+    byItem_[row.itemId].insert(row.id);
+    byLocation_[row.location].insert(row.id);
+    byUpdated_.insert(OrderKey(row.lastUpdated, row.id));
+    nextId_ = std::max(nextId_, row.id + 1);
+    rows_[row.id] = std::move(row);
+}
+
+void InventoryEngine::erase(int id) {
+    auto it = rows_.find(id);
+    if (it == rows_.end()) {
+        return;
+    }
+    const Row& old = it->second;
+    auto item = byItem_.find(old.itemId);
+    item->second.erase(id);
+    if (item->second.empty()) byItem_.erase(item);
+    auto location = byLocation_.find(old.location);
+    location->second.erase(id);
+    if (location->second.empty()) byLocation_.erase(location);
+    byUpdated_.erase(OrderKey(old.lastUpdated, id));
+    rows_.erase(it);
+}
+
+void InventoryEngine::clear() {
+    rows_.clear();
+    byItem_.clear();
+    byLocation_.clear();
+    byUpdated_.clear();
+    nextId_ = 1;
+}
+
+bool InventoryEngine::load(std::vector<Row> rows) {
+    if (mode_ == OFF) {
+        return false;
+    }
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        clear();
+        for (auto& row : rows) {
+            put(std::move(row));
+        }
+    }
+    if (mode_ == PRIMARY) {
+        // 导入的数据先写成快照，之后的写入只进 WAL
+        ready_.store(true, std::memory_order_release);
+        if (!snapshot()) {
+            ready_.store(false, std::memory_order_release);
+            GT_LOG_ERROR("库存引擎导入后写快照失败: " + snapshotPath_);
+            return false;
+        }
+        needsSeed_ = false;
+    }
+    ready_.store(true, std::memory_order_release);
+    GT_LOG_INFO("库存引擎已加载 " + std::to_string(size()) + " 条库存");
+    return true;
+}
+
+// ---------- 查询 ----------
+
+bool InventoryEngine::find(int id, Row& row) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = rows_.find(id);
+    if (it == rows_.end()) {
+        return false;
+    }
+    row = it->second;
+    return true;
+}
+
+std::vector<InventoryEngine::Row> InventoryEngine::findMany(const std::vector<int>& ids) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<Row> rows;
+    rows.reserve(ids.size());
+    for (int id : ids) {
+        auto it = rows_.find(id);
+        if (it != rows_.end()) {
+            rows.push_back(it->second);
+        }
+    }
+    return rows;
+}
+
+std::vector<InventoryEngine::Row> InventoryEngine::byItem(int itemId) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<Row> rows;
+    auto item = byItem_.find(itemId);
+    if (item == byItem_.end()) {
+        return rows;
+    }
+    for (int id : item->second) {
+        rows.push_back(rows_.at(id));
+    }
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+        return OrderKey(a.lastUpdated, a.id) > OrderKey(b.lastUpdated, b.id);
+    });
+    return rows;
+}
+
+// 筛选只检查不同的物品和位置（通常远少于行数），再经二级索引取出对应的行
+std::vector<int> InventoryEngine::matchIds(const Match& match) const {
+    std::vector<int> ids;
+    if (match.item) {
+        for (const auto& item : byItem_) {
+            if (match.item(item.first)) {
+                ids.insert(ids.end(), item.second.begin(), item.second.end());
+            }
+        }
+    }
+    if (match.location) {
+        for (const auto& location : byLocation_) {
+            if (match.location(location.first)) {
+                ids.insert(ids.end(), location.second.begin(), location.second.end());
+            }
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+std::vector<InventoryEngine::Row> InventoryEngine::page(const SearchIndex::PageRequest& request,
+                                                        const Match& match) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    // id 为 0 的游标表示从该时间起（含该时间），批量导出的时间下限用到
+    bool hasCursor = request.cursor && !request.cursor->sortTime.empty();
+    OrderKey cursorKey;
+    if (hasCursor) {
+        cursorKey = OrderKey(request.cursor->sortTime, static_cast<int>(request.cursor->id));
+    }
+
+    std::vector<Row> rows;
+    size_t skip = hasCursor ? 0 : request.offset;
+    auto take = [&](const OrderKey& key) {
+        if (skip > 0) {
+            --skip;
+            return true;
+        }
+        rows.push_back(rows_.at(key.second));
+        return rows.size() < request.limit;
+    };
+
+    if (match.empty()) {
+        // 直接沿 (last_updated, id) 索引从游标处开始
+        if (request.backward) {
+            auto it = hasCursor ? byUpdated_.upper_bound(cursorKey) : byUpdated_.begin();
+            for (; it != byUpdated_.end() && take(*it); ++it) {
+            }
+        } else {
+            auto it = hasCursor ? std::make_reverse_iterator(byUpdated_.lower_bound(cursorKey))
+                                : byUpdated_.rbegin();
+            for (; it != byUpdated_.rend() && take(*it); ++it) {
+            }
+        }
+        return rows;
+    }
+
+    std::vector<OrderKey> keys;
+    for (int id : matchIds(match)) {
+        OrderKey key(rows_.at(id).lastUpdated, id);
+        if (!hasCursor || (request.backward ? key > cursorKey : key < cursorKey)) {
+            keys.push_back(std::move(key));
+        }
+    }
+    if (request.backward) {
+        std::sort(keys.begin(), keys.end());
+    } else {
+        std::sort(keys.begin(), keys.end(), std::greater<OrderKey>());
+    }
+    for (const auto& key : keys) {
+        if (!take(key)) break;
+    }
+    return rows;
+}
+
+long long InventoryEngine::count(const Match& match) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (match.empty()) {
+        return static_cast<long long>(rows_.size());
+    }
+    return static_cast<long long>(matchIds(match).size());
+}
+
+size_t InventoryEngine::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return rows_.size();
+}
+
+void InventoryEngine::forEach(const std::function<void(const Row&)>& fn) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    for (const auto& entry : rows_) {
+        fn(entry.second);
+    }
+}
+
+// ---------- 写入 ----------
+
+bool InventoryEngine::commit(Changes& changes) {
+    if (mode_ != PRIMARY || !ready()) {
+        return false;
+    }
+    std::string now = currentSortTime();
+    uint64_t seq = lastSeq_ + 1;
+    int nextId = nextId_;
+
+    // 先生成完整的新行和 WAL 记录，WAL 落盘后才修改内存
+    for (auto& row : changes.added) {
+        row.id = nextId++;
+        row.storedTime = now;
+        row.lastUpdated = now;
+    }
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        for (auto& row : changes.updated) {
+            auto it = rows_.find(row.id);
+            if (it == rows_.end()) continue; // 调用方已在写锁内校验过
+            row.itemId = it->second.itemId;
+            row.storedTime = it->second.storedTime;
+            row.lastUpdated = now;
+        }
+    }
+
+    std::string data;
+    std::string body;
+    for (const auto* group : {&changes.added, &changes.updated}) {
+        for (const auto& row : *group) {
+            body.clear();
+            putRow(body, row);
+            putWalRecord(data, seq, WAL_PUT, body);
+        }
+    }
+    for (int id : changes.removed) {
+        body.clear();
+        putValue<int32_t>(body, id);
+        putWalRecord(data, seq, WAL_DELETE, body);
+    }
+    putWalRecord(data, seq, WAL_COMMIT, std::string());
+
+    if (!appendWal(data)) {
+        return false;
+    }
+    lastSeq_ = seq;
+
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        nextId_ = nextId;
+        for (const auto* group : {&changes.added, &changes.updated}) {
+            for (const auto& row : *group) {
+                put(row);
+            }
+        }
+        for (int id : changes.removed) {
+            erase(id);
+        }
+    }
+
+    if (walBatches_.fetch_add(1) + 1 >= snapshotAfterBatches_) {
+        loopCv_.notify_all();
+    }
+    return true;
+}
+
+void InventoryEngine::apply(const std::vector<Row>& upserts, const std::vector<int>& removed) {
+    if (mode_ != CACHE || !ready()) {
+        return;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    for (const auto& row : upserts) {
+        auto it = rows_.find(row.id);
+        if (it == rows_.end() || it->second.lastUpdated <= row.lastUpdated) {
+            put(row);
+        }
+    }
+    for (int id : removed) {
+        erase(id);
+    }
+}
+
+void InventoryEngine::invalidate() {
+    if (mode_ != CACHE) {
+        return;
+    }
+    ready_.store(false, std::memory_order_release);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    clear();
+}
+
+// ---------- 持久化（primary 模式） ----------
+
+bool InventoryEngine::openWal() {
+    walFd_ = ::open(walPath_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (walFd_ < 0) {
+        GT_LOG_ERROR("无法打开库存 WAL " + walPath_ + ": " + std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool InventoryEngine::appendWal(const std::string& data) {
+    if (walFd_ < 0) {
+        return false;
+    }
+    if (!writeAll(walFd_, data.data(), data.size()) || ::fdatasync(walFd_) != 0) {
+        GT_LOG_ERROR("写入库存 WAL 失败: " + std::string(std::strerror(errno)));
+        // 去掉可能已写入的半条记录，后续追加仍从完整的边界开始
+        if (::ftruncate(walFd_, static_cast<off_t>(walBytes_.load())) != 0) {
+            GT_LOG_ERROR("截断库存 WAL 失败: " + std::string(std::strerror(errno)));
+        }
+        return false;
+    }
+    walBytes_ += data.size();
+    return true;
+}
+
+bool InventoryEngine::recover() {
+    bool hasSnapshot = fileExists(snapshotPath_);
+    bool hasWal = fileExists(walPath_);
+    uint64_t seq = 0;
+    if (!hasSnapshot && !hasWal) {
+        needsSeed_ = true;
+        return openWal();
+    }
+    if (hasSnapshot && !readSnapshot(seq)) {
+        return false;
+    }
+    snapshotSeq_ = seq;
+    lastSeq_ = seq;
+    if (hasWal && !replayWal(seq)) {
+        return false;
+    }
+    return openWal();
+}
+
+bool InventoryEngine::readSnapshot(uint64_t& seq) {
+    std::string data;
+    if (!readFile(snapshotPath_, data)) {
+        GT_LOG_ERROR("无法读取库存快照: " + snapshotPath_);
+        return false;
+    }
+    if (data.size() < sizeof(kSnapshotMagic) + sizeof(uint32_t) ||
+        std::memcmp(data.data(), kSnapshotMagic, sizeof(kSnapshotMagic)) != 0) {
+        GT_LOG_ERROR("库存快照格式不正确: " + snapshotPath_);
+        return false;
+    }
+    size_t bodySize = data.size() - sizeof(uint32_t);
+    uint32_t stored = 0;
+    std::memcpy(&stored, data.data() + bodySize, sizeof(stored));
+    if (stored != checksum(data.data(), bodySize)) {
+        GT_LOG_ERROR("库存快照校验失败: " + snapshotPath_);
+        return false;
+    }
+
+    Reader in{data.data() + sizeof(kSnapshotMagic), data.data() + bodySize};
+    uint32_t version = 0;
+    int32_t nextId = 1;
+    uint64_t count = 0;
+    if (!in.value(version) || version != kSnapshotVersion ||
+        !in.value(seq) || !in.value(nextId) || !in.value(count)) {
+        GT_LOG_ERROR("库存快照版本不支持: " + snapshotPath_);
+        return false;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    clear();
+    rows_.reserve(static_cast<size_t>(count));
+    for (uint64_t i = 0; i < count; ++i) {
+        Row row;
+        if (!in.row(row)) {
+            GT_LOG_ERROR("库存快照数据不完整: " + snapshotPath_);
+            clear();
+            return false;
+        }
+        put(std::move(row));
+    }
+    nextId_ = std::max(nextId_, static_cast<int>(nextId));
+    return true;
+}
+
+bool InventoryEngine::replayWal(uint64_t afterSeq) {
+    std::string data;
+    if (!readFile(walPath_, data)) {
+        GT_LOG_ERROR("无法读取库存 WAL: " + walPath_);
+        return false;
+    }
+
+    struct Pending {
+        bool remove;
+        Row row;
+    };
+    std::vector<Pending> batch;
+    uint64_t batchSeq = 0;
+    uint64_t batches = 0;
+    size_t validEnd = 0;
+    Reader in{data.data(), data.data() + data.size()};
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    while (in.pos < in.end) {
+        uint32_t length = 0;
+        uint32_t sum = 0;
+        if (!in.value(length) || !in.value(sum) || static_cast<size_t>(in.end - in.pos) < length ||
+            checksum(in.pos, length) != sum) {
+            break;
+        }
+        Reader record{in.pos, in.pos + length};
+        in.pos += length;
+
+        uint64_t seq = 0;
+        uint8_t type = 0;
+        if (!record.value(seq) || !record.value(type)) break;
+        if (seq != batchSeq) {
+            batch.clear(); // 上一批没有 COMMIT，丢弃
+            batchSeq = seq;
+        }
+        if (type == WAL_PUT) {
+            Pending op{false, Row()};
+            if (!record.row(op.row)) break;
+            batch.push_back(std::move(op));
+        } else if (type == WAL_DELETE) {
+            int32_t id = 0;
+            if (!record.value(id)) break;
+            Pending op{true, Row()};
+            op.row.id = id;
+            batch.push_back(std::move(op));
+        } else if (type == WAL_COMMIT) {
+            if (seq > afterSeq) {
+                for (auto& op : batch) {
+                    if (op.remove) {
+                        erase(op.row.id);
+                    } else {
+                        put(std::move(op.row));
+                    }
+                }
+                lastSeq_ = std::max(lastSeq_, seq);
+                ++batches;
+            }
+            batch.clear();
+            validEnd = static_cast<size_t>(in.pos - data.data());
+        } else {
+            break;
+        }
+    }
+    lock.unlock();
+
+    if (validEnd < data.size()) {
+        GT_LOG_WARNING("库存 WAL 末尾有 " + std::to_string(data.size() - validEnd) +
+                       " 字节不完整的写入，已丢弃");
+        if (::truncate(walPath_.c_str(), static_cast<off_t>(validEnd)) != 0) {
+            GT_LOG_ERROR("截断库存 WAL 失败: " + std::string(std::strerror(errno)));
+            return false;
+        }
+    }
+    walBytes_ = validEnd;
+    walBatches_ = batches;
+    return true;
+}
+
+// 写快照时只在复制内存数据的短时间内阻塞写入；快照落盘后，复制之后追加的 WAL 记录保留下来，
+// 之前的部分截掉
+bool InventoryEngine::snapshot() {
+    if (mode_ != PRIMARY || !ready()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> snapshotLock(snapshotMutex_);
+
+    std::string data(kSnapshotMagic, sizeof(kSnapshotMagic));
+    uint64_t seq = 0;
+    uint64_t walSize = 0;
+    uint64_t batches = 0;
+    {
+        std::lock_guard<std::mutex> writeLock(writeMutex_);
+        seq = lastSeq_;
+        walSize = walBytes_.load();
+        batches = walBatches_.load();
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        data.reserve(data.size() + rows_.size() * 64);
+        putValue<uint32_t>(data, kSnapshotVersion);
+        putValue<uint64_t>(data, seq);
+        putValue<int32_t>(data, nextId_);
+        putValue<uint64_t>(data, rows_.size());
+        for (const auto& entry : rows_) {
+            putRow(data, entry.second);
+        }
+    }
+    putValue<uint32_t>(data, checksum(data.data(), data.size()));
+
+    if (!replaceFile(snapshotPath_, data)) {
+        GT_LOG_ERROR("写入库存快照失败: " + snapshotPath_ + ": " + std::strerror(errno));
+        return false;
+    }
+
+    std::lock_guard<std::mutex> writeLock(writeMutex_);
+    if (walBytes_.load() == walSize) {
+        if (walFd_ >= 0 && ::ftruncate(walFd_, 0) != 0) {
+            GT_LOG_WARNING("截断库存 WAL 失败: " + std::string(std::strerror(errno)));
+        } else {
+            walBytes_ = 0;
+        }
+    } else {
+        // 复制期间之后又有写入：只保留快照之后的记录
+        std::string wal;
+        if (readFile(walPath_, wal) && wal.size() >= walSize) {
+            std::string tail = wal.substr(static_cast<size_t>(walSize));
+            if (replaceFile(walPath_, tail)) {
+                ::close(walFd_);
+                openWal();
+                walBytes_ = tail.size();
+            }
+        }
+    }
+    walBatches_ -= std::min(batches, walBatches_.load());
+    snapshotSeq_ = seq;
+    snapshots_++;
+    GT_LOG_INFO("库存快照已写入: " + std::to_string(data.size()) + " 字节，序号 " + std::to_string(seq));
+    return true;
+}
+
+void InventoryEngine::snapshotLoop() {
+    std::unique_lock<std::mutex> lock(loopMutex_);
+    while (!stopping_) {
+        loopCv_.wait_for(lock, snapshotInterval_, [this] {
+            return stopping_ || walBatches_.load() >= snapshotAfterBatches_;
+        });
+        if (stopping_) break;
+        if (walBatches_.load() == 0 || !ready()) continue;
+        lock.unlock();
+        snapshot();
+        lock.lock();
+    }
+}
+
+InventoryEngine::Stats InventoryEngine::getStats() const {
+    Stats stats;
+    stats.mode = mode_;
+    stats.ready = ready();
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        stats.rows = rows_.size();
+        stats.items = byItem_.size();
+        stats.locations = byLocation_.size();
+    }
+    stats.walBatches = walBatches_.load();
+    stats.walBytes = walBytes_.load();
+    stats.snapshots = snapshots_.load();
+    stats.lastSnapshotSeq = snapshotSeq_;
+    return stats;
+}
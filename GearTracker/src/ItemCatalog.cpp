@@ -0,0 +1,98 @@
+// ====== ItemCatalog.cpp ======
+#include "ItemCatalog.h"
+#include <mutex>
+
+ItemCatalog& ItemCatalog::instance() {
+    static ItemCatalog catalog;
+    return catalog;
+}
+
+std::string ItemCatalog::nameKey(const std::string& name) {
+    std::string key = name;
+    while (!key.empty() && key.back() == ' ') {
+        key.pop_back();
+    }
+    for (char& c : key) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    return key;
+}
+
+void ItemCatalog::replace(std::vector<Item> items, const Version& version) {
+    std::unordered_map<int, Item> byId;
+    std::unordered_map<std::string, int> byName;
+    byId.reserve(items.size());
+    byName.reserve(items.size());
+    for (auto& item : items) {
+        byName[nameKey(item.name)] = item.id;
+        int id = item.id;
+        byId[id] = std::move(item);
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    byId_.swap(byId);
+    byName_.swap(byName);
+    version_ = version;
+    ready_.store(true, std::memory_order_release);
+}
+
+void ItemCatalog::upsert(const Item& item) {
+    if (item.id <= 0) {
+        return;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = byId_.find(item.id);
+    if (it != byId_.end()) {
+        byName_.erase(nameKey(it->second.name));
+    }
+    byId_[item.id] = item;
+    byName_[nameKey(item.name)] = item.id;
+}
+
+int ItemCatalog::idOf(const std::string& name) const {
+    std::string key = nameKey(name);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = byName_.find(key);
+    return it == byName_.end() ? -1 : it->second;
+}
+
+bool ItemCatalog::findByName(const std::string& name, Item& item) const {
+    std::string key = nameKey(name);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = byName_.find(key);
+    if (it == byName_.end()) {
+        return false;
+    }
+    item = byId_.at(it->second);
+    return true;
+}
+
+bool ItemCatalog::findById(int id, Item& item) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = byId_.find(id);
+    if (it == byId_.end()) {
+        return false;
+    }
+    item = it->second;
+    return true;
+}
+
+bool ItemCatalog::nameOf(int id, std::string& name) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = byId_.find(id);
+    if (it == byId_.end()) {
+        return false;
+    }
+    name = it->second.name;
+    return true;
+}
+
+ItemCatalog::Version ItemCatalog::version() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return version_;
+}
+
+size_t ItemCatalog::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return byId_.size();
+}
@@ -0,0 +1,227 @@
+// ====== JsonWriter.cpp ======
+#include "JsonWriter.h"
+#include <charconv>
+#include <cmath>
+
+// 需要转义的 ASCII 字节：0 不转义，'u' 输出 \u00XX，其余为反斜杠后的字符
+static const char kEscape[128] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 'u',
+};
+
+static const char kHex[] = "0123456789abcdef";
+
+// 从 p 开始的合法 UTF-8 多字节序列的长度，不合法返回 0（拒绝过长编码、代理区和超出 U+10FFFF 的值）
+static size_t utf8Length(const unsigned char* p, const unsigned char* end) {
+    unsigned char c = p[0];
+    size_t len;
+    unsigned char lo = 0x80, hi = 0xBF; // 第二个字节的范围
+    if (c >= 0xC2 && c <= 0xDF) {
+        len = 2;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+        len = 3;
+        if (c == 0xE0) lo = 0xA0;
+        if (c == 0xED) hi = 0x9F;
+    } else if (c >= 0xF0 && c <= 0xF4) {
+        len = 4;
+        if (c == 0xF0) lo = 0x90;
+        if (c == 0xF4) hi = 0x8F;
+    } else {
+        return 0;
+    }
+    if (static_cast<size_t>(end - p) < len || p[1] < lo || p[1] > hi) {
+        return 0;
+    }
+    for (size_t i = 2; i < len; ++i) {
+        if ((p[i] & 0xC0) != 0x80) return 0;
+    }
+    return len;
+}
+
+JsonWriter::JsonWriter(size_t reserveBytes) {
+    buf_.reserve(reserveBytes);
+    hasItems_.reserve(8);
+}
+
+JsonWriter::JsonWriter(Sink sink, size_t flushBytes)
+    : sink_(std::move(sink)), flushBytes_(flushBytes) {
+    buf_.reserve(flushBytes + flushBytes / 4);
+    hasItems_.reserve(8);
+}
+
+void JsonWriter::escape(std::string& out, std::string_view text) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data());
+    const unsigned char* end = p + text.size();
+    const unsigned char* run = p; // 尚未追加的、不需要转义的一段
+    while (p < end) {
+        unsigned char c = *p;
+        if (c < 0x80) {
+            char esc = kEscape[c];
+            if (esc == 0) {
+                ++p;
+                continue;
+            }
+            out.append(reinterpret_cast<const char*>(run), p - run);
+            if (esc == 'u') {
+                char seq[6] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 15]};
+                out.append(seq, 6);
+            } else {
+                char seq[2] = {'\\', esc};
+                out.append(seq, 2);
+            }
+            run = ++p;
+            continue;
+        }
+        size_t len = utf8Length(p, end);
+        if (len > 0) {
+            p += len;
+            continue;
+        }
+        out.append(reinterpret_cast<const char*>(run), p - run);
+        out.append("\xEF\xBF\xBD", 3);
+        run = ++p;
+    }
+    out.append(reinterpret_cast<const char*>(run), end - run);
+}
+
+void JsonWriter::separate() {
+    if (afterKey_) {
+        afterKey_ = false;
+        return;
+    }
+    if (!hasItems_.empty()) {
+        if (hasItems_.back()) {
+            buf_ += ',';
+        }
+        hasItems_.back() = 1;
+    }
+}
+
+void JsonWriter::afterValue() {
+    if (sink_ && buf_.size() >= flushBytes_) {
+        flush();
+    }
+}
+
+void JsonWriter::quoted(std::string_view text) {
+    buf_ += '"';
+    escape(buf_, text);
+    buf_ += '"';
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separate();
+    buf_ += '{';
+    hasItems_.push_back(0);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    buf_ += '}';
+    hasItems_.pop_back();
+    afterValue();
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separate();
+    buf_ += '[';
+    hasItems_.push_back(0);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    buf_ += ']';
+    hasItems_.pop_back();
+    afterValue();
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    separate();
+    quoted(name);
+    buf_ += ':';
+    afterKey_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view text) {
+    separate();
+    quoted(text);
+    afterValue();
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool flag) {
+    separate();
+    buf_ += flag ? "true" : "false";
+    afterValue();
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(long long number) {
+    separate();
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), number);
+    buf_.append(digits, result.ptr - digits);
+    afterValue();
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(unsigned long long number) {
+    separate();
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), number);
+    buf_.append(digits, result.ptr - digits);
+    afterValue();
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double number) {
+    if (!std::isfinite(number)) {
+        return value(nullptr);
+    }
+    separate();
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), number); // 最短的可往返表示
+    buf_.append(digits, result.ptr - digits);
+    afterValue();
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::nullptr_t) {
+    separate();
+    buf_ += "null";
+    afterValue();
+    return *this;
+}
+
+JsonWriter& JsonWriter::raw(std::string_view json) {
+    separate();
+    buf_.append(json.data(), json.size());
+    afterValue();
+    return *this;
+}
+
+JsonWriter& JsonWriter::endLine() {
+    buf_ += '\n';
+    afterValue();
+    return *this;
+}
+
+bool JsonWriter::flush() {
+    if (!sink_ || buf_.empty()) {
+        return ok_;
+    }
+    if (ok_) {
+        ok_ = sink_(buf_.data(), buf_.size());
+    }
+    buf_.clear();
+    return ok_;
+}
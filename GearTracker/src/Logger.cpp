@@ -0,0 +1,267 @@
+// ====== Logger.cpp ======
+#include "Logger.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+    : slots_(new Slot[kBufferCapacity]),
+      mask_(kBufferCapacity - 1) {
+    for (size_t i = 0; i < kBufferCapacity; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    batch_.reserve(64 * 1024);
+    running_ = true;
+    writer_ = std::thread(&Logger::writerLoop, this);
+}
+
+Logger::~Logger() {
+    shutdown();
+}
+
+int Logger::parseLevel(const std::string& name) {
+    std::string level = name;
+    std::transform(level.begin(), level.end(), level.begin(),
+                   [](unsigned char c){ return std::tolower(c); });
+    if (level == "debug") return LOG_DEBUG;
+    if (level == "warning") return LOG_WARNING;
+    if (level == "error") return LOG_ERROR;
+    return LOG_INFO;
+}
+
+void Logger::configure(Config& config) {
+    setLevel(parseLevel(config.getString("application", "log_level", "info")));
+
+    std::lock_guard<std::mutex> lock(settingsMutex_);
+    std::string fileName = config.getString("application", "log_file", "geartracker.log");
+    if (fileName != fileName_) {
+        fileName_ = fileName;
+        reopenRequested_ = true;
+    }
+    toConsole_ = config.getBool("application", "log_to_console", true);
+    flushInterval_ = std::chrono::milliseconds(
+        std::max(10, config.getInt("application", "log_flush_interval_ms", 100)));
+    maxFileBytes_ = static_cast<uint64_t>(
+        std::max(1, config.getInt("application", "log_max_size_mb", 10))) * 1024 * 1024;
+    rotateInterval_ = std::chrono::hours(
+        std::max(0, config.getInt("application", "log_rotate_interval_hours", 24)));
+    maxFiles_ = std::max(1, config.getInt("application", "log_max_files", 5));
+}
+
+void Logger::write(int level, std::string message) {
+    // Vyukov 有界队列入队：只用 CAS 抢占槽位，不加锁
+    size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &slots_[pos & mask_];
+        size_t seq = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // 缓冲区已满：丢弃而不是等待
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->record.level = level;
+    slot->record.time = std::chrono::system_clock::now();
+    slot->record.message = std::move(message);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+}
+
+bool Logger::tryPop(Record& record) {
+    Slot* slot = &slots_[dequeuePos_ & mask_];
+    size_t seq = slot->sequence.load(std::memory_order_acquire);
+    if (seq != dequeuePos_ + 1) {
+        return false; // 为空，或生产者尚未写完该槽位
+    }
+    record = std::move(slot->record);
+    slot->record.message.clear();
+    slot->sequence.store(dequeuePos_ + mask_ + 1, std::memory_order_release);
+    ++dequeuePos_;
+    return true;
+}
+
+void Logger::appendFormatted(const Record& record) {
+    // 同一秒内的日志复用已格式化的时间戳
+    time_t seconds = std::chrono::system_clock::to_time_t(record.time);
+    if (seconds != cachedSecond_) {
+        std::tm tmValue;
+        localtime_r(&seconds, &tmValue);
+        std::strftime(cachedTimestamp_, sizeof(cachedTimestamp_), "%Y-%m-%d %H:%M:%S", &tmValue);
+        cachedSecond_ = seconds;
+    }
+
+    static const char* levelNames[] = {"[DEBUG] ", "[INFO] ", "[WARNING] ", "[ERROR] "};
+    int level = std::min(std::max(record.level, LOG_DEBUG), LOG_ERROR);
+
+    batch_ += '[';
+    batch_ += cachedTimestamp_;
+    batch_ += "] ";
+    batch_ += levelNames[level];
+    batch_ += record.message;
+    batch_ += '\n';
+}
+
+size_t Logger::drainBatch() {
+    size_t count = 0;
+    Record record;
+    batch_.clear();
+    while (count < kBufferCapacity && tryPop(record)) {
+        appendFormatted(record);
+        ++count;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    bool toConsole;
+    {
+        std::lock_guard<std::mutex> lock(settingsMutex_);
+        toConsole = toConsole_;
+    }
+
+    rotateIfNeeded();
+    if (file_) {
+        std::fwrite(batch_.data(), 1, batch_.size(), file_);
+        std::fflush(file_);
+        fileBytes_ += batch_.size();
+    }
+    if (toConsole) {
+        std::fwrite(batch_.data(), 1, batch_.size(), stdout);
+        std::fflush(stdout);
+    }
+
+    consumed_.fetch_add(count, std::memory_order_release);
+    return count;
+}
+
+void Logger::openFile() {
+    std::string fileName;
+    {
+        std::lock_guard<std::mutex> lock(settingsMutex_);
+        fileName = fileName_;
+        reopenRequested_ = false;
+    }
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+    file_ = std::fopen(fileName.c_str(), "a");
+    if (!file_) {
+        // 如果文件打开失败，尝试使用默认文件名
+        file_ = std::fopen("geartracker.log", "a");
+    }
+    fileBytes_ = 0;
+    if (file_) {
+        std::fseek(file_, 0, SEEK_END);
+        long size = std::ftell(file_);
+        if (size > 0) fileBytes_ = static_cast<uint64_t>(size);
+    }
+    fileOpenedAt_ = std::chrono::system_clock::now();
+}
+
+void Logger::rotateIfNeeded() {
+    bool reopen;
+    uint64_t maxBytes;
+    std::chrono::hours interval;
+    {
+        std::lock_guard<std::mutex> lock(settingsMutex_);
+        reopen = reopenRequested_;
+        maxBytes = maxFileBytes_;
+        interval = rotateInterval_;
+    }
+
+    if (!file_ || reopen) {
+        openFile();
+        return;
+    }
+
+    bool tooLarge = fileBytes_ + batch_.size() > maxBytes;
+    bool tooOld = interval.count() > 0 &&
+                  std::chrono::system_clock::now() - fileOpenedAt_ >= interval;
+    if (tooLarge || tooOld) {
+        rotate();
+    }
+}
+
+void Logger::rotate() {
+    std::string fileName;
+    int maxFiles;
+    {
+        std::lock_guard<std::mutex> lock(settingsMutex_);
+        fileName = fileName_;
+        maxFiles = maxFiles_;
+    }
+
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+
+    // geartracker.log -> geartracker.log.1 -> ... -> geartracker.log.N（最旧的被删除）
+    std::remove((fileName + "." + std::to_string(maxFiles)).c_str());
+    for (int i = maxFiles - 1; i >= 1; --i) {
+        std::rename((fileName + "." + std::to_string(i)).c_str(),
+                    (fileName + "." + std::to_string(i + 1)).c_str());
+    }
+    std::rename(fileName.c_str(), (fileName + ".1").c_str());
+
+    openFile();
+}
+
+void Logger::writerLoop() {
+    while (running_.load(std::memory_order_acquire)) {
+        if (drainBatch() == 0) {
+            std::chrono::milliseconds interval;
+            {
+                std::lock_guard<std::mutex> lock(settingsMutex_);
+                interval = flushInterval_;
+            }
+            std::this_thread::sleep_for(interval);
+        }
+    }
+
+    // 退出前写出剩余日志
+    while (drainBatch() > 0) {
+    }
+    uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped > 0 && file_) {
+        std::fprintf(file_, "[日志] 缓冲区溢出共丢弃 %llu 条日志\n",
+                     static_cast<unsigned long long>(dropped));
+    }
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+void Logger::flush() {
+    uint64_t target = enqueuePos_.load(std::memory_order_acquire);
+    while (running_.load(std::memory_order_acquire) &&
+           consumed_.load(std::memory_order_acquire) < target) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+void Logger::shutdown() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
@@ -0,0 +1,222 @@
+// ====== Metrics.cpp ======
+#include "Metrics.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <mutex>
+
+// 输出的累计桶：2^4 到 2^27 微秒（16 微秒到约 134 秒）
+static const int kFirstExportedMajor = 4;
+static const int kLastExportedMajor = 27;
+
+size_t Metrics::Histogram::bucketOf(uint64_t micros) {
+    if (micros < 8) {
+        return static_cast<size_t>(micros);
+    }
+    int major = 63 - __builtin_clzll(micros);
+    if (major > kMaxMajor) {
+        return kBuckets - 1;
+    }
+    size_t sub = static_cast<size_t>(micros >> (major - 2)) & 3;
+    return static_cast<size_t>(major - 1) * 4 + sub;
+}
+
+uint64_t Metrics::Histogram::bucketLimit(size_t index) {
+    if (index < 8) {
+        return index + 1;
+    }
+    int major = static_cast<int>(index / 4) + 1;
+    return static_cast<uint64_t>(5 + index % 4) << (major - 2);
+}
+
+void Metrics::Histogram::record(uint64_t micros) {
+    buckets_[bucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(micros, std::memory_order_relaxed);
+}
+
+uint64_t Metrics::Histogram::quantile(double q) const {
+    uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(total)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank && seen > 0) {
+            return bucketLimit(i);
+        }
+    }
+    return bucketLimit(kBuckets - 1);
+}
+
+Metrics& Metrics::instance() {
+    static Metrics metrics;
+    return metrics;
+}
+
+void Metrics::configure(Config& config) {
+    enabled_.store(config.getBool("application", "metrics", true), std::memory_order_relaxed);
+}
+
+Metrics::Family& Metrics::family(const std::string& name, const std::string& help, Type type) {
+    auto it = families_.find(name);
+    if (it == families_.end()) {
+        it = families_.emplace(name, Family{type, help, {}, {}, {}}).first;
+    }
+    return it->second;
+}
+
+template <typename T>
+T* Metrics::series(const std::string& name, const std::string& help, const std::string& labels, Type type,
+                   std::map<std::string, std::unique_ptr<T>> Family::*member) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = families_.find(name);
+        if (it != families_.end()) {
+            auto& map = it->second.*member;
+            auto found = map.find(labels);
+            if (found != map.end()) {
+                return found->second.get();
+            }
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto& map = family(name, help, type).*member;
+    auto& slot = map[labels];
+    if (!slot) {
+        slot = std::make_unique<T>();
+    }
+    return slot.get();
+}
+
+Metrics::Counter* Metrics::counter(const std::string& name, const std::string& help, const std::string& labels) {
+    return series(name, help, labels, COUNTER, &Family::counters);
+}
+
+Metrics::Gauge* Metrics::gauge(const std::string& name, const std::string& help, const std::string& labels) {
+    return series(name, help, labels, GAUGE, &Family::gauges);
+}
+
+Metrics::Histogram* Metrics::histogram(const std::string& name, const std::string& help, const std::string& labels) {
+    return series(name, help, labels, HISTOGRAM, &Family::histograms);
+}
+
+std::string Metrics::label(std::string_view value) {
+    std::string out;
+    out.reserve(value.size() + 2);
+    out += '"';
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+    return out;
+}
+
+static void appendNumber(std::string& out, double value) {
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr - digits);
+}
+
+static void appendNumber(std::string& out, uint64_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr - digits);
+}
+
+static void appendHeader(std::string& out, std::string_view name, const char* type, std::string_view help) {
+    out.append("# HELP ").append(name).append(" ").append(help).append("\n");
+    out.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+}
+
+static void appendName(std::string& out, std::string_view name, const char* suffix, std::string_view labels,
+                       std::string_view extra = "") {
+    out.append(name).append(suffix);
+    if (!labels.empty() || !extra.empty()) {
+        out += '{';
+        out.append(labels);
+        if (!labels.empty() && !extra.empty()) {
+            out += ',';
+        }
+        out.append(extra);
+        out += '}';
+    }
+    out += ' ';
+}
+
+void Metrics::appendSample(std::string& out, std::string_view name, const char* type, std::string_view help,
+                           double value, std::string_view labels) {
+    appendHeader(out, name, type, help);
+    appendName(out, name, "", labels);
+    appendNumber(out, value);
+    out += '\n';
+}
+
+void Metrics::render(std::string& out) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    for (const auto& entry : families_) {
+        const std::string& name = entry.first;
+        const Family& family = entry.second;
+        switch (family.type) {
+        case COUNTER:
+            appendHeader(out, name, "counter", family.help);
+            for (const auto& series : family.counters) {
+                appendName(out, name, "", series.first);
+                appendNumber(out, series.second->value());
+                out += '\n';
+            }
+            break;
+        case GAUGE:
+            appendHeader(out, name, "gauge", family.help);
+            for (const auto& series : family.gauges) {
+                appendName(out, name, "", series.first);
+                appendNumber(out, static_cast<double>(series.second->value()));
+                out += '\n';
+            }
+            break;
+        case HISTOGRAM:
+            appendHeader(out, name, "histogram", family.help);
+            for (const auto& series : family.histograms) {
+                const Histogram& histogram = *series.second;
+                // 先读各桶再读总数：并发记录时 +Inf 桶不小于前面的累计值
+                uint64_t cumulative = 0;
+                size_t bucket = 0;
+                for (int major = kFirstExportedMajor; major <= kLastExportedMajor; ++major) {
+                    uint64_t limit = uint64_t(1) << major;
+                    while (bucket < Histogram::kBuckets && Histogram::bucketLimit(bucket) <= limit) {
+                        cumulative += histogram.buckets_[bucket++].load(std::memory_order_relaxed);
+                    }
+                    std::string le = "le=\"";
+                    appendNumber(le, static_cast<double>(limit) / 1e6);
+                    le += '"';
+                    appendName(out, name, "_bucket", series.first, le);
+                    appendNumber(out, cumulative);
+                    out += '\n';
+                }
+                for (; bucket < Histogram::kBuckets; ++bucket) {
+                    cumulative += histogram.buckets_[bucket].load(std::memory_order_relaxed);
+                }
+                uint64_t count = std::max(cumulative, histogram.count());
+                appendName(out, name, "_bucket", series.first, "le=\"+Inf\"");
+                appendNumber(out, count);
+                out += '\n';
+                appendName(out, name, "_sum", series.first);
+                appendNumber(out, static_cast<double>(histogram.sumMicros()) / 1e6);
+                out += '\n';
+                appendName(out, name, "_count", series.first);
+                appendNumber(out, count);
+                out += '\n';
+            }
+            break;
+        }
+    }
+}
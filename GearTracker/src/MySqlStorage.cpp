@@ -0,0 +1,219 @@
+// ====== MySqlStorage.cpp ======
+#include "MySqlStorage.h"
+#include "Logger.h"
+#include <cppconn/driver.h>
+#include <cppconn/datatype.h>
+#include <cppconn/exception.h>
+#include <cppconn/connection.h>
+#include <cppconn/resultset.h>
+#include <cppconn/resultset_metadata.h>
+#include <cppconn/statement.h>
+#include <cppconn/prepared_statement.h>
+#include <algorithm>
+#include <sstream>
+
+namespace {
+
+StorageError translate(const sql::SQLException& e) {
+    return StorageError(e.what(), e.getErrorCode(), e.getSQLState());
+}
+
+// 把 Connector/C++ 的异常转换为 StorageError
+template <typename Fn>
+auto guarded(Fn&& fn) -> decltype(fn()) {
+    try {
+        return fn();
+    } catch (const sql::SQLException& e) {
+        throw translate(e);
+    }
+}
+
+class MySqlResult : public StorageResult {
+public:
+    explicit MySqlResult(sql::ResultSet* res) : res_(res), meta_(res->getMetaData()) {}
+
+    bool next() override { return guarded([&] { return res_->next(); }); }
+    bool isNull(int col) override { return guarded([&] { return res_->isNull(col); }); }
+    int getInt(int col) override { return guarded([&] { return static_cast<int>(res_->getInt(col)); }); }
+    int64_t getInt64(int col) override { return guarded([&] { return static_cast<int64_t>(res_->getInt64(col)); }); }
+    double getDouble(int col) override { return guarded([&] { return static_cast<double>(res_->getDouble(col)); }); }
+    std::string getString(int col) override {
+        return guarded([&] { return std::string(res_->getString(col).asStdString()); });
+    }
+
+    int columnCount() override { return guarded([&] { return static_cast<int>(meta_->getColumnCount()); }); }
+    std::string columnLabel(int col) override {
+        return guarded([&] {
+            std::string label = meta_->getColumnLabel(col);
+            return label.empty() ? std::string(meta_->getColumnName(col)) : label;
+        });
+    }
+    ColumnType columnType(int col) override {
+        return guarded([&] {
+            switch (meta_->getColumnType(col)) {
+                case sql::DataType::BIT:
+                case sql::DataType::TINYINT:
+                case sql::DataType::SMALLINT:
+                case sql::DataType::MEDIUMINT:
+                case sql::DataType::INTEGER:
+                case sql::DataType::BIGINT:
+                case sql::DataType::YEAR:
+                    return INTEGER;
+                case sql::DataType::REAL:
+                case sql::DataType::DOUBLE:
+                    return REAL;
+                default:
+                    return TEXT;
+            }
+        });
+    }
+
+private:
+    std::unique_ptr<sql::ResultSet> res_;
+    sql::ResultSetMetaData* meta_; // 归结果集所有
+};
+
+class MySqlStatement : public StorageStatement {
+public:
+    explicit MySqlStatement(sql::PreparedStatement* stmt) : stmt_(stmt) {}
+
+    void setInt(int index, int value) override { guarded([&] { stmt_->setInt(index, value); }); }
+    void setInt64(int index, int64_t value) override { guarded([&] { stmt_->setInt64(index, value); }); }
+    void setString(int index, const std::string& value) override { guarded([&] { stmt_->setString(index, value); }); }
+    void setNull(int index) override { guarded([&] { stmt_->setNull(index, sql::DataType::LONGVARCHAR); }); }
+    void clearParameters() override { guarded([&] { stmt_->clearParameters(); }); }
+
+    StorageResult* executeQuery() override {
+        return guarded([&] { return new MySqlResult(stmt_->executeQuery()); });
+    }
+    int executeUpdate() override { return guarded([&] { return stmt_->executeUpdate(); }); }
+
+private:
+    std::unique_ptr<sql::PreparedStatement> stmt_;
+};
+
+class MySqlConnection : public StorageConnection {
+public:
+    explicit MySqlConnection(sql::Connection* con) : con_(con) {}
+
+    const char* backendName() const override { return "mysql"; }
+
+    StorageStatement* prepareStatement(const std::string& sql) override {
+        return guarded([&] { return new MySqlStatement(con_->prepareStatement(sql)); });
+    }
+    void execute(const std::string& sql) override {
+        guarded([&] {
+            std::unique_ptr<sql::Statement> stmt(con_->createStatement());
+            stmt->execute(sql);
+        });
+    }
+
+    // 连接保持自动提交模式，START TRANSACTION 只对本次事务生效
+    void begin() override { execute("START TRANSACTION"); }
+    void commit() override { guarded([&] { con_->commit(); }); }
+    void rollback() override { guarded([&] { con_->rollback(); }); }
+
+    bool isClosed() override { return guarded([&] { return con_->isClosed(); }); }
+    bool isValid() override { return guarded([&] { return con_->isValid(); }); }
+    void close() override { guarded([&] { con_->close(); }); }
+
+    long long firstInsertId(size_t) override {
+        // LAST_INSERT_ID() 本身就是多行 INSERT 中第一行的 id
+        return guarded([&] {
+            std::unique_ptr<sql::Statement> stmt(con_->createStatement());
+            std::unique_ptr<sql::ResultSet> res(stmt->executeQuery("SELECT LAST_INSERT_ID()"));
+            return res->next() ? static_cast<long long>(res->getInt64(1)) : 0LL;
+        });
+    }
+
+    // 会话变量在连接建立时确定，第一次用到时读取一次
+    long long insertIdStep() override {
+        if (idStep_ == 0) {
+            idStep_ = guarded([&] {
+                std::unique_ptr<sql::Statement> stmt(con_->createStatement());
+                std::unique_ptr<sql::ResultSet> res(
+                    stmt->executeQuery("SELECT @@session.auto_increment_increment"));
+                return res->next() ? std::max(1LL, static_cast<long long>(res->getInt64(1))) : 1LL;
+            });
+        }
+        return idStep_;
+    }
+
+    const char* lockClause() const override { return " FOR UPDATE"; }
+    bool supportsRowEstimate() const override { return true; }
+    const char* explainPrefix() const override { return "EXPLAIN "; }
+
+private:
+    std::unique_ptr<sql::Connection> con_;
+    long long idStep_ = 0;
+};
+
+} // namespace
+
+std::unique_ptr<StorageConnection> MySqlStorage::open(Config& config) {
+    std::string host = config.getString("database", "host", "127.0.0.1");
+    int port = config.getInt("database", "port", 3306);
+    std::string user = config.getString("database", "username", "");
+    std::string password = config.getString("database", "password", "");
+    std::string dbName = config.getString("database", "database", "geartracker");
+
+    // 记录详细的连接参数
+    GT_LOG_DEBUG("连接参数: ");
+    GT_LOG_DEBUG("  主机: " + host);
+    GT_LOG_DEBUG("  端口: " + std::to_string(port));
+    GT_LOG_DEBUG("  用户: " + user);
+    GT_LOG_DEBUG("  数据库: " + dbName);
+
+    try {
+        GT_LOG_DEBUG("获取MySQL驱动实例");
+        sql::Driver* driver = get_driver_instance();
+        if (!driver) {
+            throw StorageError("无法获取MySQL驱动实例");
+        }
+
+        // 构建连接字符串
+        std::string connectionStr = "tcp://" + host + ":" + std::to_string(port);
+        GT_LOG_DEBUG("正在连接到MySQL服务器: " + connectionStr);
+        sql::Connection* rawCon = driver->connect(connectionStr, user, password);
+        if (!rawCon) {
+            throw StorageError("连接创建失败，但没有抛出异常");
+        }
+        std::unique_ptr<sql::Connection> con(rawCon);
+
+        // ====== 超时设置 ======
+        con->setClientOption("OPT_CONNECT_TIMEOUT", "5");
+        con->setClientOption("OPT_READ_TIMEOUT", "10");
+        con->setClientOption("OPT_WRITE_TIMEOUT", "10");
+
+        GT_LOG_DEBUG("选择数据库: " + dbName);
+        con->setSchema(dbName);
+
+        // 设置字符集
+        std::unique_ptr<sql::Statement> stmt(con->createStatement());
+        stmt->execute("SET NAMES 'utf8mb4'");
+        stmt->execute("SET CHARACTER SET utf8mb4");
+
+        // ====== 连接保持设置 ======
+        con->setClientOption("MYSQL_OPT_KEEPALIVE_INTERVAL", "60");
+        con->setClientOption("MYSQL_OPT_TCP_KEEPALIVE", "1");
+        GT_LOG_DEBUG("已启用TCP keepalive");
+
+        // 执行简单查询验证连接
+        std::unique_ptr<sql::ResultSet> res(stmt->executeQuery("SELECT 1 AS test_value"));
+        if (!res->next() || res->getInt(1) != 1) {
+            throw StorageError("连接验证失败: 查询返回意外结果");
+        }
+
+        GT_LOG_INFO("已连接到MySQL: " + host + ":" + std::to_string(port) + "/" + dbName);
+        return std::unique_ptr<StorageConnection>(new MySqlConnection(con.release()));
+    } catch (const sql::SQLException& e) {
+        std::ostringstream params;
+        params << "MySQL连接失败，连接参数: \n"
+               << "  主机: " << host << "\n"
+               << "  端口: " << port << "\n"
+               << "  用户: " << user << "\n"
+               << "  数据库: " << dbName;
+        GT_LOG_ERROR(params.str());
+        throw translate(e);
+    }
+}
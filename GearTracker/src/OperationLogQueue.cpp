@@ -0,0 +1,410 @@
+// ====== OperationLogQueue.cpp ======
+#include "OperationLogQueue.h"
+#include "Database.h"
+#include "Logger.h"
+#include "PageCursor.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <fstream>
+#include <unistd.h>
+
+// 日志文件每行一条：
+//   E\t序号\t时间\t操作类型\t物品名称\t备注   入队的记录
+//   F\t序号                                   该序号及之前的记录已写入数据库
+// 字段中的反斜杠、制表符和换行符转义后写入。序号在日志文件清空后继续递增（清空后先写一行 F），
+// 数据库中的检查点（operation_log_checkpoint）与操作日志在同一事务中更新，恢复时以两者中较大的为准
+static std::string escapeField(const std::string& text) {
+    std::string out;
+    out.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '\t': out += "\\t"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            default: out += c;
+        }
+    }
+    return out;
+}
+
+static std::string unescapeField(const std::string& text) {
+    std::string out;
+    out.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\\' && i + 1 < text.size()) {
+            char next = text[++i];
+            switch (next) {
+                case 't': out += '\t'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                default: out += next;
+            }
+        } else {
+            out += text[i];
+        }
+    }
+    return out;
+}
+
+static std::vector<std::string> splitTabs(const std::string& line) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    for (;;) {
+        size_t tab = line.find('\t', start);
+        fields.push_back(line.substr(start, tab == std::string::npos ? std::string::npos : tab - start));
+        if (tab == std::string::npos) break;
+        start = tab + 1;
+    }
+    return fields;
+}
+
+static std::string toLowerAscii(std::string text) {
+    for (char& c : text) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    return text;
+}
+
+OperationLogQueue& OperationLogQueue::instance() {
+    static OperationLogQueue queue;
+    return queue;
+}
+
+OperationLogQueue::~OperationLogQueue() {
+    shutdown();
+}
+
+void OperationLogQueue::configure(Config& config) {
+    bool enable = config.getBool("application", "oplog_write_behind", false);
+    // 开启前在锁外读取数据库中的检查点；数据库不可用时只按日志文件中的 F 行恢复
+    uint64_t checkpoint = 0;
+    if (enable && !enabled()) {
+        try {
+            Database db(config);
+            checkpoint = db.operationLogCheckpoint(
+                config.getString("application", "oplog_journal", "operation_log.journal"));
+        } catch (const std::exception& e) {
+            GT_LOG_WARNING("读取操作日志检查点失败，按日志文件恢复: " + std::string(e.what()));
+        }
+    }
+    std::thread stale;
+    {
+        std::lock_guard<std::mutex> journalLock(journalMutex_);
+        std::lock_guard<std::mutex> lock(mutex_);
+        flushInterval_ = std::chrono::milliseconds(
+            std::max(10, config.getInt("application", "oplog_flush_interval_ms", 200)));
+        flushBatch_ = static_cast<size_t>(std::max(1, config.getInt("application", "oplog_flush_batch", 100)));
+        capacity_ = static_cast<size_t>(std::max(1, config.getInt("application", "oplog_queue_capacity", 10000)));
+        config_.reset(new Config(config));
+
+        if (enable == enabled()) {
+            return;
+        }
+        if (!enable) {
+            // 关闭：后台线程写完剩余记录后退出，之后的操作日志同步写入
+            enabled_.store(false, std::memory_order_release);
+            stopping_ = true;
+            cv_.notify_all();
+            stale = std::move(flusher_);
+        } else {
+            journalPath_ = config.getString("application", "oplog_journal", "operation_log.journal");
+            if (!openJournal()) {
+                return;
+            }
+            recoverJournal(checkpoint);
+            stopping_ = false;
+            enabled_.store(true, std::memory_order_release);
+            flusher_ = std::thread(&OperationLogQueue::flushLoop, this);
+            GT_LOG_INFO("操作日志延迟写入已开启，日志文件: " + journalPath_);
+        }
+    }
+    if (stale.joinable()) {
+        stale.join();
+    }
+}
+
+void OperationLogQueue::shutdown() {
+    std::thread flusher;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        enabled_.store(false, std::memory_order_release);
+        stopping_ = true;
+        flusher = std::move(flusher_);
+    }
+    cv_.notify_all();
+    if (flusher.joinable()) {
+        flusher.join();
+    }
+}
+
+bool OperationLogQueue::openJournal() {
+    if (journalFd_ >= 0) {
+        return true;
+    }
+    journalFd_ = ::open(journalPath_.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (journalFd_ < 0) {
+        GT_LOG_ERROR("无法打开操作日志文件 " + journalPath_ + ": " + std::strerror(errno) +
+                     "，操作日志将同步写入");
+        return false;
+    }
+    return true;
+}
+
+// 读取上次退出时未写入数据库的记录，重新放入队列。
+// checkpoint 为数据库中的检查点，序号不大于它的记录已经写入，不再重复写入
+void OperationLogQueue::recoverJournal(uint64_t checkpoint) {
+    nextSeq_ = std::max(nextSeq_, checkpoint + 1);
+    std::ifstream in(journalPath_);
+    if (!in) {
+        return;
+    }
+    std::vector<Entry> entries;
+    uint64_t flushedSeq = checkpoint;
+    bool hasLines = false;
+    std::string line;
+    while (std::getline(in, line)) {
+        hasLines = true;
+        std::vector<std::string> fields = splitTabs(line);
+        try {
+            if (fields.size() == 2 && fields[0] == "F") {
+                flushedSeq = std::max<uint64_t>(flushedSeq, std::stoull(fields[1]));
+            } else if (fields.size() == 6 && fields[0] == "E") {
+                Entry entry;
+                entry.seq = std::stoull(fields[1]);
+                entry.time = unescapeField(fields[2]);
+                entry.type = unescapeField(fields[3]);
+                entry.itemName = unescapeField(fields[4]);
+                entry.note = unescapeField(fields[5]);
+                entries.push_back(std::move(entry));
+            }
+        } catch (const std::exception&) {
+            // 最后一行可能因为异常退出而不完整，忽略
+        }
+    }
+
+    size_t recovered = 0;
+    nextSeq_ = std::max(nextSeq_, flushedSeq + 1);
+    for (auto& entry : entries) {
+        nextSeq_ = std::max(nextSeq_, entry.seq + 1);
+        if (entry.seq > flushedSeq) {
+            queue_.push_back(std::move(entry));
+            recovered++;
+        }
+    }
+    if (recovered > 0) {
+        GT_LOG_WARNING("从操作日志文件恢复 " + std::to_string(recovered) + " 条未写入的记录");
+    } else if (hasLines) {
+        truncateJournal();
+    }
+}
+
+// 清空日志文件（队列已全部写入数据库时），只留一行 F 保存当前序号。调用方持有 journalMutex_
+void OperationLogQueue::truncateJournal() {
+    if (::ftruncate(journalFd_, 0) != 0) {
+        GT_LOG_WARNING("清空操作日志文件失败: " + std::string(std::strerror(errno)));
+    }
+    appendJournal("F\t" + std::to_string(nextSeq_ - 1) + "\n", true);
+}
+
+bool OperationLogQueue::appendJournal(const std::string& data, bool sync) {
+    const char* p = data.data();
+    size_t left = data.size();
+    while (left > 0) {
+        ssize_t written = ::write(journalFd_, p, left);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            GT_LOG_ERROR("写入操作日志文件失败: " + std::string(std::strerror(errno)));
+            return false;
+        }
+        p += written;
+        left -= static_cast<size_t>(written);
+    }
+    if (sync && ::fdatasync(journalFd_) != 0) {
+        GT_LOG_ERROR("同步操作日志文件失败: " + std::string(std::strerror(errno)));
+        return false;
+    }
+    return true;
+}
+
+bool OperationLogQueue::enqueue(const std::string& type, const std::string& itemName, const std::string& note) {
+    Entry entry;
+    entry.type = type;
+    entry.itemName = itemName;
+    entry.note = note;
+    return enqueue(std::vector<Entry>{std::move(entry)});
+}
+
+void OperationLogQueue::closeJournal() {
+    if (journalFd_ >= 0) {
+        ::fdatasync(journalFd_);
+        ::close(journalFd_);
+        journalFd_ = -1;
+    }
+}
+
+// 日志文件的写入和 fsync 只持有 journalMutex_，不阻塞 pending()、统计和后台线程对队列的访问；
+// mutex_ 只在检查容量和 fsync 成功后放入队列时短暂持有。
+// 记录只在持有 journalMutex_ 时入队，所以队列顺序与序号一致，检查容量后到入队前队列只会变短
+bool OperationLogQueue::enqueue(std::vector<Entry> entries) {
+    if (entries.empty()) {
+        return true;
+    }
+    if (!enabled()) {
+        return false;
+    }
+    std::string time = currentSortTime();
+    std::lock_guard<std::mutex> journalLock(journalMutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!enabled() || queue_.size() + entries.size() > capacity_) {
+            rejected_.fetch_add(entries.size(), std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    std::string data;
+    for (auto& entry : entries) {
+        entry.seq = nextSeq_++;
+        entry.time = time;
+        data += "E\t" + std::to_string(entry.seq) + "\t" + escapeField(entry.time) + "\t" +
+                escapeField(entry.type) + "\t" + escapeField(entry.itemName) + "\t" +
+                escapeField(entry.note) + "\n";
+    }
+    if (!appendJournal(data, true)) {
+        rejected_.fetch_add(entries.size(), std::memory_order_relaxed);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : entries) {
+        queue_.push_back(std::move(entry));
+    }
+    if (queue_.size() >= flushBatch_) {
+        cv_.notify_one();
+    }
+    return true;
+}
+
+void OperationLogQueue::flushLoop() {
+    std::unique_ptr<Database> db;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cv_.wait_for(lock, flushInterval_, [this]() {
+            return stopping_ || queue_.size() >= flushBatch_;
+        });
+        if (queue_.empty()) {
+            if (!stopping_) continue;
+            // 退出前等正在写日志文件的入队完成，它们的记录也要写入数据库
+            lock.unlock();
+            std::lock_guard<std::mutex> journalLock(journalMutex_);
+            lock.lock();
+            if (queue_.empty()) {
+                closeJournal();
+                break;
+            }
+            continue;
+        }
+
+        std::vector<Entry> batch(queue_.begin(),
+                                 queue_.begin() + std::min(queue_.size(), flushBatch_));
+        std::string journal = journalPath_;
+        std::unique_ptr<Config> dbConfig;
+        if (!db) {
+            dbConfig.reset(new Config(*config_));
+        }
+        lock.unlock();
+
+        bool ok = false;
+        try {
+            if (!db) {
+                db.reset(new Database(*dbConfig));
+                db->operationLogCheckpoint(journal); // 确保检查点表存在（启动时数据库可能不可用）
+            }
+            ok = db->writeOperationLogs(batch, nullptr, journal);
+        } catch (const std::exception& e) {
+            GT_LOG_ERROR("操作日志写入失败: " + std::string(e.what()));
+        }
+
+        if (ok) {
+            // 数据库中的检查点已随这批记录提交；日志文件中的 F 行同样同步到磁盘，
+            // 供启动时数据库不可用的情况使用。队列清空时截断日志文件：
+            // 持有 journalMutex_ 期间没有已写入日志文件但还未入队的记录，截断不会丢失记录
+            std::lock_guard<std::mutex> journalLock(journalMutex_);
+            lock.lock();
+            queue_.erase(queue_.begin(), queue_.begin() + batch.size());
+            flushed_.fetch_add(batch.size(), std::memory_order_relaxed);
+            bool drained = queue_.empty();
+            lock.unlock();
+            if (drained) {
+                truncateJournal();
+            } else {
+                appendJournal("F\t" + std::to_string(batch.back().seq) + "\n", true);
+            }
+        }
+        lock.lock();
+        if (!ok) {
+            flushErrors_.fetch_add(1, std::memory_order_relaxed);
+            if (stopping_) {
+                // 退出时仍无法写入：记录留在日志文件中，下次启动恢复
+                lock.unlock();
+                std::lock_guard<std::mutex> journalLock(journalMutex_);
+                lock.lock();
+                GT_LOG_WARNING(std::to_string(queue_.size()) + " 条操作日志未能写入，将在下次启动时恢复");
+                queue_.clear();
+                closeJournal();
+                break;
+            }
+            // 数据库不可用时不要空转，等待一个间隔后重试
+            cv_.wait_for(lock, flushInterval_, [this]() { return stopping_; });
+        }
+    }
+}
+
+bool OperationLogQueue::matches(const Entry& entry, const std::string& needle) {
+    return toLowerAscii(entry.type).find(needle) != std::string::npos ||
+           toLowerAscii(entry.itemName).find(needle) != std::string::npos ||
+           toLowerAscii(entry.note).find(needle) != std::string::npos;
+}
+
+std::vector<OperationLogQueue::Entry> OperationLogQueue::pending(const std::string& search, size_t limit) const {
+    std::vector<Entry> result;
+    if (!enabled()) {
+        return result;
+    }
+    std::string needle = toLowerAscii(search);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = queue_.rbegin(); it != queue_.rend() && result.size() < limit; ++it) {
+        if (needle.empty() || matches(*it, needle)) {
+            result.push_back(*it);
+        }
+    }
+    return result;
+}
+
+size_t OperationLogQueue::pendingCount(const std::string& search) const {
+    if (!enabled()) {
+        return 0;
+    }
+    std::string needle = toLowerAscii(search);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (needle.empty()) {
+        return queue_.size();
+    }
+    return static_cast<size_t>(std::count_if(queue_.begin(), queue_.end(),
+                                             [&](const Entry& entry) { return matches(entry, needle); }));
+}
+
+OperationLogQueue::Stats OperationLogQueue::getStats() const {
+    Stats stats;
+    stats.enabled = enabled();
+    stats.flushed = flushed_.load(std::memory_order_relaxed);
+    stats.rejected = rejected_.load(std::memory_order_relaxed);
+    stats.flushErrors = flushErrors_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.pending = queue_.size();
+    return stats;
+}
@@ -0,0 +1,114 @@
+// ====== PageCursor.cpp ======
+#include "PageCursor.h"
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
+static const char kBase64Url[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+// 辅助函数：base64url 编码（不带填充）
+static std::string base64UrlEncode(const std::string& input) {
+    std::string out;
+    out.reserve((input.size() + 2) / 3 * 4);
+    size_t i = 0;
+    while (i + 2 < input.size()) {
+        unsigned int n = (static_cast<unsigned char>(input[i]) << 16) |
+                         (static_cast<unsigned char>(input[i + 1]) << 8) |
+                         static_cast<unsigned char>(input[i + 2]);
+        out += kBase64Url[(n >> 18) & 63];
+        out += kBase64Url[(n >> 12) & 63];
+        out += kBase64Url[(n >> 6) & 63];
+        out += kBase64Url[n & 63];
+        i += 3;
+    }
+    size_t rest = input.size() - i;
+    if (rest == 1) {
+        unsigned int n = static_cast<unsigned char>(input[i]) << 16;
+        out += kBase64Url[(n >> 18) & 63];
+        out += kBase64Url[(n >> 12) & 63];
+    } else if (rest == 2) {
+        unsigned int n = (static_cast<unsigned char>(input[i]) << 16) |
+                         (static_cast<unsigned char>(input[i + 1]) << 8);
+        out += kBase64Url[(n >> 18) & 63];
+        out += kBase64Url[(n >> 12) & 63];
+        out += kBase64Url[(n >> 6) & 63];
+    }
+    return out;
+}
+
+// 辅助函数：base64url 解码，遇到非法字符返回 false
+static bool base64UrlDecode(const std::string& input, std::string& out) {
+    out.clear();
+    unsigned int buffer = 0;
+    int bits = 0;
+    for (char c : input) {
+        int value;
+        if (c >= 'A' && c <= 'Z') value = c - 'A';
+        else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') value = c - '0' + 52;
+        else if (c == '-') value = 62;
+        else if (c == '_') value = 63;
+        else if (c == '=') break;
+        else return false;
+
+        buffer = (buffer << 6) | static_cast<unsigned int>(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out += static_cast<char>((buffer >> bits) & 0xFF);
+        }
+    }
+    return true;
+}
+
+std::string PageCursor::encode() const {
+    return base64UrlEncode(sortTime + "|" + std::to_string(id));
+}
+
+bool PageCursor::decode(const std::string& token, PageCursor& cursor) {
+    std::string raw;
+    if (token.empty() || token.size() > 128 || !base64UrlDecode(token, raw)) {
+        return false;
+    }
+
+    size_t sep = raw.rfind('|');
+    if (sep == std::string::npos || sep == 0 || sep + 1 >= raw.size()) {
+        return false;
+    }
+
+    // 时间部分只允许数字、空格、'-'、':'、'.'，防止拼出意外的比较值
+    std::string timePart = raw.substr(0, sep);
+    for (char c : timePart) {
+        if (!std::isdigit(static_cast<unsigned char>(c)) && c != ' ' && c != '-' && c != ':' && c != '.') {
+            return false;
+        }
+    }
+
+    try {
+        size_t used = 0;
+        long long id = std::stoll(raw.substr(sep + 1), &used);
+        if (used != raw.size() - sep - 1 || id <= 0) {
+            return false;
+        }
+        cursor.sortTime = timePart;
+        cursor.id = id;
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+std::string currentSortTime() {
+    auto now = std::chrono::system_clock::now();
+    time_t seconds = std::chrono::system_clock::to_time_t(now);
+    long micros = static_cast<long>(std::chrono::duration_cast<std::chrono::microseconds>(
+        now.time_since_epoch()).count() % 1000000);
+    struct tm tstruct;
+    localtime_r(&seconds, &tstruct);
+    char buf[40];
+    size_t len = strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tstruct);
+    snprintf(buf + len, sizeof(buf) - len, ".%06ld", micros);
+    return buf;
+}
@@ -0,0 +1,171 @@
+// ====== RequestQueue.cpp ======
+#include "RequestQueue.h"
+#include <algorithm>
+
+namespace {
+
+thread_local bool tlOverloaded = false;
+thread_local long long tlQueueWaitMs = 0;
+
+} // namespace
+
+RequestQueue::RequestQueue(const Options& options, std::shared_ptr<Counters> counters)
+    : options_(options), counters_(std::move(counters)) {
+    options_.workers = std::max<size_t>(1, options_.workers);
+    counters_->workers = options_.workers;
+    counters_->active = 0;
+    counters_->queued = 0;
+    for (size_t i = 0; i < options_.workers; ++i) {
+        threads_.emplace_back(&RequestQueue::workerLoop, this);
+    }
+    for (size_t i = 0; i < std::max<size_t>(1, options_.overflowThreads); ++i) {
+        threads_.emplace_back(&RequestQueue::overflowLoop, this);
+    }
+}
+
+RequestQueue::~RequestQueue() {
+    shutdown();
+}
+
+bool RequestQueue::enqueue(std::function<void()> fn) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (shutdown_) {
+            return false;
+        }
+        Job job{std::move(fn), std::chrono::steady_clock::now()};
+        // 空闲的工作线程马上会取走的连接不算排队
+        if (options_.maxQueued == 0 || jobs_.size() < options_.maxQueued + idle_) {
+            jobs_.push_back(std::move(job));
+            counters_->queued.store(jobs_.size() > idle_ ? jobs_.size() - idle_ : 0, std::memory_order_relaxed);
+            cv_.notify_one();
+            return true;
+        }
+        // 只交给空闲的溢出线程；都在忙时排队也来不及快速回复，直接关闭
+        if (overflow_.size() < overflowIdle_) {
+            overflow_.push_back(std::move(job));
+            counters_->overflowed.fetch_add(1, std::memory_order_relaxed);
+            overflowCv_.notify_one();
+            return true;
+        }
+    }
+    counters_->dropped.fetch_add(1, std::memory_order_relaxed);
+    return false; // httplib 直接关闭连接
+}
+
+void RequestQueue::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (shutdown_) {
+            return;
+        }
+        shutdown_ = true;
+    }
+    cv_.notify_all();
+    overflowCv_.notify_all();
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    counters_->workers = 0;
+}
+
+// 已接收的连接在停止时仍处理完，与 httplib 默认线程池的行为一致
+void RequestQueue::workerLoop() {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ++idle_;
+            cv_.wait(lock, [this]() { return shutdown_ || !jobs_.empty(); });
+            --idle_;
+            if (jobs_.empty()) {
+                return;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+            counters_->queued.store(jobs_.size() > idle_ ? jobs_.size() - idle_ : 0, std::memory_order_relaxed);
+        }
+
+        uint64_t waitMs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - job.enqueued).count());
+        counters_->accepted.fetch_add(1, std::memory_order_relaxed);
+        counters_->waitMsTotal.fetch_add(waitMs, std::memory_order_relaxed);
+        uint64_t maxWait = counters_->waitMsMax.load(std::memory_order_relaxed);
+        while (waitMs > maxWait &&
+               !counters_->waitMsMax.compare_exchange_weak(maxWait, waitMs, std::memory_order_relaxed)) {
+        }
+
+        tlOverloaded = false;
+        tlQueueWaitMs = static_cast<long long>(waitMs);
+        counters_->active.fetch_add(1, std::memory_order_relaxed);
+        job.fn();
+        counters_->active.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void RequestQueue::overflowLoop() {
+    tlOverloaded = true;
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ++overflowIdle_;
+            overflowCv_.wait(lock, [this]() { return shutdown_ || !overflow_.empty(); });
+            --overflowIdle_;
+            if (overflow_.empty()) {
+                return;
+            }
+            job = std::move(overflow_.front());
+            overflow_.pop_front();
+        }
+        job.fn();
+    }
+}
+
+bool RequestQueue::overloaded() {
+    return tlOverloaded;
+}
+
+long long RequestQueue::takeQueueWaitMs() {
+    long long waitMs = tlQueueWaitMs;
+    tlQueueWaitMs = 0;
+    return waitMs;
+}
+
+// ====== HttpServer ======
+bool HttpServer::process_and_close_socket(socket_t sock) {
+    auto start = std::chrono::steady_clock::now();
+    std::string remoteAddr;
+    int remotePort = 0;
+    httplib::detail::get_remote_ip_and_port(sock, remoteAddr, remotePort);
+    std::string localAddr;
+    int localPort = 0;
+    httplib::detail::get_local_ip_and_port(sock, localAddr, localPort);
+
+    auto handle = [&](httplib::Stream& strm, bool closeConnection, bool& connectionClosed) {
+        return process_request(strm, remoteAddr, remotePort, localAddr, localPort, closeConnection,
+                               connectionClosed, nullptr);
+    };
+
+    bool ret = false;
+    if (!RequestQueue::overloaded()) {
+        ret = httplib::detail::process_server_socket(
+            svr_sock_, sock, keep_alive_max_count_, keep_alive_timeout_sec_, read_timeout_sec_,
+            read_timeout_usec_, write_timeout_sec_, write_timeout_usec_, handle);
+    } else {
+        // 每次读写的超时和读取的总时限都是 overflowTimeoutMs_（总时限从接收连接时算起）
+        time_t sec = overflowTimeoutMs_ / 1000;
+        time_t usec = (overflowTimeoutMs_ % 1000) * 1000;
+        if (httplib::detail::select_read(sock, sec, usec) > 0) {
+            httplib::detail::SocketStream strm(sock, sec, usec, sec, usec, overflowTimeoutMs_, start);
+            bool connectionClosed = false;
+            ret = handle(strm, true, connectionClosed); // close_connection：回复带 Connection: close
+        }
+    }
+
+    httplib::detail::shutdown_socket(sock);
+    httplib::detail::close_socket(sock);
+    return ret;
+}
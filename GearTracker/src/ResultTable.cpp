@@ -0,0 +1,146 @@
+// ====== ResultTable.cpp ======
+#include "ResultTable.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+ResultTable::ColumnType ResultTable::mapType(StorageResult::ColumnType type) {
+    switch (type) {
+        case StorageResult::INTEGER: return INTEGER;
+        case StorageResult::REAL: return REAL;
+        default:
+            // DECIMAL 按文本保存，避免丢失精度
+            return TEXT;
+    }
+}
+
+void ResultTable::clear() {
+    columns_.clear();
+    data_.clear();
+    arena_.clear();
+    rows_ = 0;
+}
+
+void ResultTable::load(StorageResult* res, size_t expectedRows) {
+    clear();
+    if (!res) return;
+
+    // 列信息只解析一次
+    unsigned int count = static_cast<unsigned int>(res->columnCount());
+    columns_.resize(count);
+    data_.resize(count);
+    for (unsigned int i = 0; i < count; ++i) {
+        std::string name = res->columnLabel(i + 1);
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c){ return std::tolower(c); });
+        columns_[i].name = std::move(name);
+        columns_[i].type = mapType(res->columnType(i + 1));
+    }
+
+    if (expectedRows > 0) {
+        for (unsigned int i = 0; i < count; ++i) {
+            ColumnData& data = data_[i];
+            data.nulls.reserve(expectedRows);
+            switch (columns_[i].type) {
+                case INTEGER: data.ints.reserve(expectedRows); break;
+                case REAL: data.reals.reserve(expectedRows); break;
+                case TEXT: data.texts.reserve(expectedRows); break;
+            }
+        }
+        arena_.reserve(expectedRows * count * 16);
+    }
+
+    while (res->next()) {
+        for (unsigned int i = 0; i < count; ++i) {
+            ColumnData& data = data_[i];
+            bool null = res->isNull(i + 1);
+            data.nulls.push_back(null ? 1 : 0);
+            switch (columns_[i].type) {
+                case INTEGER:
+                    data.ints.push_back(null ? 0 : res->getInt64(i + 1));
+                    break;
+                case REAL:
+                    data.reals.push_back(null ? 0.0 : res->getDouble(i + 1));
+                    break;
+                case TEXT: {
+                    Slice slice;
+                    slice.offset = static_cast<uint32_t>(arena_.size());
+                    if (!null) {
+                        std::string text = res->getString(i + 1);
+                        arena_.append(text);
+                        slice.length = static_cast<uint32_t>(text.size());
+                    }
+                    data.texts.push_back(slice);
+                    break;
+                }
+            }
+        }
+        ++rows_;
+    }
+}
+
+int ResultTable::columnIndex(const std::string& name) const {
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        const std::string& columnName = columns_[i].name;
+        if (columnName.size() == name.size() &&
+            std::equal(columnName.begin(), columnName.end(), name.begin(),
+                       [](char a, char b) {
+                           return a == std::tolower(static_cast<unsigned char>(b));
+                       })) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+int64_t ResultTable::getInt(size_t row, size_t col) const {
+    const ColumnData& data = data_[col];
+    switch (columns_[col].type) {
+        case INTEGER: return data.ints[row];
+        case REAL: return static_cast<int64_t>(data.reals[row]);
+        case TEXT: {
+            std::string_view text = getString(row, col);
+            return text.empty() ? 0 : std::strtoll(std::string(text).c_str(), nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+double ResultTable::getDouble(size_t row, size_t col) const {
+    const ColumnData& data = data_[col];
+    switch (columns_[col].type) {
+        case INTEGER: return static_cast<double>(data.ints[row]);
+        case REAL: return data.reals[row];
+        case TEXT: {
+            std::string_view text = getString(row, col);
+            return text.empty() ? 0.0 : std::strtod(std::string(text).c_str(), nullptr);
+        }
+    }
+    return 0.0;
+}
+
+std::string_view ResultTable::getString(size_t row, size_t col) const {
+    if (columns_[col].type != TEXT) {
+        return std::string_view();
+    }
+    const Slice& slice = data_[col].texts[row];
+    return std::string_view(arena_.data() + slice.offset, slice.length);
+}
+
+std::string ResultTable::getText(size_t row, size_t col) const {
+    if (isNull(row, col)) {
+        return "";
+    }
+    switch (columns_[col].type) {
+        case INTEGER: return std::to_string(data_[col].ints[row]);
+        case REAL: {
+            std::string text = std::to_string(data_[col].reals[row]);
+            // 去掉 to_string 补出的末尾 0
+            text.erase(text.find_last_not_of('0') + 1);
+            if (!text.empty() && text.back() == '.') text.pop_back();
+            return text;
+        }
+        case TEXT: return std::string(getString(row, col));
+    }
+    return "";
+}
@@ -0,0 +1,330 @@
+// ====== SearchIndex.cpp ======
+#include "SearchIndex.h"
+#include <algorithm>
+
+// 辅助函数：把 UTF-8 文本解码为字符（码点），英文字母转为小写。
+// 非法字节按单个字符处理，不中断解码
+static std::vector<uint32_t> decodeUtf8(const std::string& text) {
+    std::vector<uint32_t> codepoints;
+    codepoints.reserve(text.size());
+    size_t i = 0;
+    while (i < text.size()) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        uint32_t cp = c;
+        size_t extra = 0;
+        if (c >= 0xF0 && c < 0xF8) { cp = c & 0x07; extra = 3; }
+        else if (c >= 0xE0) { cp = c & 0x0F; extra = 2; }
+        else if (c >= 0xC0) { cp = c & 0x1F; extra = 1; }
+
+        if (extra > 0) {
+            bool valid = true;
+            for (size_t k = 1; valid && k <= extra; ++k) {
+                if (i + k >= text.size() ||
+                    (static_cast<unsigned char>(text[i + k]) & 0xC0) != 0x80) {
+                    valid = false;
+                } else {
+                    cp = (cp << 6) | (static_cast<unsigned char>(text[i + k]) & 0x3F);
+                }
+            }
+            if (valid) {
+                i += extra + 1;
+                codepoints.push_back(cp);
+                continue;
+            }
+            cp = c;
+        }
+        if (cp >= 'A' && cp <= 'Z') cp += 'a' - 'A';
+        codepoints.push_back(cp);
+        ++i;
+    }
+    return codepoints;
+}
+
+// 单字和相邻两字使用不同的键空间
+static uint64_t unigramKey(uint32_t a) {
+    return (1ull << 63) | a;
+}
+
+static uint64_t bigramKey(uint32_t a, uint32_t b) {
+    return (static_cast<uint64_t>(a) << 21) | b;
+}
+
+// 文档的全部词项（去重后有序），不跨列生成 bigram
+static std::vector<uint64_t> documentTokens(const std::vector<std::string>& fields) {
+    std::vector<uint64_t> tokens;
+    for (const auto& field : fields) {
+        std::vector<uint32_t> cps = decodeUtf8(field);
+        for (size_t i = 0; i < cps.size(); ++i) {
+            tokens.push_back(unigramKey(cps[i]));
+            if (i + 1 < cps.size()) {
+                tokens.push_back(bigramKey(cps[i], cps[i + 1]));
+            }
+        }
+    }
+    std::sort(tokens.begin(), tokens.end());
+    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+    return tokens;
+}
+
+static std::string toLowerAscii(std::string text) {
+    for (char& c : text) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    return text;
+}
+
+SearchIndex& SearchIndex::instance() {
+    static SearchIndex index;
+    return index;
+}
+
+SearchIndex::StoredDocument SearchIndex::normalize(Document& doc) {
+    StoredDocument stored;
+    stored.fields.reserve(doc.fields.size());
+    for (auto& field : doc.fields) {
+        stored.fields.push_back(toLowerAscii(std::move(field)));
+    }
+    stored.sortKey = std::move(doc.sortKey);
+    return stored;
+}
+
+void SearchIndex::addDocument(Table& table, int id, StoredDocument doc) {
+    removeDocument(table, id);
+    for (uint64_t token : documentTokens(doc.fields)) {
+        std::vector<int>& posting = table.postings[token];
+        // 自增 id 通常递增写入，直接追加；否则插入到有序位置
+        if (posting.empty() || posting.back() < id) {
+            posting.push_back(id);
+        } else {
+            auto it = std::lower_bound(posting.begin(), posting.end(), id);
+            if (it == posting.end() || *it != id) {
+                posting.insert(it, id);
+            }
+        }
+    }
+    table.documents[id] = std::move(doc);
+}
+
+void SearchIndex::removeDocument(Table& table, int id) {
+    auto docIt = table.documents.find(id);
+    if (docIt == table.documents.end()) {
+        return;
+    }
+    for (uint64_t token : documentTokens(docIt->second.fields)) {
+        auto postingIt = table.postings.find(token);
+        if (postingIt == table.postings.end()) continue;
+        std::vector<int>& posting = postingIt->second;
+        auto it = std::lower_bound(posting.begin(), posting.end(), id);
+        if (it != posting.end() && *it == id) {
+            posting.erase(it);
+        }
+        if (posting.empty()) {
+            table.postings.erase(postingIt);
+        }
+    }
+    table.documents.erase(docIt);
+}
+
+void SearchIndex::beginRebuild() {
+    std::lock_guard<std::mutex> lock(pendingMutex_);
+    staging_.reset(new Table[DOMAIN_COUNT]);
+    pending_.clear();
+    rebuilding_ = true;
+}
+
+void SearchIndex::addToRebuild(Domain domain, Document doc) {
+    int id = doc.id;
+    addDocument(staging_[domain], id, normalize(doc));
+}
+
+void SearchIndex::commitRebuild() {
+    std::lock_guard<std::mutex> pendingLock(pendingMutex_);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    for (int d = 0; d < DOMAIN_COUNT; ++d) {
+        std::swap(tables_[d], staging_[d]);
+    }
+    // 重放构建期间发生的写入（可能已包含在新索引中，重放是幂等的）
+    for (auto& op : pending_) {
+        if (op.remove) {
+            removeDocument(tables_[op.domain], op.doc.id);
+        } else {
+            int id = op.doc.id;
+            addDocument(tables_[op.domain], id, normalize(op.doc));
+        }
+    }
+    pending_.clear();
+    staging_.reset();
+    rebuilding_ = false;
+    ready_.store(true, std::memory_order_release);
+}
+
+void SearchIndex::abortRebuild() {
+    std::lock_guard<std::mutex> lock(pendingMutex_);
+    pending_.clear();
+    staging_.reset();
+    rebuilding_ = false;
+}
+
+void SearchIndex::upsert(Domain domain, Document doc) {
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        if (rebuilding_) {
+            pending_.push_back(PendingOp{domain, false, doc});
+        }
+    }
+    if (!ready()) {
+        return;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    int id = doc.id;
+    addDocument(tables_[domain], id, normalize(doc));
+}
+
+void SearchIndex::remove(Domain domain, int id) {
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        if (rebuilding_) {
+            PendingOp op{domain, true, Document()};
+            op.doc.id = id;
+            pending_.push_back(std::move(op));
+        }
+    }
+    if (!ready()) {
+        return;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    removeDocument(tables_[domain], id);
+}
+
+// 调用方持有读锁
+std::vector<int> SearchIndex::match(const Table& table, const std::string& term) const {
+    std::vector<uint32_t> cps = decodeUtf8(term);
+    std::vector<int> result;
+    if (cps.empty()) {
+        return result;
+    }
+
+    std::vector<uint64_t> tokens;
+    if (cps.size() == 1) {
+        tokens.push_back(unigramKey(cps[0]));
+    } else {
+        for (size_t i = 0; i + 1 < cps.size(); ++i) {
+            tokens.push_back(bigramKey(cps[i], cps[i + 1]));
+        }
+        std::sort(tokens.begin(), tokens.end());
+        tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+    }
+
+    std::vector<const std::vector<int>*> lists;
+    for (uint64_t token : tokens) {
+        auto it = table.postings.find(token);
+        if (it == table.postings.end()) {
+            return result; // 有一个词项不存在即无匹配
+        }
+        lists.push_back(&it->second);
+    }
+
+    // 从最短的倒排表开始求交集
+    std::sort(lists.begin(), lists.end(),
+              [](const std::vector<int>* a, const std::vector<int>* b) { return a->size() < b->size(); });
+    result = *lists[0];
+    std::vector<int> next;
+    for (size_t i = 1; i < lists.size() && !result.empty(); ++i) {
+        next.clear();
+        std::set_intersection(result.begin(), result.end(),
+                              lists[i]->begin(), lists[i]->end(),
+                              std::back_inserter(next));
+        result.swap(next);
+    }
+
+    // 三个字以上时 bigram 都出现不代表连续出现，用子串确认
+    if (cps.size() > 2) {
+        std::string needle = toLowerAscii(term);
+        result.erase(std::remove_if(result.begin(), result.end(), [&](int id) {
+            auto docIt = table.documents.find(id);
+            if (docIt == table.documents.end()) return true;
+            for (const auto& field : docIt->second.fields) {
+                if (field.find(needle) != std::string::npos) return false;
+            }
+            return true;
+        }), result.end());
+    }
+    return result;
+}
+
+bool SearchIndex::findPage(Domain domain, const std::string& term, const PageRequest& request,
+                           std::vector<int>& ids) const {
+    ids.clear();
+    if (!ready()) {
+        return false;
+    }
+    queries_.fetch_add(1, std::memory_order_relaxed);
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const Table& table = tables_[domain];
+    std::vector<int> matched = match(table, term);
+
+    struct Hit {
+        const std::string* sortKey;
+        int id;
+    };
+    std::vector<Hit> hits;
+    hits.reserve(matched.size());
+
+    bool descending = domain != ITEMS;
+    if (request.backward) {
+        descending = !descending;
+    }
+    const PageCursor* cursor = request.cursor;
+    for (int id : matched) {
+        const std::string& key = table.documents.at(id).sortKey;
+        if (cursor) {
+            // 只保留游标之后（按当前方向）的文档
+            int cmp = key.compare(cursor->sortTime);
+            bool after = descending ? (cmp < 0 || (cmp == 0 && id < cursor->id))
+                                    : (cmp > 0 || (cmp == 0 && id > cursor->id));
+            if (!after) continue;
+        }
+        hits.push_back(Hit{&key, id});
+    }
+
+    auto before = [descending](const Hit& a, const Hit& b) {
+        int cmp = a.sortKey->compare(*b.sortKey);
+        if (cmp != 0) return descending ? cmp > 0 : cmp < 0;
+        return descending ? a.id > b.id : a.id < b.id;
+    };
+
+    size_t offset = cursor ? 0 : request.offset;
+    if (offset >= hits.size()) {
+        return true;
+    }
+    size_t end = std::min(hits.size(), offset + request.limit);
+    std::partial_sort(hits.begin(), hits.begin() + end, hits.end(), before);
+
+    ids.reserve(end - offset);
+    for (size_t i = offset; i < end; ++i) {
+        ids.push_back(hits[i].id);
+    }
+    return true;
+}
+
+bool SearchIndex::count(Domain domain, const std::string& term, long long& total) const {
+    if (!ready()) {
+        return false;
+    }
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    total = static_cast<long long>(match(tables_[domain], term).size());
+    return true;
+}
+
+SearchIndex::Stats SearchIndex::getStats() const {
+    Stats stats;
+    stats.ready = ready();
+    stats.queries = queries_.load(std::memory_order_relaxed);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    for (int d = 0; d < DOMAIN_COUNT; ++d) {
+        stats.documents[d] = tables_[d].documents.size();
+        stats.tokens[d] = tables_[d].postings.size();
+    }
+    return stats;
+}
@@ -0,0 +1,411 @@
+// ====== SlowQueryLog.cpp ======
+#include "SlowQueryLog.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+// 后台线程积压的上限，超过后丢弃新的慢查询（只计数）
+static const size_t kMaxPending = 256;
+// EXPLAIN 连接建立失败后，隔一段时间再重试
+static const std::chrono::seconds kReconnectDelay(30);
+
+static std::string currentTime() {
+    auto now = std::chrono::system_clock::now();
+    time_t seconds = std::chrono::system_clock::to_time_t(now);
+    long millis = static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        now.time_since_epoch()).count() % 1000);
+    struct tm tstruct;
+    localtime_r(&seconds, &tstruct);
+    char buf[40];
+    size_t len = strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tstruct);
+    snprintf(buf + len, sizeof(buf) - len, ".%03ld", millis);
+    return buf;
+}
+
+static std::string paramShape(const SlowQueryLog::Param& param) {
+    switch (param.type) {
+        case SlowQueryLog::Param::INT: return "int";
+        case SlowQueryLog::Param::INT64: return "int64";
+        case SlowQueryLog::Param::STRING: return "string(" + std::to_string(param.text.size()) + ")";
+        case SlowQueryLog::Param::NULL_VALUE: return "null";
+        default: return "?";
+    }
+}
+
+static bool isIdentChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+}
+
+// 只对读取和修改数据的语句查看执行计划
+static bool explainable(const std::string& normalizedSql) {
+    size_t end = 0;
+    while (end < normalizedSql.size() && isIdentChar(normalizedSql[end])) ++end;
+    std::string verb = normalizedSql.substr(0, end);
+    for (char& c : verb) {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+    return verb == "SELECT" || verb == "UPDATE" || verb == "DELETE" || verb == "WITH";
+}
+
+SlowQueryLog& SlowQueryLog::instance() {
+    static SlowQueryLog log;
+    return log;
+}
+
+SlowQueryLog::~SlowQueryLog() {
+    shutdown();
+}
+
+void SlowQueryLog::configure(Config& config) {
+    double ms = std::atof(config.getString("application", "slow_query_ms", "200").c_str());
+    explain_.store(config.getBool("application", "slow_query_explain", true), std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    keep_ = static_cast<size_t>(std::max(1, config.getInt("application", "slow_query_keep", 100)));
+    while (recent_.size() > keep_) {
+        recent_.pop_back();
+    }
+    path_ = config.getString("application", "slow_query_log", "geartracker.slow.log");
+    config_.reset(new Config(config));
+    thresholdMicros_.store(ms > 0 ? std::max<int64_t>(1, static_cast<int64_t>(ms * 1000)) : 0,
+                           std::memory_order_relaxed);
+    if (ms > 0 && !writer_.joinable()) {
+        stopping_ = false;
+        writer_ = std::thread(&SlowQueryLog::writerLoop, this);
+        GT_LOG_INFO("慢查询日志已开启，阈值 " + config.getString("application", "slow_query_ms", "200") +
+                    " ms，日志文件: " + path_);
+    }
+}
+
+void SlowQueryLog::shutdown() {
+    std::thread writer;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        thresholdMicros_.store(0, std::memory_order_relaxed);
+        stopping_ = true;
+        writer = std::move(writer_);
+    }
+    cv_.notify_all();
+    if (writer.joinable()) {
+        writer.join();
+    }
+}
+
+void SlowQueryLog::record(const std::string& sql, const std::string& query, std::vector<Param> params,
+                          long long rows, std::chrono::steady_clock::duration elapsed) {
+    Pending pending;
+    pending.entry.time = currentTime();
+    pending.entry.query = query;
+    pending.entry.sql = normalize(sql);
+    pending.entry.rows = rows;
+    pending.entry.durationMs =
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() / 1000.0;
+    // 连续相同的类型合并为 "string(8)*90"（IN 列表、多行 INSERT）
+    std::string last;
+    size_t repeat = 0;
+    auto flush = [&] {
+        if (repeat > 0) pending.entry.params.push_back(repeat > 1 ? last + "*" + std::to_string(repeat) : last);
+    };
+    for (const auto& param : params) {
+        std::string shape = paramShape(param);
+        if (repeat > 0 && shape == last) {
+            repeat++;
+            continue;
+        }
+        flush();
+        last = std::move(shape);
+        repeat = 1;
+    }
+    flush();
+    pending.rawSql = sql;
+    pending.params = std::move(params);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || !writer_.joinable() || queue_.size() >= kMaxPending) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        pending.entry.id = nextId_++;
+        queue_.push_back(std::move(pending));
+    }
+    recorded_.fetch_add(1, std::memory_order_relaxed);
+    cv_.notify_one();
+}
+
+void SlowQueryLog::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            break; // stopping_ 且已处理完
+        }
+        Pending pending = std::move(queue_.front());
+        queue_.pop_front();
+        std::string path = path_;
+        lock.unlock();
+
+        if (explain_.load(std::memory_order_relaxed) && !stopping_ && explainable(pending.entry.sql)) {
+            explain(pending);
+        }
+        if (path != openPath_) {
+            if (file_.is_open()) {
+                file_.close();
+            }
+            openPath_ = path;
+        }
+        writeEntry(pending.entry);
+
+        lock.lock();
+        Summary& summary = summary_[pending.entry.sql];
+        if (summary.count == 0) {
+            summary.sql = pending.entry.sql;
+            summary.query = pending.entry.query;
+        }
+        summary.count++;
+        summary.totalMs += pending.entry.durationMs;
+        summary.maxMs = std::max(summary.maxMs, pending.entry.durationMs);
+        summary.maxRows = std::max(summary.maxRows, pending.entry.rows);
+        recent_.push_front(std::move(pending.entry));
+        while (recent_.size() > keep_) {
+            recent_.pop_back();
+        }
+    }
+    lock.unlock();
+    explainCon_.reset();
+    if (file_.is_open()) {
+        file_.close();
+    }
+}
+
+// 在后台线程自己的连接上用原来的参数执行 EXPLAIN。该连接不经过 StatementCache，EXPLAIN 本身不计时
+void SlowQueryLog::explain(Pending& pending) {
+    Entry& entry = pending.entry;
+    if (!explainCon_) {
+        if (std::chrono::steady_clock::now() < explainRetryAt_) {
+            entry.planError = "EXPLAIN 连接不可用";
+            return;
+        }
+        std::unique_ptr<Config> config;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            config.reset(new Config(*config_));
+        }
+        try {
+            explainCon_ = openStorage(*config);
+        } catch (const std::exception& e) {
+            explainRetryAt_ = std::chrono::steady_clock::now() + kReconnectDelay;
+            entry.planError = std::string("EXPLAIN 连接失败: ") + e.what();
+            GT_LOG_WARNING("慢查询日志: " + entry.planError);
+            return;
+        }
+    }
+
+    try {
+        std::unique_ptr<StorageStatement> stmt(
+            explainCon_->prepareStatement(explainCon_->explainPrefix() + pending.rawSql));
+        for (size_t i = 0; i < pending.params.size(); ++i) {
+            const Param& param = pending.params[i];
+            int index = static_cast<int>(i) + 1;
+            switch (param.type) {
+                case Param::INT: stmt->setInt(index, static_cast<int>(param.number)); break;
+                case Param::INT64: stmt->setInt64(index, param.number); break;
+                case Param::STRING: stmt->setString(index, param.text); break;
+                default: stmt->setNull(index); break;
+            }
+        }
+        std::unique_ptr<StorageResult> res(stmt->executeQuery());
+        const int columns = res->columnCount();
+        int detail = 0; // SQLite 的 EXPLAIN QUERY PLAN 只有 detail 列有意义
+        for (int col = 1; col <= columns; ++col) {
+            if (res->columnLabel(col) == "detail") detail = col;
+        }
+        while (res->next()) {
+            std::string row;
+            if (detail > 0) {
+                row = res->getString(detail);
+            } else {
+                for (int col = 1; col <= columns; ++col) {
+                    if (res->isNull(col)) continue;
+                    if (!row.empty()) row += ' ';
+                    row += res->columnLabel(col) + "=" + res->getString(col);
+                }
+            }
+            entry.plan.push_back(std::move(row));
+        }
+    } catch (const StorageError& e) {
+        entry.planError = e.what();
+        if (explainCon_->isClosed()) {
+            explainCon_.reset();
+        }
+    } catch (const std::exception& e) {
+        entry.planError = e.what();
+    }
+}
+
+// 每条记录一段，格式与 MySQL 的慢查询日志相近：# 开头的注释行，之后是 SQL 和执行计划
+void SlowQueryLog::writeEntry(const Entry& entry) {
+    if (!file_.is_open()) {
+        file_.clear();
+        file_.open(openPath_, std::ios::app);
+        if (!file_) {
+            GT_LOG_WARNING("无法打开慢查询日志文件: " + openPath_);
+            return;
+        }
+    }
+    char duration[32];
+    std::snprintf(duration, sizeof(duration), "%.3f", entry.durationMs);
+    std::string text = "# Time: " + entry.time + "  Id: " + std::to_string(entry.id) + "\n" +
+                       "# Query: " + entry.query + "  Duration_ms: " + duration +
+                       "  Rows: " + std::to_string(entry.rows) + "\n";
+    if (!entry.params.empty()) {
+        text += "# Params:";
+        for (size_t i = 0; i < entry.params.size(); ++i) {
+            text += (i == 0 ? " " : ", ") + entry.params[i];
+        }
+        text += "\n";
+    }
+    text += entry.sql + ";\n";
+    if (!entry.plan.empty()) {
+        text += "# Plan:\n";
+        for (const auto& row : entry.plan) {
+            text += "#   " + row + "\n";
+        }
+    } else if (!entry.planError.empty()) {
+        text += "# Plan error: " + entry.planError + "\n";
+    }
+    file_ << text << '\n';
+    file_.flush();
+}
+
+std::vector<SlowQueryLog::Entry> SlowQueryLog::recent(size_t limit) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = std::min(limit, recent_.size());
+    return std::vector<Entry>(recent_.begin(), recent_.begin() + static_cast<std::ptrdiff_t>(count));
+}
+
+std::vector<SlowQueryLog::Summary> SlowQueryLog::summary(size_t limit) const {
+    std::vector<Summary> result;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result.reserve(summary_.size());
+        for (const auto& entry : summary_) {
+            result.push_back(entry.second);
+        }
+    }
+    std::sort(result.begin(), result.end(),
+              [](const Summary& a, const Summary& b) { return a.totalMs > b.totalMs; });
+    if (result.size() > limit) {
+        result.resize(limit);
+    }
+    return result;
+}
+
+SlowQueryLog::Stats SlowQueryLog::getStats() const {
+    Stats stats;
+    stats.enabled = enabled();
+    stats.thresholdMs = static_cast<double>(thresholdMicros()) / 1000.0;
+    stats.recorded = recorded_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void SlowQueryLog::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    recent_.clear();
+    summary_.clear();
+}
+
+std::string SlowQueryLog::normalize(const std::string& sql) {
+    // 第一遍：合并空白，字符串和数字字面量替换为 ?
+    std::string flat;
+    flat.reserve(sql.size());
+    for (size_t i = 0; i < sql.size();) {
+        char c = sql[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            while (i < sql.size() && std::isspace(static_cast<unsigned char>(sql[i]))) ++i;
+            if (!flat.empty()) flat += ' ';
+        } else if (c == '\'') {
+            for (++i; i < sql.size(); ++i) {
+                if (sql[i] == '\\') {
+                    ++i;
+                } else if (sql[i] == '\'') {
+                    if (i + 1 < sql.size() && sql[i + 1] == '\'') {
+                        ++i; // '' 转义
+                    } else {
+                        break;
+                    }
+                }
+            }
+            ++i;
+            flat += '?';
+        } else if (c == '`' || c == '"') {
+            size_t end = sql.find(c, i + 1); // 带引号的标识符原样保留
+            end = end == std::string::npos ? sql.size() : end + 1;
+            flat.append(sql, i, end - i);
+            i = end;
+        } else if (std::isdigit(static_cast<unsigned char>(c)) && (flat.empty() || !isIdentChar(flat.back()))) {
+            while (i < sql.size() && (std::isalnum(static_cast<unsigned char>(sql[i])) || sql[i] == '.')) ++i;
+            flat += '?';
+        } else {
+            flat += c;
+            ++i;
+        }
+    }
+    while (!flat.empty() && flat.back() == ' ') {
+        flat.pop_back();
+    }
+
+    // 第二遍：连续的占位符 "?, ?, ?" 合并为 "?, ..."；内容相同的连续括号组（多行 VALUES）合并为 "(...), ..."
+    std::string out;
+    out.reserve(flat.size());
+    auto skipSeparator = [](const std::string& text, size_t pos) {
+        while (pos < text.size() && text[pos] == ' ') ++pos;
+        if (pos >= text.size() || text[pos] != ',') return std::string::npos;
+        ++pos;
+        while (pos < text.size() && text[pos] == ' ') ++pos;
+        return pos;
+    };
+    for (size_t i = 0; i < flat.size();) {
+        if (flat[i] == '?') {
+            size_t next = i + 1;
+            bool repeated = false;
+            for (;;) {
+                size_t pos = skipSeparator(flat, next);
+                if (pos == std::string::npos || pos >= flat.size() || flat[pos] != '?') break;
+                next = pos + 1;
+                repeated = true;
+            }
+            out += repeated ? "?, ..." : "?";
+            i = next;
+        } else {
+            out += flat[i++];
+        }
+    }
+
+    std::string result;
+    result.reserve(out.size());
+    for (size_t i = 0; i < out.size();) {
+        size_t close = out[i] == '(' ? out.find(')', i) : std::string::npos;
+        if (close == std::string::npos || out.find('(', i + 1) < close) {
+            result += out[i++];
+            continue;
+        }
+        std::string group = out.substr(i, close + 1 - i);
+        size_t next = close + 1;
+        bool repeated = false;
+        for (;;) {
+            size_t pos = skipSeparator(out, next);
+            if (pos == std::string::npos || out.compare(pos, group.size(), group) != 0) break;
+            next = pos + group.size();
+            repeated = true;
+        }
+        result += group;
+        if (repeated) result += ", ...";
+        i = next;
+    }
+    return result;
+}
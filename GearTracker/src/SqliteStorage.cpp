@@ -0,0 +1,415 @@
+// ====== SqliteStorage.cpp ======
+#include "SqliteStorage.h"
+#include "Logger.h"
+#include <sqlite3.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+// 时间列的默认值：SQLite 的 %f 只有毫秒，补齐到与 MySQL DATETIME(6) 相同的 6 位小数
+#define GT_SQLITE_NOW "(strftime('%Y-%m-%d %H:%M:%f', 'now', 'localtime') || '000')"
+
+const char* const kSchema =
+    "CREATE TABLE IF NOT EXISTS item_list ("
+    "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
+    "  name TEXT NOT NULL COLLATE NOCASE,"
+    "  category TEXT,"
+    "  grade TEXT,"
+    "  effect TEXT,"
+    "  description TEXT,"
+    "  note TEXT"
+    ");"
+    "CREATE TABLE IF NOT EXISTS inventory ("
+    "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
+    "  item_id INTEGER NOT NULL REFERENCES item_list(id),"
+    "  quantity INTEGER NOT NULL DEFAULT 0,"
+    "  location TEXT,"
+    "  stored_time TEXT NOT NULL DEFAULT " GT_SQLITE_NOW ","
+    "  last_updated TEXT NOT NULL DEFAULT " GT_SQLITE_NOW
+    ");"
+    "CREATE TABLE IF NOT EXISTS operation_log ("
+    "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
+    "  operation_type TEXT NOT NULL,"
+    "  item_name TEXT,"
+    "  operation_time TEXT NOT NULL DEFAULT " GT_SQLITE_NOW ","
+    "  operation_note TEXT"
+    ");"
+    // 相当于 MySQL 的 ON UPDATE CURRENT_TIMESTAMP
+    "CREATE TRIGGER IF NOT EXISTS inventory_touch AFTER UPDATE OF item_id, quantity, location ON inventory "
+    "BEGIN UPDATE inventory SET last_updated = " GT_SQLITE_NOW " WHERE id = NEW.id; END;"
+    "CREATE INDEX IF NOT EXISTS idx_item_list_name ON item_list (name);"
+    "CREATE INDEX IF NOT EXISTS idx_inventory_item_id ON inventory (item_id);"
+    "CREATE INDEX IF NOT EXISTS idx_inventory_updated_id ON inventory (last_updated, id);"
+    "CREATE INDEX IF NOT EXISTS idx_operation_log_time_id ON operation_log (operation_time, id);";
+
+StorageError sqliteError(sqlite3* db, const std::string& context) {
+    return StorageError(context + ": " + sqlite3_errmsg(db), sqlite3_extended_errcode(db));
+}
+
+// ---------- 与 MySQL 同名的 SQL 函数 ----------
+
+// DATE_FORMAT(time, format)：支持 %Y %m %d %H %i %s %f %%，其余字符原样输出
+void dateFormatFunc(sqlite3_context* ctx, int, sqlite3_value** argv) {
+    if (sqlite3_value_type(argv[0]) == SQLITE_NULL || sqlite3_value_type(argv[1]) == SQLITE_NULL) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    // 先按 "YYYY-MM-DD HH:MM:SS.ffffff" 补齐，缺少的部分视为 0
+    std::string value(reinterpret_cast<const char*>(sqlite3_value_text(argv[0])));
+    std::string time = "0000-00-00 00:00:00.000000";
+    std::copy(value.begin(), value.begin() + std::min(value.size(), time.size()), time.begin());
+    time[10] = ' ';
+    time[19] = '.';
+
+    const char* format = reinterpret_cast<const char*>(sqlite3_value_text(argv[1]));
+    std::string out;
+    for (const char* p = format; *p; ++p) {
+        if (*p != '%' || !p[1]) {
+            out += *p;
+            continue;
+        }
+        switch (*++p) {
+            case 'Y': out.append(time, 0, 4); break;
+            case 'm': out.append(time, 5, 2); break;
+            case 'd': out.append(time, 8, 2); break;
+            case 'H': out.append(time, 11, 2); break;
+            case 'i': out.append(time, 14, 2); break;
+            case 's': out.append(time, 17, 2); break;
+            case 'f': out.append(time, 20, 6); break;
+            default: out += *p; break; // 包括 %%
+        }
+    }
+    sqlite3_result_text(ctx, out.data(), static_cast<int>(out.size()), SQLITE_TRANSIENT);
+}
+
+// CRC32(text)：与 MySQL 相同的 IEEE 802.3 多项式
+void crc32Func(sqlite3_context* ctx, int, sqlite3_value** argv) {
+    if (sqlite3_value_type(argv[0]) == SQLITE_NULL) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    static uint32_t table[256];
+    static bool ready = [] {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        return true;
+    }();
+    (void)ready;
+
+    const unsigned char* data = sqlite3_value_text(argv[0]);
+    int length = sqlite3_value_bytes(argv[0]);
+    uint32_t crc = 0xFFFFFFFFu;
+    for (int i = 0; i < length; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    sqlite3_result_int64(ctx, static_cast<sqlite3_int64>(crc ^ 0xFFFFFFFFu));
+}
+
+// CONCAT_WS(sep, ...)：跳过 NULL 参数（SQLite 3.44 起自带同名函数，这里统一注册以兼容旧版本）
+void concatWsFunc(sqlite3_context* ctx, int argc, sqlite3_value** argv) {
+    if (argc < 1 || sqlite3_value_type(argv[0]) == SQLITE_NULL) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    std::string separator(reinterpret_cast<const char*>(sqlite3_value_text(argv[0])));
+    std::string out;
+    bool first = true;
+    for (int i = 1; i < argc; ++i) {
+        if (sqlite3_value_type(argv[i]) == SQLITE_NULL) continue;
+        if (!first) out += separator;
+        out.append(reinterpret_cast<const char*>(sqlite3_value_text(argv[i])),
+                   static_cast<size_t>(sqlite3_value_bytes(argv[i])));
+        first = false;
+    }
+    sqlite3_result_text(ctx, out.data(), static_cast<int>(out.size()), SQLITE_TRANSIENT);
+}
+
+// ---------- 语句与结果集 ----------
+
+class SqliteStatement;
+
+// 结果集构造时先取第一行，这样没有声明类型的表达式列（COUNT(*)、SUM 等）也能从值确定类型。
+// 结果集读完或释放时重置语句，及时结束读事务（WAL 检查点不会被未读完的语句挡住）
+class SqliteResult : public StorageResult {
+public:
+    SqliteResult(SqliteStatement* owner, sqlite3* db, sqlite3_stmt* stmt)
+        : owner_(owner), db_(db), stmt_(stmt) {
+        hasRow_ = step();
+    }
+    ~SqliteResult() override;
+
+    // 语句被重新执行或释放时断开与结果集的关联
+    void detach() {
+        stmt_ = nullptr;
+        hasRow_ = false;
+    }
+
+    bool next() override {
+        if (first_) {
+            first_ = false;
+            return hasRow_;
+        }
+        if (hasRow_) {
+            hasRow_ = step();
+        }
+        return hasRow_;
+    }
+
+    bool isNull(int col) override { return sqlite3_column_type(stmt_, col - 1) == SQLITE_NULL; }
+    int getInt(int col) override { return sqlite3_column_int(stmt_, col - 1); }
+    int64_t getInt64(int col) override { return sqlite3_column_int64(stmt_, col - 1); }
+    double getDouble(int col) override { return sqlite3_column_double(stmt_, col - 1); }
+    std::string getString(int col) override {
+        const unsigned char* text = sqlite3_column_text(stmt_, col - 1);
+        if (!text) return std::string();
+        return std::string(reinterpret_cast<const char*>(text),
+                           static_cast<size_t>(sqlite3_column_bytes(stmt_, col - 1)));
+    }
+
+    int columnCount() override { return columns_; }
+    std::string columnLabel(int col) override {
+        const char* name = sqlite3_column_name(stmt_, col - 1);
+        return name ? name : "";
+    }
+    ColumnType columnType(int col) override {
+        const char* declared = sqlite3_column_decltype(stmt_, col - 1);
+        if (declared) {
+            std::string type(declared);
+            std::transform(type.begin(), type.end(), type.begin(),
+                           [](unsigned char c){ return std::toupper(c); });
+            // 与 SQLite 的类型亲和规则一致
+            if (type.find("INT") != std::string::npos) return INTEGER;
+            if (type.find("REAL") != std::string::npos || type.find("FLOA") != std::string::npos ||
+                type.find("DOUB") != std::string::npos) return REAL;
+            return TEXT;
+        }
+        // 表达式列：按第一行的值判断
+        switch (hasRow_ ? sqlite3_column_type(stmt_, col - 1) : SQLITE_NULL) {
+            case SQLITE_INTEGER: return INTEGER;
+            case SQLITE_FLOAT: return REAL;
+            default: return TEXT;
+        }
+    }
+
+private:
+    bool step() {
+        if (!stmt_) return false;
+        int rc = sqlite3_step(stmt_);
+        if (rc == SQLITE_ROW) {
+            return true;
+        }
+        // 读完后列名和声明类型仍可访问，但不再持有读事务
+        sqlite3_reset(stmt_);
+        if (rc != SQLITE_DONE) {
+            throw sqliteError(db_, "读取结果失败");
+        }
+        return false;
+    }
+
+    SqliteStatement* owner_;
+    sqlite3* db_;
+    sqlite3_stmt* stmt_;
+    int columns_ = stmt_ ? sqlite3_column_count(stmt_) : 0;
+    bool hasRow_ = false;
+    bool first_ = true;
+};
+
+class SqliteStatement : public StorageStatement {
+public:
+    SqliteStatement(sqlite3* db, sqlite3_stmt* stmt) : db_(db), stmt_(stmt) {}
+    ~SqliteStatement() override {
+        release();
+        sqlite3_finalize(stmt_);
+    }
+
+    void setInt(int index, int value) override {
+        release();
+        check(sqlite3_bind_int(stmt_, index, value), "绑定参数失败");
+    }
+    void setInt64(int index, int64_t value) override {
+        release();
+        check(sqlite3_bind_int64(stmt_, index, value), "绑定参数失败");
+    }
+    void setString(int index, const std::string& value) override {
+        release();
+        check(sqlite3_bind_text(stmt_, index, value.data(), static_cast<int>(value.size()), SQLITE_TRANSIENT),
+              "绑定参数失败");
+    }
+    void setNull(int index) override {
+        release();
+        check(sqlite3_bind_null(stmt_, index), "绑定参数失败");
+    }
+    void clearParameters() override {
+        release();
+        sqlite3_clear_bindings(stmt_);
+    }
+
+    StorageResult* executeQuery() override {
+        release();
+        auto* result = new SqliteResult(this, db_, stmt_);
+        active_ = result;
+        return result;
+    }
+
+    int executeUpdate() override {
+        release();
+        int rc;
+        while ((rc = sqlite3_step(stmt_)) == SQLITE_ROW) {
+        }
+        sqlite3_reset(stmt_);
+        if (rc != SQLITE_DONE) {
+            throw sqliteError(db_, "执行失败");
+        }
+        return sqlite3_changes(db_);
+    }
+
+    void resultClosed(SqliteResult* result) {
+        if (active_ == result) active_ = nullptr;
+    }
+
+private:
+    // 重新绑定或执行前：断开仍存活的结果集并重置语句（参数绑定保留）
+    void release() {
+        if (active_) {
+            active_->detach();
+            active_ = nullptr;
+        }
+        sqlite3_reset(stmt_);
+    }
+
+    void check(int rc, const char* context) {
+        if (rc != SQLITE_OK) {
+            throw sqliteError(db_, context);
+        }
+    }
+
+    sqlite3* db_;
+    sqlite3_stmt* stmt_;
+    SqliteResult* active_ = nullptr;
+};
+
+SqliteResult::~SqliteResult() {
+    if (stmt_) {
+        sqlite3_reset(stmt_);
+        owner_->resultClosed(this);
+    }
+}
+
+class SqliteConnection : public StorageConnection {
+public:
+    explicit SqliteConnection(sqlite3* db) : db_(db) {}
+    ~SqliteConnection() override { close(); }
+
+    const char* backendName() const override { return "sqlite"; }
+
+    StorageStatement* prepareStatement(const std::string& sql) override {
+        ensureOpen();
+        sqlite3_stmt* stmt = nullptr;
+        // 语句会被语句缓存长期持有
+        int rc = sqlite3_prepare_v3(db_, sql.c_str(), static_cast<int>(sql.size()),
+                                    SQLITE_PREPARE_PERSISTENT, &stmt, nullptr);
+        if (rc != SQLITE_OK) {
+            throw sqliteError(db_, "预处理失败");
+        }
+        return new SqliteStatement(db_, stmt);
+    }
+
+    void execute(const std::string& sql) override {
+        ensureOpen();
+        char* message = nullptr;
+        if (sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, &message) != SQLITE_OK) {
+            std::string error = message ? message : sqlite3_errmsg(db_);
+            sqlite3_free(message);
+            throw StorageError("执行失败: " + error, sqlite3_extended_errcode(db_));
+        }
+    }
+
+    // IMMEDIATE 在开始时就取得写锁：事务中读到的行不会被其他连接修改，相当于 FOR UPDATE
+    void begin() override { execute("BEGIN IMMEDIATE"); }
+    void commit() override { execute("COMMIT"); }
+    void rollback() override {
+        if (db_ && !sqlite3_get_autocommit(db_)) {
+            execute("ROLLBACK");
+        }
+    }
+
+    bool isClosed() override { return db_ == nullptr; }
+    bool isValid() override { return db_ != nullptr; }
+    void close() override {
+        if (db_) {
+            // 仍未释放的语句由 close_v2 延后到其 finalize 时一并关闭
+            sqlite3_close_v2(db_);
+            db_ = nullptr;
+        }
+    }
+
+    // 写入在事务或单条语句内独占进行，多行 INSERT 的 rowid 连续，最后一行的 rowid 往前推即是第一行
+    long long firstInsertId(size_t rows) override {
+        ensureOpen();
+        long long last = sqlite3_last_insert_rowid(db_);
+        return rows > 0 ? last - static_cast<long long>(rows) + 1 : last;
+    }
+
+    // 事务内独占写入，一条多行 INSERT 的 rowid 连续
+    long long insertIdStep() override { return 1; }
+
+    const char* lockClause() const override { return ""; }
+    bool supportsRowEstimate() const override { return false; }
+    const char* explainPrefix() const override { return "EXPLAIN QUERY PLAN "; }
+
+private:
+    void ensureOpen() {
+        if (!db_) {
+            throw StorageError("SQLite 连接已关闭");
+        }
+    }
+
+    sqlite3* db_;
+};
+
+} // namespace
+
+std::unique_ptr<StorageConnection> SqliteStorage::open(Config& config) {
+    std::string path = config.getString("database", "sqlite_path", "geartracker.db");
+    int busyTimeout = config.getInt("database", "sqlite_busy_timeout", 5000);
+
+    if (sqlite3_libversion_number() < 3032000) {
+        throw StorageError(std::string("SQLite 版本过低（需要 3.32 及以上）: ") + sqlite3_libversion());
+    }
+
+    sqlite3* db = nullptr;
+    int rc = sqlite3_open_v2(path.c_str(), &db,
+                             SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX, nullptr);
+    // 之后出错时由连接对象负责关闭
+    std::unique_ptr<StorageConnection> con(new SqliteConnection(db));
+    if (rc != SQLITE_OK) {
+        std::string message = db ? sqlite3_errmsg(db) : sqlite3_errstr(rc);
+        throw StorageError("无法打开 SQLite 数据库 " + path + ": " + message, rc);
+    }
+
+    sqlite3_busy_timeout(db, busyTimeout);
+    sqlite3_extended_result_codes(db, 1);
+
+    const int flags = SQLITE_UTF8 | SQLITE_DETERMINISTIC;
+    if (sqlite3_create_function(db, "DATE_FORMAT", 2, flags, nullptr, dateFormatFunc, nullptr, nullptr) != SQLITE_OK ||
+        sqlite3_create_function(db, "CRC32", 1, flags, nullptr, crc32Func, nullptr, nullptr) != SQLITE_OK ||
+        sqlite3_create_function(db, "CONCAT_WS", -1, flags, nullptr, concatWsFunc, nullptr, nullptr) != SQLITE_OK) {
+        throw sqliteError(db, "注册 SQL 函数失败");
+    }
+
+    // WAL：读不阻塞写、写不阻塞读；synchronous=NORMAL 在 WAL 下只在检查点时 fsync
+    con->execute("PRAGMA journal_mode=WAL");
+    con->execute("PRAGMA synchronous=NORMAL");
+    con->execute("PRAGMA foreign_keys=ON");
+    con->execute(kSchema);
+
+    GT_LOG_INFO("已打开SQLite数据库: " + path + "（SQLite " + sqlite3_libversion() + "）");
+    return con;
+}
@@ -0,0 +1,276 @@
+// ====== StatementCache.cpp ======
+#include "StatementCache.h"
+#include "Metrics.h"
+#include "SlowQueryLog.h"
+#include "Trace.h"
+#include <cctype>
+#include <vector>
+
+namespace {
+
+// 由 SQL 文本得到指标中的查询名："动词 表名"，如 "SELECT inventory"、"COUNT operation_log"、"INSERT item_list"
+std::string queryName(const std::string& sql) {
+    std::string text = sql;
+    for (char& c : text) {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+    // pos 处（跳过空白后）的一个标识符
+    auto wordAt = [&sql](size_t pos) {
+        while (pos < sql.size() && std::isspace(static_cast<unsigned char>(sql[pos]))) ++pos;
+        size_t end = pos;
+        while (end < sql.size() && (std::isalnum(static_cast<unsigned char>(sql[end])) || sql[end] == '_')) ++end;
+        return sql.substr(pos, end - pos);
+    };
+    size_t start = text.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos) {
+        return "OTHER";
+    }
+    std::string verb = wordAt(start);
+    for (char& c : verb) {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+    const char* keyword = nullptr; // 表名之前的关键字
+    if (verb == "SELECT") {
+        if (text.compare(start, 13, "SELECT COUNT(") == 0) verb = "COUNT";
+        keyword = " FROM ";
+    } else if (verb == "INSERT" || verb == "REPLACE") {
+        keyword = " INTO ";
+    } else if (verb == "DELETE") {
+        keyword = " FROM ";
+    }
+    std::string table;
+    if (verb == "UPDATE") {
+        table = wordAt(start + verb.size());
+    } else if (keyword) {
+        size_t pos = text.find(keyword, start);
+        if (pos != std::string::npos) table = wordAt(pos + 6);
+    }
+    return table.empty() ? verb : verb + " " + table;
+}
+
+class TimedStatement;
+
+// 记录执行时间的结果集：从 executeQuery 开始到读完最后一行（或提前释放）为止
+class TimedResult : public StorageResult {
+public:
+    TimedResult(StorageResult* inner, TimedStatement* owner, std::vector<SlowQueryLog::Param> params,
+                std::chrono::steady_clock::time_point start, Trace::Span span)
+        : inner_(inner), owner_(owner), params_(std::move(params)), start_(start), span_(std::move(span)) {}
+    ~TimedResult() override { finish(); }
+
+    bool next() override {
+        bool more = inner_->next();
+        if (more) {
+            rows_++;
+        } else {
+            finish();
+        }
+        return more;
+    }
+    bool isNull(int col) override { return inner_->isNull(col); }
+    int getInt(int col) override { return inner_->getInt(col); }
+    int64_t getInt64(int col) override { return inner_->getInt64(col); }
+    double getDouble(int col) override { return inner_->getDouble(col); }
+    std::string getString(int col) override { return inner_->getString(col); }
+    int columnCount() override { return inner_->columnCount(); }
+    std::string columnLabel(int col) override { return inner_->columnLabel(col); }
+    ColumnType columnType(int col) override { return inner_->columnType(col); }
+
+private:
+    void finish();
+
+    std::unique_ptr<StorageResult> inner_;
+    TimedStatement* owner_; // 结果集本来就不能比语句活得更久
+    std::vector<SlowQueryLog::Param> params_;
+    std::chrono::steady_clock::time_point start_;
+    Trace::Span span_;
+    long long rows_ = 0;
+};
+
+// 按查询名记录执行时间和错误数的预处理语句；当前请求在追踪时每次执行记为一个 span，
+// 超过慢查询阈值时连同绑定的参数交给 SlowQueryLog
+class TimedStatement : public StorageStatement {
+public:
+    TimedStatement(std::unique_ptr<StorageStatement> inner, const std::string& sql, const std::string& name)
+        : inner_(std::move(inner)), sql_(sql), name_(name), spanName_("SQL " + name) {
+        Metrics& metrics = Metrics::instance();
+        if (metrics.enabled()) {
+            std::string labels = "query=" + Metrics::label(name);
+            duration_ = metrics.histogram("geartracker_db_query_duration_seconds",
+                                          "SQL 语句执行时间（查询含读取结果）", labels);
+            errors_ = metrics.counter("geartracker_db_query_errors_total", "SQL 语句执行失败次数", labels);
+        }
+    }
+
+    void setInt(int index, int value) override {
+        inner_->setInt(index, value);
+        if (SlowQueryLog::instance().enabled()) param(index, SlowQueryLog::Param::INT).number = value;
+    }
+    void setInt64(int index, int64_t value) override {
+        inner_->setInt64(index, value);
+        if (SlowQueryLog::instance().enabled()) param(index, SlowQueryLog::Param::INT64).number = value;
+    }
+    void setString(int index, const std::string& value) override {
+        inner_->setString(index, value);
+        if (SlowQueryLog::instance().enabled()) param(index, SlowQueryLog::Param::STRING).text = value;
+    }
+    void setNull(int index) override {
+        inner_->setNull(index);
+        if (SlowQueryLog::instance().enabled()) param(index, SlowQueryLog::Param::NULL_VALUE);
+    }
+    void clearParameters() override {
+        inner_->clearParameters();
+        params_.clear();
+    }
+
+    // 参数只在慢查询日志开启时记录，执行后交给结果集；缓存的语句每次取出时都会清空并重新绑定参数
+    StorageResult* executeQuery() override {
+        auto start = std::chrono::steady_clock::now();
+        Trace::Span span(spanName_.c_str());
+        try {
+            return new TimedResult(inner_->executeQuery(), this, std::move(params_), start, std::move(span));
+        } catch (...) {
+            if (errors_) errors_->add();
+            throw;
+        }
+    }
+
+    int executeUpdate() override {
+        auto start = std::chrono::steady_clock::now();
+        Trace::Span span(spanName_.c_str());
+        int rows;
+        try {
+            rows = inner_->executeUpdate();
+        } catch (...) {
+            if (errors_) errors_->add();
+            throw;
+        }
+        span.end();
+        finished(std::chrono::steady_clock::now() - start, rows, params_);
+        return rows;
+    }
+
+    void finished(std::chrono::steady_clock::duration elapsed, long long rows,
+                  std::vector<SlowQueryLog::Param>& params) {
+        if (duration_) {
+            duration_->record(elapsed);
+        }
+        int64_t threshold = SlowQueryLog::instance().thresholdMicros();
+        if (threshold > 0 && std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() >= threshold) {
+            SlowQueryLog::instance().record(sql_, name_, std::move(params), rows, elapsed);
+        }
+    }
+
+private:
+    SlowQueryLog::Param& param(int index, SlowQueryLog::Param::Type type) {
+        size_t slot = static_cast<size_t>(index > 0 ? index - 1 : 0);
+        if (params_.size() <= slot) {
+            params_.resize(slot + 1);
+        }
+        params_[slot].type = type;
+        return params_[slot];
+    }
+
+    std::unique_ptr<StorageStatement> inner_;
+    std::string sql_;
+    std::string name_;
+    std::string spanName_;
+    Metrics::Histogram* duration_ = nullptr;
+    Metrics::Counter* errors_ = nullptr;
+    std::vector<SlowQueryLog::Param> params_;
+};
+
+void TimedResult::finish() {
+    span_.end();
+    if (owner_) {
+        owner_->finished(std::chrono::steady_clock::now() - start_, rows_, params_);
+        owner_ = nullptr;
+    }
+}
+
+} // namespace
+
+std::atomic<uint64_t> StatementCache::totalHits_{0};
+std::atomic<uint64_t> StatementCache::totalMisses_{0};
+std::atomic<uint64_t> StatementCache::totalEvictions_{0};
+
+StatementCache::StatementCache(size_t capacity)
+    : capacity_(capacity == 0 ? 1 : capacity) {}
+
+StatementCache::~StatementCache() {
+    clear();
+}
+
+StorageStatement* StatementCache::get(StorageConnection* con, const std::string& sql) {
+    auto it = index_.find(sql);
+    if (it != index_.end()) {
+        // 命中：移到 LRU 头部，并清掉上一次绑定的参数
+        lru_.splice(lru_.begin(), lru_, it->second);
+        hits_++;
+        totalHits_.fetch_add(1, std::memory_order_relaxed);
+        StorageStatement* stmt = it->second->second.get();
+        stmt->clearParameters();
+        return stmt;
+    }
+
+    // 未命中：解析一次后放入缓存
+    std::unique_ptr<StorageStatement> stmt(prepare(con, sql));
+    misses_++;
+    totalMisses_.fetch_add(1, std::memory_order_relaxed);
+
+    lru_.emplace_front(sql, std::move(stmt));
+    index_[sql] = lru_.begin();
+    evictOverflow();
+    return lru_.front().second.get();
+}
+
+StorageStatement* StatementCache::prepare(StorageConnection* con, const std::string& sql) {
+    std::unique_ptr<StorageStatement> stmt(con->prepareStatement(sql));
+    // 开启指标或慢查询日志、或编译了追踪时包装一层，按查询名记录执行时间
+#ifdef GEARTRACKER_TRACING
+    const bool timed = true;
+#else
+    const bool timed = Metrics::instance().enabled() || SlowQueryLog::instance().enabled();
+#endif
+    if (timed) {
+        stmt = std::make_unique<TimedStatement>(std::move(stmt), sql, queryName(sql));
+    }
+    return stmt.release();
+}
+
+void StatementCache::evictOverflow() {
+    while (lru_.size() > capacity_) {
+        index_.erase(lru_.back().first);
+        lru_.pop_back();
+        evictions_++;
+        totalEvictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void StatementCache::clear() {
+    index_.clear();
+    lru_.clear();
+}
+
+void StatementCache::setCapacity(size_t capacity) {
+    capacity_ = capacity == 0 ? 1 : capacity;
+    evictOverflow();
+}
+
+StatementCache::Stats StatementCache::getStats() const {
+    Stats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    stats.size = lru_.size();
+    stats.capacity = capacity_;
+    return stats;
+}
+
+StatementCache::Stats StatementCache::globalStats() {
+    Stats stats;
+    stats.hits = totalHits_.load(std::memory_order_relaxed);
+    stats.misses = totalMisses_.load(std::memory_order_relaxed);
+    stats.evictions = totalEvictions_.load(std::memory_order_relaxed);
+    return stats;
+}
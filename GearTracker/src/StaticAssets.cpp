@@ -0,0 +1,122 @@
+// ====== StaticAssets.cpp ======
+#include "StaticAssets.h"
+#include "HttpCompression.h"
+#include "Logger.h"
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool readFile(const fs::path& path, std::string& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad();
+}
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() &&
+           text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// 64 位 FNV-1a，生成 ETag 用
+std::string contentTag(const std::string& data) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    char buf[24];
+    snprintf(buf, sizeof(buf), "\"%016llx\"", static_cast<unsigned long long>(hash));
+    return buf;
+}
+
+} // namespace
+
+std::string StaticAssets::contentTypeOf(const std::string& path) {
+    static const std::unordered_map<std::string, std::string> types = {
+        {".html", "text/html; charset=utf-8"},
+        {".js", "application/javascript; charset=utf-8"},
+        {".css", "text/css; charset=utf-8"},
+        {".json", "application/json"},
+        {".svg", "image/svg+xml"},
+        {".png", "image/png"},
+        {".jpg", "image/jpeg"},
+        {".ico", "image/x-icon"},
+        {".txt", "text/plain; charset=utf-8"}
+    };
+    auto it = types.find(fs::path(path).extension().string());
+    return it == types.end() ? "application/octet-stream" : it->second;
+}
+
+// main.3f2a9c1b0d.js：扩展名前是 10 位十六进制的内容哈希
+bool StaticAssets::hasContentHash(const std::string& path) {
+    std::string stem = fs::path(path).stem().string();
+    size_t dot = stem.rfind('.');
+    if (dot == std::string::npos || stem.size() - dot - 1 != 10) {
+        return false;
+    }
+    for (size_t i = dot + 1; i < stem.size(); ++i) {
+        if (!std::isxdigit(static_cast<unsigned char>(stem[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool StaticAssets::load(const std::string& root, int gzipLevel) {
+    std::error_code ec;
+    if (!fs::is_directory(root, ec)) {
+        GT_LOG_ERROR("静态文件目录不存在: " + root);
+        return false;
+    }
+
+    size_t bytes = 0;
+    size_t precompressed = 0;
+    for (auto it = fs::recursive_directory_iterator(root, ec); !ec && it != fs::recursive_directory_iterator();
+         it.increment(ec)) {
+        if (!it->is_regular_file(ec)) continue;
+        std::string relative = "/" + fs::relative(it->path(), root, ec).generic_string();
+        if (endsWith(relative, ".gz")) continue; // 与原文件一起处理
+
+        Asset asset;
+        if (!readFile(it->path(), asset.body)) {
+            GT_LOG_WARNING("读取静态文件失败: " + it->path().string());
+            continue;
+        }
+        asset.contentType = contentTypeOf(relative);
+        asset.etag = contentTag(asset.body);
+        asset.immutable = hasContentHash(relative);
+
+        fs::path gzPath = it->path().string() + ".gz";
+        if (fs::is_regular_file(gzPath, ec) && readFile(gzPath, asset.gzip)) {
+            ++precompressed;
+        } else if (HttpCompression::compressible(asset.contentType)) {
+            HttpCompression::compress(HttpCompression::GZIP, asset.body, asset.gzip, gzipLevel);
+        }
+        if (asset.gzip.size() >= asset.body.size()) {
+            asset.gzip.clear(); // 压缩后没有变小
+        }
+        bytes += asset.body.size();
+        assets_[relative] = std::move(asset);
+    }
+
+    GT_LOG_INFO("已加载静态文件 " + std::to_string(assets_.size()) + " 个（" + std::to_string(bytes) +
+                " 字节，预压缩 " + std::to_string(precompressed) + " 个）");
+    return true;
+}
+
+const StaticAssets::Asset* StaticAssets::find(const std::string& path) const {
+    std::string key = path.empty() ? "/" : path;
+    if (key.back() == '/') {
+        key += "index.html";
+    }
+    auto it = assets_.find(key);
+    return it == assets_.end() ? nullptr : &it->second;
+}
@@ -0,0 +1,36 @@
+// ====== Storage.cpp ======
+#include "Storage.h"
+#include <algorithm>
+#include <cctype>
+
+#ifdef GEARTRACKER_WITH_MYSQL
+#include "MySqlStorage.h"
+#endif
+#ifdef GEARTRACKER_WITH_SQLITE
+#include "SqliteStorage.h"
+#endif
+
+StorageError::StorageError(const std::string& message, int code, const std::string& sqlState)
+    : std::runtime_error(message), code_(code), sqlState_(sqlState) {}
+
+std::unique_ptr<StorageConnection> openStorage(Config& config) {
+    std::string backend = config.getString("database", "backend", "mysql");
+    std::transform(backend.begin(), backend.end(), backend.begin(),
+                   [](unsigned char c){ return std::tolower(c); });
+
+    if (backend == "mysql") {
+#ifdef GEARTRACKER_WITH_MYSQL
+        return MySqlStorage::open(config);
+#else
+        throw StorageError("本程序编译时未包含 MySQL 后端（GEARTRACKER_WITH_MYSQL）");
+#endif
+    }
+    if (backend == "sqlite") {
+#ifdef GEARTRACKER_WITH_SQLITE
+        return SqliteStorage::open(config);
+#else
+        throw StorageError("本程序编译时未包含 SQLite 后端（GEARTRACKER_WITH_SQLITE）");
+#endif
+    }
+    throw StorageError("未知的存储后端: " + backend + "（可选 mysql / sqlite）");
+}
@@ -0,0 +1,179 @@
+// ====== Trace.cpp ======
+#include "Trace.h"
+#include "JsonWriter.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+struct Event {
+    std::string name;
+    int64_t start;
+    int64_t duration;
+};
+
+// 当前线程上正在处理的请求
+struct ThreadState {
+    bool recording = false;
+    std::string traceId;
+    std::vector<Event> events;
+    int tid = 0;
+    std::mt19937_64 random;
+};
+
+const auto kEpoch = std::chrono::steady_clock::now();
+std::atomic<int> nextTid{1};
+
+ThreadState& threadState() {
+    thread_local ThreadState state = [] {
+        ThreadState s;
+        s.tid = nextTid.fetch_add(1);
+        s.random.seed(std::random_device{}() ^ (static_cast<uint64_t>(s.tid) << 32));
+        return s;
+    }();
+    return state;
+}
+
+int64_t micros(std::chrono::steady_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time - kEpoch).count();
+}
+
+int64_t nowMicros() {
+    return micros(std::chrono::steady_clock::now());
+}
+
+// Chrome trace_event 的完整事件（ph = "X"），每行一个，以逗号结尾（JSON 数组格式允许缺少结尾的 ]）
+void appendEvent(JsonWriter& out, std::string_view name, const char* category, int64_t start, int64_t duration,
+                 int tid, const std::string& traceId, int status) {
+    static const int pid = static_cast<int>(getpid());
+    out.beginObject()
+       .field("name", name)
+       .field("cat", category)
+       .field("ph", "X")
+       .field("ts", static_cast<long long>(start))
+       .field("dur", static_cast<long long>(duration))
+       .field("pid", pid)
+       .field("tid", tid)
+       .key("args").beginObject().field("trace_id", traceId);
+    if (status > 0) {
+        out.field("status", status);
+    }
+    out.endObject().endObject().raw(",").endLine();
+}
+
+} // namespace
+
+Trace::Span::Span(const char* name) : name_(name), start_(-1) {
+    if (threadState().recording) {
+        start_ = nowMicros();
+    }
+}
+
+void Trace::Span::end() {
+    if (start_ < 0) {
+        return;
+    }
+    ThreadState& state = threadState();
+    if (state.recording) {
+        state.events.push_back({name_, start_, nowMicros() - start_});
+    }
+    start_ = -1;
+}
+
+Trace& Trace::instance() {
+    static Trace trace;
+    return trace;
+}
+
+void Trace::configure(Config& config) {
+    double rate = std::atof(config.getString("application", "trace_sample_rate", "0.01").c_str());
+    rate = std::min(1.0, std::max(0.0, rate));
+    sampleThreshold_.store(static_cast<uint64_t>(rate * 9007199254740992.0)); // rate * 2^53
+
+    std::lock_guard<std::mutex> lock(fileMutex_);
+    maxBytes_ = static_cast<size_t>(std::max(1, config.getInt("application", "trace_file_max_mb", 16))) << 20;
+    maxFiles_ = std::max(1, config.getInt("application", "trace_files", 3));
+    std::string path = config.getString("application", "trace_file", "geartracker.trace.json");
+    if (path != path_) {
+        path_ = path;
+        if (file_.is_open()) {
+            file_.close();
+        }
+    }
+}
+
+std::string Trace::beginRequest(bool force) {
+    ThreadState& state = threadState();
+    uint64_t random = state.random();
+    char id[17];
+    std::snprintf(id, sizeof(id), "%016llx", static_cast<unsigned long long>(random));
+    state.traceId = id;
+    state.events.clear();
+    state.recording = force || (random >> 11) < sampleThreshold_.load(std::memory_order_relaxed);
+    return state.traceId;
+}
+
+bool Trace::recording() {
+    return threadState().recording;
+}
+
+void Trace::endRequest(std::string_view name, std::chrono::steady_clock::time_point start, int status) {
+    ThreadState& state = threadState();
+    if (state.recording) {
+        state.recording = false;
+        int64_t begin = micros(start);
+        JsonWriter out(256 + state.events.size() * 160);
+        appendEvent(out, name, "request", begin, nowMicros() - begin, state.tid, state.traceId, status);
+        for (const auto& event : state.events) {
+            appendEvent(out, event.name, "span", event.start, event.duration, state.tid, state.traceId, 0);
+        }
+        write(out.str());
+    }
+    state.traceId.clear();
+    state.events.clear();
+}
+
+void Trace::openFile() {
+    file_.clear();
+    file_.open(path_, std::ios::binary | std::ios::app);
+    if (!file_) {
+        GT_LOG_WARNING("无法打开追踪文件: " + path_);
+        return;
+    }
+    file_.seekp(0, std::ios::end);
+    fileBytes_ = static_cast<size_t>(file_.tellp());
+    if (fileBytes_ == 0) {
+        file_ << "[\n";
+        fileBytes_ = 2;
+    }
+}
+
+// geartracker.trace.json -> .1 -> .2 ...，超出 maxFiles_ 的最旧文件被覆盖
+void Trace::rotate() {
+    file_.close();
+    for (int i = maxFiles_ - 1; i >= 1; --i) {
+        std::rename((path_ + "." + std::to_string(i)).c_str(), (path_ + "." + std::to_string(i + 1)).c_str());
+    }
+    std::rename(path_.c_str(), (path_ + ".1").c_str());
+    openFile();
+}
+
+void Trace::write(const std::string& events) {
+    std::lock_guard<std::mutex> lock(fileMutex_);
+    if (!file_.is_open()) {
+        openFile();
+    } else if (fileBytes_ + events.size() > maxBytes_) {
+        rotate();
+    }
+    if (!file_) {
+        return;
+    }
+    file_.write(events.data(), static_cast<std::streamsize>(events.size()));
+    file_.flush();
+    fileBytes_ += events.size();
+}
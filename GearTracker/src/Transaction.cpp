@@ -0,0 +1,29 @@
+// ====== Transaction.cpp ======
+#include "Transaction.h"
+#include "Logger.h"
+
+Transaction::Transaction(StorageConnection* con)
+    : con_(con), active_(false) {
+    con_->begin();
+    active_ = true;
+}
+
+Transaction::~Transaction() {
+    if (active_) {
+        rollback();
+    }
+}
+
+void Transaction::commit() {
+    con_->commit();
+    active_ = false;
+}
+
+void Transaction::rollback() {
+    active_ = false;
+    try {
+        con_->rollback();
+    } catch (const StorageError& e) {
+        GT_LOG_WARNING("事务回滚失败: " + std::string(e.what()));
+    }
+}
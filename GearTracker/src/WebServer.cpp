@@ -1,22 +1,103 @@
 #include "WebServer.h"
 #include "Config.h"
 #include "Database.h"
+#include "HttpCompression.h"
+#include "JsonWriter.h"
+#include "Csv.h"
+#include "Importer.h"
+#include "Metrics.h"
+#include "SlowQueryLog.h"
+#include "Trace.h"
 #include <fstream>
 #include <sstream>
 #include <iomanip>
-#include <json/json.h>
 #include <nlohmann/json.hpp>
+#include <cctype>
 #include <ctime>
 
+// 请求体用 nlohmann::json 解析；响应统一由 JsonWriter 直接写入输出缓冲区
 using json = nlohmann::json;
 
+// 当前线程上正在处理的请求是否已计入 in-flight（预路由时计入，httplib 写访问日志时减去）。
+// 解析失败的请求不经过预路由，但同样会写访问日志
+static thread_local bool tRequestInFlight = false;
+
+static void writeFields(JsonWriter&) {}
+
+template <typename Value, typename... Rest>
+static void writeFields(JsonWriter& out, const char* name, const Value& value, const Rest&... rest) {
+    out.field(name, value);
+    writeFields(out, rest...);
+}
+
+// 只有几个字段的小对象（错误信息、操作结果）：jsonObject("error", "...", "code", "...")
+template <typename... Fields>
+static std::string jsonObject(const Fields&... fields) {
+    JsonWriter out(128);
+    out.beginObject();
+    writeFields(out, fields...);
+    out.endObject();
+    return out.take();
+}
+
+// 压缩后的响应使用不同的强 ETag："abc" -> "abc-gzip" / "abc-br"
+static std::string encodedETag(const std::string& etag, HttpCompression::Encoding encoding) {
+    if (encoding == HttpCompression::IDENTITY || etag.size() < 2 || etag.back() != '"') {
+        return etag;
+    }
+    return etag.substr(0, etag.size() - 1) + "-" + HttpCompression::name(encoding) + "\"";
+}
+
+// 条件请求：If-None-Match 中任一 ETag（或 *）与当前 ETag 相同时回复 304，调用方直接返回。
+// 按 RFC 7232 对 If-None-Match 使用弱比较，忽略 W/ 前缀；压缩响应的 ETag 变体也视为相同
+static bool notModified(const httplib::Request& req, httplib::Response& res, const std::string& etag) {
+    if (!req.has_header("If-None-Match")) {
+        return false;
+    }
+    std::string header = req.get_header_value("If-None-Match");
+    size_t pos = 0;
+    while (pos < header.size()) {
+        size_t end = header.find(',', pos);
+        if (end == std::string::npos) end = header.size();
+        std::string tag = header.substr(pos, end - pos);
+        tag.erase(0, tag.find_first_not_of(" \t"));
+        tag.erase(tag.find_last_not_of(" \t") + 1);
+        if (tag.compare(0, 2, "W/") == 0) {
+            tag.erase(0, 2);
+        }
+        if (tag == "*" || tag == etag || tag == encodedETag(etag, HttpCompression::GZIP) ||
+            tag == encodedETag(etag, HttpCompression::BROTLI)) {
+            res.status = 304;
+            res.set_header("ETag", tag == "*" ? etag : tag);
+            res.set_header("Cache-Control", "no-cache");
+            return true;
+        }
+        pos = end + 1;
+    }
+    return false;
+}
+
 WebServer::WebServer(int port, Config& config)
     : port_(port), 
       config_(config),
-      server(std::make_unique<httplib::Server>()),
+      server(std::make_unique<HttpServer>()),
+      dbPool_(std::make_unique<ConnectionPool>(config)),
       running(false) {
     serverThread = std::thread();
-    std::cout << "WebServer 初始化完成，端口: " << port_ << std::endl;
+    compression_ = config_.getBool("application", "compression", true);
+    compressionMinBytes_ = static_cast<size_t>(std::max(0, config_.getInt("application", "compression_min_bytes", 1024)));
+    compressionLevel_ = config_.getInt("application", "compression_level", 6);
+    webRoot_ = config_.getString("application", "web_root", "./web");
+    eventsMaxClients_ = std::max(0, config_.getInt("application", "events_max_clients", 4));
+    exportMaxClients_ = std::max(0, config_.getInt("application", "export_max_clients", 2));
+    exportChunkRows_ = std::max(1, config_.getInt("application", "export_chunk_rows", 1000));
+    importChunkRows_ = std::max(1, config_.getInt("application", "import_chunk_rows", 1000));
+    httpInFlight_ = Metrics::instance().gauge("geartracker_http_requests_in_flight", "正在处理的 HTTP 请求数");
+    httpBytesOut_ = Metrics::instance().counter("geartracker_http_response_bytes_total",
+                                                "HTTP 响应体字节数（压缩后）");
+    importMaxBytes_ = static_cast<size_t>(std::max(1, config_.getInt("application", "import_max_mb", 64))) << 20;
+    loadWebOptions();
+    GT_LOG_INFO("WebServer 初始化完成，端口: " + std::to_string(port_));
 }
 
 WebServer::~WebServer() {
@@ -28,37 +109,175 @@ void WebServer::start() {
     if (running) return;
     
     setupRoutes();
+    setupStaticRoutes();
+    if (!staticAssets_.load(webRoot_, compressionLevel_)) {
+        GT_LOG_WARNING("Web 界面文件加载失败，只提供 API");
+    }
+    dbPool_->warmUp();
     running = true;
     
+    // 物品目录同步加载：后续检查物品/添加库存都依赖它
+    {
+        auto db = dbPool_->acquire();
+        if (!db || !db->refreshItemCatalog(true)) {
+            GT_LOG_WARNING("物品目录加载失败，物品查找将直接查询数据库");
+        }
+    }
+    backgroundStop_ = false;
+    int catalogInterval = config_.getInt("application", "catalog_refresh_interval", 30);
+    if (catalogInterval > 0) {
+        catalogThread_ = std::thread([this, catalogInterval]() {
+            std::unique_lock<std::mutex> lock(backgroundMutex_);
+            while (!backgroundCv_.wait_for(lock, std::chrono::seconds(catalogInterval),
+                                           [this]() { return backgroundStop_; })) {
+                lock.unlock();
+                {
+                    auto db = dbPool_->acquire();
+                    if (db) {
+                        db->refreshItemCatalog();
+                    }
+                }
+                lock.lock();
+            }
+        });
+    }
+    
+    // 数据库连接状态通过 /api/events 推送，没有订阅者时不检查
+    int healthInterval = config_.getInt("application", "events_health_interval", 10);
+    if (healthInterval > 0) {
+        healthThread_ = std::thread([this, healthInterval]() {
+            bool lastConnected = false;
+            bool known = false;
+            std::unique_lock<std::mutex> lock(backgroundMutex_);
+            while (!backgroundCv_.wait_for(lock, std::chrono::seconds(healthInterval),
+                                           [this]() { return backgroundStop_; })) {
+                if (!EventBus::instance().hasSubscribers()) {
+                    continue;
+                }
+                lock.unlock();
+                checkConnectionHealth(lastConnected, known);
+                lock.lock();
+            }
+        });
+    }
+    
+    // 搜索索引在后台构建，完成前搜索请求仍走 LIKE 查询
+    if (config_.getBool("application", "search_index", true)) {
+        indexThread_ = std::thread([this]() {
+            auto db = dbPool_->acquire();
+            if (!db || !db->buildSearchIndex()) {
+                GT_LOG_WARNING("搜索索引构建失败，搜索将使用 LIKE 查询");
+            }
+        });
+    }
+    
     serverThread = std::thread([this]() {
-        server->set_mount_point("/", "./web");
-        server->set_file_extension_and_mimetype_mapping("js", "application/javascript");
-        server->set_file_extension_and_mimetype_mapping("css", "text/css");
-        server->set_file_extension_and_mimetype_mapping("html", "text/html");
+        server->set_read_timeout(readTimeout_);
+        server->set_write_timeout(writeTimeout_);
+        server->set_keep_alive_max_count(static_cast<size_t>(keepAliveMaxRequests_));
+        server->set_tcp_nodelay(true); // 头和正文分两次写出，开启 Nagle 时长连接上的每个响应都要等对端的延迟确认（约 40ms）
+        server->set_keep_alive_timeout(keepAliveTimeout_);
+        server->setOverflowTimeout(queueOptions_.overflowTimeoutMs);
+        server->set_payload_max_length(importMaxBytes_); // 请求体上限，最大的请求是 /api/import
+        server->new_task_queue = [this]() {
+            return new RequestQueue(queueOptions_, queueCounters_);
+        };
         
-        server->set_read_timeout(20);
-        server->set_write_timeout(20);
+        // 队列已满时接收的连接、在队列中等待过久的请求直接回复 503，不进入路由
+        server->set_pre_routing_handler([this](const httplib::Request& req, httplib::Response& res) {
+            if (Metrics::instance().enabled()) {
+                httpInFlight_->add(1);
+                tRequestInFlight = true;
+            }
+#ifdef GEARTRACKER_TRACING
+            // 每个请求一个 trace id，抽中（或带 X-Trace: 1）的请求记录各阶段的 span
+            res.set_header("X-Trace-Id", Trace::instance().beginRequest(req.get_header_value("X-Trace") == "1"));
+#endif
+            if (RequestQueue::overloaded()) {
+                rejectBusy(res, true);
+                return httplib::Server::HandlerResponse::Handled;
+            }
+            long long waitMs = RequestQueue::takeQueueWaitMs();
+            int limit = routeTimeoutMs(req.path);
+            if (limit > 0 && waitMs > limit) {
+                GT_LOG_WARNING("请求在队列中等待 " + std::to_string(waitMs) +
+                               " 毫秒，超过 " + std::to_string(limit) + " 毫秒，已拒绝: " + req.path);
+                rejectBusy(res, false);
+                return httplib::Server::HandlerResponse::Handled;
+            }
+            return httplib::Server::HandlerResponse::Unhandled;
+        });
         
-        server->set_logger([](const httplib::Request& req, const httplib::Response& res) {
+        server->set_logger([this](const httplib::Request& req, const httplib::Response& res) {
+            recordRequestMetrics(req, res);
+            // 异步写出，不阻塞请求线程；错误响应用更高级别记录
+            int level = res.status >= 400 ? LOG_WARNING : LOG_INFO;
+            if (!Logger::instance().shouldLog(level)) return;
             std::string log = "Request: " + req.method + " " + req.path + " -> " + std::to_string(res.status);
             if (res.status >= 400) {
                 log += " Error: " + res.body.substr(0, 100);
             }
-            std::cout << log << std::endl;
+            Logger::instance().write(level, std::move(log));
         });
         
-        std::cout << "启动Web服务器在端口: " << port_ << std::endl;
+        if (compression_) {
+            server->set_post_routing_handler([this](const httplib::Request& req, httplib::Response& res) {
+                compressResponse(req, res);
+            });
+        }
+        
+        GT_LOG_INFO("启动Web服务器在端口: " + std::to_string(port_));
         server->listen("0.0.0.0", port_);
     });
 }
 
+// 每个请求结束时（httplib 的访问日志回调，在响应写完之后）按方法和路由模式记录次数、耗时和输出字节数。
+// 未匹配任何路由的请求（404、预路由直接回复的 503）记为 route="unmatched"
+void WebServer::recordRequestMetrics(const httplib::Request& req, const httplib::Response& res) {
+    if (tRequestInFlight) {
+        tRequestInFlight = false;
+        httpInFlight_->add(-1);
+    }
+#ifdef GEARTRACKER_TRACING
+    Trace::instance().endRequest(req.method + " " + (req.matched_route.empty() ? req.path : req.matched_route),
+                                 req.start_time_, res.status);
+#endif
+    Metrics& metrics = Metrics::instance();
+    if (!metrics.enabled()) {
+        return;
+    }
+    std::string labels = "method=" + Metrics::label(req.method) + ",route=" +
+                         Metrics::label(req.matched_route.empty() ? "unmatched" : req.matched_route);
+    metrics.histogram("geartracker_http_request_duration_seconds", "HTTP 请求处理时间（含写出响应）", labels)
+        ->record(std::chrono::steady_clock::now() - req.start_time_);
+    metrics.counter("geartracker_http_requests_total", "HTTP 请求数",
+                    labels + ",status=\"" + std::to_string(res.status) + "\"")->add();
+    httpBytesOut_->add(res.body.size()); // 分块传输的响应在写出时计入
+}
+
 void WebServer::stop() {
     if (running) {
         running = false;
+        EventBus::instance().close(); // 结束实时事件连接，否则工作线程要等到下一次心跳
         server->stop();
         if (serverThread.joinable()) {
             serverThread.join();
         }
+        if (indexThread_.joinable()) {
+            indexThread_.join();
+        }
+        {
+            std::lock_guard<std::mutex> backgroundLock(backgroundMutex_);
+            backgroundStop_ = true;
+        }
+        backgroundCv_.notify_all();
+        if (catalogThread_.joinable()) {
+            catalogThread_.join();
+        }
+        if (healthThread_.joinable()) {
+            healthThread_.join();
+        }
+        dbPool_->shutdown();
     }
 }
 
@@ -66,18 +285,177 @@ bool WebServer::isRunning() const {
     return running;
 }
 
+// 导出的时间参数："YYYY-MM-DD" 或 "YYYY-MM-DD HH:MM[:SS]"（也接受 T 分隔）。
+// 上限补齐到该日/该分/该秒的最后一微秒，与含微秒的时间列比较时包含边界
+static bool parseExportTime(std::string text, bool upper, std::string& out) {
+    out.clear();
+    if (text.empty()) {
+        return true;
+    }
+    if (text.size() > 10 && text[10] == 'T') {
+        text[10] = ' ';
+    }
+    static const char kPattern[] = "dddd-dd-dd dd:dd:dd";
+    if (text.size() != 10 && text.size() != 16 && text.size() != 19) {
+        return false;
+    }
+    for (size_t i = 0; i < text.size(); ++i) {
+        bool ok = kPattern[i] == 'd' ? std::isdigit(static_cast<unsigned char>(text[i])) != 0
+                                     : text[i] == kPattern[i];
+        if (!ok) {
+            return false;
+        }
+    }
+    if (text.size() == 10) {
+        text += upper ? " 23:59:59" : " 00:00:00";
+    } else if (text.size() == 16) {
+        text += upper ? ":59" : ":00";
+    }
+    out = upper ? text + ".999999" : text;
+    return true;
+}
+
+static void writeCsv(CsvWriter& out, const Database::InventoryItem& item) {
+    out.field(item.id).field(item.item_id).field(item.item_name).field(item.quantity)
+       .field(item.location).field(item.stored_time).field(item.last_updated).endRow();
+}
+
+static void writeCsv(CsvWriter& out, const Database::OperationLogEntry& entry) {
+    out.field(entry.id).field(entry.operation_type).field(entry.item_name)
+       .field(entry.operation_time).field(entry.operation_note).endRow();
+}
+
+template <typename Row>
+void WebServer::streamExport(const httplib::Request& req, httplib::Response& res, const std::string& name,
+                             const std::vector<std::string>& csvHeader, const Database::ExportFilter& filter,
+                             std::vector<Row> (Database::*fetch)(const Database::ExportFilter&, PageCursor&, int, bool&)) {
+    std::string format = req.has_param("format") ? req.get_param_value("format") : "csv";
+    if (format != "csv" && format != "ndjson") {
+        res.status = 400;
+        res.set_content(jsonObject("error", "format 只能是 csv 或 ndjson", "code", "INVALID_FORMAT"), "application/json");
+        return;
+    }
+    // 每个导出在传输期间占用一个工作线程
+    if (++activeExports_ > exportMaxClients_) {
+        --activeExports_;
+        res.status = 503;
+        res.set_header("Retry-After", std::to_string(retryAfter_));
+        res.set_content(jsonObject("error", "同时进行的导出过多，请稍后重试", "code", "EXPORT_BUSY"), "application/json");
+        return;
+    }
+
+    struct ExportState {
+        WebServer* server;
+        Database::ExportFilter filter;
+        PageCursor after;
+        std::vector<Row> rows;
+        bool done = false;
+        bool started = false;
+        size_t exported = 0;
+        ~ExportState() { --server->activeExports_; }
+    };
+    auto state = std::make_shared<ExportState>();
+    state->server = this;
+    state->filter = filter;
+
+    // 第一段在回复之前读取，数据库不可用时还能返回错误
+    {
+        auto db = dbPool_->acquire();
+        if (!db) {
+            res.status = 500;
+            res.set_content(jsonObject("error", "无法连接数据库", "code", "DB_CONNECTION_FAILED"), "application/json");
+            return;
+        }
+        try {
+            state->rows = ((*db).*fetch)(state->filter, state->after, exportChunkRows_, state->done);
+        } catch (const StorageError& e) {
+            res.status = 500;
+            res.set_content(jsonObject("error", "数据库查询错误", "code", e.getErrorCode(), "message", e.what()),
+                            "application/json");
+            return;
+        }
+    }
+
+    bool csv = format == "csv";
+    char stamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", std::localtime(&now));
+    res.set_header("Content-Disposition",
+                   "attachment; filename=\"" + name + "-" + stamp + (csv ? ".csv" : ".ndjson") + "\"");
+    res.set_header("Cache-Control", "no-store");
+    res.set_header("X-Accel-Buffering", "no");
+
+    std::function<bool()> isClosed = req.is_connection_closed;
+    auto chunkRows = exportChunkRows_;
+    res.set_chunked_content_provider(csv ? "text/csv; charset=utf-8" : "application/x-ndjson",
+        [this, state, csv, csvHeader, name, fetch, chunkRows, isClosed](size_t, httplib::DataSink& sink) {
+            auto write = [this, &sink](const char* data, size_t size) {
+                httpBytesOut_->add(size);
+                return sink.write(data, size);
+            };
+            bool ok;
+            if (csv) {
+                CsvWriter out(write);
+                if (!state->started) {
+                    out.raw("\xEF\xBB\xBF"); // UTF-8 BOM，Excel 才能正确识别中文
+                    for (const auto& column : csvHeader) {
+                        out.field(column);
+                    }
+                    out.endRow();
+                }
+                for (const auto& row : state->rows) {
+                    writeCsv(out, row);
+                }
+                ok = out.flush();
+            } else {
+                JsonWriter out(write);
+                for (const auto& row : state->rows) {
+                    Database::writeJson(out, row);
+                    out.endLine();
+                }
+                ok = out.flush();
+            }
+            state->started = true;
+            state->exported += state->rows.size();
+            state->rows.clear();
+            if (!ok || (isClosed && isClosed())) {
+                return false; // 客户端已断开
+            }
+            if (state->done) {
+                GT_LOG_INFO("导出完成: " + name + "，" +
+                            std::to_string(state->exported) + " 行");
+                sink.done();
+                return true;
+            }
+
+            // 下一段：每段单独借用连接，导出期间不长期占用连接池
+            auto db = dbPool_->acquire();
+            if (!db) {
+                GT_LOG_ERROR("导出中止（无法连接数据库）: " + name);
+                return false;
+            }
+            try {
+                state->rows = ((*db).*fetch)(state->filter, state->after, chunkRows, state->done);
+            } catch (const std::exception& e) {
+                GT_LOG_ERROR("导出中止: " + name + ": " + e.what());
+                return false;
+            }
+            return true;
+        });
+}
+
 void WebServer::setupRoutes() {
     // API端点 - 库存数据
     server->Get("/api/inventory", [this](const httplib::Request &req, httplib::Response &res) {
-        Database db(config_); // 创建独立数据库实例
-        // 强制测试连接
-        if (!db.testConnection()) {
+        // 库存和物品名称都没有变化时不借用连接、不查询
+        std::string etag = DataVersion::instance().etag({DataVersion::INVENTORY, DataVersion::ITEMS});
+        if (notModified(req, res, etag)) {
+            return;
+        }
+        auto db = dbPool_->acquire(); // 从连接池借用连接
+        if (!db) {
             res.status = 500;
-            nlohmann::json error = {
-                {"error", "无法连接数据库"},
-                {"code", "DB_CONNECTION_FAILED"}
-            };
-            res.set_content(error.dump(), "application/json");
+            res.set_content(jsonObject("error", "无法连接数据库", "code", "DB_CONNECTION_FAILED"), "application/json");
             return;
         }
         try {
@@ -91,7 +469,7 @@ void WebServer::setupRoutes() {
                     if (page < 1) page = 1;
                 } catch (const std::exception& e) {
                     // 使用局部db实例
-                    db.log("无效的分页参数: " + std::string(e.what()), true);
+                    db->log("无效的分页参数: " + std::string(e.what()), true);
                 }
             }
             
@@ -101,7 +479,7 @@ void WebServer::setupRoutes() {
                     if (perPage < 1) perPage = 10;
                     if (perPage > 100) perPage = 100;
                 } catch (const std::exception& e) {
-                    db.log("无效的每页数量参数: " + std::string(e.what()), true);
+                    db->log("无效的每页数量参数: " + std::string(e.what()), true);
                 }
             }
             
@@ -109,68 +487,86 @@ void WebServer::setupRoutes() {
                 searchTerm = req.get_param_value("search");
             }
             
-            db.log("收到 /api/inventory 请求: page=" + std::to_string(page) + 
+            db->log("收到 /api/inventory 请求: page=" + std::to_string(page) + 
                    ", perPage=" + std::to_string(perPage) + 
                    ", search='" + searchTerm + "'");
             
-            // 使用局部db实例
-            if (!db.testConnection()) {
-                res.status = 500;
-                res.set_content(json{{"error", "无法连接数据库"}}.dump(), "application/json");
+            // 带 cursor 参数时使用键集分页（cursor 为空表示第一页），否则保持原有的页码分页
+            bool keyset = req.has_param("cursor");
+            PageCursor cursor;
+            if (keyset && !req.get_param_value("cursor").empty() &&
+                !PageCursor::decode(req.get_param_value("cursor"), cursor)) {
+                res.status = 400;
+                res.set_content(jsonObject("error", "无效的分页游标", "code", "INVALID_CURSOR"), "application/json");
                 return;
             }
+            bool backward = req.has_param("dir") && req.get_param_value("dir") == "prev";
             
             try {
-                auto inventoryData = db.getInventory(page, perPage, searchTerm);
-                int totalItems = db.getTotalInventoryCount();
-                
-                Json::Value root;
-                Json::Value items(Json::arrayValue);
+                Database::KeysetPage<Database::InventoryItem> keysetPage;
+                std::vector<Database::InventoryItem> inventoryData;
+                if (keyset) {
+                    keysetPage = db->getInventoryByCursor(cursor, backward, perPage, searchTerm);
+                    inventoryData = std::move(keysetPage.rows);
+                } else {
+                    inventoryData = db->getInventory(page, perPage, searchTerm);
+                }
+                // 总数与列表使用相同的筛选条件
+                CountService::CountResult total = db->countInventory(searchTerm);
+                long long totalItems = total.count;
                 
+                // 行直接写入按页大小预留的输出缓冲区，再整体移交给响应，不构建中间的 JSON 树
+                TRACE_SPAN("WebServer::serialize");
+                JsonWriter out(256 + inventoryData.size() * 192);
+                out.beginObject().key("items").beginArray();
                 for (const auto& item : inventoryData) {
-                    Json::Value itemObj;
-                    itemObj["id"] = std::stoi(Database::safeGet(item, "inventory_id", "0"));
-                    itemObj["item_id"] = std::stoi(Database::safeGet(item, "item_id", "0"));
-                    itemObj["item_name"] = Database::safeGet(item, "item_name");
-                    itemObj["quantity"] = std::stoi(Database::safeGet(item, "quantity"));
-                    itemObj["location"] = Database::safeGet(item, "location");
-                    itemObj["stored_time"] = Database::safeGet(item, "stored_time");
-                    itemObj["last_updated"] = Database::safeGet(item, "last_updated");
-                    items.append(itemObj);
+                    Database::writeJson(out, item);
                 }
+                out.endArray()
+                   .field("total", totalItems)
+                   .field("totalEstimated", total.estimated)
+                   .field("page", page)
+                   .field("perPage", perPage)
+                   .field("totalPages", (totalItems + perPage - 1) / perPage);
+                if (keyset) {
+                    out.optionalField("next_cursor", keysetPage.nextCursor)
+                       .optionalField("prev_cursor", keysetPage.prevCursor);
+                }
+                out.endObject();
                 
-                root["items"] = items;
-                root["total"] = totalItems;
-                root["page"] = page;
-                root["perPage"] = perPage;
-                root["totalPages"] = (totalItems + perPage - 1) / perPage;
-                
-                Json::StreamWriterBuilder builder;
-                builder["indentation"] = "";
-                std::string output = Json::writeString(builder, root);
-                
-                res.set_content(output, "application/json");
-                db.log("成功返回库存数据: " + std::to_string(items.size()) + " 条记录");
+                res.set_header("ETag", etag);
+                res.set_header("Cache-Control", "no-cache");
+                res.set_content(out.take(), "application/json");
+                db->log("成功返回库存数据: " + std::to_string(inventoryData.size()) + " 条记录");
                 
-            } catch (const sql::SQLException& e) {
-                db.log("数据库查询错误: " + std::string(e.what()), true);
+            } catch (const StorageError& e) {
+                db->log("数据库查询错误: " + std::string(e.what()), true);
                 res.status = 500;
-                res.set_content(json{{"error", "Database query failed"}, {"code", e.getErrorCode()}}.dump(), "application/json");
+                res.set_content(jsonObject("error", "Database query failed", "code", e.getErrorCode()), "application/json");
             } catch (const std::exception& e) {
-                db.log("库存数据获取错误: " + std::string(e.what()), true);
+                db->log("库存数据获取错误: " + std::string(e.what()), true);
                 res.status = 500;
-                res.set_content(json{{"error", "Failed to get inventory data"}}.dump(), "application/json");
+                res.set_content(jsonObject("error", "Failed to get inventory data"), "application/json");
             }
             
         } catch (const std::exception& e) {
             res.status = 500;
-            res.set_content(json{{"error", "Internal server error"}}.dump(), "application/json");
+            res.set_content(jsonObject("error", "Internal server error"), "application/json");
         }
     });
 
     // API端点 - 操作日志
     server->Get("/api/operation_logs", [this](const httplib::Request &req, httplib::Response &res) {
-        Database db(config_);
+        std::string etag = DataVersion::instance().etag({DataVersion::OPERATION_LOG});
+        if (notModified(req, res, etag)) {
+            return;
+        }
+        auto db = dbPool_->acquire();
+        if (!db) {
+            res.status = 500;
+            res.set_content(jsonObject("error", "无法连接数据库"), "application/json");
+            return;
+        }
         
         int page = 1;
         int perPage = 10;
@@ -197,128 +593,130 @@ void WebServer::setupRoutes() {
             search = req.get_param_value("search");
         }
         
+        // 带 cursor 参数时使用键集分页，深翻页不再扫描并丢弃前面的行
+        bool keyset = req.has_param("cursor");
+        PageCursor cursor;
+        if (keyset && !req.get_param_value("cursor").empty() &&
+            !PageCursor::decode(req.get_param_value("cursor"), cursor)) {
+            res.status = 400;
+            res.set_content(jsonObject("error", "无效的分页游标", "code", "INVALID_CURSOR"), "application/json");
+            return;
+        }
+        bool backward = req.has_param("dir") && req.get_param_value("dir") == "prev";
+        
         try {
-            // 测试连接
-            if (!db.testConnection()) {
-                res.status = 500;
-                res.set_content(json{{"error", "无法连接数据库"}}.dump(), "application/json");
-                return;
-            }
-            
             // 获取日志数据
-            auto logs = db.getOperationLogs(page, perPage, search);
+            Database::KeysetPage<Database::OperationLogEntry> keysetPage;
+            std::vector<Database::OperationLogEntry> logs;
+            if (keyset) {
+                keysetPage = db->getOperationLogsByCursor(cursor, backward, perPage, search);
+                logs = std::move(keysetPage.rows);
+            } else {
+                logs = db->getOperationLogs(page, perPage, search);
+            }
             
-            // 获取总数 - 先于数据处理，避免影响连接
-            int totalItems = db.getTotalOperationLogsCount();
-            int totalPages = (totalItems + perPage - 1) / perPage;
+            // 获取与搜索条件一致的总数（缓存或估算，不再每页做一次全表 COUNT）
+            CountService::CountResult total = db->countOperationLogs(search);
+            long long totalItems = total.count;
+            long long totalPages = (totalItems + perPage - 1) / perPage;
             if (totalPages == 0) totalPages = 1;
             
-            // 使用 nlohmann::json 构建响应（更一致）
-            nlohmann::json response;
-            response["status"] = "success";
-            response["page"] = page;
-            response["perPage"] = perPage;
-            response["totalItems"] = totalItems;
-            response["totalPages"] = totalPages;
-            
-            nlohmann::json logsArray = nlohmann::json::array();
+            TRACE_SPAN("WebServer::serialize");
+            JsonWriter out(256 + logs.size() * 192);
+            out.beginObject()
+               .field("status", "success")
+               .field("page", page)
+               .field("perPage", perPage)
+               .field("totalItems", totalItems)
+               .field("totalEstimated", total.estimated)
+               .field("totalPages", totalPages);
+            if (keyset) {
+                out.optionalField("next_cursor", keysetPage.nextCursor)
+                   .optionalField("prev_cursor", keysetPage.prevCursor);
+            }
+            out.key("logs").beginArray();
             for (const auto& logEntry : logs) {
-                nlohmann::json logJson;
-                logJson["id"] = std::stoi(Database::safeGet(logEntry, "id", "0"));
-                logJson["operation_type"] = Database::safeGet(logEntry, "operation_type");
-                logJson["item_name"] = Database::safeGet(logEntry, "item_name");
-                
-                // 关键修改：使用新的列名
-                logJson["operation_time"] = Database::safeGet(logEntry, "formatted_time");
-                
-                logJson["operation_note"] = Database::safeGet(logEntry, "operation_note");
-                logsArray.push_back(logJson);
+                Database::writeJson(out, logEntry);
             }
-            response["logs"] = logsArray;
+            out.endArray().endObject();
             
-            res.set_content(response.dump(), "application/json");
+            res.set_header("ETag", etag);
+            res.set_header("Cache-Control", "no-cache");
+            res.set_content(out.take(), "application/json");
             
-        } catch (const sql::SQLException& e) {
-            nlohmann::json error = {
-                {"error", "数据库错误"},
-                {"code", e.getErrorCode()},
-                {"message", e.what()}
-            };
+        } catch (const StorageError& e) {
             res.status = 500;
-            res.set_content(error.dump(), "application/json");
+            res.set_content(jsonObject("error", "数据库错误", "code", e.getErrorCode(), "message", e.what()),
+                            "application/json");
         } catch (const std::exception& e) {
-            nlohmann::json error = {
-                {"error", "获取操作日志失败"},
-                {"message", e.what()}
-            };
             res.status = 500;
-            res.set_content(error.dump(), "application/json");
+            res.set_content(jsonObject("error", "获取操作日志失败", "message", e.what()), "application/json");
         }
     });
 
     
     server->Delete("/api/inventory/:id", [this](const httplib::Request &req, httplib::Response &res) {
-        Database db(config_); // 创建独立数据库实例
+        auto db = dbPool_->acquire();
+        if (!db) {
+            res.status = 500;
+            res.set_content(jsonObject("error", "无法连接数据库"), "application/json");
+            return;
+        }
         
         try {
             int id = std::stoi(req.path_params.at("id"));
             auto params = json::parse(req.body);
             std::string reason = params["reason"];
             
-            if (!db.testConnection()) {
-                res.status = 500;
-                res.set_content(json{{"error", "无法连接数据库"}}.dump(), "application/json");
-                return;
-            }
-            
-            if (db.deleteInventoryItem(id, reason)) {
-                res.set_content(json{{"success", true}, {"message", "删除成功"}}.dump(), "application/json");
+            if (db->deleteInventoryItem(id, reason)) {
+                res.set_content(jsonObject("success", true, "message", "删除成功"), "application/json");
             } else {
-                res.set_content(json{{"success", false}, {"message", "删除失败"}}.dump(), "application/json");
+                res.set_content(jsonObject("success", false, "message", "删除失败"), "application/json");
             }
         } catch (const std::exception& e) {
-            res.set_content(json{{"success", false}, {"error", e.what()}}.dump(), "application/json");
+            res.set_content(jsonObject("success", false, "error", e.what()), "application/json");
         }
     });
     
     server->Get("/api/inventory/item/:id", [this](const httplib::Request &req, httplib::Response &res) {
-        Database db(config_); // 创建独立数据库实例
+        auto db = dbPool_->acquire();
+        if (!db) {
+            res.status = 500;
+            res.set_content(jsonObject("error", "无法连接数据库"), "application/json");
+            return;
+        }
         
         try {
             int id = std::stoi(req.path_params.at("id"));
             
-            if (!db.testConnection()) {
-                res.status = 500;
-                res.set_content(json{{"error", "无法连接数据库"}}.dump(), "application/json");
-                return;
-            }
-            
-            auto itemData = db.getInventoryItemById(id);
+            auto itemData = db->getInventoryItemById(id);
             
             if (!itemData.empty()) {
-                // 修复JSON构造问题
-                nlohmann::json response = {
-                    {"inventory_id", std::stoi(Database::safeGet(itemData[0], "id", "0"))},
-                    {"item_id", std::stoi(Database::safeGet(itemData[0], "item_id", "0"))},
-                    {"item_name", Database::safeGet(itemData[0], "item_name")},
-                    {"quantity", std::stoi(Database::safeGet(itemData[0], "quantity", "0"))},
-                    {"location", Database::safeGet(itemData[0], "location")}
-                };
-                res.set_content(response.dump(), "application/json");
+                res.set_content(jsonObject(
+                    "inventory_id", std::stoi(Database::safeGet(itemData[0], "id", "0")),
+                    "item_id", std::stoi(Database::safeGet(itemData[0], "item_id", "0")),
+                    "item_name", Database::safeGet(itemData[0], "item_name"),
+                    "quantity", std::stoi(Database::safeGet(itemData[0], "quantity", "0")),
+                    "location", Database::safeGet(itemData[0], "location")), "application/json");
             } else {
-                res.set_content(json{{"error", "未找到库存项目"}}.dump(), "application/json");
+                res.set_content(jsonObject("error", "未找到库存项目"), "application/json");
             }
         } catch (const std::exception& e) {
-            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+            res.set_content(jsonObject("error", e.what()), "application/json");
         }
     });
 
     server->Put("/api/inventory/:id", [this](const httplib::Request &req, httplib::Response &res) {
-        Database db(config_); // 创建独立数据库实例
+        auto db = dbPool_->acquire();
+        if (!db) {
+            res.status = 500;
+            res.set_content(jsonObject("error", "无法连接数据库"), "application/json");
+            return;
+        }
         
         try {
             std::string idStr = req.path_params.at("id");
-            db.log("收到更新请求，库存ID: " + idStr + ", 数据: " + req.body);
+            db->log("收到更新请求，库存ID: " + idStr + ", 数据: " + req.body);
             int id = std::stoi(idStr);
             
             auto params = json::parse(req.body);
@@ -333,45 +731,566 @@ void WebServer::setupRoutes() {
             std::string location = params["location"];
             std::string reason = params["reason"];
             
-            if (!db.testConnection()) {
-                res.status = 500;
-                res.set_content(json{{"error", "无法连接数据库"}}.dump(), "application/json");
-                return;
-            }
-            
-            if (db.updateInventoryItem(id, quantity, location, reason)) {
-                res.set_content(json{{"success", true}, {"message", "更新成功"}}.dump(), "application/json");
+            if (db->updateInventoryItem(id, quantity, location, reason)) {
+                res.set_content(jsonObject("success", true, "message", "更新成功"), "application/json");
             } else {
-                res.set_content(json{{"success", false}, {"message", "更新失败"}}.dump(), "application/json");
+                res.set_content(jsonObject("success", false, "message", "更新失败"), "application/json");
             }
         } catch (const std::invalid_argument& e) {
-            db.log("无效的库存ID: " + std::string(e.what()), true);
-            res.set_content(json{{"success", false}, {"error", "无效的库存ID"}}.dump(), "application/json");
+            db->log("无效的库存ID: " + std::string(e.what()), true);
+            res.set_content(jsonObject("success", false, "error", "无效的库存ID"), "application/json");
         } catch (const std::exception& e) {
-            db.log("Web API 更新错误: " + std::string(e.what()), true);
-            res.set_content(json{{"success", false}, {"error", e.what()}}.dump(), "application/json");
+            db->log("Web API 更新错误: " + std::string(e.what()), true);
+            res.set_content(jsonObject("success", false, "error", e.what()), "application/json");
         }
     });
     
-    server->Get("/api/connection-status", [this](const httplib::Request&, httplib::Response& res) {
-        nlohmann::json response;
+    // 批量增删改库存，所有操作在一个事务中执行
+    server->Post("/api/inventory/batch", [this](const httplib::Request &req, httplib::Response &res) {
+        json body;
+        try {
+            body = json::parse(req.body);
+        } catch (const std::exception& e) {
+            res.status = 400;
+            res.set_content(jsonObject("success", false, "error", "请求体不是有效的JSON", "code", "INVALID_JSON"),
+                            "application/json");
+            return;
+        }
+        if (!body.contains("operations") || !body["operations"].is_array()) {
+            res.status = 400;
+            res.set_content(jsonObject("success", false, "error", "缺少 operations 数组", "code", "INVALID_BATCH"),
+                            "application/json");
+            return;
+        }
+        
+        const json& operations = body["operations"];
+        size_t maxOperations = static_cast<size_t>(
+            std::max(1, config_.getInt("application", "batch_max_operations", 1000)));
+        if (operations.size() > maxOperations) {
+            res.status = 400;
+            res.set_content(jsonObject("success", false,
+                                       "error", "单次最多 " + std::to_string(maxOperations) + " 个操作",
+                                       "code", "BATCH_TOO_LARGE"), "application/json");
+            return;
+        }
+        bool atomic = body.value("atomic", true);
+        
+        auto db = dbPool_->acquire();
+        if (!db) {
+            res.status = 500;
+            res.set_content(jsonObject("success", false, "error", "无法连接数据库", "code", "DB_CONNECTION_FAILED"),
+                            "application/json");
+            return;
+        }
         
+        // 解析各项操作；格式错误的项直接记为失败，不交给数据库
+        std::vector<Database::InventoryOperation> ops;
+        std::vector<size_t> opIndex; // ops[k] 对应请求中的第 opIndex[k] 项
+        std::vector<Database::InventoryOperationResult> results(operations.size());
+        bool invalid = false;
+        for (size_t i = 0; i < operations.size(); ++i) {
+            const json& item = operations[i];
+            try {
+                Database::InventoryOperation op;
+                std::string type = item.at("op").get<std::string>();
+                auto readQuantity = [&item]() {
+                    const json& quantity = item.at("quantity");
+                    return quantity.is_string() ? std::stoi(quantity.get<std::string>()) : quantity.get<int>();
+                };
+                if (type == "add") {
+                    op.type = Database::InventoryOperation::ADD;
+                    if (item.contains("itemId")) {
+                        op.itemId = item["itemId"].get<int>();
+                    } else {
+                        op.itemId = db->getItemIdByName(item.at("itemName").get<std::string>());
+                    }
+                    op.quantity = readQuantity();
+                    op.location = item.at("location").get<std::string>();
+                } else if (type == "update") {
+                    op.type = Database::InventoryOperation::UPDATE;
+                    op.inventoryId = item.at("id").get<int>();
+                    op.quantity = readQuantity();
+                    op.location = item.at("location").get<std::string>();
+                } else if (type == "delete") {
+                    op.type = Database::InventoryOperation::REMOVE;
+                    op.inventoryId = item.at("id").get<int>();
+                } else {
+                    throw std::invalid_argument("未知的操作类型: " + type);
+                }
+                op.reason = item.value("reason", "");
+                ops.push_back(std::move(op));
+                opIndex.push_back(i);
+            } catch (const std::exception& e) {
+                results[i].error = std::string("操作格式错误: ") + e.what();
+                invalid = true;
+            }
+        }
+        
+        std::vector<Database::InventoryOperationResult> opResults;
+        bool success = false;
+        if (invalid && atomic) {
+            opResults.assign(ops.size(), Database::InventoryOperationResult());
+            for (auto& result : opResults) {
+                result.error = "同批次中有操作失败，未执行";
+            }
+        } else {
+            success = db->applyInventoryBatch(ops, atomic, opResults) && !invalid;
+        }
+        
+        size_t applied = 0;
+        for (size_t k = 0; k < ops.size(); ++k) {
+            if (opResults[k].success) {
+                applied++;
+            }
+            results[opIndex[k]] = std::move(opResults[k]);
+        }
+        
+        JsonWriter out(64 + results.size() * 48);
+        out.beginObject()
+           .field("success", success)
+           .field("applied", applied)
+           .key("results").beginArray();
+        for (size_t i = 0; i < results.size(); ++i) {
+            out.beginObject().field("index", i).field("success", results[i].success);
+            if (results[i].success) {
+                out.field("id", results[i].inventoryId);
+            } else {
+                out.field("error", results[i].error);
+            }
+            out.endObject();
+        }
+        out.endArray().endObject();
+        res.set_content(out.take(), "application/json");
+    });
+    
+    // ====== 批量导入 ======
+    // 请求体为 CSV 或 NDJSON（格式见 Importer.h），按 format 参数或 Content-Type 识别，默认 CSV。
+    // 同一时间只进行一个导入；被拒绝的行在响应中最多列出 100 条
+    server->Post("/api/import", [this](const httplib::Request& req, httplib::Response& res) {
+        Importer::Format format = Importer::CSV;
+        std::string formatName = req.get_param_value("format");
+        std::string contentType = req.get_header_value("Content-Type");
+        if (!formatName.empty()) {
+            if (!Importer::formatFromName(formatName, format)) {
+                res.status = 400;
+                res.set_content(jsonObject("success", false, "error", "format 只能是 csv 或 ndjson", "code", "INVALID_FORMAT"),
+                                "application/json");
+                return;
+            }
+        } else if (contentType.find("ndjson") != std::string::npos || contentType.find("jsonl") != std::string::npos) {
+            format = Importer::NDJSON;
+        }
+
+        if (activeImports_.fetch_add(1) >= 1) {
+            activeImports_.fetch_sub(1);
+            res.status = 503;
+            res.set_header("Retry-After", std::to_string(retryAfter_));
+            res.set_content(jsonObject("success", false, "error", "已有导入正在进行", "code", "IMPORT_BUSY"),
+                            "application/json");
+            return;
+        }
+        struct ImportSlot {
+            std::atomic<int>& count;
+            ~ImportSlot() { count.fetch_sub(1); }
+        } slot{activeImports_};
+
+        auto db = dbPool_->acquire();
+        if (!db) {
+            res.status = 500;
+            res.set_content(jsonObject("success", false, "error", "无法连接数据库", "code", "DB_CONNECTION_FAILED"),
+                            "application/json");
+            return;
+        }
+
+        // 直接从请求体读取，不复制
+        struct BodyBuffer : std::streambuf {
+            explicit BodyBuffer(const std::string& body) {
+                char* data = const_cast<char*>(body.data());
+                setg(data, data, data + body.size());
+            }
+        } buffer(req.body);
+        std::istream input(&buffer);
+
+        const size_t maxRejects = 100;
+        std::vector<Importer::Reject> rejects;
+        Importer::Options options;
+        options.chunkRows = static_cast<size_t>(importChunkRows_);
+        if (req.has_param("reason")) {
+            options.reason = req.get_param_value("reason");
+        }
+        options.onReject = [&rejects, maxRejects](const Importer::Reject& reject) {
+            if (rejects.size() < maxRejects) {
+                rejects.push_back(reject);
+            }
+        };
+
+        Importer::Progress progress;
+        std::string error;
+        bool ok = Importer::run(*db, input, format, options, progress, error);
+
+        JsonWriter out(256 + rejects.size() * 128);
+        out.beginObject()
+           .field("success", ok)
+           .field("rows", progress.rows)
+           .field("itemsCreated", progress.itemsCreated)
+           .field("inventoryAdded", progress.inventoryAdded)
+           .field("rejected", progress.rejected)
+           .field("seconds", progress.seconds);
+        if (!ok) {
+            res.status = 422;
+            out.field("error", error).field("code", "IMPORT_FAILED");
+        }
+        out.key("rejects").beginArray();
+        for (const auto& reject : rejects) {
+            out.beginObject().field("line", reject.line).field("error", reject.error).field("row", reject.row).endObject();
+        }
+        out.endArray().endObject();
+        res.set_content(out.take(), "application/json");
+    });
+
+    // ====== 批量导出 ======
+    // 全部（或按条件筛选的）库存和操作日志，按时间升序以分块传输写出 CSV 或 NDJSON。
+    // 数据按 export_chunk_rows 行一段读取，导出任意多行只占用一段的内存
+    server->Get("/api/export/inventory", [this](const httplib::Request& req, httplib::Response& res) {
+        Database::ExportFilter filter;
+        filter.search = req.get_param_value("search");
+        filter.location = req.get_param_value("location");
+        if (req.has_param("item_id")) {
+            filter.itemId = std::atoi(req.get_param_value("item_id").c_str());
+        }
+        if (!parseExportTime(req.get_param_value("from"), false, filter.from) ||
+            !parseExportTime(req.get_param_value("to"), true, filter.to)) {
+            res.status = 400;
+            res.set_content(jsonObject("error", "时间格式应为 YYYY-MM-DD 或 YYYY-MM-DD HH:MM:SS", "code", "INVALID_TIME"),
+                            "application/json");
+            return;
+        }
+        streamExport(req, res, "inventory",
+                     {"id", "item_id", "item_name", "quantity", "location", "stored_time", "last_updated"},
+                     filter, &Database::exportInventory);
+    });
+
+    server->Get("/api/export/operation_logs", [this](const httplib::Request& req, httplib::Response& res) {
+        Database::ExportFilter filter;
+        filter.search = req.get_param_value("search");
+        filter.operationType = req.get_param_value("type");
+        if (!parseExportTime(req.get_param_value("from"), false, filter.from) ||
+            !parseExportTime(req.get_param_value("to"), true, filter.to)) {
+            res.status = 400;
+            res.set_content(jsonObject("error", "时间格式应为 YYYY-MM-DD 或 YYYY-MM-DD HH:MM:SS", "code", "INVALID_TIME"),
+                            "application/json");
+            return;
+        }
+        streamExport(req, res, "operation_logs",
+                     {"id", "operation_type", "item_name", "operation_time", "operation_note"},
+                     filter, &Database::exportOperationLogs);
+    });
+    
+    // ====== 实时事件（Server-Sent Events）======
+    // 推送库存变化（inventory）、操作日志（operation_log）和数据库连接状态（connection）。
+    // 每个连接在推送期间占用一个工作线程，连接数限制为 events_max_clients
+    server->Get("/api/events", [this](const httplib::Request& req, httplib::Response& res) {
+        EventBus& bus = EventBus::instance();
+        if (!bus.addSubscriber(static_cast<size_t>(eventsMaxClients_))) {
+            res.status = 503;
+            res.set_header("Retry-After", "30");
+            res.set_content(jsonObject("error", "实时事件连接数已达上限", "code", "EVENTS_FULL"),
+                            "application/json");
+            return;
+        }
+
+        struct StreamState {
+            uint64_t lastId = 0;
+            bool started = false;
+            bool reset = false; // 无法补发断线期间的事件，客户端需要重新加载
+        };
+        auto state = std::make_shared<StreamState>();
+        state->lastId = bus.lastId();
+        // 断线重连时浏览器带上最后收到的编号（"启动时间-序号"），补发之后的事件
+        std::string lastEventId = req.get_header_value("Last-Event-ID");
+        if (!lastEventId.empty()) {
+            size_t dash = lastEventId.find('-');
+            if (dash != std::string::npos && lastEventId.compare(0, dash, bus.epoch()) == 0) {
+                state->lastId = std::strtoull(lastEventId.c_str() + dash + 1, nullptr, 10);
+            } else {
+                state->reset = true;
+            }
+        }
+
+        res.set_header("Cache-Control", "no-cache");
+        res.set_header("X-Accel-Buffering", "no");
+        std::function<bool()> isClosed = req.is_connection_closed;
+        Metrics::Counter* bytesOut = httpBytesOut_;
+        res.set_chunked_content_provider("text/event-stream",
+            [state, isClosed, bytesOut](size_t, httplib::DataSink& sink) {
+                EventBus& bus = EventBus::instance();
+                auto format = [&bus](const EventBus::Event& event, bool withId) {
+                    std::string text = "event: " + event.type + "\n";
+                    if (withId) {
+                        text += "id: " + bus.epoch() + "-" + std::to_string(event.id) + "\n";
+                    }
+                    return text + "data: " + event.data + "\n\n";
+                };
+
+                std::string out;
+                int waitSeconds = 15; // 没有事件时每 15 秒发一次心跳
+                if (!state->started) {
+                    // 连上后立即发送重连间隔和最新的连接状态（sticky 事件不带编号，不影响补发位置）
+                    state->started = true;
+                    waitSeconds = 0;
+                    out = "retry: 3000\n\n";
+                    for (const auto& event : bus.stickyEvents()) {
+                        out += format(event, false);
+                    }
+                }
+
+                // 每秒检查一次客户端是否已断开，尽快释放工作线程
+                std::vector<EventBus::Event> events;
+                bool current = !state->reset && bus.waitEvents(state->lastId, std::chrono::milliseconds(0), events);
+                for (int waited = 0; current && events.empty() && waited < waitSeconds && !bus.closed(); ++waited) {
+                    if (isClosed && isClosed()) {
+                        return false;
+                    }
+                    current = bus.waitEvents(state->lastId, std::chrono::seconds(1), events);
+                }
+                if (!current) {
+                    state->reset = false;
+                    state->lastId = bus.lastId();
+                    EventBus::Event reset;
+                    reset.id = state->lastId;
+                    reset.type = "reset";
+                    reset.data = "{}";
+                    out += format(reset, true);
+                }
+                for (const auto& event : events) {
+                    out += format(event, true);
+                    state->lastId = event.id;
+                }
+                if (out.empty()) {
+                    out = ": keep-alive\n\n";
+                }
+                if (!sink.write(out.data(), out.size())) {
+                    return false; // 客户端已断开
+                }
+                bytesOut->add(out.size());
+                if (bus.closed()) {
+                    sink.done();
+                }
+                return true;
+            },
+            [](bool) { EventBus::instance().removeSubscriber(); });
+    });
+
+    // ====== 指标（Prometheus 文本格式）======
+    // 注册表中的请求/查询耗时直方图和计数，加上各模块现有统计的当前值
+    server->Get("/metrics", [this](const httplib::Request&, httplib::Response& res) {
+        if (!Metrics::instance().enabled()) {
+            res.status = 404;
+            res.set_content(jsonObject("error", "指标未开启", "code", "METRICS_DISABLED"), "application/json");
+            return;
+        }
+        std::string out;
+        out.reserve(64 * 1024);
+        Metrics::instance().render(out);
+
+        Metrics::appendSample(out, "geartracker_http_workers", "gauge", "HTTP 工作线程数",
+                              static_cast<double>(queueCounters_->workers.load()));
+        Metrics::appendSample(out, "geartracker_http_workers_busy", "gauge", "正在处理连接的工作线程数",
+                              static_cast<double>(queueCounters_->active.load()));
+        Metrics::appendSample(out, "geartracker_http_connections_queued", "gauge", "等待工作线程的连接数",
+                              static_cast<double>(queueCounters_->queued.load()));
+        Metrics::appendSample(out, "geartracker_http_connections_accepted_total", "counter", "交给工作线程的连接数",
+                              static_cast<double>(queueCounters_->accepted.load()));
+        Metrics::appendSample(out, "geartracker_http_connections_overflowed_total", "counter",
+                              "队列已满、回复 503 的连接数", static_cast<double>(queueCounters_->overflowed.load()));
+        Metrics::appendSample(out, "geartracker_http_connections_dropped_total", "counter",
+                              "溢出线程都在忙、直接关闭的连接数", static_cast<double>(queueCounters_->dropped.load()));
+
+        auto pool = dbPool_->getStats();
+        Metrics::appendSample(out, "geartracker_db_pool_connections", "gauge", "连接池中的连接数",
+                              static_cast<double>(pool.total));
+        Metrics::appendSample(out, "geartracker_db_pool_in_use", "gauge", "借出的连接数",
+                              static_cast<double>(pool.inUse));
+        Metrics::appendSample(out, "geartracker_db_pool_timeouts_total", "counter", "等待空闲连接超时次数",
+                              static_cast<double>(pool.timeouts));
+
+        auto cache = StatementCache::globalStats();
+        Metrics::appendSample(out, "geartracker_db_statement_cache_hits_total", "counter", "预处理语句缓存命中次数",
+                              static_cast<double>(cache.hits));
+        Metrics::appendSample(out, "geartracker_db_statement_cache_misses_total", "counter", "预处理语句缓存未命中次数",
+                              static_cast<double>(cache.misses));
+
+        auto oplog = OperationLogQueue::instance().getStats();
+        Metrics::appendSample(out, "geartracker_oplog_queue_pending", "gauge", "等待写入的操作日志数",
+                              static_cast<double>(oplog.pending));
+        Metrics::appendSample(out, "geartracker_events_subscribers", "gauge", "实时事件订阅者数",
+                              static_cast<double>(EventBus::instance().subscriberCount()));
+        Metrics::appendSample(out, "geartracker_log_dropped_total", "counter", "日志缓冲区满时丢弃的日志条数",
+                              static_cast<double>(Logger::instance().droppedCount()));
+        Metrics::appendSample(out, "geartracker_slow_queries_total", "counter", "超过 slow_query_ms 的 SQL 语句数",
+                              static_cast<double>(SlowQueryLog::instance().getStats().recorded));
+
+        res.set_header("Cache-Control", "no-store");
+        res.set_content(std::move(out), "text/plain; version=0.0.4; charset=utf-8");
+    });
+
+    // ====== 慢查询日志 ======
+    // 最近的慢查询（含执行计划）和按规范化 SQL 的汇总；limit 限制两者的条数
+    server->Get("/api/admin/slow-queries", [](const httplib::Request& req, httplib::Response& res) {
+        size_t limit = 50;
+        if (req.has_param("limit")) {
+            limit = static_cast<size_t>(std::max(1, std::min(1000, std::atoi(req.get_param_value("limit").c_str()))));
+        }
+        SlowQueryLog& slowLog = SlowQueryLog::instance();
+        auto stats = slowLog.getStats();
+        auto entries = slowLog.recent(limit);
+        auto summary = slowLog.summary(limit);
+
+        JsonWriter out(512 + entries.size() * 512 + summary.size() * 256);
+        out.beginObject()
+           .field("enabled", stats.enabled)
+           .field("threshold_ms", stats.thresholdMs)
+           .field("recorded", stats.recorded)
+           .field("dropped", stats.dropped);
+        out.key("summary").beginArray();
+        for (const auto& item : summary) {
+            out.beginObject()
+               .field("query", item.query)
+               .field("sql", item.sql)
+               .field("count", item.count)
+               .field("total_ms", item.totalMs)
+               .field("avg_ms", item.totalMs / static_cast<double>(item.count))
+               .field("max_ms", item.maxMs)
+               .field("max_rows", item.maxRows)
+               .endObject();
+        }
+        out.endArray();
+        out.key("entries").beginArray();
+        for (const auto& entry : entries) {
+            out.beginObject()
+               .field("id", entry.id)
+               .field("time", entry.time)
+               .field("query", entry.query)
+               .field("sql", entry.sql)
+               .field("duration_ms", entry.durationMs)
+               .field("rows", entry.rows);
+            out.key("params").beginArray();
+            for (const auto& shape : entry.params) {
+                out.value(shape);
+            }
+            out.endArray();
+            out.key("plan").beginArray();
+            for (const auto& row : entry.plan) {
+                out.value(row);
+            }
+            out.endArray();
+            out.optionalField("plan_error", entry.planError);
+            out.endObject();
+        }
+        out.endArray().endObject();
+        res.set_header("Cache-Control", "no-store");
+        res.set_content(out.take(), "application/json");
+    });
+
+    // 清空内存中的慢查询记录和汇总（日志文件不受影响）
+    server->Delete("/api/admin/slow-queries", [](const httplib::Request&, httplib::Response& res) {
+        SlowQueryLog::instance().clear();
+        res.set_content(jsonObject("success", true), "application/json");
+    });
+
+    server->Get("/api/connection-status", [this](const httplib::Request&, httplib::Response& res) {
+        JsonWriter out(1536);
+        out.beginObject();
         try {
-            Database db(config_); // 创建独立数据库实例
+            auto db = dbPool_->acquire();
             
-            if (db.testConnection()) {
-                response["status"] = "connected";
-                response["message"] = "数据库连接正常";
+            // 健康检查需要真实往返，因此显式测试借到的连接
+            if (db && db->testConnection()) {
+                out.field("status", "connected").field("message", "数据库连接正常");
             } else {
-                response["status"] = "disconnected";
-                response["error"] = "数据库连接失败";
+                out.field("status", "disconnected").field("error", "数据库连接失败");
             }
         } catch (const std::exception& e) {
-            response["status"] = "disconnected";
-            response["error"] = e.what();
+            out.field("status", "disconnected").field("error", e.what());
         }
         
-        res.set_content(response.dump(), "application/json");
+        out.field("log_dropped", Logger::instance().droppedCount());
+        
+        auto queueStats = OperationLogQueue::instance().getStats();
+        out.key("oplog_queue").beginObject()
+           .field("enabled", queueStats.enabled)
+           .field("pending", queueStats.pending)
+           .field("flushed", queueStats.flushed)
+           .field("rejected", queueStats.rejected)
+           .field("flush_errors", queueStats.flushErrors)
+           .endObject();
+        
+        out.key("events").beginObject()
+           .field("subscribers", EventBus::instance().subscriberCount())
+           .field("last_id", EventBus::instance().lastId())
+           .endObject();
+        
+        uint64_t accepted = queueCounters_->accepted.load();
+        out.key("http").beginObject()
+           .field("workers", queueCounters_->workers.load())
+           .field("active", queueCounters_->active.load())
+           .field("queued", queueCounters_->queued.load())
+           .field("max_queued", queueOptions_.maxQueued)
+           .field("accepted", accepted)
+           .field("overflowed", queueCounters_->overflowed.load())
+           .field("dropped", queueCounters_->dropped.load())
+           .field("avg_wait_ms", accepted == 0 ? 0.0 :
+                  static_cast<double>(queueCounters_->waitMsTotal.load()) / accepted)
+           .field("max_wait_ms", queueCounters_->waitMsMax.load())
+           .endObject();
+        
+        out.key("item_catalog").beginObject()
+           .field("ready", ItemCatalog::instance().ready())
+           .field("items", ItemCatalog::instance().size())
+           .endObject();
+        
+        auto engineStats = InventoryEngine::instance().getStats();
+        out.key("inventory_engine").beginObject()
+           .field("mode", InventoryEngine::modeName(engineStats.mode))
+           .field("ready", engineStats.ready)
+           .field("rows", engineStats.rows)
+           .field("items", engineStats.items)
+           .field("locations", engineStats.locations)
+           .field("wal_batches", engineStats.walBatches)
+           .field("wal_bytes", engineStats.walBytes)
+           .field("snapshots", engineStats.snapshots)
+           .field("snapshot_seq", engineStats.lastSnapshotSeq)
+           .endObject();
+        
+        auto indexStats = SearchIndex::instance().getStats();
+        out.key("search_index").beginObject()
+           .field("ready", indexStats.ready)
+           .field("items", indexStats.documents[SearchIndex::ITEMS])
+           .field("inventory", indexStats.documents[SearchIndex::INVENTORY])
+           .field("operation_logs", indexStats.documents[SearchIndex::OPERATION_LOG])
+           .field("queries", indexStats.queries)
+           .endObject();
+        
+        auto cacheStats = StatementCache::globalStats();
+        out.key("statement_cache").beginObject()
+           .field("hits", cacheStats.hits)
+           .field("misses", cacheStats.misses)
+           .field("evictions", cacheStats.evictions)
+           .endObject();
+        
+        auto stats = dbPool_->getStats();
+        out.key("pool").beginObject()
+           .field("total", stats.total)
+           .field("idle", stats.idle)
+           .field("in_use", stats.inUse)
+           .field("max", stats.maxSize)
+           .field("created", stats.created)
+           .field("reused", stats.reused)
+           .field("timeouts", stats.timeouts)
+           .endObject();
+        
+        out.endObject();
+        res.set_content(out.take(), "application/json");
     });
 
     /********************************************************************
@@ -380,109 +1299,88 @@ void WebServer::setupRoutes() {
     
     // ====== 1. 检查物品是否存在 ======
     server->Get("/api/check-item", [this](const httplib::Request &req, httplib::Response &res) {
-        Database db(config_);
-        if (!db.testConnection()) {
-            res.status = 500;
-            res.set_content(json{{"error", "无法连接数据库"}}.dump(), "application/json");
-            return;
-        }
-        
         if (!req.has_param("name")) {
             res.status = 400;
-            res.set_content(json{{"error", "缺少物品名称参数"}}.dump(), "application/json");
+            res.set_content(jsonObject("error", "缺少物品名称参数"), "application/json");
             return;
         }
         
         std::string itemName = req.get_param_value("name");
-        bool exists = db.itemExistsInList(itemName);
         int itemId = -1;
-        if (exists) {
-            itemId = db.getItemIdByName(itemName);
+        if (ItemCatalog::instance().ready()) {
+            // 物品目录已加载，不占用数据库连接
+            itemId = ItemCatalog::instance().idOf(itemName);
+        } else {
+            auto db = dbPool_->acquire();
+            if (!db) {
+                res.status = 500;
+                res.set_content(jsonObject("error", "无法连接数据库"), "application/json");
+                return;
+            }
+            if (db->itemExistsInList(itemName)) {
+                itemId = db->getItemIdByName(itemName);
+            }
+        }
+        bool exists = itemId > 0;
+        if (!exists) {
+            itemId = -1;
         }
         
-        nlohmann::json response = {
-            {"exists", exists},
-            {"itemId", itemId}
-        };
-        res.set_content(response.dump(), "application/json");
+        res.set_content(jsonObject("exists", exists, "itemId", itemId), "application/json");
     });
     
     server->Get("/api/search-items", [this](const httplib::Request &req, httplib::Response &res) {
-        Database db(config_);
-        if (!db.testConnection()) {
+        auto db = dbPool_->acquire();
+        if (!db) {
             res.status = 500;
-            res.set_content(json{{"error", "无法连接数据库"}}.dump(), "application/json");
+            res.set_content(jsonObject("error", "无法连接数据库"), "application/json");
             return;
         }
         
         if (!req.has_param("q")) {
             res.status = 400;
-            res.set_content(json{{"error", "缺少搜索参数"}}.dump(), "application/json");
+            res.set_content(jsonObject("error", "缺少搜索参数"), "application/json");
             return;
         }
         
         std::string query = req.get_param_value("q");
         
         try {
-            // 使用参数化查询防止SQL注入
-            sql::Connection* connection = db.getConnection(); // 使用新添加的方法
-            std::unique_ptr<sql::PreparedStatement> pstmt(
-                connection->prepareStatement(
-                    "SELECT id, name, category, grade, effect, description "
-                    "FROM item_list WHERE name LIKE ? "
-                    "ORDER BY name LIMIT 10"
-                )
-            );
-            std::string searchPattern = "%" + query + "%";
-            pstmt->setString(1, searchPattern);
-            
-            std::unique_ptr<sql::ResultSet> result(pstmt->executeQuery());
-            nlohmann::json items = nlohmann::json::array();
-            
-            while (result->next()) {
-                nlohmann::json item;
-                item["id"] = result->getInt("id");
-                item["name"] = result->getString("name");
-                item["category"] = result->getString("category");
-                item["grade"] = result->getString("grade");
-                item["effect"] = result->getString("effect");
-                
-                if (!result->isNull("description")) {
-                    item["description"] = result->getString("description");
-                } else {
-                    item["description"] = "";
-                }
-                
-                items.push_back(item);
+            // 索引可用时走倒排索引，否则回退到参数化的 LIKE 查询
+            auto matches = db->searchItems(query, 10);
+            JsonWriter out(64 + matches.size() * 256);
+            out.beginArray();
+            for (const auto& match : matches) {
+                out.beginObject()
+                   .field("id", std::atoi(Database::safeGet(match, "id", "0").c_str()))
+                   .field("name", Database::safeGet(match, "name", ""))
+                   .field("category", Database::safeGet(match, "category", ""))
+                   .field("grade", Database::safeGet(match, "grade", ""))
+                   .field("effect", Database::safeGet(match, "effect", ""))
+                   .field("description", Database::safeGet(match, "description", ""))
+                   .endObject();
             }
+            out.endArray();
             
-            res.set_content(items.dump(), "application/json");
+            res.set_content(out.take(), "application/json");
             
-        } catch (sql::SQLException &e) {
-            nlohmann::json error = {
-                {"error", "数据库查询错误"},
-                {"code", e.getErrorCode()},
-                {"message", e.what()}
-            };
+        } catch (const StorageError &e) {
             res.status = 500;
-            res.set_content(error.dump(), "application/json");
+            res.set_content(jsonObject("error", "数据库查询错误", "code", e.getErrorCode(), "message", e.what()),
+                            "application/json");
         } catch (const std::exception& e) {
-            nlohmann::json error = {
-                {"error", "搜索物品失败"},
-                {"message", e.what()}
-            };
             res.status = 500;
-            res.set_content(error.dump(), "application/json");
+            res.set_content(jsonObject("error", "搜索物品失败", "message", e.what()), "application/json");
         }
     });
 
     
     // ====== 3. 添加物品 ======
     server->Post("/api/add-item", [this](const httplib::Request &req, httplib::Response &res) {
-        Database db(config_);
-        if (!db.testConnection()) {
+        auto db = dbPool_->acquire();
+        if (!db) {
             res.status = 500;
-            res.set_content(json{{"error", "无法连接数据库"}}.dump(), "application/json");
+            res.set_content(jsonObject("error", "无法连接数据库"), "application/json");
             return;
         }
         
@@ -499,7 +1397,7 @@ void WebServer::setupRoutes() {
             
             // 如果是新物品，先添加到物品列表
             if (isNewItem) {
-                if (!db.addItemToList(
+                if (!db->addItemToList(
                     itemName,
                     itemInfo["category"].get<std::string>(),
                     itemInfo["grade"].get<std::string>(),
@@ -508,16 +1406,12 @@ void WebServer::setupRoutes() {
                     itemInfo["note"].get<std::string>(),
                     reason
                 )) {
-                    nlohmann::json response = {
-                        {"success", false},
-                        {"message", "添加物品到列表失败"}
-                    };
-                    res.set_content(response.dump(), "application/json");
+                    res.set_content(jsonObject("success", false, "message", "添加物品到列表失败"), "application/json");
                     return;
                 }
                 
                 // 获取新添加物品的ID
-                itemId = db.getItemIdByName(itemName);
+                itemId = db->getItemIdByName(itemName);
                 if (itemId <= 0) {
                     throw std::runtime_error("获取新物品ID失败");
                 }
@@ -526,25 +1420,161 @@ void WebServer::setupRoutes() {
             }
             
             // 添加到库存
-            if (db.addItemToInventory(itemId, quantity, location, reason)) {
-                nlohmann::json response = {
-                    {"success", true}
-                };
-                res.set_content(response.dump(), "application/json");
+            if (db->addItemToInventory(itemId, quantity, location, reason)) {
+                res.set_content(jsonObject("success", true), "application/json");
             } else {
-                nlohmann::json response = {
-                    {"success", false},
-                    {"message", "添加到库存失败"}
-                };
-                res.set_content(response.dump(), "application/json");
+                res.set_content(jsonObject("success", false, "message", "添加到库存失败"), "application/json");
             }
         } catch (const std::exception& e) {
-            nlohmann::json response = {
-                {"success", false},
-                {"message", e.what()}
-            };
             res.status = 400;
-            res.set_content(response.dump(), "application/json");
+            res.set_content(jsonObject("success", false, "message", e.what()), "application/json");
+        }
+    });
+}
+
+// Web 界面文件：注册在所有 API 路由之后，匹配其余 GET/HEAD 请求
+void WebServer::setupStaticRoutes() {
+    server->Get(".*", [this](const httplib::Request& req, httplib::Response& res) {
+        const StaticAssets::Asset* asset = staticAssets_.find(req.path);
+        if (!asset) {
+            res.status = 404;
+            res.set_content("Not Found", "text/plain; charset=utf-8");
+            return;
+        }
+
+        bool gzip = !asset->gzip.empty() &&
+                    HttpCompression::accepts(req.get_header_value("Accept-Encoding"), HttpCompression::GZIP);
+        if (!asset->gzip.empty()) {
+            res.set_header("Vary", "Accept-Encoding");
+        }
+        // 带内容哈希的文件名内容不会变化，浏览器缓存一年且不再验证
+        std::string cacheControl = asset->immutable ? "public, max-age=31536000, immutable" : "no-cache";
+        if (notModified(req, res, asset->etag)) {
+            res.headers.erase("Cache-Control");
+            res.set_header("Cache-Control", cacheControl);
+            return;
+        }
+
+        res.set_header("Cache-Control", cacheControl);
+        if (gzip) {
+            res.set_header("Content-Encoding", "gzip");
+            res.set_header("ETag", encodedETag(asset->etag, HttpCompression::GZIP));
+            res.set_content(asset->gzip, asset->contentType);
+        } else {
+            res.set_header("ETag", asset->etag);
+            res.set_content(asset->body, asset->contentType);
         }
     });
 }
+
+// 按 Accept-Encoding 压缩较大的文本响应（API 的 JSON 等），已经压缩过的（预压缩的静态文件）不处理。
+// 在 httplib 写出响应前调用，此时 Content-Length 已经按原始内容设置，需要替换
+void WebServer::compressResponse(const httplib::Request& req, httplib::Response& res) const {
+    if (req.method == "HEAD" || res.status == 206 || res.body.size() < compressionMinBytes_ ||
+        res.has_header("Content-Encoding") ||
+        !HttpCompression::compressible(res.get_header_value("Content-Type"))) {
+        return;
+    }
+    TRACE_SPAN("WebServer::compressResponse");
+    HttpCompression::Encoding encoding = HttpCompression::negotiate(req.get_header_value("Accept-Encoding"));
+    if (!res.has_header("Vary")) {
+        res.set_header("Vary", "Accept-Encoding");
+    }
+    if (encoding == HttpCompression::IDENTITY) {
+        return;
+    }
+
+    std::string compressed;
+    if (!HttpCompression::compress(encoding, res.body, compressed, compressionLevel_) ||
+        compressed.size() >= res.body.size()) {
+        return;
+    }
+    res.body = std::move(compressed);
+    res.set_header("Content-Encoding", HttpCompression::name(encoding));
+    res.headers.erase("Content-Length");
+    res.set_header("Content-Length", std::to_string(res.body.size()));
+    if (res.has_header("ETag")) {
+        std::string etag = res.get_header_value("ETag");
+        res.headers.erase("ETag");
+        res.set_header("ETag", encodedETag(etag, encoding));
+    }
+}
+
+// 检查一次数据库连接，状态与上次不同（或第一次检查）时发布 connection 事件
+void WebServer::checkConnectionHealth(bool& lastConnected, bool& known) {
+    bool connected = false;
+    std::string error;
+    try {
+        auto db = dbPool_->acquire();
+        connected = db && db->testConnection();
+        if (!connected) {
+            error = "数据库连接失败";
+        }
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+    if (known && connected == lastConnected) {
+        return;
+    }
+    known = true;
+    lastConnected = connected;
+    std::string data = connected ? jsonObject("status", "connected")
+                                 : jsonObject("status", "disconnected", "error", error);
+    EventBus::instance().publish("connection", std::move(data), true);
+}
+
+// [web] 节。route_timeouts 形如 "/api/events=0, /api/inventory/batch=15000"，按最长前缀匹配
+void WebServer::loadWebOptions() {
+    unsigned hardware = std::thread::hardware_concurrency();
+    int defaultThreads = static_cast<int>(std::max(8u, hardware > 0 ? hardware - 1 : 0u));
+    queueOptions_.workers = static_cast<size_t>(std::max(1, config_.getInt("web", "threads", defaultThreads)));
+    queueOptions_.maxQueued = static_cast<size_t>(std::max(0, config_.getInt("web", "max_queued", 64)));
+    queueOptions_.overflowThreads = static_cast<size_t>(std::max(1, config_.getInt("web", "overflow_threads", 2)));
+    queueOptions_.overflowTimeoutMs = std::max(1, config_.getInt("web", "overflow_timeout_ms", 1000));
+    readTimeout_ = std::max(1, config_.getInt("web", "read_timeout", 20));
+    writeTimeout_ = std::max(1, config_.getInt("web", "write_timeout", 20));
+    keepAliveMaxRequests_ = std::max(1, config_.getInt("web", "keep_alive_max_requests", 100));
+    keepAliveTimeout_ = std::max(1, config_.getInt("web", "keep_alive_timeout", 5));
+    retryAfter_ = std::max(1, config_.getInt("web", "retry_after", 5));
+    queueTimeoutMs_ = std::max(0, config_.getInt("web", "queue_timeout_ms", 5000));
+
+    routeTimeouts_.clear();
+    std::stringstream list(config_.getString("web", "route_timeouts", ""));
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) continue;
+        std::string prefix = item.substr(0, eq);
+        prefix.erase(0, prefix.find_first_not_of(" \t"));
+        prefix.erase(prefix.find_last_not_of(" \t") + 1);
+        if (prefix.empty()) continue;
+        routeTimeouts_.emplace_back(prefix, std::max(0, std::atoi(item.c_str() + eq + 1)));
+    }
+    std::sort(routeTimeouts_.begin(), routeTimeouts_.end(),
+              [](const std::pair<std::string, int>& a, const std::pair<std::string, int>& b) {
+                  return a.first.size() > b.first.size();
+              });
+
+    if (static_cast<size_t>(eventsMaxClients_ + exportMaxClients_) >= queueOptions_.workers) {
+        GT_LOG_WARNING("events_max_clients 与 export_max_clients 之和不小于 HTTP 工作线程数，"
+                       "事件流和导出可能占满全部工作线程");
+    }
+}
+
+int WebServer::routeTimeoutMs(const std::string& path) const {
+    for (const auto& route : routeTimeouts_) {
+        if (path.compare(0, route.first.size(), route.first) == 0) {
+            return route.second;
+        }
+    }
+    return queueTimeoutMs_;
+}
+
+void WebServer::rejectBusy(httplib::Response& res, bool closeConnection) const {
+    res.status = 503;
+    res.set_header("Retry-After", std::to_string(retryAfter_));
+    if (closeConnection) {
+        res.set_header("Connection", "close"); // 溢出线程上 HttpServer 回复后即关闭连接
+    }
+    res.set_content(jsonObject("error", "服务器繁忙，请稍后重试", "code", "SERVER_BUSY"), "application/json");
+}
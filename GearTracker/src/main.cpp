@@ -1,6 +1,9 @@
 #include "Database.h"
 #include "WebServer.h"
 #include "Config.h"
+#include "Importer.h"
+#include "SlowQueryLog.h"
+#include "Trace.h"
 #include <iostream>
 #include <limits>
 #include <cctype>
@@ -106,15 +109,32 @@ void reloadConfig(Database& db);
 void createDefaultConfigIfMissing();
 void deleteInventoryItem(Database& db);
 void modifyInventoryItem(Database& db);
+int importCommand(int argc, char* argv[]);
 
-int main() {
+int main(int argc, char* argv[]) {
     // 创建默认配置（如果需要）
     createDefaultConfigIfMissing();
+
+    // geartracker import <文件> [选项]：批量导入后退出，不启动菜单和 Web 服务
+    if (argc >= 2 && std::string(argv[1]) == "import") {
+        return importCommand(argc, argv);
+    }
     
     try {
         // 创建配置实例
         Config config;
         
+        // 按配置启动异步日志
+        Logger::instance().configure(config);
+        Metrics::instance().configure(config);
+        Trace::instance().configure(config);
+        SlowQueryLog::instance().configure(config);
+        CountService::instance().configure(config);
+        DataVersion::instance().configure(config);
+        EventBus::instance().configure(config);
+        OperationLogQueue::instance().configure(config);
+        InventoryEngine::instance().configure(config); // primary 模式在这里读取快照并重放 WAL
+        
         // 创建数据库实例（堆分配）
          Database db(config);
         // 尝试连接数据库
@@ -122,7 +142,12 @@ int main() {
             throw std::runtime_error("无法连接到数据库");
         }
         
-        std::cout << "成功连接到MySQL数据库!\n";
+        std::cout << "成功连接到数据库 (" << config.getString("database", "backend", "mysql") << ")!\n";
+        
+        // 内存库存引擎：cache 模式从数据库加载，primary 模式首次启动时从数据库导入
+        if (!db.loadInventoryEngine()) {
+            std::cerr << "内存库存引擎加载失败，库存查询将访问数据库\n";
+        }
         
         // 启动Web服务器
         int webPort = 8080; // 默认端口
@@ -163,6 +188,10 @@ int main() {
         
         // 停止Web服务器（如果需要显式停止）
         server.stop();
+        SlowQueryLog::instance().shutdown();      // 写出尚未写入的慢查询
+        OperationLogQueue::instance().shutdown(); // 写出尚未写入的操作日志
+        InventoryEngine::instance().shutdown();   // primary 模式写最后一次快照
+        Logger::instance().shutdown();
     } catch (const std::exception& e) {
         std::cerr << "初始化失败: " << e.what() << "\n";
         std::cerr << "请检查配置文件 config.ini\n";
@@ -197,13 +226,13 @@ void displayInventory(Database& db) {
                   << "最后更新\n";
         
         for (const auto& item : inventory) {
-            std::cout << std::setw(6) << Database::safeGet(item, "inventory_id") 
-                      << std::setw(8) << Database::safeGet(item, "item_id")
-                      << std::setw(20) << Database::safeGet(item, "item_name")
-                      << std::setw(6) << Database::safeGet(item, "quantity")
-                      << std::setw(15) << Database::safeGet(item, "location")
-                      << std::setw(20) << Database::safeGet(item, "stored_time")
-                      << Database::safeGet(item, "last_updated") << "\n";
+            std::cout << std::setw(6) << item.id
+                      << std::setw(8) << item.item_id
+                      << std::setw(20) << item.item_name
+                      << std::setw(6) << item.quantity
+                      << std::setw(15) << item.location
+                      << std::setw(20) << item.stored_time
+                      << item.last_updated << "\n";
         }
         
         // 显示操作选项
@@ -263,11 +292,11 @@ void displayOperationLogs(Database& db) {
         // ... 格式代码保持不变 ...
         
         for (const auto& log : logs) {
-            std::cout << std::setw(5) << Database::safeGet(log, "id")
-                      << std::setw(8) << Database::safeGet(log, "operation_type")
-                      << std::setw(20) << Database::safeGet(log, "item_name")
-                      << std::setw(25) << Database::safeGet(log, "operation_time")
-                      << Database::safeGet(log, "operation_note") << "\n";
+            std::cout << std::setw(5) << log.id
+                      << std::setw(8) << log.operation_type
+                      << std::setw(20) << log.item_name
+                      << std::setw(25) << log.operation_time
+                      << log.operation_note << "\n";
         }
         
         // 显示分页导航
@@ -618,6 +647,7 @@ void createDefaultConfigIfMissing() {
         
         if (configFile.is_open()) {
             configFile << "[database]\n";
+            configFile << "backend = mysql\n";
             configFile << "host = 192.168.1.7\n";
             configFile << "port = 3306\n";
             configFile << "username = vm_liaoya\n";
@@ -762,3 +792,117 @@ void modifyInventoryItem(Database& db) {
         }
     }
 }
+
+// ====== 命令行批量导入 ======
+// geartracker import <file.csv|file.ndjson> [--format csv|ndjson] [--rejects 文件] [--chunk 行数] [--reason 原因]
+int importCommand(int argc, char* argv[]) {
+    std::string path, rejectsPath, reason = "批量导入", formatName;
+    long chunkRows = 0;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--rejects" && hasValue) {
+            rejectsPath = argv[++i];
+        } else if (arg == "--chunk" && hasValue) {
+            chunkRows = std::atol(argv[++i]);
+        } else if (arg == "--reason" && hasValue) {
+            reason = argv[++i];
+        } else if (arg == "--format" && hasValue) {
+            formatName = argv[++i];
+        } else if (path.empty() && arg.compare(0, 2, "--") != 0) {
+            path = arg;
+        } else {
+            path.clear();
+            break;
+        }
+    }
+    Importer::Format format = Importer::CSV;
+    if (path.empty() || !Importer::formatFromName(formatName.empty() ? path : formatName, format)) {
+        std::cerr << "用法: geartracker import <文件.csv|文件.ndjson> [--format csv|ndjson] "
+                     "[--rejects 拒绝行文件] [--chunk 每批行数] [--reason 操作原因]\n";
+        return 2;
+    }
+
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        std::cerr << "无法打开文件: " << path << "\n";
+        return 1;
+    }
+    // 被拒绝的行写成 NDJSON：{"line":行号,"error":原因,"row":原始文本}
+    std::ofstream rejects;
+    if (!rejectsPath.empty()) {
+        rejects.open(rejectsPath, std::ios::binary | std::ios::trunc);
+        if (!rejects) {
+            std::cerr << "无法写入拒绝行文件: " << rejectsPath << "\n";
+            return 1;
+        }
+    }
+
+    int exitCode = 0;
+    try {
+        Config config;
+        Logger::instance().configure(config);
+        Metrics::instance().configure(config);
+        Trace::instance().configure(config);
+        SlowQueryLog::instance().configure(config);
+        CountService::instance().configure(config);
+        DataVersion::instance().configure(config);
+        OperationLogQueue::instance().configure(config);
+        InventoryEngine::instance().configure(config);
+
+        Database db(config);
+        if (!db.connect()) {
+            throw std::runtime_error("无法连接到数据库");
+        }
+        if (!db.loadInventoryEngine()) {
+            std::cerr << "内存库存引擎加载失败，库存将直接写入数据库\n";
+        }
+
+        Importer::Options options;
+        options.chunkRows = static_cast<size_t>(
+            chunkRows > 0 ? chunkRows : std::max(1, config.getInt("application", "import_chunk_rows", 1000)));
+        options.reason = reason;
+        size_t firstRejects = 0;
+        options.onReject = [&](const Importer::Reject& reject) {
+            if (rejects.is_open()) {
+                JsonWriter out(reject.row.size() + 64);
+                out.beginObject().field("line", reject.line).field("error", reject.error)
+                   .field("row", reject.row).endObject().endLine();
+                rejects << out.str();
+            } else if (firstRejects++ < 20) {
+                std::cerr << "第 " << reject.line << " 行: " << reject.error << "\n";
+            }
+        };
+        options.onProgress = [](const Importer::Progress& progress) {
+            std::cerr << "\r已处理 " << progress.rows << " 行 (" << progress.bytesRead / 1024 << " KB, "
+                      << static_cast<long long>(progress.rows / std::max(progress.seconds, 0.001)) << " 行/秒)"
+                      << std::flush;
+        };
+
+        Importer::Progress progress;
+        std::string error;
+        bool ok = Importer::run(db, input, format, options, progress, error);
+        std::cerr << "\n";
+        std::cout << "导入完成: " << progress.rows << " 行, 新建物品 " << progress.itemsCreated
+                  << ", 添加库存 " << progress.inventoryAdded << ", 拒绝 " << progress.rejected
+                  << ", 用时 " << std::fixed << std::setprecision(2) << progress.seconds << " 秒\n";
+        if (!ok) {
+            std::cerr << "导入中止: " << error << "\n";
+            exitCode = 1;
+        } else if (progress.rejected > 0) {
+            if (!rejectsPath.empty()) {
+                std::cerr << "被拒绝的行已写入 " << rejectsPath << "\n";
+            }
+            exitCode = 3;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "初始化失败: " << e.what() << "\n";
+        std::cerr << "请检查配置文件 config.ini\n";
+        exitCode = 1;
+    }
+    SlowQueryLog::instance().shutdown();
+    OperationLogQueue::instance().shutdown();
+    InventoryEngine::instance().shutdown();
+    Logger::instance().shutdown();
+    return exitCode;
+}
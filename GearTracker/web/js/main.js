@@ -3,12 +3,60 @@ let currentPage = 1;
 let perPage = 10;
 let totalItems = 0;
 let totalPages = 1;
+let totalEstimated = false; // 总数为估算值时显示“约”
+
+// 库存键集分页状态：请求当前页所用的游标，以及服务器返回的前后页游标
+let requestCursor = '';
+let requestDir = 'next';
+let nextCursor = null;
+let prevCursor = null;
 
 // 操作日志页面分页状态
 let currentLogPage = 1;
 let perLogPage = 10;
 let totalLogItems = 0;
 let totalLogPages = 1;
+let totalLogEstimated = false;
+let logsRequestCursor = '';
+let logsRequestDir = 'next';
+let logsNextCursor = null;
+let logsPrevCursor = null;
+
+// 列表接口的 ETag 缓存：再次请求同一 URL 时带上 If-None-Match，
+// 数据没有变化时服务器回复 304，直接使用上次的结果
+const etagCache = new Map();
+const ETAG_CACHE_LIMIT = 50;
+
+function fetchJsonWithETag(url, options = {}) {
+    const cached = etagCache.get(url);
+    const headers = Object.assign({}, options.headers);
+    if (cached) {
+        headers['If-None-Match'] = cached.etag;
+    }
+    return fetch(url, Object.assign({}, options, { headers, cache: 'no-store' }))
+        .then(response => {
+            if (response.status === 304 && cached) {
+                // 移到末尾，淘汰时按最近使用的顺序
+                etagCache.delete(url);
+                etagCache.set(url, cached);
+                return cached.data;
+            }
+            if (!response.ok) {
+                throw new Error(`HTTP错误! 状态码: ${response.status}`);
+            }
+            const etag = response.headers.get('ETag');
+            return response.json().then(data => {
+                if (etag) {
+                    etagCache.delete(url);
+                    etagCache.set(url, { etag, data });
+                    if (etagCache.size > ETAG_CACHE_LIMIT) {
+                        etagCache.delete(etagCache.keys().next().value);
+                    }
+                }
+                return data;
+            });
+        });
+}
 
 // 添加物品状态管理对象
 let addingItemState = {
@@ -35,85 +83,86 @@ document.addEventListener('DOMContentLoaded', function() {
             });
             document.getElementById(`${section}-section`).classList.add('active');
 
-            // ====== 操作日志分页事件绑定 ======
-            document.getElementById('logs-prev-page').addEventListener('click', function() {
-                console.log("点击上一页按钮");
-                if (currentLogPage > 1) {
-                    currentLogPage--;
-                    loadLogsData();
-                } else {
-                    console.log("已在第一页");
-                }
-            });
-            
-            document.getElementById('logs-next-page').addEventListener('click', function() {
-                console.log("点击下一页按钮");
-                if (currentLogPage < totalLogPages) {
-                    currentLogPage++;
-                    loadLogsData();
-                } else {
-                    console.log("已在最后一页");
-                }
-            });
-            
-            document.getElementById('logs-per-page').addEventListener('change', function() {
-                perLogPage = parseInt(this.value) || 10;
-                console.log("更改每页数量:", perLogPage);
-                currentLogPage = 1;
-                loadLogsData();
-            });
-            
-            // 日志刷新按钮
-            document.getElementById('refresh-logs').addEventListener('click', function() {
-                console.log("刷新日志");
-                loadLogsData();
-            });
-            
-            // 日志搜索按钮
-            document.getElementById('apply-log-filter').addEventListener('click', function() {
-                console.log("应用日志筛选");
-                currentLogPage = 1;
-                loadLogsData();
-            });
-            
-            // 导航到日志页面时自动加载
-            document.querySelector('a[data-section="logs"]').addEventListener('click', function() {
-                console.log("导航到日志页面");
-                currentLogPage = 1;
-                perLogPage = parseInt(document.getElementById('logs-per-page').value) || 10;
-                
-                setTimeout(function() {
-                    loadLogsData();
-                }, 100);
-            });
             // 如果是库存部分，加载数据
             if (section === 'inventory') {
                 loadInventoryData();
             }
             if (section === 'logs') {
+                // 导航到日志页面时从第一页开始
+                resetLogsPaging();
+                perLogPage = parseInt(document.getElementById('logs-per-page').value) || 10;
                 loadLogsData();
             }
         });
     });
     
+    // ====== 操作日志分页事件绑定（只绑定一次）======
+    document.getElementById('logs-prev-page').addEventListener('click', function() {
+        if (logsPrevCursor) {
+            currentLogPage--;
+            if (currentLogPage <= 1) {
+                resetLogsPaging();
+            } else {
+                logsRequestCursor = logsPrevCursor;
+                logsRequestDir = 'prev';
+            }
+            loadLogsData();
+        }
+    });
+    
+    document.getElementById('logs-next-page').addEventListener('click', function() {
+        if (logsNextCursor) {
+            currentLogPage++;
+            logsRequestCursor = logsNextCursor;
+            logsRequestDir = 'next';
+            loadLogsData();
+        }
+    });
+    
+    document.getElementById('logs-per-page').addEventListener('change', function() {
+        perLogPage = parseInt(this.value) || 10;
+        resetLogsPaging();
+        loadLogsData();
+    });
+    
+    // 日志刷新按钮（停留在当前页）
+    document.getElementById('refresh-logs').addEventListener('click', function() {
+        loadLogsData();
+    });
+    
+    // 日志搜索按钮
+    document.getElementById('apply-log-filter').addEventListener('click', function() {
+        resetLogsPaging();
+        loadLogsData();
+    });
+    
     // 分页控件事件
     document.getElementById('prev-page').addEventListener('click', function() {
-        if (currentPage > 1) {
+        if (prevCursor) {
             currentPage--;
+            if (currentPage <= 1) {
+                // 回到第一页时直接取最新数据，期间新增的记录也能看到
+                resetInventoryPaging();
+            } else {
+                requestCursor = prevCursor;
+                requestDir = 'prev';
+            }
             loadInventoryData();
         }
     });
     
     document.getElementById('next-page').addEventListener('click', function() {
-        if (currentPage < totalPages) {
+        if (nextCursor) {
             currentPage++;
+            requestCursor = nextCursor;
+            requestDir = 'next';
             loadInventoryData();
         }
     });
     
     document.getElementById('per-page').addEventListener('change', function() {
         perPage = parseInt(this.value);
-        currentPage = 1;
+        resetInventoryPaging();
         loadInventoryData();
     });
     
@@ -130,7 +179,7 @@ document.addEventListener('DOMContentLoaded', function() {
     
     // 搜索按钮
     document.getElementById('apply-filter').addEventListener('click', function() {
-        currentPage = 1;
+        resetInventoryPaging();
         loadInventoryData();
     });
     
@@ -299,41 +348,9 @@ document.addEventListener('DOMContentLoaded', function() {
     // 初始加载库存数据
     loadInventoryData();
     
-    // 添加连接状态监控
-    function checkConnectionStatus() {
-        fetch('/api/connection-status')
-            .then(response => {
-                if (!response.ok) throw new Error('网络请求失败');
-                return response.json();
-            })
-            .then(data => {
-                const statusElem = document.getElementById('connection-status');
-                
-                // 移除所有状态类
-                statusElem.classList.remove('connected', 'disconnected', 'unknown');
-                
-                if (data.status === 'connected') {
-                    statusElem.classList.add('connected');
-                    statusElem.querySelector('.status-text').textContent = '数据库已连接';
-                } else {
-                    statusElem.classList.add('disconnected');
-                    const errorMsg = data.error ? data.error.substring(0, 50) : '未知错误';
-                    statusElem.querySelector('.status-text').textContent = `连接失败: ${errorMsg}`;
-                }
-            })
-            .catch(error => {
-                const statusElem = document.getElementById('connection-status');
-                statusElem.classList.remove('connected', 'disconnected');
-                statusElem.classList.add('unknown');
-                statusElem.querySelector('.status-text').textContent = '连接状态未知';
-            });
-    }
-    
-    // 初始检查
+    // 初始检查；之后的变化由 /api/events 推送，事件流不可用时每30秒检查一次
     checkConnectionStatus();
-    
-    // 每30秒检查一次
-    setInterval(checkConnectionStatus, 30000);
+    connectEvents();
     
     // 添加点击刷新功能
     document.getElementById('connection-status').addEventListener('click', function() {
@@ -343,6 +360,143 @@ document.addEventListener('DOMContentLoaded', function() {
     });
 });
 
+// 添加连接状态监控
+function checkConnectionStatus() {
+    fetch('/api/connection-status')
+        .then(response => {
+            if (!response.ok) throw new Error('网络请求失败');
+            return response.json();
+        })
+        .then(showConnectionStatus)
+        .catch(error => {
+            const statusElem = document.getElementById('connection-status');
+            statusElem.classList.remove('connected', 'disconnected');
+            statusElem.classList.add('unknown');
+            statusElem.querySelector('.status-text').textContent = '连接状态未知';
+        });
+}
+
+function showConnectionStatus(data) {
+    const statusElem = document.getElementById('connection-status');
+    
+    // 移除所有状态类
+    statusElem.classList.remove('connected', 'disconnected', 'unknown');
+    
+    if (data.status === 'connected') {
+        statusElem.classList.add('connected');
+        statusElem.querySelector('.status-text').textContent = '数据库已连接';
+    } else {
+        statusElem.classList.add('disconnected');
+        const errorMsg = data.error ? data.error.substring(0, 50) : '未知错误';
+        statusElem.querySelector('.status-text').textContent = `连接失败: ${errorMsg}`;
+    }
+}
+
+// ====== 实时事件（Server-Sent Events）======
+// 服务器推送库存变化、新的操作日志和连接状态，表格按增量更新，不再整页重新加载。
+// 断线后浏览器自动重连并补发期间的事件；无法补发时收到 reset，重新加载当前页
+let statusPollTimer = null;
+
+function startStatusPolling() {
+    if (!statusPollTimer) {
+        statusPollTimer = setInterval(checkConnectionStatus, 30000);
+    }
+}
+
+function stopStatusPolling() {
+    if (statusPollTimer) {
+        clearInterval(statusPollTimer);
+        statusPollTimer = null;
+    }
+}
+
+function connectEvents() {
+    if (!window.EventSource) {
+        startStatusPolling();
+        return;
+    }
+    const source = new EventSource('/api/events');
+    source.addEventListener('open', stopStatusPolling);
+    source.addEventListener('error', () => {
+        // 连接数已满（503）等情况下浏览器不再重连，退回轮询，稍后再试
+        startStatusPolling();
+        if (source.readyState === EventSource.CLOSED) {
+            setTimeout(connectEvents, 30000);
+        }
+    });
+    source.addEventListener('connection', e => showConnectionStatus(JSON.parse(e.data)));
+    source.addEventListener('inventory', e => applyInventoryEvent(JSON.parse(e.data)));
+    source.addEventListener('operation_log', e => applyOperationLogEvent(JSON.parse(e.data)));
+    source.addEventListener('reset', () => {
+        etagCache.clear();
+        loadInventoryData();
+        if (document.getElementById('logs-section').classList.contains('active')) {
+            loadLogsData();
+        }
+    });
+}
+
+// 库存列表第一页且没有搜索条件时，新增和修改的行（按更新时间排在最前）插到表格顶部；
+// 其他页只原地更新已显示的行，删除的行直接移除
+function applyInventoryEvent(data) {
+    const tableBody = document.getElementById('inventory-table').querySelector('tbody');
+    const firstPage = !requestCursor && !document.getElementById('search-items').value;
+    const findRow = id => tableBody.querySelector(`tr[data-id="${id}"]`);
+    
+    (data.removed || []).forEach(id => {
+        const row = findRow(id);
+        if (row) row.remove();
+    });
+    [...(data.updated || []), ...(data.added || [])].forEach(item => {
+        const row = findRow(item.id);
+        const newRow = createInventoryRow(item);
+        if (firstPage) {
+            if (row) row.remove();
+            tableBody.insertBefore(newRow, tableBody.firstChild);
+        } else if (row) {
+            row.replaceWith(newRow);
+        }
+    });
+    if (firstPage) {
+        // 去掉“没有找到库存记录”的提示行，并保持每页行数
+        tableBody.querySelectorAll('tr:not([data-id])').forEach(row => row.remove());
+        const rows = tableBody.querySelectorAll('tr[data-id]');
+        for (let i = perPage; i < rows.length; i++) {
+            rows[i].remove();
+        }
+    }
+    
+    totalItems = Math.max(0, totalItems + (data.added || []).length - (data.removed || []).length);
+    totalPages = Math.max(1, Math.ceil(totalItems / perPage));
+    updatePaginationInfo();
+    // 缓存的列表已过期，下次翻页时重新请求
+    etagCache.clear();
+}
+
+// 操作日志第一页且没有搜索条件时，新记录插到表格顶部
+function applyOperationLogEvent(data) {
+    const logs = data.logs || [];
+    etagCache.clear();
+    if (!logs.length || !document.getElementById('logs-section').classList.contains('active')) {
+        return;
+    }
+    const tableBody = document.getElementById('logs-table').querySelector('tbody');
+    if (!logsRequestCursor && !document.getElementById('search-logs').value) {
+        tableBody.querySelectorAll('td[colspan]').forEach(cell => cell.parentElement.remove());
+        // 同一批中后面的记录更新，依次插到顶部后排在最前
+        logs.forEach(log => {
+            tableBody.insertBefore(createLogRow(log, null), tableBody.firstChild);
+        });
+        while (tableBody.rows.length > perLogPage) {
+            tableBody.deleteRow(tableBody.rows.length - 1);
+        }
+    }
+    totalLogItems += logs.length;
+    totalLogPages = Math.max(1, Math.ceil(totalLogItems / perLogPage));
+    document.getElementById('logs-page-info').textContent = 
+        `第 ${currentLogPage} 页，共 ${totalLogEstimated ? '约 ' : ''}${totalLogPages} 页 (${totalLogEstimated ? '约 ' : ''}${totalLogItems} 条记录)`;
+}
+
 // 加载库存数据
 function loadInventoryData() {
     const tableBody = document.getElementById('inventory-table').querySelector('tbody');
@@ -355,51 +509,25 @@ function loadInventoryData() {
     // 获取搜索值
     const search = document.getElementById('search-items').value;
     
-    // 构建API URL
-    const url = `/api/inventory?page=${currentPage}&perPage=${perPage}&search=${encodeURIComponent(search)}`;
+    // 构建API URL（键集分页：深翻页的代价与第一页相同）
+    const url = `/api/inventory?cursor=${encodeURIComponent(requestCursor)}&dir=${requestDir}` +
+        `&perPage=${perPage}&search=${encodeURIComponent(search)}`;
     
-    // 获取数据
-    fetch(url)
-        .then(response => response.json())
+    // 获取数据（数据未变化时服务器回复 304，使用缓存的结果）
+    fetchJsonWithETag(url)
         .then(data => {
             // 更新分页信息
             totalItems = data.total || 0;
-            totalPages = Math.ceil(totalItems / perPage);
+            totalPages = Math.max(1, Math.ceil(totalItems / perPage));
+            totalEstimated = !!data.totalEstimated;
+            nextCursor = data.next_cursor || null;
+            prevCursor = data.prev_cursor || null;
             updatePaginationInfo();
             
             // 填充表格
             if (data.items && data.items.length > 0) {
                 data.items.forEach(item => {
-                    const row = document.createElement('tr');
-                    row.innerHTML = `
-                        <td>${item.id}</td>
-                        <td>${item.item_id}</td>
-                        <td>${item.item_name || 'N/A'}</td>
-                        <td>${item.quantity}</td>
-                        <td>${item.location}</td>
-                        <td>${formatDate(item.stored_time)}</td>
-                        <td>${formatDate(item.last_updated)}</td>
-                        <td class="actions-cell">
-                            <button class="edit-btn" data-id="${item.id}">编辑</button>
-                            <button class="delete-btn" data-id="${item.id}">删除</button>
-                        </td>
-                    `;
-                    tableBody.appendChild(row);
-                });
-                
-                // 添加行操作事件
-                document.querySelectorAll('.edit-btn').forEach(btn => {
-                    btn.addEventListener('click', function() {
-                        const id = this.getAttribute('data-id');
-                        editItem(id);
-                    });
-                });
-                
-                document.querySelectorAll('.delete-btn').forEach(btn => {
-                    btn.addEventListener('click', function() {
-                        const id = this.getAttribute('data-id');
-                        deleteItem(id);
-                    });
+                    tableBody.appendChild(createInventoryRow(item));
                 });
             } else {
                 const row = document.createElement('tr');
@@ -418,14 +546,50 @@ function loadInventoryData() {
         });
 }
 
+// 生成一行库存（含编辑/删除按钮的事件）
+function createInventoryRow(item) {
+    const row = document.createElement('tr');
+    row.dataset.id = item.id;
+    row.innerHTML = `
+        <td>${item.id}</td>
+        <td>${item.item_id}</td>
+        <td>${item.item_name || 'N/A'}</td>
+        <td>${item.quantity}</td>
+        <td>${item.location}</td>
+        <td>${formatDate(item.stored_time)}</td>
+        <td>${formatDate(item.last_updated)}</td>
+        <td class="actions-cell">
+            <button class="edit-btn" data-id="${item.id}">编辑</button>
+            <button class="delete-btn" data-id="${item.id}">删除</button>
+        </td>
+    `;
+    row.querySelector('.edit-btn').addEventListener('click', () => editItem(String(item.id)));
+    row.querySelector('.delete-btn').addEventListener('click', () => deleteItem(String(item.id)));
+    return row;
+}
+
 // 更新分页信息
 function updatePaginationInfo() {
     document.getElementById('page-info').textContent = 
-        `第 ${currentPage} 页，共 ${totalPages} 页 (${totalItems} 条记录)`;
+        `第 ${currentPage} 页，共 ${totalEstimated ? '约 ' : ''}${totalPages} 页 (${totalEstimated ? '约 ' : ''}${totalItems} 条记录)`;
     
     // 更新按钮状态
-    document.getElementById('prev-page').disabled = currentPage <= 1;
-    document.getElementById('next-page').disabled = currentPage >= totalPages;
+    document.getElementById('prev-page').disabled = !prevCursor;
+    document.getElementById('next-page').disabled = !nextCursor;
+}
+
+// 回到库存第一页
+function resetInventoryPaging() {
+    currentPage = 1;
+    requestCursor = '';
+    requestDir = 'next';
+}
+
+// 回到日志第一页
+function resetLogsPaging() {
+    currentLogPage = 1;
+    logsRequestCursor = '';
+    logsRequestDir = 'next';
 }
 
 // 格式化日期
@@ -615,7 +779,8 @@ function loadLogsData() {
     const search = document.getElementById('search-logs').value || '';
     
     // 构建API URL
-    const url = `/api/operation_logs?page=${currentLogPage}&perPage=${perLogPage}&search=${encodeURIComponent(search)}`;
+    const url = `/api/operation_logs?cursor=${encodeURIComponent(logsRequestCursor)}&dir=${logsRequestDir}` +
+        `&perPage=${perLogPage}&search=${encodeURIComponent(search)}`;
     
     // 添加请求取消机制
     if (window.logsFetchController) {
@@ -623,13 +788,7 @@ function loadLogsData() {
     }
     window.logsFetchController = new AbortController();
     
-    fetch(url, { signal: window.logsFetchController.signal })
-        .then(response => {
-            if (!response.ok) {
-                throw new Error(`HTTP错误! 状态码: ${response.status}`);
-            }
-            return response.json();
-        })
+    fetchJsonWithETag(url, { signal: window.logsFetchController.signal })
         .then(data => {
             // 清除请求控制器引用
             window.logsFetchController = null;
@@ -638,14 +797,17 @@ function loadLogsData() {
                 // 更新分页信息
                 totalLogItems = data.totalItems || 0;
                 totalLogPages = data.totalPages || 1;
+                totalLogEstimated = !!data.totalEstimated;
+                logsNextCursor = data.next_cursor || null;
+                logsPrevCursor = data.prev_cursor || null;
                 
                 // 更新分页UI显示
                 document.getElementById('logs-page-info').textContent = 
-                    `第 ${currentLogPage} 页，共 ${totalLogPages} 页 (${totalLogItems} 条记录)`;
+                    `第 ${currentLogPage} 页，共 ${totalLogEstimated ? '约 ' : ''}${totalLogPages} 页 (${totalLogEstimated ? '约 ' : ''}${totalLogItems} 条记录)`;
                 
                 // 更新按钮状态
-                document.getElementById('logs-prev-page').disabled = currentLogPage <= 1;
-                document.getElementById('logs-next-page').disabled = currentLogPage >= totalLogPages;
+                document.getElementById('logs-prev-page').disabled = !logsPrevCursor;
+                document.getElementById('logs-next-page').disabled = !logsNextCursor;
                 
                 // 填充表格
                 if (data.logs && data.logs.length > 0) {
@@ -653,28 +815,7 @@ function loadLogsData() {
                     const searchPattern = search ? new RegExp(`(${escapeRegExp(search)})`, 'gi') : null;
                     
                     data.logs.forEach(log => {
-                        const row = document.createElement('tr');
-                        
-                        // 根据操作类型添加样式类
-                        const typeClass = `log-type-${log.operation_type}`;
-                        
-                        // 高亮搜索结果
-                        let highlightedItemName = searchPattern 
-                            ? log.item_name.replace(searchPattern, '<mark>$1</mark>')
-                            : log.item_name;
-                        
-                        let highlightedNote = searchPattern 
-                            ? log.operation_note.replace(searchPattern, '<mark极$1</mark>')
-                            : log.operation_note;
-                        
-                        row.innerHTML = `
-                            <td>${log.id}</td>
-                            <td><span class="log-type ${typeClass}">${log.operation_type}</span></td>
-                            <td>${highlightedItemName}</td>
-                            <td>${formatDate(log.operation_time)}</td>
-                            <td>${highlightedNote}</td>
-                        `;
-                        fragment.appendChild(row);
+                        fragment.appendChild(createLogRow(log, searchPattern));
                     });
                     tableBody.appendChild(fragment);
                 } else {
@@ -708,6 +849,32 @@ function loadLogsData() {
         });
 }
 
+// 生成一行操作日志，searchPattern 非空时高亮匹配的文字
+function createLogRow(log, searchPattern) {
+    const row = document.createElement('tr');
+    
+    // 根据操作类型添加样式类
+    const typeClass = `log-type-${log.operation_type}`;
+    
+    // 高亮搜索结果
+    const highlightedItemName = searchPattern 
+        ? log.item_name.replace(searchPattern, '<mark>$1</mark>')
+        : log.item_name;
+    
+    const highlightedNote = searchPattern 
+        ? log.operation_note.replace(searchPattern, '<mark>$1</mark>')
+        : log.operation_note;
+    
+    row.innerHTML = `
+        <td>${log.id > 0 ? log.id : '待写入'}</td>
+        <td><span class="log-type ${typeClass}">${log.operation_type}</span></td>
+        <td>${highlightedItemName}</td>
+        <td>${formatDate(log.operation_time)}</td>
+        <td>${highlightedNote}</td>
+    `;
+    return row;
+}
+
 // 辅助函数：转义正则表达式特殊字符
 function escapeRegExp(string) {
     return string.replace(/[.*+?^${}()|[\]\\]/g, '\\$&');